@@ -40,6 +40,8 @@
 #include <glog/logging.h>
 #include "control_message_factory.h"
 #include "gnss_synchro.h"
+#include "gps_acquisition_assistance.h"
+#include "gps_vector_tracking.h"
 #include "concurrent_map.h"
 #include "sbas_telemetry_data.h"
 #include "sbas_ionospheric_correction.h"
@@ -240,6 +242,36 @@ int gps_l1_ca_pvt_cc::general_work (int noutput_items, gr_vector_int &ninput_ite
                             d_kml_dump.print_position(d_ls_pvt, d_flag_averaging);
                             d_nmea_printer->Print_Nmea_Line(d_ls_pvt, d_flag_averaging);
 
+                            // Feed the acquisition assistance with the fix and the
+                            // Doppler shifts being tracked (clock frequency offset)
+                            Gps_Acquisition_Assistance* assistance = Gps_Acquisition_Assistance::instance();
+                            assistance->set_receiver_fix(d_ls_pvt->d_latitude_d, d_ls_pvt->d_longitude_d,
+                                                         d_ls_pvt->d_height_m, d_rx_time,
+                                                         gnss_pseudoranges_map.begin()->second.Tracking_timestamp_secs);
+                            for (std::map<int,Gnss_Synchro>::iterator gnss_pseudoranges_iter = gnss_pseudoranges_map.begin();
+                                    gnss_pseudoranges_iter != gnss_pseudoranges_map.end();
+                                    gnss_pseudoranges_iter++)
+                                {
+                                    assistance->report_doppler(gnss_pseudoranges_iter->first,
+                                                               gnss_pseudoranges_iter->second.Carrier_Doppler_hz);
+                                }
+
+                            // Feed the tracking loops with the Doppler shifts predicted by the
+                            // velocity solution (vector tracking)
+                            if (d_ls_pvt->b_valid_velocity == true)
+                                {
+                                    Gps_Vector_Tracking* vector_tracking = Gps_Vector_Tracking::instance();
+                                    for (std::map<int,double>::iterator doppler_iter = d_ls_pvt->d_predicted_doppler_hz.begin();
+                                            doppler_iter != d_ls_pvt->d_predicted_doppler_hz.end();
+                                            doppler_iter++)
+                                        {
+                                            vector_tracking->set_prediction(doppler_iter->first,
+                                                    gnss_pseudoranges_map[doppler_iter->first].Tracking_timestamp_secs,
+                                                    doppler_iter->second,
+                                                    GPS_L1_CA_CODE_RATE_HZ + (doppler_iter->second * GPS_L1_CA_CODE_RATE_HZ) / GPS_L1_FREQ_HZ);
+                                        }
+                                }
+
                             if (!b_rinex_header_writen) //  & we have utc data in nav message!
                                 {
                                     std::map<int,Gps_Ephemeris>::iterator gps_ephemeris_iter;
@@ -46,6 +46,11 @@ gps_l1_ca_ls_pvt::gps_l1_ca_ls_pvt(int nchannels,std::string dump_filename, bool
     d_averaging_depth = 0;
     d_GPS_current_time = 0;
     b_valid_position = false;
+    b_valid_velocity = false;
+    d_vx_m_s = 0;
+    d_vy_m_s = 0;
+    d_vz_m_s = 0;
+    d_clock_drift_m_s = 0;
     // ############# ENABLE DATA FILE LOG #################
     if (d_flag_dump_enabled == true)
         {
@@ -214,6 +219,53 @@ arma::vec gps_l1_ca_ls_pvt::leastSquarePos(arma::mat satpos, arma::vec obs, arma
 }
 
 
+arma::vec gps_l1_ca_ls_pvt::leastSquareVel(arma::mat satpos, arma::mat satvel, arma::vec doppler, arma::mat w, arma::vec pos, arma::vec& predicted_doppler)
+{
+    /* Computes the Least Squares velocity solution.
+     *   Inputs:
+     *       satpos      - Satellites positions in ECEF system: [X; Y; Z;]
+     *       satvel      - Satellites velocities in ECEF system: [VX; VY; VZ;]
+     *       doppler     - Observations - the carrier Doppler shifts measured for each satellite
+     *       w           - weigths vector
+     *       pos         - receiver position (in ECEF system: [X, Y, Z, dt])
+     *
+     *   Returns:
+     *       vel         - receiver velocity and receiver clock drift
+     *                   (in ECEF system: [VX, VY, VZ, drift], in m/s)
+     *       predicted_doppler - Doppler shift of each satellite given by the solution
+     *
+     *   The pseudorange rate of each satellite is -lambda * doppler = u * (v_sat - v_rx) + drift,
+     *   where u is the line of sight unit vector from the receiver to the satellite.
+     */
+    double lambda = GPS_C_m_s / GPS_L1_FREQ_HZ;
+    int nmbOfSatellites = satpos.n_cols;
+    arma::mat A = arma::zeros(nmbOfSatellites, 4);
+    arma::vec omc = arma::zeros(nmbOfSatellites);
+    arma::mat los = arma::zeros(3, nmbOfSatellites);
+    arma::vec Rot_X;
+
+    for (int i = 0; i < nmbOfSatellites; i++)
+        {
+            Rot_X = rotateSatellite(arma::norm(satpos.col(i) - pos.subvec(0,2), 2) / GPS_C_m_s, satpos.col(i));
+            los.col(i) = (Rot_X - pos.subvec(0,2)) / arma::norm(Rot_X - pos.subvec(0,2), 2);
+            omc(i) = -lambda * doppler(i) - arma::dot(los.col(i), satvel.col(i));
+            A(i,0) = -los(0,i);
+            A(i,1) = -los(1,i);
+            A(i,2) = -los(2,i);
+            A(i,3) = 1.0;
+        }
+
+    arma::vec vel = arma::solve(w*A, w*omc); // Armadillo
+
+    predicted_doppler = arma::zeros(nmbOfSatellites);
+    for (int i = 0; i < nmbOfSatellites; i++)
+        {
+            predicted_doppler(i) = -(arma::dot(los.col(i), satvel.col(i) - vel.subvec(0,2)) + vel(3)) / lambda;
+        }
+    return vel;
+}
+
+
 bool gps_l1_ca_ls_pvt::get_PVT(std::map<int,Gnss_Synchro> gnss_pseudoranges_map, double GPS_current_time, bool flag_averaging)
 {
     std::map<int,Gnss_Synchro>::iterator gnss_pseudoranges_iter;
@@ -223,6 +275,8 @@ bool gps_l1_ca_ls_pvt::get_PVT(std::map<int,Gnss_Synchro> gnss_pseudoranges_map,
     arma::mat W = arma::eye(valid_pseudoranges, valid_pseudoranges); //channels weights matrix
     arma::vec obs = arma::zeros(valid_pseudoranges);         // pseudoranges observation vector
     arma::mat satpos = arma::zeros(3, valid_pseudoranges);    //satellite positions matrix
+    arma::mat satvel = arma::zeros(3, valid_pseudoranges);    //satellite velocities matrix
+    arma::vec doppler = arma::zeros(valid_pseudoranges);      // carrier Doppler observation vector
 
     int GPS_week = 0;
     double utc = 0;
@@ -265,6 +319,18 @@ bool gps_l1_ca_ls_pvt::get_PVT(std::map<int,Gnss_Synchro> gnss_pseudoranges_map,
                     // 4- compute the current ECEF position for this SV using corrected TX time
                     SV_clock_bias_s = SV_clock_drift_s + SV_relativistic_clock_corr_s - gps_ephemeris_iter->second.d_TGD;
                     TX_time_corrected_s = Tx_time - SV_clock_bias_s;
+
+                    // ECEF velocity by central difference over one second
+                    gps_ephemeris_iter->second.satellitePosition(TX_time_corrected_s + 0.5);
+                    satvel(0, obs_counter) = gps_ephemeris_iter->second.d_satpos_X;
+                    satvel(1, obs_counter) = gps_ephemeris_iter->second.d_satpos_Y;
+                    satvel(2, obs_counter) = gps_ephemeris_iter->second.d_satpos_Z;
+                    gps_ephemeris_iter->second.satellitePosition(TX_time_corrected_s - 0.5);
+                    satvel(0, obs_counter) -= gps_ephemeris_iter->second.d_satpos_X;
+                    satvel(1, obs_counter) -= gps_ephemeris_iter->second.d_satpos_Y;
+                    satvel(2, obs_counter) -= gps_ephemeris_iter->second.d_satpos_Z;
+                    doppler(obs_counter) = gnss_pseudoranges_iter->second.Carrier_Doppler_hz;
+
                     gps_ephemeris_iter->second.satellitePosition(TX_time_corrected_s);
 
                     satpos(0, obs_counter) = gps_ephemeris_iter->second.d_satpos_X;
@@ -313,12 +379,44 @@ bool gps_l1_ca_ls_pvt::get_PVT(std::map<int,Gnss_Synchro> gnss_pseudoranges_map,
             mypos = leastSquarePos(satpos, obs, W);
             LOG(INFO) << "(new)Position at TOW=" << GPS_current_time << " in ECEF (X,Y,Z) = " << mypos;
             gps_l1_ca_ls_pvt::cart2geo(mypos(0), mypos(1), mypos(2), 4);
+
             //ToDo: Find an Observables/PVT random bug with some satellite configurations that gives an erratic PVT solution (i.e. height>50 km)
             if (d_height_m > 50000)
             {
             	b_valid_position = false;
             	return false;
             }
+
+            // Velocity and clock drift, and the Doppler shifts they predict (vector tracking)
+            arma::vec predicted_doppler;
+            d_predicted_doppler_hz.clear();
+            b_valid_velocity = false;
+            try
+            {
+                    arma::vec myvel = leastSquareVel(satpos, satvel, doppler, W, mypos, predicted_doppler);
+                    d_vx_m_s = myvel(0);
+                    d_vy_m_s = myvel(1);
+                    d_vz_m_s = myvel(2);
+                    d_clock_drift_m_s = myvel(3);
+                    obs_counter = 0;
+                    for(gnss_pseudoranges_iter = gnss_pseudoranges_map.begin();
+                            gnss_pseudoranges_iter != gnss_pseudoranges_map.end();
+                            gnss_pseudoranges_iter++)
+                        {
+                            if (W(obs_counter, obs_counter) > 0)
+                                {
+                                    d_predicted_doppler_hz[gnss_pseudoranges_iter->first] = predicted_doppler(obs_counter);
+                                }
+                            obs_counter++;
+                        }
+                    b_valid_velocity = true;
+                    LOG(INFO) << "(new)Velocity at TOW=" << GPS_current_time << " in ECEF (VX,VY,VZ,drift) = " << myvel;
+            }
+            catch(std::exception& e)
+            {
+                    LOG(WARNING) << "Velocity solution failed: " << e.what();
+            }
+
             // Compute UTC time and print PVT solution
             double secondsperweek = 604800.0; // number of seconds in one week (7*24*60*60)
             boost::posix_time::time_duration t = boost::posix_time::seconds(utc + secondsperweek*(double)GPS_week);
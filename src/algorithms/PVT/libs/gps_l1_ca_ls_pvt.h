@@ -107,6 +107,14 @@ public:
     double d_y_m;
     double d_z_m;
 
+    // Velocity solution, from the carrier Doppler shifts
+    bool b_valid_velocity;
+    double d_vx_m_s;         //!< ECEF receiver velocity X [m/s]
+    double d_vy_m_s;         //!< ECEF receiver velocity Y [m/s]
+    double d_vz_m_s;         //!< ECEF receiver velocity Z [m/s]
+    double d_clock_drift_m_s; //!< Receiver clock drift [m/s]
+    std::map<int,double> d_predicted_doppler_hz; //!< Carrier Doppler shift of each SV predicted by the solution [Hz]
+
     // DOP estimations
     arma::mat d_Q;
     double d_GDOP;
@@ -128,6 +136,14 @@ public:
 
     bool get_PVT(std::map<int,Gnss_Synchro> gnss_pseudoranges_map, double GPS_current_time, bool flag_averaging);
 
+    /*!
+     * \brief Least squares solution of the receiver velocity and clock drift
+     * from the carrier Doppler shifts, at the receiver position pos (ECEF [X, Y, Z, dt]).
+     * Returns [VX, VY, VZ, drift] in m/s, and the Doppler shift of each satellite
+     * given by the solution in predicted_doppler [Hz].
+     */
+    arma::vec leastSquareVel(arma::mat satpos, arma::mat satvel, arma::vec doppler, arma::mat w, arma::vec pos, arma::vec& predicted_doppler);
+
     /*!
      * \brief Conversion of Cartesian coordinates (X,Y,Z) to geographical
      * coordinates (d_latitude_d, d_longitude_d, d_height_m) on a selected reference ellipsoid.
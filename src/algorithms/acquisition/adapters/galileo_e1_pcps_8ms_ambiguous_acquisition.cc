@@ -38,6 +38,7 @@
 #include "galileo_e1_signal_processing.h"
 #include "Galileo_E1.h"
 #include "configuration_interface.h"
+#include "pcps_code_spectrum_cache.h"
 
 using google::LogMessage;
 
@@ -76,6 +77,9 @@ GalileoE1Pcps8msAmbiguousAcquisition::GalileoE1Pcps8msAmbiguousAcquisition(
     dump_filename_ = configuration_->property(role + ".dump_filename",
             default_dump_filename);
 
+    noncoherent_accumulation_ = configuration_->property(role + ".noncoherent_accumulation", false);
+    fold_factor_ = configuration_->property(role + ".fold_factor", 1);
+
     //--- Find number of samples per spreading code (4 ms)  -----------------
 
     code_length_ = round(
@@ -94,7 +98,7 @@ GalileoE1Pcps8msAmbiguousAcquisition::GalileoE1Pcps8msAmbiguousAcquisition(
             item_size_ = sizeof(gr_complex);
             acquisition_cc_ = galileo_pcps_8ms_make_acquisition_cc(sampled_ms_, max_dwells_,
                     shift_resolution_, if_, fs_in_, samples_per_ms, code_length_,
-                    queue_, dump_, dump_filename_);
+                    noncoherent_accumulation_, fold_factor_, queue_, dump_, dump_filename_);
             stream_to_vector_ = gr::blocks::stream_to_vector::make(item_size_, vector_length_);
             DLOG(INFO) << "stream_to_vector("
                     << stream_to_vector_->unique_id() << ")";
@@ -230,6 +234,20 @@ GalileoE1Pcps8msAmbiguousAcquisition::set_local_code()
                     "Acquisition" + boost::lexical_cast<std::string>(channel_)
                             + ".cboc", false);
 
+            // Reuse the code spectrum if it was already computed for this PRN
+            std::string label = std::string("Galileo ") + gnss_synchro_->Signal
+                    + (cboc ? " cboc" : " sinboc");
+            Pcps_Code_Spectrum_Cache* cache = Pcps_Code_Spectrum_Cache::instance();
+            const gr_complex* fft_code_A = cache->find(label, gnss_synchro_->PRN,
+                    fs_in_, vector_length_);
+            const gr_complex* fft_code_B = cache->find(label + " 8ms B", gnss_synchro_->PRN,
+                    fs_in_, vector_length_);
+            if (fft_code_A != 0 && fft_code_B != 0)
+                {
+                    acquisition_cc_->set_local_code_spectra(fft_code_A, fft_code_B);
+                    return;
+                }
+
             std::complex<float> * code = new std::complex<float>[code_length_];
 
             galileo_e1_code_gen_complex_sampled(code, gnss_synchro_->Signal,
@@ -242,6 +260,11 @@ GalileoE1Pcps8msAmbiguousAcquisition::set_local_code()
                 }
 
             acquisition_cc_->set_local_code(code_);
+            // code A is the usual replica of two primary codes
+            cache->insert(label, gnss_synchro_->PRN, fs_in_, vector_length_,
+                    acquisition_cc_->local_code_A_spectrum());
+            cache->insert(label + " 8ms B", gnss_synchro_->PRN, fs_in_, vector_length_,
+                    acquisition_cc_->local_code_B_spectrum());
 
             delete[] code;
         }
@@ -144,6 +144,8 @@ private:
     unsigned int shift_resolution_;
     unsigned int sampled_ms_;
     unsigned int max_dwells_;
+    bool noncoherent_accumulation_;
+    unsigned int fold_factor_;
     long fs_in_;
     long if_;
     bool dump_;
@@ -37,6 +37,7 @@
 #include "galileo_e1_signal_processing.h"
 #include "Galileo_E1.h"
 #include "configuration_interface.h"
+#include "pcps_code_spectrum_cache.h"
 
 using google::LogMessage;
 
@@ -83,6 +84,16 @@ GalileoE1PcpsAmbiguousAcquisition::GalileoE1PcpsAmbiguousAcquisition(
 
     dump_filename_ = configuration_->property(role + ".dump_filename",
             default_dump_filename);
+    dump_ring_slots_ = configuration_->property(role + ".dump_ring_slots", 2);
+
+    doppler_batch_size_ = configuration_->property(role + ".doppler_batch_size", 8);
+    doppler_workers_ = configuration_->property(role + ".doppler_workers", 1);
+    coarse_doppler_step_ = configuration_->property(role + ".coarse_doppler_step", 0);
+    coarse_candidates_ = configuration_->property(role + ".coarse_candidates", 3);
+    doppler_rotation_ = configuration_->property(role + ".doppler_rotation", false);
+    shared_service_ = configuration_->property(role + ".shared_service", false);
+    wipeoff_bits_ = configuration_->property(role + ".wipeoff_bits", 32);
+    wipeoff_nco_ = configuration_->property(role + ".wipeoff_nco", false);
 
     //--- Find number of samples per spreading code (4 ms)  -----------------
 
@@ -104,7 +115,10 @@ GalileoE1PcpsAmbiguousAcquisition::GalileoE1PcpsAmbiguousAcquisition(
             item_size_ = sizeof(gr_complex);
             acquisition_cc_ = pcps_make_acquisition_cc(sampled_ms_, max_dwells_,
                     shift_resolution_, if_, fs_in_, samples_per_ms, code_length_,
-                    bit_transition_flag_, queue_, dump_, dump_filename_);
+                    bit_transition_flag_, doppler_batch_size_, doppler_workers_,
+                    coarse_doppler_step_, coarse_candidates_, doppler_rotation_,
+                    shared_service_, wipeoff_bits_, wipeoff_nco_, queue_, dump_, dump_filename_,
+                    dump_ring_slots_);
             stream_to_vector_ = gr::blocks::stream_to_vector::make(item_size_, vector_length_);
             DLOG(INFO) << "stream_to_vector("
                     << stream_to_vector_->unique_id() << ")";
@@ -240,6 +254,18 @@ GalileoE1PcpsAmbiguousAcquisition::set_local_code()
                     "Acquisition" + boost::lexical_cast<std::string>(channel_)
                             + ".cboc", false);
 
+            // Reuse the code spectrum if it was already computed for this PRN
+            std::string label = std::string("Galileo ") + gnss_synchro_->Signal
+                    + (cboc ? " cboc" : " sinboc");
+            Pcps_Code_Spectrum_Cache* cache = Pcps_Code_Spectrum_Cache::instance();
+            const gr_complex* fft_codes = cache->find(label, gnss_synchro_->PRN,
+                    fs_in_, vector_length_);
+            if (fft_codes != 0)
+                {
+                    acquisition_cc_->set_local_code_spectrum(fft_codes);
+                    return;
+                }
+
             std::complex<float> * code = new std::complex<float>[code_length_];
 
             galileo_e1_code_gen_complex_sampled(code, gnss_synchro_->Signal,
@@ -252,6 +278,8 @@ GalileoE1PcpsAmbiguousAcquisition::set_local_code()
                 }
 
             acquisition_cc_->set_local_code(code_);
+            cache->insert(label, gnss_synchro_->PRN, fs_in_, vector_length_,
+                    acquisition_cc_->local_code_spectrum());
 
             delete[] code;
         }
@@ -138,6 +138,14 @@ private:
     unsigned int vector_length_;
     unsigned int code_length_;
     bool bit_transition_flag_;
+    unsigned int doppler_batch_size_;
+    unsigned int doppler_workers_;
+    unsigned int coarse_doppler_step_;
+    unsigned int coarse_candidates_;
+    bool doppler_rotation_;
+    bool shared_service_;
+    unsigned int wipeoff_bits_;
+    bool wipeoff_nco_;
     unsigned int channel_;
     float threshold_;
     unsigned int doppler_max_;
@@ -149,6 +157,7 @@ private:
     long if_;
     bool dump_;
     std::string dump_filename_;
+    unsigned int dump_ring_slots_;
     std::complex<float> * code_;
     Gnss_Synchro * gnss_synchro_;
     std::string role_;
@@ -38,6 +38,7 @@
 #include "galileo_e1_signal_processing.h"
 #include "Galileo_E1.h"
 #include "configuration_interface.h"
+#include "pcps_code_spectrum_cache.h"
 
 using google::LogMessage;
 
@@ -75,6 +76,9 @@ GalileoE1PcpsCccwsrAmbiguousAcquisition::GalileoE1PcpsCccwsrAmbiguousAcquisition
     dump_filename_ = configuration_->property(role + ".dump_filename",
             default_dump_filename);
 
+    doppler_rotation_ = configuration_->property(role + ".doppler_rotation", false);
+    noncoherent_accumulation_ = configuration_->property(role + ".noncoherent_accumulation", false);
+
     //--- Find number of samples per spreading code (4 ms)  -----------------
 
     code_length_ = round(
@@ -94,7 +98,7 @@ GalileoE1PcpsCccwsrAmbiguousAcquisition::GalileoE1PcpsCccwsrAmbiguousAcquisition
             item_size_ = sizeof(gr_complex);
             acquisition_cc_ = pcps_cccwsr_make_acquisition_cc(sampled_ms_, max_dwells_,
                     shift_resolution_, if_, fs_in_, samples_per_ms, code_length_,
-                    queue_, dump_, dump_filename_);
+                    doppler_rotation_, noncoherent_accumulation_, queue_, dump_, dump_filename_);
             stream_to_vector_ = gr::blocks::stream_to_vector::make(item_size_, vector_length_);
             DLOG(INFO) << "stream_to_vector("
                     << stream_to_vector_->unique_id() << ")";
@@ -233,6 +237,21 @@ GalileoE1PcpsCccwsrAmbiguousAcquisition::set_local_code()
                     "Acquisition" + boost::lexical_cast<std::string>(channel_)
                             + ".cboc", false);
 
+            // Reuse the code spectra if they were already computed for this PRN.
+            // Only one code period is generated here, so the labels differ from
+            // the ones of the other Galileo acquisitions.
+            std::string model = cboc ? " cboc cccwsr" : " sinboc cccwsr";
+            Pcps_Code_Spectrum_Cache* cache = Pcps_Code_Spectrum_Cache::instance();
+            const gr_complex* fft_code_data = cache->find("Galileo 1B" + model,
+                    gnss_synchro_->PRN, fs_in_, vector_length_);
+            const gr_complex* fft_code_pilot = cache->find("Galileo 1C" + model,
+                    gnss_synchro_->PRN, fs_in_, vector_length_);
+            if (fft_code_data != 0 && fft_code_pilot != 0)
+                {
+                    acquisition_cc_->set_local_code_spectra(fft_code_data, fft_code_pilot);
+                    return;
+                }
+
             char signal[3];
 
             strcpy(signal, "1B");
@@ -246,6 +265,10 @@ GalileoE1PcpsCccwsrAmbiguousAcquisition::set_local_code()
                     cboc, gnss_synchro_->PRN, fs_in_, 0, false);
 
             acquisition_cc_->set_local_code(code_data_, code_pilot_);
+            cache->insert("Galileo 1B" + model, gnss_synchro_->PRN, fs_in_, vector_length_,
+                    acquisition_cc_->local_code_data_spectrum());
+            cache->insert("Galileo 1C" + model, gnss_synchro_->PRN, fs_in_, vector_length_,
+                    acquisition_cc_->local_code_pilot_spectrum());
         }
 }
 
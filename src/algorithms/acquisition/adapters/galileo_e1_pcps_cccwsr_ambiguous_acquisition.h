@@ -142,6 +142,8 @@ private:
     unsigned int shift_resolution_;
     unsigned int sampled_ms_;
     unsigned int max_dwells_;
+    bool doppler_rotation_;
+    bool noncoherent_accumulation_;
     long fs_in_;
     long if_;
     bool dump_;
@@ -37,6 +37,7 @@
 #include "galileo_e1_signal_processing.h"
 #include "Galileo_E1.h"
 #include "configuration_interface.h"
+#include "pcps_code_spectrum_cache.h"
 
 using google::LogMessage;
 
@@ -76,6 +77,8 @@ GalileoE1PcpsTongAmbiguousAcquisition::GalileoE1PcpsTongAmbiguousAcquisition(
     dump_filename_ = configuration_->property(role + ".dump_filename",
             default_dump_filename);
 
+    doppler_rotation_ = configuration_->property(role + ".doppler_rotation", false);
+
     //--- Find number of samples per spreading code (4 ms)  -----------------
 
     code_length_ = round(
@@ -94,7 +97,7 @@ GalileoE1PcpsTongAmbiguousAcquisition::GalileoE1PcpsTongAmbiguousAcquisition(
             item_size_ = sizeof(gr_complex);
             acquisition_cc_ = pcps_tong_make_acquisition_cc(sampled_ms_, shift_resolution_,
                     if_, fs_in_, samples_per_ms, code_length_, tong_init_val_,
-                    tong_max_val_, queue_, dump_, dump_filename_);
+                    tong_max_val_, doppler_rotation_, queue_, dump_, dump_filename_);
 
             stream_to_vector_ = gr::blocks::stream_to_vector::make(item_size_, vector_length_);
             DLOG(INFO) << "stream_to_vector("
@@ -232,6 +235,18 @@ GalileoE1PcpsTongAmbiguousAcquisition::set_local_code()
                     "Acquisition" + boost::lexical_cast<std::string>(channel_)
                             + ".cboc", false);
 
+            // Reuse the code spectrum if it was already computed for this PRN
+            std::string label = std::string("Galileo ") + gnss_synchro_->Signal
+                    + (cboc ? " cboc" : " sinboc");
+            Pcps_Code_Spectrum_Cache* cache = Pcps_Code_Spectrum_Cache::instance();
+            const gr_complex* fft_codes = cache->find(label, gnss_synchro_->PRN,
+                    fs_in_, vector_length_);
+            if (fft_codes != 0)
+                {
+                    acquisition_cc_->set_local_code_spectrum(fft_codes);
+                    return;
+                }
+
             std::complex<float> * code = new std::complex<float>[code_length_];
 
             galileo_e1_code_gen_complex_sampled(code, gnss_synchro_->Signal,
@@ -244,6 +259,8 @@ GalileoE1PcpsTongAmbiguousAcquisition::set_local_code()
                 }
 
             acquisition_cc_->set_local_code(code_);
+            cache->insert(label, gnss_synchro_->PRN, fs_in_, vector_length_,
+                    acquisition_cc_->local_code_spectrum());
 
             delete[] code;
         }
@@ -42,6 +42,7 @@
 #include "gps_sdr_signal_processing.h"
 #include "GPS_L1_CA.h"
 #include "configuration_interface.h"
+#include "pcps_code_spectrum_cache.h"
 
 
 using google::LogMessage;
@@ -80,6 +81,19 @@ GpsL1CaPcpsAcquisition::GpsL1CaPcpsAcquisition(
 
     dump_filename_ = configuration_->property(role + ".dump_filename",
             default_dump_filename);
+    dump_ring_slots_ = configuration_->property(role + ".dump_ring_slots", 2);
+
+    doppler_batch_size_ = configuration_->property(role + ".doppler_batch_size", 8);
+    doppler_workers_ = configuration_->property(role + ".doppler_workers", 1);
+    coarse_doppler_step_ = configuration_->property(role + ".coarse_doppler_step", 0);
+    coarse_candidates_ = configuration_->property(role + ".coarse_candidates", 3);
+    doppler_rotation_ = configuration_->property(role + ".doppler_rotation", false);
+    shared_service_ = configuration_->property(role + ".shared_service", false);
+    wipeoff_bits_ = configuration_->property(role + ".wipeoff_bits", 32);
+    wipeoff_nco_ = configuration_->property(role + ".wipeoff_nco", false);
+    use_assistance_ = configuration_->property(role + ".use_assistance", false);
+    assistance_doppler_window_ = configuration_->property(role + ".assistance_doppler_window_hz", 1000);
+    assistance_elevation_mask_ = configuration_->property(role + ".assistance_elevation_mask_deg", 0.0);
 
     //--- Find number of samples per spreading code -------------------------
     code_length_ = round(fs_in_
@@ -94,7 +108,12 @@ GpsL1CaPcpsAcquisition::GpsL1CaPcpsAcquisition(
         item_size_ = sizeof(gr_complex);
         acquisition_cc_ = pcps_make_acquisition_cc(sampled_ms_, max_dwells_,
                 shift_resolution_, if_, fs_in_, code_length_, code_length_,
-                bit_transition_flag_, queue_, dump_, dump_filename_);
+                bit_transition_flag_, doppler_batch_size_, doppler_workers_,
+                coarse_doppler_step_, coarse_candidates_, doppler_rotation_,
+                shared_service_, wipeoff_bits_, wipeoff_nco_, queue_, dump_, dump_filename_,
+                dump_ring_slots_);
+        acquisition_cc_->set_assistance(use_assistance_, assistance_doppler_window_,
+                assistance_elevation_mask_);
 
         stream_to_vector_ = gr::blocks::stream_to_vector::make(item_size_, vector_length_);
 
@@ -219,6 +238,16 @@ void GpsL1CaPcpsAcquisition::set_local_code()
 {
     if (item_type_.compare("gr_complex") == 0)
     {
+        // Reuse the code spectrum if it was already computed for this PRN
+        Pcps_Code_Spectrum_Cache* cache = Pcps_Code_Spectrum_Cache::instance();
+        const gr_complex* fft_codes = cache->find("GPS 1C", gnss_synchro_->PRN,
+                fs_in_, vector_length_);
+        if (fft_codes != 0)
+            {
+                acquisition_cc_->set_local_code_spectrum(fft_codes);
+                return;
+            }
+
         std::complex<float>* code = new std::complex<float>[code_length_];
 
         gps_l1_ca_code_gen_complex_sampled(code, gnss_synchro_->PRN, fs_in_, 0);
@@ -230,6 +259,8 @@ void GpsL1CaPcpsAcquisition::set_local_code()
             }
 
         acquisition_cc_->set_local_code(code_);
+        cache->insert("GPS 1C", gnss_synchro_->PRN, fs_in_, vector_length_,
+                acquisition_cc_->local_code_spectrum());
 
         delete[] code;
     }
@@ -143,6 +143,17 @@ private:
     unsigned int vector_length_;
     unsigned int code_length_;
     bool bit_transition_flag_;
+    unsigned int doppler_batch_size_;
+    unsigned int doppler_workers_;
+    unsigned int coarse_doppler_step_;
+    unsigned int coarse_candidates_;
+    bool doppler_rotation_;
+    bool shared_service_;
+    unsigned int wipeoff_bits_;
+    bool wipeoff_nco_;
+    bool use_assistance_;
+    unsigned int assistance_doppler_window_;
+    double assistance_elevation_mask_;
     unsigned int channel_;
     float threshold_;
     unsigned int doppler_max_;
@@ -154,6 +165,7 @@ private:
     long if_;
     bool dump_;
     std::string dump_filename_;
+    unsigned int dump_ring_slots_;
     std::complex<float> * code_;
     Gnss_Synchro * gnss_synchro_;
     std::string role_;
@@ -38,6 +38,7 @@
 #include "gps_sdr_signal_processing.h"
 #include "GPS_L1_CA.h"
 #include "configuration_interface.h"
+#include "pcps_code_spectrum_cache.h"
 
 
 using google::LogMessage;
@@ -69,6 +70,8 @@ GpsL1CaPcpsTongAcquisition::GpsL1CaPcpsTongAcquisition(
     dump_filename_ = configuration_->property(role + ".dump_filename",
             default_dump_filename);
 
+    doppler_rotation_ = configuration_->property(role + ".doppler_rotation", false);
+
     //--- Find number of samples per spreading code -------------------------
     code_length_ = round(fs_in_
             / (GPS_L1_CA_CODE_RATE_HZ / GPS_L1_CA_CODE_LENGTH_CHIPS));
@@ -82,7 +85,7 @@ GpsL1CaPcpsTongAcquisition::GpsL1CaPcpsTongAcquisition(
             item_size_ = sizeof(gr_complex);
             acquisition_cc_ = pcps_tong_make_acquisition_cc(sampled_ms_, shift_resolution_, if_, fs_in_,
                                     code_length_, code_length_, tong_init_val_, tong_max_val_,
-                                    queue_, dump_, dump_filename_);
+                                    doppler_rotation_, queue_, dump_, dump_filename_);
 
             stream_to_vector_ = gr::blocks::stream_to_vector::make(item_size_, vector_length_);
 
@@ -205,6 +208,16 @@ void GpsL1CaPcpsTongAcquisition::set_local_code()
 {
     if (item_type_.compare("gr_complex") == 0)
     {
+        // Reuse the code spectrum if it was already computed for this PRN
+        Pcps_Code_Spectrum_Cache* cache = Pcps_Code_Spectrum_Cache::instance();
+        const gr_complex* fft_codes = cache->find("GPS 1C", gnss_synchro_->PRN,
+                fs_in_, vector_length_);
+        if (fft_codes != 0)
+            {
+                acquisition_cc_->set_local_code_spectrum(fft_codes);
+                return;
+            }
+
         std::complex<float>* code = new std::complex<float>[code_length_];
 
         gps_l1_ca_code_gen_complex_sampled(code, gnss_synchro_->PRN, fs_in_, 0);
@@ -216,6 +229,8 @@ void GpsL1CaPcpsTongAcquisition::set_local_code()
             }
 
         acquisition_cc_->set_local_code(code_);
+        cache->insert("GPS 1C", gnss_synchro_->PRN, fs_in_, vector_length_,
+                acquisition_cc_->local_code_spectrum());
 
         delete[] code;
     }
@@ -43,19 +43,24 @@ galileo_pcps_8ms_acquisition_cc_sptr galileo_pcps_8ms_make_acquisition_cc(
                                  unsigned int sampled_ms, unsigned int max_dwells,
                                  unsigned int doppler_max, long freq, long fs_in,
                                  int samples_per_ms, int samples_per_code,
+                                 bool noncoherent_accumulation,
+                                 unsigned int fold_factor,
                                  gr::msg_queue::sptr queue, bool dump,
                                  std::string dump_filename)
 {
 
     return galileo_pcps_8ms_acquisition_cc_sptr(
             new galileo_pcps_8ms_acquisition_cc(sampled_ms, max_dwells, doppler_max, freq, fs_in, samples_per_ms,
-                                     samples_per_code, queue, dump, dump_filename));
+                                     samples_per_code, noncoherent_accumulation, fold_factor, queue, dump,
+                                     dump_filename));
 }
 
 galileo_pcps_8ms_acquisition_cc::galileo_pcps_8ms_acquisition_cc(
                          unsigned int sampled_ms, unsigned int max_dwells,
                          unsigned int doppler_max, long freq, long fs_in,
                          int samples_per_ms, int samples_per_code,
+                         bool noncoherent_accumulation,
+                         unsigned int fold_factor,
                          gr::msg_queue::sptr queue, bool dump,
                          std::string dump_filename) :
     gr::block("galileo_pcps_8ms_acquisition_cc",
@@ -78,11 +83,16 @@ galileo_pcps_8ms_acquisition_cc::galileo_pcps_8ms_acquisition_cc(
     d_mag = 0;
     d_input_power = 0.0;
     d_num_doppler_bins = 0;
+    d_noncoherent_accumulation = noncoherent_accumulation;
+    d_grid = 0;
+    d_fold_factor = fold_factor;
+    d_folded_search = 0;
 
     //todo: do something if posix_memalign fails
     if (posix_memalign((void**)&d_fft_code_A, 16, d_fft_size * sizeof(gr_complex)) == 0){};
     if (posix_memalign((void**)&d_fft_code_B, 16, d_fft_size * sizeof(gr_complex)) == 0){};
     if (posix_memalign((void**)&d_magnitude, 16, d_fft_size * sizeof(float)) == 0){};
+    if (posix_memalign((void**)&d_magnitude_B, 16, d_fft_size * sizeof(float)) == 0){};
 
     // Direct FFT
     d_fft_if = new gr::fft::fft_complex(d_fft_size, true);
@@ -109,7 +119,10 @@ galileo_pcps_8ms_acquisition_cc::~galileo_pcps_8ms_acquisition_cc()
     free(d_fft_code_A);
     free(d_fft_code_B);
     free(d_magnitude);
+    free(d_magnitude_B);
 
+    delete d_grid;
+    delete d_folded_search;
     delete d_ifft;
     delete d_fft_if;
 
@@ -152,6 +165,25 @@ void galileo_pcps_8ms_acquisition_cc::set_local_code(std::complex<float> * code)
         {
             volk_32fc_conjugate_32fc_a(d_fft_code_B,d_fft_if->get_outbuf(),d_fft_size);
         }
+
+    if (d_folded_search != 0)
+        {
+            d_folded_search->set_local_code_spectrum(0, d_fft_code_A);
+            d_folded_search->set_local_code_spectrum(1, d_fft_code_B);
+        }
+}
+
+void galileo_pcps_8ms_acquisition_cc::set_local_code_spectra(const gr_complex* fft_code_A,
+                                                         const gr_complex* fft_code_B)
+{
+    memcpy(d_fft_code_A, fft_code_A, sizeof(gr_complex)*d_fft_size);
+    memcpy(d_fft_code_B, fft_code_B, sizeof(gr_complex)*d_fft_size);
+
+    if (d_folded_search != 0)
+        {
+            d_folded_search->set_local_code_spectrum(0, d_fft_code_A);
+            d_folded_search->set_local_code_spectrum(1, d_fft_code_B);
+        }
 }
 
 void galileo_pcps_8ms_acquisition_cc::init()
@@ -182,6 +214,33 @@ void galileo_pcps_8ms_acquisition_cc::init()
             complex_exp_gen_conj(d_grid_doppler_wipeoffs[doppler_index],
                                  d_freq + doppler, d_fs_in, d_fft_size);
         }
+
+    if (d_noncoherent_accumulation)
+        {
+            // The whole magnitude grid is kept across dwells
+            delete d_grid;
+            d_grid = new Pcps_Noncoherent_Grid(d_num_doppler_bins, d_fft_size);
+        }
+
+    delete d_folded_search;
+    d_folded_search = 0;
+    if (d_fold_factor > 1)
+        {
+            if (Pcps_Folded_Search::supported(d_fft_size, d_fold_factor) && d_fold_factor % 2 == 1
+                    && !d_noncoherent_accumulation && !d_dump)
+                {
+                    d_folded_search = new Pcps_Folded_Search(d_fft_size, d_fold_factor, 2);
+                    d_folded_search->set_local_code_spectrum(0, d_fft_code_A);
+                    d_folded_search->set_local_code_spectrum(1, d_fft_code_B);
+                }
+            else
+                {
+                    LOG(WARNING) << "Folded search not applicable (fold factor " << d_fold_factor
+                                 << ", " << d_fft_size << " samples, noncoherent accumulation "
+                                 << d_noncoherent_accumulation << ", dump " << d_dump
+                                 << "), searching the whole dwell";
+                }
+        }
 }
 
 int galileo_pcps_8ms_acquisition_cc::general_work(int noutput_items,
@@ -205,6 +264,10 @@ int galileo_pcps_8ms_acquisition_cc::general_work(int noutput_items,
                     d_mag = 0.0;
                     d_input_power = 0.0;
                     d_test_statistics = 0.0;
+                    if (d_grid != 0)
+                        {
+                            d_grid->reset();
+                        }
 
                     d_state = 1;
                 }
@@ -225,9 +288,9 @@ int galileo_pcps_8ms_acquisition_cc::general_work(int noutput_items,
             float magt = 0.0;
             float magt_A = 0.0;
             float magt_B = 0.0;
+            float input_power = 0.0;
             const gr_complex *in = (const gr_complex *)input_items[0]; //Get the input samples pointer
             float fft_normalization_factor = (float)d_fft_size * (float)d_fft_size;
-            d_input_power = 0.0;
             d_mag = 0.0;
 
             d_sample_counter += d_fft_size; // sample counter
@@ -242,8 +305,17 @@ int galileo_pcps_8ms_acquisition_cc::general_work(int noutput_items,
 
             // 1- Compute the input signal power estimation
             volk_32fc_magnitude_squared_32f_a(d_magnitude, in, d_fft_size);
-            volk_32f_accumulator_s32f_a(&d_input_power, d_magnitude, d_fft_size);
-            d_input_power /= (float)d_fft_size;
+            volk_32f_accumulator_s32f_a(&input_power, d_magnitude, d_fft_size);
+            input_power /= (float)d_fft_size;
+            if (d_noncoherent_accumulation)
+                {
+                    // Sum over the dwells, as the magnitude grid
+                    d_input_power += input_power;
+                }
+            else
+                {
+                    d_input_power = input_power;
+                }
 
             // 2- Doppler frequency search loop
             for (unsigned int doppler_index=0;doppler_index<d_num_doppler_bins;doppler_index++)
@@ -252,47 +324,65 @@ int galileo_pcps_8ms_acquisition_cc::general_work(int noutput_items,
 
                     doppler=-(int)d_doppler_max+d_doppler_step*doppler_index;
 
-                    volk_32fc_x2_multiply_32fc_a(d_fft_if->get_inbuf(), in,
-                                d_grid_doppler_wipeoffs[doppler_index], d_fft_size);
+                    if (d_folded_search != 0)
+                    {
+                        // 3- Folded search of both code hypotheses, with
+                        // shorter FFTs and time domain checks of the candidates
+                        d_folded_search->fold(in, d_grid_doppler_wipeoffs[doppler_index]);
+                        magt_A = d_folded_search->correlate(0, &indext_A) / (fft_normalization_factor * fft_normalization_factor);
+                        magt_B = d_folded_search->correlate(1, &indext_B) / (fft_normalization_factor * fft_normalization_factor);
+                    }
+                    else
+                    {
+                        volk_32fc_x2_multiply_32fc_a(d_fft_if->get_inbuf(), in,
+                                    d_grid_doppler_wipeoffs[doppler_index], d_fft_size);
 
-                    // 3- Perform the FFT-based convolution  (parallel time search)
-                    // Compute the FFT of the carrier wiped--off incoming signal
-                    d_fft_if->execute();
+                        // 3- Perform the FFT-based convolution  (parallel time search)
+                        // Compute the FFT of the carrier wiped--off incoming signal
+                        d_fft_if->execute();
 
-                    // Multiply carrier wiped--off, Fourier transformed incoming signal
-                    // with the local FFT'd code A reference using SIMD operations with
-                    // VOLK library
-                    volk_32fc_x2_multiply_32fc_a(d_ifft->get_inbuf(),
-                                d_fft_if->get_outbuf(), d_fft_code_A, d_fft_size);
+                        // Multiply carrier wiped--off, Fourier transformed incoming signal
+                        // with the local FFT'd code A reference using SIMD operations with
+                        // VOLK library
+                        volk_32fc_x2_multiply_32fc_a(d_ifft->get_inbuf(),
+                                    d_fft_if->get_outbuf(), d_fft_code_A, d_fft_size);
 
-                    // compute the inverse FFT
-                    d_ifft->execute();
+                        // compute the inverse FFT
+                        d_ifft->execute();
 
-                    // Search maximum
-                    volk_32fc_magnitude_squared_32f_a(d_magnitude, d_ifft->get_outbuf(), d_fft_size);
-                    volk_32f_index_max_16u_a(&indext_A, d_magnitude, d_fft_size);
+                        // Search maximum
+                        volk_32fc_magnitude_squared_32f_a(d_magnitude, d_ifft->get_outbuf(), d_fft_size);
+                        volk_32f_index_max_16u_a(&indext_A, d_magnitude, d_fft_size);
 
-                    // Normalize the maximum value to correct the scale factor introduced by FFTW
-                    magt_A = d_magnitude[indext_A] / (fft_normalization_factor * fft_normalization_factor);
+                        // Normalize the maximum value to correct the scale factor introduced by FFTW
+                        magt_A = d_magnitude[indext_A] / (fft_normalization_factor * fft_normalization_factor);
 
-                    // Multiply carrier wiped--off, Fourier transformed incoming signal
-                    // with the local FFT'd code B reference using SIMD operations with
-                    // VOLK library
-                    volk_32fc_x2_multiply_32fc_a(d_ifft->get_inbuf(),
-                                d_fft_if->get_outbuf(), d_fft_code_B, d_fft_size);
+                        // Multiply carrier wiped--off, Fourier transformed incoming signal
+                        // with the local FFT'd code B reference using SIMD operations with
+                        // VOLK library
+                        volk_32fc_x2_multiply_32fc_a(d_ifft->get_inbuf(),
+                                    d_fft_if->get_outbuf(), d_fft_code_B, d_fft_size);
 
-                    // compute the inverse FFT
-                    d_ifft->execute();
+                        // compute the inverse FFT
+                        d_ifft->execute();
 
-                    // Search maximum
-                    volk_32fc_magnitude_squared_32f_a(d_magnitude, d_ifft->get_outbuf(), d_fft_size);
-                    volk_32f_index_max_16u_a(&indext_B, d_magnitude, d_fft_size);
+                        // Search maximum
+                        volk_32fc_magnitude_squared_32f_a(d_magnitude_B, d_ifft->get_outbuf(), d_fft_size);
+                        volk_32f_index_max_16u_a(&indext_B, d_magnitude_B, d_fft_size);
 
-                    // Normalize the maximum value to correct the scale factor introduced by FFTW
-                    magt_B = d_magnitude[indext_B] / (fft_normalization_factor * fft_normalization_factor);
+                        // Normalize the maximum value to correct the scale factor introduced by FFTW
+                        magt_B = d_magnitude_B[indext_B] / (fft_normalization_factor * fft_normalization_factor);
+                    }
 
+                    if (d_noncoherent_accumulation)
+                    {
+                        // Both code hypotheses come from the same forward FFT; the
+                        // greater of them is added to the grid, sample by sample
+                        d_grid->accumulate_max(doppler_index, d_magnitude, d_magnitude_B);
+                        magt = d_grid->peak(doppler_index, &indext) / (fft_normalization_factor * fft_normalization_factor);
+                    }
                     // Take the greater magnitude
-                    if (magt_A >= magt_B)
+                    else if (magt_A >= magt_B)
                     {
                         magt = magt_A;
                         indext = indext_A;
@@ -331,7 +421,23 @@ int galileo_pcps_8ms_acquisition_cc::general_work(int noutput_items,
             //d_test_statistics = 2 * d_fft_size * d_mag / d_input_power;
             d_test_statistics = d_mag / d_input_power;
 
-            if (d_test_statistics > d_threshold)
+            if (d_noncoherent_accumulation)
+                {
+                    // Decide once all the dwells are integrated
+                    d_grid->end_dwell();
+                    if (d_well_count == d_max_dwells)
+                        {
+                            if (d_test_statistics > d_threshold)
+                                {
+                                    d_state = 2; // Positive acquisition
+                                }
+                            else
+                                {
+                                    d_state = 3; // Negative acquisition
+                                }
+                        }
+                }
+            else if (d_test_statistics > d_threshold)
                 {
                     d_state = 2; // Positive acquisition
                 }
@@ -43,6 +43,8 @@
 #include <gnuradio/fft/fft.h>
 #include "concurrent_queue.h"
 #include "gnss_synchro.h"
+#include "pcps_noncoherent_grid.h"
+#include "pcps_folded_search.h"
 
 class galileo_pcps_8ms_acquisition_cc;
 
@@ -52,12 +54,25 @@ galileo_pcps_8ms_acquisition_cc_sptr
 galileo_pcps_8ms_make_acquisition_cc(unsigned int sampled_ms, unsigned int max_dwells,
                              unsigned int doppler_max, long freq, long fs_in,
                              int samples_per_ms, int samples_per_code,
+                             bool noncoherent_accumulation,
+                             unsigned int fold_factor,
                              gr::msg_queue::sptr queue, bool dump,
                              std::string dump_filename);
 
 /*!
  * \brief This class implements a Parallel Code Phase Search Acquisition for
  * Galileo E1 signals with coherent integration time = 8 ms (two codes)
+ *
+ * If noncoherent_accumulation is set, the magnitude grid of every dwell is
+ * added to a grid kept across dwells (see Pcps_Noncoherent_Grid), and the
+ * detection is decided on the integrated grid after max_dwells dwells.
+ *
+ * If fold_factor is greater than one, the code phase of each Doppler bin is
+ * searched on the dwell folded by that factor (see Pcps_Folded_Search), so
+ * the FFTs are fold_factor times shorter, at the cost of a lower sensitivity
+ * of the search. The factor must be odd, since folding by an even factor
+ * cancels code B, and folding is not used with noncoherent_accumulation or
+ * dump, which need the whole correlation.
  */
 class galileo_pcps_8ms_acquisition_cc: public gr::block
 {
@@ -66,6 +81,8 @@ private:
     galileo_pcps_8ms_make_acquisition_cc(unsigned int sampled_ms, unsigned int max_dwells,
                                  unsigned int doppler_max, long freq, long fs_in,
                                  int samples_per_ms, int samples_per_code,
+                                 bool noncoherent_accumulation,
+                                 unsigned int fold_factor,
                                  gr::msg_queue::sptr queue, bool dump,
                                  std::string dump_filename);
 
@@ -73,6 +90,8 @@ private:
     galileo_pcps_8ms_acquisition_cc(unsigned int sampled_ms, unsigned int max_dwells,
                             unsigned int doppler_max, long freq, long fs_in,
                             int samples_per_ms, int samples_per_code,
+                            bool noncoherent_accumulation,
+                            unsigned int fold_factor,
                             gr::msg_queue::sptr queue, bool dump,
                             std::string dump_filename);
 
@@ -105,6 +124,11 @@ private:
 	float d_doppler_freq;
 	float d_mag;
     float* d_magnitude;
+    float* d_magnitude_B;
+    bool d_noncoherent_accumulation;
+    Pcps_Noncoherent_Grid* d_grid;
+    unsigned int d_fold_factor;
+    Pcps_Folded_Search* d_folded_search;
 	float d_input_power;
 	float d_test_statistics;
     gr::msg_queue::sptr d_queue;
@@ -151,6 +175,30 @@ public:
      */
     void set_local_code(std::complex<float> * code);
 
+    /*!
+     * \brief Sets the conjugated spectra of the local codes directly,
+     * e.g. from Pcps_Code_Spectrum_Cache.
+     * \param fft_code_A - Conjugated FFT of code A (two replicas of the primary code).
+     * \param fft_code_B - Conjugated FFT of code B (second replica inverted).
+     */
+    void set_local_code_spectra(const gr_complex* fft_code_A, const gr_complex* fft_code_B);
+
+    /*!
+     * \brief Returns the conjugated spectrum of the current code A.
+     */
+    const gr_complex* local_code_A_spectrum() const
+    {
+        return d_fft_code_A;
+    }
+
+    /*!
+     * \brief Returns the conjugated spectrum of the current code B.
+     */
+    const gr_complex* local_code_B_spectrum() const
+    {
+        return d_fft_code_B;
+    }
+
     /*!
      * \brief Starts acquisition algorithm, turning from standby mode to
      * active mode
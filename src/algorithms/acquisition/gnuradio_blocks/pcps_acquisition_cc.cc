@@ -34,12 +34,14 @@
 
 #include "pcps_acquisition_cc.h"
 #include <sys/time.h>
-#include <sstream>
+#include <algorithm>
+#include <cmath>
 #include <gnuradio/io_signature.h>
 #include <glog/logging.h>
 #include <volk/volk.h>
 #include "gnss_signal_processing.h"
 #include "control_message_factory.h"
+#include "gps_acquisition_assistance.h"
 
 using google::LogMessage;
 
@@ -48,13 +50,23 @@ pcps_acquisition_cc_sptr pcps_make_acquisition_cc(
                                  unsigned int doppler_max, long freq, long fs_in,
                                  int samples_per_ms, int samples_per_code,
                                  bool bit_transition_flag,
+                                 unsigned int doppler_batch_size,
+                                 unsigned int doppler_workers,
+                                 unsigned int coarse_doppler_step,
+                                 unsigned int coarse_candidates,
+                                 bool doppler_rotation,
+                                 bool shared_service,
+                                 unsigned int wipeoff_bits, bool wipeoff_nco,
                                  gr::msg_queue::sptr queue, bool dump,
-                                 std::string dump_filename)
+                                 std::string dump_filename, unsigned int dump_ring_slots)
 {
 
     return pcps_acquisition_cc_sptr(
             new pcps_acquisition_cc(sampled_ms, max_dwells, doppler_max, freq, fs_in, samples_per_ms,
-                                     samples_per_code, bit_transition_flag, queue, dump, dump_filename));
+                                     samples_per_code, bit_transition_flag, doppler_batch_size,
+                                     doppler_workers, coarse_doppler_step, coarse_candidates,
+                                     doppler_rotation, shared_service, wipeoff_bits, wipeoff_nco, queue, dump,
+                                     dump_filename, dump_ring_slots));
 }
 
 pcps_acquisition_cc::pcps_acquisition_cc(
@@ -62,8 +74,15 @@ pcps_acquisition_cc::pcps_acquisition_cc(
                          unsigned int doppler_max, long freq, long fs_in,
                          int samples_per_ms, int samples_per_code,
                          bool bit_transition_flag,
+                         unsigned int doppler_batch_size,
+                         unsigned int doppler_workers,
+                         unsigned int coarse_doppler_step,
+                         unsigned int coarse_candidates,
+                         bool doppler_rotation,
+                         bool shared_service,
+                         unsigned int wipeoff_bits, bool wipeoff_nco,
                          gr::msg_queue::sptr queue, bool dump,
-                         std::string dump_filename) :
+                         std::string dump_filename, unsigned int dump_ring_slots) :
     gr::block("pcps_acquisition_cc",
     gr::io_signature::make(1, 1, sizeof(gr_complex) * sampled_ms * samples_per_ms),
     gr::io_signature::make(0, 0, sizeof(gr_complex) * sampled_ms * samples_per_ms))
@@ -85,43 +104,52 @@ pcps_acquisition_cc::pcps_acquisition_cc(
     d_input_power = 0.0;
     d_num_doppler_bins = 0;
     d_bit_transition_flag = bit_transition_flag;
+    d_doppler_batch_size = doppler_batch_size;
+    d_batch_engine = 0;
+    d_doppler_workers = doppler_workers;
+    d_parallel_search = 0;
+    d_coarse_doppler_step = coarse_doppler_step;
+    d_coarse_candidates = coarse_candidates;
+    d_hierarchical_search = 0;
+    d_doppler_rotation = doppler_rotation;
+    d_rotation = 0;
+    d_shared_service = shared_service;
+    d_use_assistance = false;
+    d_assistance_doppler_window = 0;
+    d_assistance_elevation_mask = 0.0;
+    d_first_bin = 0;
+    d_last_bin = 0;
+    d_wipeoff_bits = wipeoff_bits;
+    d_wipeoff_nco = wipeoff_nco;
 
     //todo: do something if posix_memalign fails
     if (posix_memalign((void**)&d_fft_codes, 16, d_fft_size * sizeof(gr_complex)) == 0){};
     if (posix_memalign((void**)&d_magnitude, 16, d_fft_size * sizeof(float)) == 0){};
 
-    // Direct FFT
+    // Direct FFT (local code spectrum). The Doppler search FFTs are
+    // planned by the batch engine in init(), once the grid is known.
     d_fft_if = new gr::fft::fft_complex(d_fft_size, true);
 
-    // Inverse FFT
-    d_ifft = new gr::fft::fft_complex(d_fft_size, false);
-
     // For dumping samples into a file
     d_dump = dump;
     d_dump_filename = dump_filename;
+    d_dump_ring_slots = dump_ring_slots;
+    d_grid_recorder = 0;
 }
 
 pcps_acquisition_cc::~pcps_acquisition_cc()
 {
-    if (d_num_doppler_bins > 0)
-        {
-            for (unsigned int i = 0; i < d_num_doppler_bins; i++)
-                {
-                    free(d_grid_doppler_wipeoffs[i]);
-                }
-            delete[] d_grid_doppler_wipeoffs;
-        }
-
     free(d_fft_codes);
     free(d_magnitude);
 
-    delete d_ifft;
+    delete d_hierarchical_search;
+    delete d_parallel_search;
+    delete d_batch_engine;
+    delete d_rotation;
     delete d_fft_if;
 
-    if (d_dump)
-        {
-            d_dump_file.close();
-        }
+    // Writes the pending grids
+    delete d_grid_recorder;
 }
 
 void pcps_acquisition_cc::set_local_code(std::complex<float> * code)
@@ -139,6 +167,21 @@ void pcps_acquisition_cc::set_local_code(std::complex<float> * code)
         {
             volk_32fc_conjugate_32fc_a(d_fft_codes,d_fft_if->get_outbuf(),d_fft_size);
         }
+
+    if (d_hierarchical_search != 0)
+        {
+            d_hierarchical_search->set_local_code_spectrum(d_fft_codes);
+        }
+}
+
+void pcps_acquisition_cc::set_local_code_spectrum(const gr_complex* fft_codes)
+{
+    memcpy(d_fft_codes, fft_codes, sizeof(gr_complex)*d_fft_size);
+
+    if (d_hierarchical_search != 0)
+        {
+            d_hierarchical_search->set_local_code_spectrum(d_fft_codes);
+        }
 }
 
 void pcps_acquisition_cc::init()
@@ -157,17 +200,180 @@ void pcps_acquisition_cc::init()
     {
         d_num_doppler_bins++;
     }
+    d_first_bin = 0;
+    d_last_bin = d_num_doppler_bins - 1;
+
+    if (d_doppler_rotation)
+        {
+            // Decompose the grid in spectrum rotations plus residual wipe-offs
+            delete d_rotation;
+            d_rotation = new Pcps_Doppler_Rotation(d_freq, d_fs_in, d_fft_size,
+                                                   d_doppler_max, d_doppler_step);
+        }
+    else if (!d_shared_service)
+        {
+            // Carrier Doppler wipeoff signals
+            if (d_wipeoff_nco)
+                {
+                    d_wipeoffs.reset(new Pcps_Wipeoff_Nco(d_freq, d_fs_in, d_fft_size,
+                                                          d_doppler_max, d_doppler_step));
+                }
+            else
+                {
+                    d_wipeoffs = Pcps_Wipeoff_Registry::instance()->table(d_freq, d_fs_in,
+                            d_fft_size, d_doppler_max, d_doppler_step, d_wipeoff_bits);
+                }
+        }
+    else
+        {
+            // Doppler grid of the service, shared by the channels
+            d_service_grid = Pcps_Acquisition_Service::instance()->grid(d_freq, d_fs_in,
+                    d_fft_size, d_doppler_max, d_doppler_step);
+        }
+
+    // Plan the batched Doppler search
+    delete d_batch_engine;
+    d_batch_engine = 0;
+    delete d_parallel_search;
+    d_parallel_search = 0;
+    delete d_hierarchical_search;
+    d_hierarchical_search = 0;
+    bool hierarchical = d_coarse_doppler_step > 0 && !d_dump
+            && Pcps_Hierarchical_Doppler_Search::supported(d_fft_size, d_samples_per_code,
+                    d_doppler_max, d_doppler_step, d_coarse_doppler_step, d_coarse_candidates);
+    if (d_coarse_doppler_step > 0 && !hierarchical)
+        {
+            LOG(WARNING) << "Coarse-to-fine Doppler search not applicable or not shorter (coarse step "
+                         << d_coarse_doppler_step << " Hz, step " << d_doppler_step
+                         << " Hz, dwell of " << d_fft_size << " samples, code period of "
+                         << d_samples_per_code << " samples, dump "
+                         << d_dump << "), searching the whole grid";
+        }
+    if (hierarchical)
+        {
+            d_hierarchical_search = new Pcps_Hierarchical_Doppler_Search(d_freq, d_fs_in,
+                    d_fft_size, d_samples_per_code, d_doppler_max, d_doppler_step,
+                    d_coarse_doppler_step, d_coarse_candidates, d_doppler_batch_size);
+            d_hierarchical_search->set_local_code_spectrum(d_fft_codes);
+        }
+    else if (d_doppler_workers > 1 && !d_dump)
+        {
+            d_parallel_search = new Pcps_Parallel_Doppler_Search(d_doppler_workers, d_fft_size,
+                                                                 d_num_doppler_bins, d_doppler_batch_size);
+        }
+    else
+        {
+            if (d_doppler_workers > 1)
+                {
+                    LOG(WARNING) << "Dump of the acquisition grid enabled, using a single Doppler search worker";
+                }
+            d_batch_engine = new Pcps_Doppler_Batch_Engine(d_fft_size, d_num_doppler_bins,
+                                                           d_doppler_batch_size);
+        }
+    if (d_dump)
+        {
+            delete d_grid_recorder;
+            d_grid_recorder = new Pcps_Grid_Recorder(d_dump_filename, d_fft_size,
+                                                     d_num_doppler_bins, d_dump_ring_slots);
+        }
+    if (d_use_assistance && d_batch_engine == 0)
+        {
+            // Narrowed searches are done serially
+            d_batch_engine = new Pcps_Doppler_Batch_Engine(d_fft_size, d_num_doppler_bins,
+                                                           d_doppler_batch_size);
+        }
+}
 
-    // Create the carrier Doppler wipeoff signals
-    d_grid_doppler_wipeoffs = new gr_complex*[d_num_doppler_bins];
-    for (unsigned int doppler_index = 0; doppler_index < d_num_doppler_bins; doppler_index++)
+bool pcps_acquisition_cc::apply_assistance()
+{
+    d_first_bin = 0;
+    d_last_bin = d_num_doppler_bins - 1;
+
+    double doppler_hz;
+    double doppler_uncertainty_hz;
+    double elevation_deg;
+    bool clock_calibrated;
+    // Receiver time of the samples, as the time stamps of the tracking blocks
+    double rx_time_s = (double)d_sample_counter / (double)d_fs_in;
+    if (!d_use_assistance || d_gnss_synchro->System != 'G'
+            || !Gps_Acquisition_Assistance::instance()->predict(d_gnss_synchro->PRN, rx_time_s,
+                    &doppler_hz, &doppler_uncertainty_hz, &elevation_deg, &clock_calibrated))
         {
-            if (posix_memalign((void**)&(d_grid_doppler_wipeoffs[doppler_index]), 16,
-                               d_fft_size * sizeof(gr_complex)) == 0){};
+            return true;
+        }
+
+    if (elevation_deg < d_assistance_elevation_mask)
+        {
+            DLOG(INFO) << "Channel: " << d_channel << " , satellite " << d_gnss_synchro->PRN
+                       << " predicted below the elevation mask (" << elevation_deg << " deg)";
+            return false;
+        }
 
-            int doppler = -(int)d_doppler_max + d_doppler_step*doppler_index;
-            complex_exp_gen_conj(d_grid_doppler_wipeoffs[doppler_index],
-                                 d_freq + doppler, d_fs_in, d_fft_size);
+    if (clock_calibrated)
+        {
+            // Bins within the window around the prediction, as offsets from -doppler_max.
+            // The window widens with the age of the fix
+            double window_hz = (double)d_assistance_doppler_window + doppler_uncertainty_hz;
+            double first = doppler_hz - window_hz + (double)d_doppler_max;
+            double last = doppler_hz + window_hz + (double)d_doppler_max;
+            if (last >= 0.0 && first <= (double)(d_doppler_step * (d_num_doppler_bins - 1)))
+                {
+                    if (first > 0.0)
+                        {
+                            d_first_bin = (unsigned int)ceil(first / (double)d_doppler_step);
+                        }
+                    if (last < (double)(d_doppler_step * (d_num_doppler_bins - 1)))
+                        {
+                            d_last_bin = (unsigned int)floor(last / (double)d_doppler_step);
+                        }
+                    if (d_first_bin > d_last_bin)
+                        {
+                            // Window narrower than a bin: nearest bin
+                            double nearest = round((doppler_hz + (double)d_doppler_max) / (double)d_doppler_step);
+                            nearest = std::max(0.0, std::min(nearest, (double)(d_num_doppler_bins - 1)));
+                            d_first_bin = (unsigned int)nearest;
+                            d_last_bin = d_first_bin;
+                        }
+                    DLOG(INFO) << "Channel: " << d_channel << " , satellite " << d_gnss_synchro->PRN
+                               << " predicted Doppler " << doppler_hz << " Hz, searching bins "
+                               << d_first_bin << " to " << d_last_bin;
+                }
+            else
+                {
+                    // A wrong prediction (or a clock offset beyond the grid): unassisted search
+                    LOG(WARNING) << "Channel: " << d_channel << " , satellite " << d_gnss_synchro->PRN
+                                 << " predicted Doppler " << doppler_hz << " +- " << window_hz
+                                 << " Hz outside +-" << d_doppler_max << " Hz, searching the whole grid";
+                }
+        }
+    return true;
+}
+
+void pcps_acquisition_cc::update_peak(unsigned int doppler_index, unsigned int indext, float magt)
+{
+    int doppler = -(int)d_doppler_max + d_doppler_step*doppler_index;
+
+    if (d_mag < magt)
+        {
+            d_mag = magt;
+
+            // In case that d_bit_transition_flag = true, we compare the potentially
+            // new maximum test statistics (d_mag/d_input_power) with the value in
+            // d_test_statistics. When the second dwell is being processed, the value
+            // of d_mag/d_input_power could be lower than d_test_statistics (i.e,
+            // the maximum test statistics in the previous dwell is greater than
+            // current d_mag/d_input_power). Note that d_test_statistics is not
+            // restarted between consecutive dwells in multidwell operation.
+            if (d_test_statistics < (d_mag / d_input_power) || !d_bit_transition_flag)
+            {
+                d_gnss_synchro->Acq_delay_samples = (double)(indext % d_samples_per_code);
+                d_gnss_synchro->Acq_doppler_hz = (double)doppler;
+                d_gnss_synchro->Acq_samplestamp_samples = d_sample_counter;
+
+                // 5- Compute the test statistics and compare to the threshold
+                //d_test_statistics = 2 * d_fft_size * d_mag / d_input_power;
+                d_test_statistics = d_mag / d_input_power;
+            }
         }
 }
 
@@ -203,7 +409,14 @@ int pcps_acquisition_cc::general_work(int noutput_items,
                     d_input_power = 0.0;
                     d_test_statistics = 0.0;
 
-                    d_state = 1;
+                    if (apply_assistance())
+                        {
+                            d_state = 1;
+                        }
+                    else
+                        {
+                            d_state = 3; // Not visible: negative acquisition without searching
+                        }
                 }
 
             d_sample_counter += d_fft_size * ninput_items[0]; // sample counter
@@ -234,78 +447,163 @@ int pcps_acquisition_cc::general_work(int noutput_items,
                     << ", doppler_step: " << d_doppler_step;
 
             // 1- Compute the input signal power estimation
-            volk_32fc_magnitude_squared_32f_a(d_magnitude, in, d_fft_size);
-            volk_32f_accumulator_s32f_a(&d_input_power, d_magnitude, d_fft_size);
-            d_input_power /= (float)d_fft_size;
+            pcps_shared_dwell_sptr shared_dwell;
+            if (d_shared_service && !d_doppler_rotation)
+                {
+                    // The wiped-off spectra of all the Doppler bins come from the
+                    // service, computed once for all the channels
+                    shared_dwell = Pcps_Acquisition_Service::instance()->dwell(d_service_grid,
+                            d_sample_counter, in);
+                    if (!shared_dwell)
+                        {
+                            // Out of memory: negative acquisition
+                            d_state = 3;
+                            consume_each(1);
+                            break;
+                        }
+                    d_input_power = shared_dwell->input_power();
+                }
+            else
+                {
+                    volk_32fc_magnitude_squared_32f_a(d_magnitude, in, d_fft_size);
+                    volk_32f_accumulator_s32f_a(&d_input_power, d_magnitude, d_fft_size);
+                    d_input_power /= (float)d_fft_size;
+                }
 
-            // 2- Doppler frequency search loop
-            for (unsigned int doppler_index=0;doppler_index<d_num_doppler_bins;doppler_index++)
+            // In rotation mode, one forward FFT per residual for the whole grid
+            if (d_doppler_rotation)
                 {
-                    // doppler search steps
+                    d_rotation->forward(in, d_fft_if);
+                }
 
-                    doppler=-(int)d_doppler_max+d_doppler_step*doppler_index;
+            if (d_dump)
+                {
+                    d_grid_recorder->begin(d_channel, d_gnss_synchro->System, d_gnss_synchro->Signal,
+                                           d_gnss_synchro->PRN, d_sample_counter);
+                }
 
-                    volk_32fc_x2_multiply_32fc_a(d_fft_if->get_inbuf(), in,
-                                d_grid_doppler_wipeoffs[doppler_index], d_fft_size);
+            // 2- Doppler frequency search loop, in batches of Doppler bins
+            bool narrowed = d_first_bin > 0 || d_last_bin < d_num_doppler_bins - 1;
+            if (d_hierarchical_search != 0 && !narrowed)
+                {
+                    // 3- Coarse pass over the whole Doppler range, then full
+                    // correlation only around the best coarse candidates
+                    if (d_doppler_rotation)
+                        {
+                            d_hierarchical_search->search(in, 0, d_rotation, d_fft_codes);
+                        }
+                    else if (shared_dwell)
+                        {
+                            d_hierarchical_search->search(in, 0, shared_dwell.get(), d_fft_codes);
+                        }
+                    else
+                        {
+                            d_hierarchical_search->search(in, d_wipeoffs.get(), 0, d_fft_codes);
+                        }
 
-                    // 3- Perform the FFT-based convolution  (parallel time search)
-                    // Compute the FFT of the carrier wiped--off incoming signal
-                    d_fft_if->execute();
+                    // 4- Reduce the maxima of the evaluated bins in Doppler order
+                    for (unsigned int doppler_index = 0; doppler_index < d_num_doppler_bins; doppler_index++)
+                        {
+                            if (d_hierarchical_search->evaluated(doppler_index))
+                                {
+                                    magt = d_hierarchical_search->peak_magnitude(doppler_index) / (fft_normalization_factor * fft_normalization_factor);
+                                    update_peak(doppler_index, d_hierarchical_search->peak_index(doppler_index), magt);
+                                }
+                        }
+                }
+            else if (d_parallel_search != 0 && !narrowed)
+                {
+                    // 3- The batches are split across the worker pool, each worker
+                    // with its own FFT plans and buffers
+                    if (d_doppler_rotation)
+                        {
+                            d_parallel_search->search(in, 0, d_rotation, d_fft_codes);
+                        }
+                    else if (shared_dwell)
+                        {
+                            d_parallel_search->search(in, 0, shared_dwell.get(), d_fft_codes);
+                        }
+                    else
+                        {
+                            d_parallel_search->search(in, d_wipeoffs.get(), 0, d_fft_codes);
+                        }
+
+                    // 4- Reduce the per-bin maxima in Doppler order, as the serial search does
+                    for (unsigned int doppler_index = 0; doppler_index < d_num_doppler_bins; doppler_index++)
+                        {
+                            magt = d_parallel_search->peak_magnitude(doppler_index) / (fft_normalization_factor * fft_normalization_factor);
+                            update_peak(doppler_index, d_parallel_search->peak_index(doppler_index), magt);
+                        }
+                }
+            else
+                {
+                    for (unsigned int batch = 0; batch < d_batch_engine->num_batches(); batch++)
+                        {
+                            if (d_batch_engine->first_bin(batch) > d_last_bin
+                                    || d_batch_engine->first_bin(batch) + d_batch_engine->batch_length(batch) <= d_first_bin)
+                                {
+                                    continue; // outside the assistance window
+                                }
+
+                            // 3- Perform the FFT-based convolution  (parallel time search)
+                            if (d_doppler_rotation)
+                                {
+                                    // Multiply the rotated input spectra with the local FFT'd code
+                                    // reference, compute the inverse FFTs and search the maximum
+                                    // of each Doppler bin
+                                    d_batch_engine->correlate(batch, d_rotation, d_fft_codes);
+                                }
+                            else if (shared_dwell)
+                                {
+                                    // Multiply the shared spectra with the local FFT'd code
+                                    // reference, compute the inverse FFTs and search the maximum
+                                    // of each Doppler bin
+                                    d_batch_engine->correlate(batch, shared_dwell.get(), d_fft_codes);
+                                }
+                            else
+                                {
+                                    // Carrier wipe-off and FFT of all the Doppler bins of the batch
+                                    d_batch_engine->forward(batch, in, d_wipeoffs.get());
+
+                                    // Multiply with the local FFT'd code reference, compute the
+                                    // inverse FFTs and search the maximum of each Doppler bin
+                                    d_batch_engine->correlate(d_fft_codes);
+                                }
 
-                    // Multiply carrier wiped--off, Fourier transformed incoming signal
-                    // with the local FFT'd code reference using SIMD operations with VOLK library
-                    volk_32fc_x2_multiply_32fc_a(d_ifft->get_inbuf(),
-                                d_fft_if->get_outbuf(), d_fft_codes, d_fft_size);
+                            for (unsigned int row = 0; row < d_batch_engine->batch_length(batch); row++)
+                                {
+                                    // doppler search steps
+                                    unsigned int doppler_index = d_batch_engine->first_bin(batch) + row;
+                                    if (doppler_index < d_first_bin || doppler_index > d_last_bin)
+                                        {
+                                            continue;
+                                        }
 
-                    // compute the inverse FFT
-                    d_ifft->execute();
+                                    doppler = -(int)d_doppler_max + d_doppler_step*doppler_index;
 
-                    // Search maximum
-                    volk_32fc_magnitude_squared_32f_a(d_magnitude, d_ifft->get_outbuf(), d_fft_size);
-                    volk_32f_index_max_16u_a(&indext, d_magnitude, d_fft_size);
+                                    indext = d_batch_engine->peak_index(row);
 
-                    // Normalize the maximum value to correct the scale factor introduced by FFTW
-                    magt = d_magnitude[indext] / (fft_normalization_factor * fft_normalization_factor);
+                                    // Normalize the maximum value to correct the scale factor introduced by FFTW
+                                    magt = d_batch_engine->peak_magnitude(row) / (fft_normalization_factor * fft_normalization_factor);
 
-                    // 4- record the maximum peak and the associated synchronization parameters
-                    if (d_mag < magt)
-                        {
-                            d_mag = magt;
-
-                            // In case that d_bit_transition_flag = true, we compare the potentially
-                            // new maximum test statistics (d_mag/d_input_power) with the value in
-                            // d_test_statistics. When the second dwell is being processed, the value
-                            // of d_mag/d_input_power could be lower than d_test_statistics (i.e,
-                            // the maximum test statistics in the previous dwell is greater than
-                            // current d_mag/d_input_power). Note that d_test_statistics is not
-                            // restarted between consecutive dwells in multidwell operation.
-                            if (d_test_statistics < (d_mag / d_input_power) || !d_bit_transition_flag)
-                            {
-                                d_gnss_synchro->Acq_delay_samples = (double)(indext % d_samples_per_code);
-                                d_gnss_synchro->Acq_doppler_hz = (double)doppler;
-                                d_gnss_synchro->Acq_samplestamp_samples = d_sample_counter;
-
-                                // 5- Compute the test statistics and compare to the threshold
-                                //d_test_statistics = 2 * d_fft_size * d_mag / d_input_power;
-                                d_test_statistics = d_mag / d_input_power;
-                            }
-                        }
+                                    // 4- record the maximum peak and the associated synchronization parameters
+                                    update_peak(doppler_index, indext, magt);
 
-                    // Record results to file if required
-                    if (d_dump)
-                        {
-                            std::stringstream filename;
-                            std::streamsize n = 2 * sizeof(float) * (d_fft_size); // complex file write
-                            filename.str("");
-                            filename << "../data/test_statistics_" << d_gnss_synchro->System
-                                     <<"_" << d_gnss_synchro->Signal << "_sat_"
-                                     << d_gnss_synchro->PRN << "_doppler_" <<  doppler << ".dat";
-                            d_dump_file.open(filename.str().c_str(), std::ios::out | std::ios::binary);
-                            d_dump_file.write((char*)d_ifft->get_outbuf(), n); //write directly |abs(x)|^2 in this Doppler bin?
-                            d_dump_file.close();
+                                    // Record results if required
+                                    if (d_dump)
+                                        {
+                                            d_grid_recorder->record(doppler_index, doppler,
+                                                                    d_batch_engine->correlation(row));
+                                        }
+                                }
                         }
                 }
 
+            if (d_dump)
+                {
+                    d_grid_recorder->commit(d_test_statistics, d_threshold);
+                }
+
             if (!d_bit_transition_flag)
                 {
                     if (d_test_statistics > d_threshold)
@@ -5,7 +5,7 @@
  *  Acquisition strategy (Kay Borre book + CFAR threshold).
  *  <ol>
  *  <li> Compute the input signal power estimation
- *  <li> Doppler serial search loop
+ *  <li> Doppler search loop, in batches of Doppler bins
  *  <li> Perform the FFT-based circular convolution (parallel time search)
  *  <li> Record the maximum peak and the associated synchronization parameters
  *  <li> Compute the test statistics and compare to the threshold
@@ -61,6 +61,14 @@
 #include <gnuradio/fft/fft.h>
 #include "concurrent_queue.h"
 #include "gnss_synchro.h"
+#include "pcps_doppler_batch_engine.h"
+#include "pcps_hierarchical_doppler_search.h"
+#include "pcps_parallel_doppler_search.h"
+#include "pcps_doppler_rotation.h"
+#include "pcps_grid_recorder.h"
+#include "pcps_acquisition_service.h"
+#include "pcps_wipeoff_nco.h"
+#include "pcps_wipeoff_registry.h"
 
 class pcps_acquisition_cc;
 
@@ -71,14 +79,64 @@ pcps_make_acquisition_cc(unsigned int sampled_ms, unsigned int max_dwells,
                          unsigned int doppler_max, long freq, long fs_in,
                          int samples_per_ms, int samples_per_code,
                          bool bit_transition_flag,
+                         unsigned int doppler_batch_size,
+                         unsigned int doppler_workers,
+                         unsigned int coarse_doppler_step,
+                         unsigned int coarse_candidates,
+                         bool doppler_rotation,
+                         bool shared_service,
+                         unsigned int wipeoff_bits, bool wipeoff_nco,
                          gr::msg_queue::sptr queue, bool dump,
-                         std::string dump_filename);
+                         std::string dump_filename, unsigned int dump_ring_slots);
 
 /*!
  * \brief This class implements a Parallel Code Phase Search Acquisition.
  *
  * Check \ref Navitec2012 "An Open Source Galileo E1 Software Receiver",
  * Algorithm 1, for a pseudocode description of this implementation.
+ *
+ * If doppler_rotation is set, the Doppler bins are obtained by circular
+ * rotation of the input spectrum (see Pcps_Doppler_Rotation), and only one
+ * forward FFT per distinct fractional residual is computed in each dwell.
+ *
+ * Otherwise, if shared_service is set, the input power estimation and the
+ * wiped-off input spectra of each block of samples are obtained from the
+ * Pcps_Acquisition_Service shared by all the channels, so they are computed
+ * only once for all the PRNs being searched.
+ *
+ * If doppler_workers is greater than one, the batches of Doppler bins are
+ * split across doppler_workers workers (see Pcps_Parallel_Doppler_Search),
+ * and the per-bin maxima are reduced in Doppler order, so the outcome is the
+ * same as with a single worker. The threads of the workers are shared by all
+ * the channels (see Pcps_Doppler_Worker_Pool). The dump of the search grid requires a single worker.
+ * The grid of each dwell is copied to one of dump_ring_slots preallocated
+ * slots and written to its own file by a background thread (see
+ * Pcps_Grid_Recorder), so the dump does not slow down the acquisition.
+ *
+ * If coarse_doppler_step is not zero, the Doppler search is done coarse to
+ * fine (see Pcps_Hierarchical_Doppler_Search): a single code period is
+ * correlated over a grid with that step, and only the bins of the regular
+ * grid around the best coarse_candidates are correlated over the whole dwell.
+ * This takes precedence over doppler_workers. It is not used with dump, nor
+ * when it does not correlate fewer samples than the whole grid (e.g. with a
+ * dwell of a single code period).
+ *
+ * Unless doppler_rotation or shared_service is set, the carrier wipe-offs
+ * of the grid are precomputed and stored with wipeoff_bits bits per
+ * component (see Pcps_Wipeoff_Table): 32 (float), or 16 or 8 to reduce
+ * their memory by 2 or 4 times. The table is shared by all the channels
+ * with the same grid (see Pcps_Wipeoff_Registry). If wipeoff_nco is set,
+ * there is no table at all: the wipe-offs are generated on the fly by a
+ * rotator fused with the multiplication (see Pcps_Wipeoff_Nco).
+ *
+ * If the assistance is enabled (see set_assistance()), each acquisition of a
+ * GPS satellite first asks Gps_Acquisition_Assistance for a prediction. A
+ * satellite below the elevation mask is declared absent without searching,
+ * and, once the clock frequency offset is known, only the Doppler bins
+ * within the assistance window around the predicted Doppler shift are
+ * searched. The window widens with the age of the fix, counted in samples.
+ * The code phase is not restricted, since all the code phases of
+ * a Doppler bin are obtained from the same inverse FFT.
  */
 class pcps_acquisition_cc: public gr::block
 {
@@ -88,19 +146,37 @@ private:
             unsigned int doppler_max, long freq, long fs_in,
             int samples_per_ms, int samples_per_code,
             bool bit_transition_flag,
+            unsigned int doppler_batch_size,
+            unsigned int doppler_workers,
+            unsigned int coarse_doppler_step,
+            unsigned int coarse_candidates,
+            bool doppler_rotation,
+            bool shared_service,
+            unsigned int wipeoff_bits, bool wipeoff_nco,
             gr::msg_queue::sptr queue, bool dump,
-            std::string dump_filename);
+            std::string dump_filename, unsigned int dump_ring_slots);
 
     pcps_acquisition_cc(unsigned int sampled_ms, unsigned int max_dwells,
             unsigned int doppler_max, long freq, long fs_in,
             int samples_per_ms, int samples_per_code,
             bool bit_transition_flag,
+            unsigned int doppler_batch_size,
+            unsigned int doppler_workers,
+            unsigned int coarse_doppler_step,
+            unsigned int coarse_candidates,
+            bool doppler_rotation,
+            bool shared_service,
+            unsigned int wipeoff_bits, bool wipeoff_nco,
             gr::msg_queue::sptr queue, bool dump,
-            std::string dump_filename);
+            std::string dump_filename, unsigned int dump_ring_slots);
 
     void calculate_magnitudes(gr_complex* fft_begin, int doppler_shift,
             int doppler_offset);
 
+    void update_peak(unsigned int doppler_index, unsigned int indext, float magt);
+
+    bool apply_assistance();
+
     long d_fs_in;
     long d_freq;
     int d_samples_per_ms;
@@ -115,11 +191,28 @@ private:
     unsigned int d_well_count;
     unsigned int d_fft_size;
     unsigned long int d_sample_counter;
-    gr_complex** d_grid_doppler_wipeoffs;
+    unsigned int d_wipeoff_bits;
+    bool d_wipeoff_nco;
+    boost::shared_ptr<const Pcps_Wipeoff_Source> d_wipeoffs;
     unsigned int d_num_doppler_bins;
     gr_complex* d_fft_codes;
     gr::fft::fft_complex* d_fft_if;
-    gr::fft::fft_complex* d_ifft;
+    unsigned int d_doppler_batch_size;
+    Pcps_Doppler_Batch_Engine* d_batch_engine;
+    unsigned int d_doppler_workers;
+    Pcps_Parallel_Doppler_Search* d_parallel_search;
+    unsigned int d_coarse_doppler_step;
+    unsigned int d_coarse_candidates;
+    Pcps_Hierarchical_Doppler_Search* d_hierarchical_search;
+    bool d_doppler_rotation;
+    Pcps_Doppler_Rotation* d_rotation;
+    bool d_shared_service;
+    pcps_acquisition_grid_sptr d_service_grid;
+    bool d_use_assistance;
+    unsigned int d_assistance_doppler_window;
+    double d_assistance_elevation_mask;
+    unsigned int d_first_bin;
+    unsigned int d_last_bin;
     Gnss_Synchro *d_gnss_synchro;
     unsigned int d_code_phase;
     float d_doppler_freq;
@@ -130,12 +223,13 @@ private:
     bool d_bit_transition_flag;
     gr::msg_queue::sptr d_queue;
     concurrent_queue<int> *d_channel_internal_queue;
-    std::ofstream d_dump_file;
     bool d_active;
     int d_state;
     bool d_dump;
     unsigned int d_channel;
     std::string d_dump_filename;
+    unsigned int d_dump_ring_slots;
+    Pcps_Grid_Recorder* d_grid_recorder;
 
 public:
     /*!
@@ -172,6 +266,21 @@ public:
       */
      void set_local_code(std::complex<float> * code);
 
+     /*!
+      * \brief Sets the conjugated spectrum of the local code directly,
+      * e.g. from Pcps_Code_Spectrum_Cache.
+      * \param fft_codes - Conjugated FFT of the local code (fft_size samples).
+      */
+     void set_local_code_spectrum(const gr_complex* fft_codes);
+
+     /*!
+      * \brief Returns the conjugated spectrum of the current local code.
+      */
+     const gr_complex* local_code_spectrum() const
+     {
+         return d_fft_codes;
+     }
+
      /*!
       * \brief Starts acquisition algorithm, turning from standby mode to
       * active mode
@@ -219,6 +328,19 @@ public:
          d_doppler_step = doppler_step;
      }
 
+     /*!
+      * \brief Set the use of the predictions of Gps_Acquisition_Assistance
+      * \param use_assistance - Enables the assistance (GPS satellites only).
+      * \param doppler_window - Half width of the Doppler search around the prediction [Hz].
+      * \param elevation_mask - Satellites predicted below this elevation are not searched [deg].
+      */
+     void set_assistance(bool use_assistance, unsigned int doppler_window, double elevation_mask)
+     {
+         d_use_assistance = use_assistance;
+         d_assistance_doppler_window = doppler_window;
+         d_assistance_elevation_mask = elevation_mask;
+     }
+
 
      /*!
       * \brief Set tracking channel internal queue.
@@ -49,6 +49,8 @@ pcps_cccwsr_acquisition_cc_sptr pcps_cccwsr_make_acquisition_cc(
                                 unsigned int sampled_ms, unsigned int max_dwells,
                                 unsigned int doppler_max, long freq, long fs_in,
                                 int samples_per_ms, int samples_per_code,
+                                bool doppler_rotation,
+                                bool noncoherent_accumulation,
                                 gr::msg_queue::sptr queue, bool dump,
                                 std::string dump_filename)
 
@@ -56,13 +58,16 @@ pcps_cccwsr_acquisition_cc_sptr pcps_cccwsr_make_acquisition_cc(
 
     return pcps_cccwsr_acquisition_cc_sptr(
             new pcps_cccwsr_acquisition_cc(sampled_ms, max_dwells, doppler_max, freq, fs_in,
-                    samples_per_ms, samples_per_code, queue, dump, dump_filename));
+                    samples_per_ms, samples_per_code, doppler_rotation, noncoherent_accumulation,
+                    queue, dump, dump_filename));
 }
 
 pcps_cccwsr_acquisition_cc::pcps_cccwsr_acquisition_cc(
                     unsigned int sampled_ms, unsigned int max_dwells,
                     unsigned int doppler_max, long freq, long fs_in,
                     int samples_per_ms, int samples_per_code,
+                    bool doppler_rotation,
+                    bool noncoherent_accumulation,
                     gr::msg_queue::sptr queue, bool dump,
                     std::string dump_filename) :
     gr::block("pcps_cccwsr_acquisition_cc",
@@ -85,6 +90,10 @@ pcps_cccwsr_acquisition_cc::pcps_cccwsr_acquisition_cc(
     d_mag = 0;
     d_input_power = 0.0;
     d_num_doppler_bins = 0;
+    d_doppler_rotation = doppler_rotation;
+    d_rotation = 0;
+    d_noncoherent_accumulation = noncoherent_accumulation;
+    d_grid = 0;
 
     //todo: do something if posix_memalign fails
     if (posix_memalign((void**)&d_fft_code_data, 16, d_fft_size * sizeof(gr_complex)) == 0){};
@@ -94,6 +103,7 @@ pcps_cccwsr_acquisition_cc::pcps_cccwsr_acquisition_cc(
     if (posix_memalign((void**)&d_correlation_plus, 16, d_fft_size * sizeof(gr_complex)) == 0){};
     if (posix_memalign((void**)&d_correlation_minus, 16, d_fft_size * sizeof(gr_complex)) == 0){};
     if (posix_memalign((void**)&d_magnitude, 16, d_fft_size * sizeof(float)) == 0){};
+    if (posix_memalign((void**)&d_magnitude_minus, 16, d_fft_size * sizeof(float)) == 0){};
 
     // Direct FFT
     d_fft_if = new gr::fft::fft_complex(d_fft_size, true);
@@ -108,7 +118,7 @@ pcps_cccwsr_acquisition_cc::pcps_cccwsr_acquisition_cc(
 
 pcps_cccwsr_acquisition_cc::~pcps_cccwsr_acquisition_cc()
 {
-    if (d_num_doppler_bins > 0)
+    if (d_num_doppler_bins > 0 && !d_doppler_rotation)
         {
             for (unsigned int i = 0; i < d_num_doppler_bins; i++)
                 {
@@ -124,7 +134,10 @@ pcps_cccwsr_acquisition_cc::~pcps_cccwsr_acquisition_cc()
     free(d_correlation_plus);
     free(d_correlation_minus);
     free(d_magnitude);
+    free(d_magnitude_minus);
 
+    delete d_grid;
+    delete d_rotation;
     delete d_ifft;
     delete d_fft_if;
 
@@ -168,6 +181,13 @@ void pcps_cccwsr_acquisition_cc::set_local_code(std::complex<float> * code_data,
         }
 }
 
+void pcps_cccwsr_acquisition_cc::set_local_code_spectra(const gr_complex* fft_code_data,
+                                                    const gr_complex* fft_code_pilot)
+{
+    memcpy(d_fft_code_data, fft_code_data, sizeof(gr_complex)*d_fft_size);
+    memcpy(d_fft_code_pilot, fft_code_pilot, sizeof(gr_complex)*d_fft_size);
+}
+
 void pcps_cccwsr_acquisition_cc::init()
 {
     d_gnss_synchro->Acq_delay_samples = 0.0;
@@ -185,6 +205,22 @@ void pcps_cccwsr_acquisition_cc::init()
         d_num_doppler_bins++;
     }
 
+    if (d_noncoherent_accumulation)
+        {
+            // The whole magnitude grid is kept across dwells
+            delete d_grid;
+            d_grid = new Pcps_Noncoherent_Grid(d_num_doppler_bins, d_fft_size);
+        }
+
+    if (d_doppler_rotation)
+        {
+            // Decompose the grid in spectrum rotations plus residual wipe-offs
+            delete d_rotation;
+            d_rotation = new Pcps_Doppler_Rotation(d_freq, d_fs_in, d_fft_size,
+                                                   d_doppler_max, d_doppler_step);
+            return;
+        }
+
     // Create the carrier Doppler wipeoff signals
     d_grid_doppler_wipeoffs = new gr_complex*[d_num_doppler_bins];
     for (unsigned int doppler_index=0;doppler_index<d_num_doppler_bins;doppler_index++)
@@ -219,6 +255,10 @@ int pcps_cccwsr_acquisition_cc::general_work(int noutput_items,
                     d_mag = 0.0;
                     d_input_power = 0.0;
                     d_test_statistics = 0.0;
+                    if (d_grid != 0)
+                        {
+                            d_grid->reset();
+                        }
 
                     d_state = 1;
                 }
@@ -238,8 +278,14 @@ int pcps_cccwsr_acquisition_cc::general_work(int noutput_items,
             float magt = 0.0;
             float magt_plus = 0.0;
             float magt_minus = 0.0;
+            float input_power = 0.0;
             const gr_complex *in = (const gr_complex *)input_items[0]; //Get the input samples pointer
             float fft_normalization_factor = (float)d_fft_size * (float)d_fft_size;
+            if (d_noncoherent_accumulation)
+                {
+                    // The maximum is searched again on the integrated grid
+                    d_mag = 0.0;
+                }
 
             d_sample_counter += d_fft_size; // sample counter
 
@@ -253,8 +299,23 @@ int pcps_cccwsr_acquisition_cc::general_work(int noutput_items,
 
             // 1- Compute the input signal power estimation
             volk_32fc_magnitude_squared_32f_a(d_magnitude, in, d_fft_size);
-            volk_32f_accumulator_s32f_a(&d_input_power, d_magnitude, d_fft_size);
-            d_input_power /= (float)d_fft_size;
+            volk_32f_accumulator_s32f_a(&input_power, d_magnitude, d_fft_size);
+            input_power /= (float)d_fft_size;
+            if (d_noncoherent_accumulation)
+                {
+                    // Sum over the dwells, as the magnitude grid
+                    d_input_power += input_power;
+                }
+            else
+                {
+                    d_input_power = input_power;
+                }
+
+            // In rotation mode, one forward FFT per residual for the whole grid
+            if (d_doppler_rotation)
+                {
+                    d_rotation->forward(in, d_fft_if);
+                }
 
             // 2- Doppler frequency search loop
             for (unsigned int doppler_index=0;doppler_index<d_num_doppler_bins;doppler_index++)
@@ -263,18 +324,27 @@ int pcps_cccwsr_acquisition_cc::general_work(int noutput_items,
 
                     doppler=-(int)d_doppler_max+d_doppler_step*doppler_index;
 
-                    volk_32fc_x2_multiply_32fc_a(d_fft_if->get_inbuf(), in,
-                                d_grid_doppler_wipeoffs[doppler_index], d_fft_size);
-
                     // 3- Perform the FFT-based convolution  (parallel time search)
-                    // Compute the FFT of the carrier wiped--off incoming signal
-                    d_fft_if->execute();
+                    if (d_doppler_rotation)
+                        {
+                            // Multiply the rotated spectrum of this Doppler bin with the
+                            // local FFT'd data code reference (E1B)
+                            d_rotation->multiply(d_ifft->get_inbuf(), doppler_index, d_fft_code_data);
+                        }
+                    else
+                        {
+                            volk_32fc_x2_multiply_32fc_a(d_fft_if->get_inbuf(), in,
+                                        d_grid_doppler_wipeoffs[doppler_index], d_fft_size);
 
-                    // Multiply carrier wiped--off, Fourier transformed incoming signal
-                    // with the local FFT'd data code reference (E1B) using SIMD operations
-                    // with VOLK library
-                    volk_32fc_x2_multiply_32fc_a(d_ifft->get_inbuf(),
-                                d_fft_if->get_outbuf(), d_fft_code_data, d_fft_size);
+                            // Compute the FFT of the carrier wiped--off incoming signal
+                            d_fft_if->execute();
+
+                            // Multiply carrier wiped--off, Fourier transformed incoming signal
+                            // with the local FFT'd data code reference (E1B) using SIMD operations
+                            // with VOLK library
+                            volk_32fc_x2_multiply_32fc_a(d_ifft->get_inbuf(),
+                                        d_fft_if->get_outbuf(), d_fft_code_data, d_fft_size);
+                        }
 
                     // compute the inverse FFT
                     d_ifft->execute();
@@ -286,8 +356,15 @@ int pcps_cccwsr_acquisition_cc::general_work(int noutput_items,
                     // Multiply carrier wiped--off, Fourier transformed incoming signal
                     // with the local FFT'd pilot code reference (E1C) using SIMD operations
                     // with VOLK library
-                    volk_32fc_x2_multiply_32fc_a(d_ifft->get_inbuf(),
-                                d_fft_if->get_outbuf(), d_fft_code_pilot, d_fft_size);
+                    if (d_doppler_rotation)
+                        {
+                            d_rotation->multiply(d_ifft->get_inbuf(), doppler_index, d_fft_code_pilot);
+                        }
+                    else
+                        {
+                            volk_32fc_x2_multiply_32fc_a(d_ifft->get_inbuf(),
+                                        d_fft_if->get_outbuf(), d_fft_code_pilot, d_fft_size);
+                        }
 
                     // Compute the inverse FFT
                     d_ifft->execute();
@@ -311,11 +388,18 @@ int pcps_cccwsr_acquisition_cc::general_work(int noutput_items,
                     volk_32f_index_max_16u_a(&indext_plus, d_magnitude, d_fft_size);
                     magt_plus = d_magnitude[indext_plus] / (fft_normalization_factor * fft_normalization_factor);
 
-                    volk_32fc_magnitude_squared_32f_a(d_magnitude, d_correlation_minus, d_fft_size);
-                    volk_32f_index_max_16u_a(&indext_minus, d_magnitude, d_fft_size);
-                    magt_minus = d_magnitude[indext_minus] / (fft_normalization_factor * fft_normalization_factor);
+                    volk_32fc_magnitude_squared_32f_a(d_magnitude_minus, d_correlation_minus, d_fft_size);
+                    volk_32f_index_max_16u_a(&indext_minus, d_magnitude_minus, d_fft_size);
+                    magt_minus = d_magnitude_minus[indext_minus] / (fft_normalization_factor * fft_normalization_factor);
 
-                    if (magt_plus >= magt_minus)
+                    if (d_noncoherent_accumulation)
+                    {
+                        // Both sign hypotheses come from the same forward FFT; the
+                        // greater of them is added to the grid, sample by sample
+                        d_grid->accumulate_max(doppler_index, d_magnitude, d_magnitude_minus);
+                        magt = d_grid->peak(doppler_index, &indext) / (fft_normalization_factor * fft_normalization_factor);
+                    }
+                    else if (magt_plus >= magt_minus)
                     {
                         magt = magt_plus;
                         indext = indext_plus;
@@ -355,7 +439,23 @@ int pcps_cccwsr_acquisition_cc::general_work(int noutput_items,
             d_test_statistics = d_mag / d_input_power;
 
             // 6- Declare positive or negative acquisition using a message queue
-            if (d_test_statistics > d_threshold)
+            if (d_noncoherent_accumulation)
+                {
+                    // Decide once all the dwells are integrated
+                    d_grid->end_dwell();
+                    if (d_well_count == d_max_dwells)
+                        {
+                            if (d_test_statistics > d_threshold)
+                                {
+                                    d_state = 2; // Positive acquisition
+                                }
+                            else
+                                {
+                                    d_state = 3; // Negative acquisition
+                                }
+                        }
+                }
+            else if (d_test_statistics > d_threshold)
                 {
                     d_state = 2; // Positive acquisition
                 }
@@ -49,6 +49,8 @@
 #include <gnuradio/fft/fft.h>
 #include "concurrent_queue.h"
 #include "gnss_synchro.h"
+#include "pcps_doppler_rotation.h"
+#include "pcps_noncoherent_grid.h"
 
 
 class pcps_cccwsr_acquisition_cc;
@@ -59,12 +61,21 @@ pcps_cccwsr_acquisition_cc_sptr
 pcps_cccwsr_make_acquisition_cc(unsigned int sampled_ms, unsigned int max_dwells,
                          unsigned int doppler_max, long freq, long fs_in,
                          int samples_per_ms, int samples_per_code,
+                         bool doppler_rotation,
+                         bool noncoherent_accumulation,
                          gr::msg_queue::sptr queue, bool dump,
                          std::string dump_filename);
 
 /*!
  * \brief This class implements a Parallel Code Phase Search Acquisition with
  * Coherent Channel Combining With Sign Recovery scheme.
+ *
+ * If doppler_rotation is set, the Doppler bins are obtained by circular
+ * rotation of the input spectrum (see Pcps_Doppler_Rotation).
+ *
+ * If noncoherent_accumulation is set, the magnitude grid of every dwell is
+ * added to a grid kept across dwells (see Pcps_Noncoherent_Grid), and the
+ * detection is decided on the integrated grid after max_dwells dwells.
  */
 class pcps_cccwsr_acquisition_cc: public gr::block
 {
@@ -73,6 +84,8 @@ private:
     pcps_cccwsr_make_acquisition_cc(unsigned int sampled_ms, unsigned int max_dwells,
             unsigned int doppler_max, long freq, long fs_in,
             int samples_per_ms, int samples_per_code,
+            bool doppler_rotation,
+            bool noncoherent_accumulation,
             gr::msg_queue::sptr queue, bool dump,
             std::string dump_filename);
 
@@ -80,6 +93,8 @@ private:
     pcps_cccwsr_acquisition_cc(unsigned int sampled_ms, unsigned int max_dwells,
             unsigned int doppler_max, long freq, long fs_in,
             int samples_per_ms, int samples_per_code,
+            bool doppler_rotation,
+            bool noncoherent_accumulation,
             gr::msg_queue::sptr queue, bool dump,
             std::string dump_filename);
 
@@ -106,11 +121,16 @@ private:
     gr_complex* d_fft_code_pilot;
     gr::fft::fft_complex* d_fft_if;
     gr::fft::fft_complex* d_ifft;
+    bool d_doppler_rotation;
+    Pcps_Doppler_Rotation* d_rotation;
     Gnss_Synchro *d_gnss_synchro;
     unsigned int d_code_phase;
     float d_doppler_freq;
     float d_mag;
     float* d_magnitude;
+    float* d_magnitude_minus;
+    bool d_noncoherent_accumulation;
+    Pcps_Noncoherent_Grid* d_grid;
     gr_complex* d_data_correlation;
     gr_complex* d_pilot_correlation;
     gr_complex* d_correlation_plus;
@@ -162,6 +182,30 @@ public:
       */
      void set_local_code(std::complex<float> * code_data, std::complex<float> * code_pilot);
 
+     /*!
+      * \brief Sets the conjugated spectra of the local codes directly,
+      * e.g. from Pcps_Code_Spectrum_Cache.
+      * \param fft_code_data - Conjugated FFT of the data PRN code.
+      * \param fft_code_pilot - Conjugated FFT of the pilot PRN code.
+      */
+     void set_local_code_spectra(const gr_complex* fft_code_data, const gr_complex* fft_code_pilot);
+
+     /*!
+      * \brief Returns the conjugated spectrum of the current data code.
+      */
+     const gr_complex* local_code_data_spectrum() const
+     {
+         return d_fft_code_data;
+     }
+
+     /*!
+      * \brief Returns the conjugated spectrum of the current pilot code.
+      */
+     const gr_complex* local_code_pilot_spectrum() const
+     {
+         return d_fft_code_pilot;
+     }
+
      /*!
       * \brief Starts acquisition algorithm, turning from standby mode to
       * active mode
@@ -62,19 +62,21 @@ pcps_tong_acquisition_cc_sptr pcps_tong_make_acquisition_cc(
                               unsigned int sampled_ms, unsigned int doppler_max,
                               long freq, long fs_in, int samples_per_ms,
                               int samples_per_code, unsigned int tong_init_val,
-                              unsigned int tong_max_val, gr::msg_queue::sptr queue,
+                              unsigned int tong_max_val, bool doppler_rotation,
+                              gr::msg_queue::sptr queue,
                               bool dump, std::string dump_filename)
 {
     return pcps_tong_acquisition_cc_sptr(
             new pcps_tong_acquisition_cc(sampled_ms, doppler_max, freq, fs_in, samples_per_ms, samples_per_code,
-                                    tong_init_val, tong_max_val, queue, dump, dump_filename));
+                                    tong_init_val, tong_max_val, doppler_rotation, queue, dump, dump_filename));
 }
 
 pcps_tong_acquisition_cc::pcps_tong_acquisition_cc(
                          unsigned int sampled_ms, unsigned int doppler_max,
                          long freq, long fs_in, int samples_per_ms,
                          int samples_per_code, unsigned int tong_init_val,
-                         unsigned int tong_max_val, gr::msg_queue::sptr queue,
+                         unsigned int tong_max_val, bool doppler_rotation,
+                         gr::msg_queue::sptr queue,
                          bool dump, std::string dump_filename) :
     gr::block("pcps_tong_acquisition_cc",
     gr::io_signature::make(1, 1, sizeof(gr_complex) * sampled_ms * samples_per_ms),
@@ -98,6 +100,9 @@ pcps_tong_acquisition_cc::pcps_tong_acquisition_cc(
     d_mag = 0;
     d_input_power = 0.0;
     d_num_doppler_bins = 0;
+    d_doppler_rotation = doppler_rotation;
+    d_rotation = 0;
+    d_grid = 0;
 
     //todo: do something if posix_memalign fails
     if (posix_memalign((void**)&d_fft_codes, 16, d_fft_size * sizeof(gr_complex)) == 0){};
@@ -116,20 +121,21 @@ pcps_tong_acquisition_cc::pcps_tong_acquisition_cc(
 
 pcps_tong_acquisition_cc::~pcps_tong_acquisition_cc()
 {
-    if (d_num_doppler_bins > 0)
+    if (d_num_doppler_bins > 0 && !d_doppler_rotation)
         {
             for (unsigned int i = 0; i < d_num_doppler_bins; i++)
                 {
                     free(d_grid_doppler_wipeoffs[i]);
-                    free(d_grid_data[i]);
                 }
             delete[] d_grid_doppler_wipeoffs;
-            delete[] d_grid_data;
         }
 
+    delete d_grid;
+
     free(d_fft_codes);
     free(d_magnitude);
 
+    delete d_rotation;
     delete d_ifft;
     delete d_fft_if;
 
@@ -156,6 +162,11 @@ void pcps_tong_acquisition_cc::set_local_code(std::complex<float> * code)
         }
 }
 
+void pcps_tong_acquisition_cc::set_local_code_spectrum(const gr_complex* fft_codes)
+{
+    memcpy(d_fft_codes, fft_codes, sizeof(gr_complex)*d_fft_size);
+}
+
 void pcps_tong_acquisition_cc::init()
 {
     d_gnss_synchro->Acq_delay_samples = 0.0;
@@ -173,27 +184,32 @@ void pcps_tong_acquisition_cc::init()
         d_num_doppler_bins++;
     }
 
-    // Create the carrier Doppler wipeoff signals and allocate data grid.
-    d_grid_doppler_wipeoffs = new gr_complex*[d_num_doppler_bins];
-    d_grid_data = new float*[d_num_doppler_bins];
-    for (unsigned int doppler_index = 0; doppler_index < d_num_doppler_bins; doppler_index++)
+    if (d_doppler_rotation)
         {
-            if (posix_memalign((void**)&(d_grid_doppler_wipeoffs[doppler_index]), 16,
-                               d_fft_size * sizeof(gr_complex)) == 0){};
-
-            int doppler=-(int)d_doppler_max+d_doppler_step*doppler_index;
-
-            complex_exp_gen_conj(d_grid_doppler_wipeoffs[doppler_index],
-                                 d_freq + doppler, d_fs_in, d_fft_size);
+            // Decompose the grid in spectrum rotations plus residual wipe-offs
+            delete d_rotation;
+            d_rotation = new Pcps_Doppler_Rotation(d_freq, d_fs_in, d_fft_size,
+                                                   d_doppler_max, d_doppler_step);
+        }
+    else
+        {
+            // Create the carrier Doppler wipeoff signals
+            d_grid_doppler_wipeoffs = new gr_complex*[d_num_doppler_bins];
+            for (unsigned int doppler_index = 0; doppler_index < d_num_doppler_bins; doppler_index++)
+                {
+                    if (posix_memalign((void**)&(d_grid_doppler_wipeoffs[doppler_index]), 16,
+                                       d_fft_size * sizeof(gr_complex)) == 0){};
 
-            if (posix_memalign((void**)&(d_grid_data[doppler_index]), 16,
-                               d_fft_size * sizeof(float)) == 0){};
+                    int doppler=-(int)d_doppler_max+d_doppler_step*doppler_index;
 
-            for (unsigned int i = 0; i < d_fft_size; i++)
-                {
-                    d_grid_data[doppler_index][i] = 0;
+                    complex_exp_gen_conj(d_grid_doppler_wipeoffs[doppler_index],
+                                         d_freq + doppler, d_fs_in, d_fft_size);
                 }
         }
+
+    // Allocate the data grid, where test statistics are accumulated across dwells
+    delete d_grid;
+    d_grid = new Pcps_Noncoherent_Grid(d_num_doppler_bins, d_fft_size);
 }
 
 int pcps_tong_acquisition_cc::general_work(int noutput_items,
@@ -218,13 +234,7 @@ int pcps_tong_acquisition_cc::general_work(int noutput_items,
                     d_input_power = 0.0;
                     d_test_statistics = 0.0;
 
-                    for (unsigned int doppler_index = 0; doppler_index < d_num_doppler_bins; doppler_index++)
-                        {
-                            for (unsigned int i = 0; i < d_fft_size; i++)
-                                {
-                                    d_grid_data[doppler_index][i] = 0;
-                                }
-                        }
+                    d_grid->reset();
 
                     d_state = 1;
                 }
@@ -261,6 +271,12 @@ int pcps_tong_acquisition_cc::general_work(int noutput_items,
             volk_32f_accumulator_s32f_a(&d_input_power, d_magnitude, d_fft_size);
             d_input_power /= (float)d_fft_size;
 
+            // In rotation mode, one forward FFT per residual for the whole grid
+            if (d_doppler_rotation)
+                {
+                    d_rotation->forward(in, d_fft_if);
+                }
+
             // 2- Doppler frequency search loop
             for (unsigned int doppler_index = 0; doppler_index < d_num_doppler_bins; doppler_index++)
                 {
@@ -268,17 +284,26 @@ int pcps_tong_acquisition_cc::general_work(int noutput_items,
 
                     doppler = -(int)d_doppler_max + d_doppler_step*doppler_index;
 
-                    volk_32fc_x2_multiply_32fc_a(d_fft_if->get_inbuf(), in,
-                                d_grid_doppler_wipeoffs[doppler_index], d_fft_size);
-
                     // 3- Perform the FFT-based convolution  (parallel time search)
-                    // Compute the FFT of the carrier wiped--off incoming signal
-                    d_fft_if->execute();
+                    if (d_doppler_rotation)
+                        {
+                            // Multiply the rotated spectrum of this Doppler bin with the
+                            // local FFT'd code reference
+                            d_rotation->multiply(d_ifft->get_inbuf(), doppler_index, d_fft_codes);
+                        }
+                    else
+                        {
+                            volk_32fc_x2_multiply_32fc_a(d_fft_if->get_inbuf(), in,
+                                        d_grid_doppler_wipeoffs[doppler_index], d_fft_size);
+
+                            // Compute the FFT of the carrier wiped--off incoming signal
+                            d_fft_if->execute();
 
-                    // Multiply carrier wiped--off, Fourier transformed incoming signal
-                    // with the local FFT'd code reference using SIMD operations with VOLK library
-                    volk_32fc_x2_multiply_32fc_a(d_ifft->get_inbuf(),
-                                d_fft_if->get_outbuf(), d_fft_codes, d_fft_size);
+                            // Multiply carrier wiped--off, Fourier transformed incoming signal
+                            // with the local FFT'd code reference using SIMD operations with VOLK library
+                            volk_32fc_x2_multiply_32fc_a(d_ifft->get_inbuf(),
+                                        d_fft_if->get_outbuf(), d_fft_codes, d_fft_size);
+                        }
 
                     // compute the inverse FFT
                     d_ifft->execute();
@@ -291,13 +316,11 @@ int pcps_tong_acquisition_cc::general_work(int noutput_items,
                                                 1/(fft_normalization_factor*fft_normalization_factor*d_input_power),
                                                 d_fft_size);
 
-                    // Accumulate test statistics in d_grid_data.
-                    volk_32f_x2_add_32f_a(d_grid_data[doppler_index], d_magnitude, d_grid_data[doppler_index], d_fft_size);
+                    // Accumulate test statistics in the data grid.
+                    d_grid->accumulate(doppler_index, d_magnitude);
 
                     // Search maximum
-                    volk_32f_index_max_16u_a(&indext, d_grid_data[doppler_index], d_fft_size);
-
-                    magt = d_grid_data[doppler_index][indext];
+                    magt = d_grid->peak(doppler_index, &indext);
 
                     // 4- record the maximum peak and the associated synchronization parameters
                     if (d_mag < magt)
@@ -323,6 +346,8 @@ int pcps_tong_acquisition_cc::general_work(int noutput_items,
                         }
                 }
 
+            d_grid->end_dwell();
+
             // 5- Compute the test statistics and compare to the threshold
             d_test_statistics = d_mag;
 
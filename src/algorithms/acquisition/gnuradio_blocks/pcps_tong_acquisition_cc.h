@@ -62,6 +62,8 @@
 #include <gnuradio/fft/fft.h>
 #include "concurrent_queue.h"
 #include "gnss_synchro.h"
+#include "pcps_doppler_rotation.h"
+#include "pcps_noncoherent_grid.h"
 
 class pcps_tong_acquisition_cc;
 
@@ -71,12 +73,16 @@ pcps_tong_acquisition_cc_sptr
 pcps_tong_make_acquisition_cc(unsigned int sampled_ms, unsigned int doppler_max,
                               long freq, long fs_in, int samples_per_ms,
                               int samples_per_code, unsigned int tong_init_val,
-                              unsigned int tong_max_val, gr::msg_queue::sptr queue,
+                              unsigned int tong_max_val, bool doppler_rotation,
+                              gr::msg_queue::sptr queue,
                               bool dump, std::string dump_filename);
 
 /*!
  * \brief This class implements a Parallel Code Phase Search Acquisition with
  * Tong algorithm.
+ *
+ * If doppler_rotation is set, the Doppler bins are obtained by circular
+ * rotation of the input spectrum (see Pcps_Doppler_Rotation).
  */
 class pcps_tong_acquisition_cc: public gr::block
 {
@@ -85,13 +91,15 @@ private:
     pcps_tong_make_acquisition_cc(unsigned int sampled_ms, unsigned int doppler_max,
             long freq, long fs_in, int samples_per_ms,
             int samples_per_code, unsigned int tong_init_val,
-            unsigned int tong_max_val, gr::msg_queue::sptr queue,
+            unsigned int tong_max_val, bool doppler_rotation,
+            gr::msg_queue::sptr queue,
             bool dump, std::string dump_filename);
 
     pcps_tong_acquisition_cc(unsigned int sampled_ms, unsigned int doppler_max,
             long freq, long fs_in, int samples_per_ms,
             int samples_per_code, unsigned int tong_init_val,
-            unsigned int tong_max_val, gr::msg_queue::sptr queue,
+            unsigned int tong_max_val, bool doppler_rotation,
+            gr::msg_queue::sptr queue,
             bool dump, std::string dump_filename);
 
     void calculate_magnitudes(gr_complex* fft_begin, int doppler_shift,
@@ -116,9 +124,11 @@ private:
     gr_complex** d_grid_doppler_wipeoffs;
     unsigned int d_num_doppler_bins;
     gr_complex* d_fft_codes;
-    float** d_grid_data;
+    Pcps_Noncoherent_Grid* d_grid;
     gr::fft::fft_complex* d_fft_if;
     gr::fft::fft_complex* d_ifft;
+    bool d_doppler_rotation;
+    Pcps_Doppler_Rotation* d_rotation;
     Gnss_Synchro *d_gnss_synchro;
     unsigned int d_code_phase;
     float d_doppler_freq;
@@ -170,6 +180,21 @@ public:
       */
      void set_local_code(std::complex<float> * code);
 
+     /*!
+      * \brief Sets the conjugated spectrum of the local code directly,
+      * e.g. from Pcps_Code_Spectrum_Cache.
+      * \param fft_codes - Conjugated FFT of the local code (fft_size samples).
+      */
+     void set_local_code_spectrum(const gr_complex* fft_codes);
+
+     /*!
+      * \brief Returns the conjugated spectrum of the current local code.
+      */
+     const gr_complex* local_code_spectrum() const
+     {
+         return d_fft_codes;
+     }
+
      /*!
       * \brief Starts acquisition algorithm, turning from standby mode to
       * active mode
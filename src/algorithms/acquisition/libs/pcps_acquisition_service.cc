@@ -0,0 +1,291 @@
+/*!
+ * \file pcps_acquisition_service.cc
+ * \brief Acquisition service shared by all the channels of the receiver.
+ * It computes the PRN-independent part of a Parallel Code Phase Search
+ * once per block of input samples.
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "pcps_acquisition_service.h"
+#include <cstdlib>
+#include <cstring>
+#include <glog/logging.h>
+#include <volk/volk.h>
+
+using google::LogMessage;
+
+// Blocks of samples kept for each Doppler grid: at most this number, and
+// not more than PCPS_SERVICE_BYTES_PER_GRID bytes (but at least one block)
+#define PCPS_SERVICE_DWELLS_PER_GRID 8
+#define PCPS_SERVICE_BYTES_PER_GRID (16 * 1024 * 1024)
+
+Pcps_Shared_Dwell::Pcps_Shared_Dwell(unsigned int fft_size, unsigned int num_doppler_bins)
+{
+    d_fft_size = fft_size;
+    d_num_doppler_bins = num_doppler_bins;
+    d_input_power = 0.0;
+    d_ready = false;
+    // Null pointers if the allocation fails (see Pcps_Acquisition_Service::dwell())
+    if (posix_memalign((void**)&d_samples, 16, d_fft_size * sizeof(gr_complex)) != 0) d_samples = 0;
+    if (posix_memalign((void**)&d_spectra, 16, (size_t)d_num_doppler_bins * d_fft_size * sizeof(gr_complex)) != 0) d_spectra = 0;
+}
+
+
+
+Pcps_Shared_Dwell::~Pcps_Shared_Dwell()
+{
+    free(d_samples);
+    free(d_spectra);
+}
+
+
+
+void Pcps_Shared_Dwell::multiply(gr_complex* out, unsigned int doppler_index,
+        const gr_complex* fft_codes) const
+{
+    // Rows keep the 16 bytes alignment only if fft_size is even
+    if (d_fft_size % 2 == 0)
+        {
+            volk_32fc_x2_multiply_32fc_a(out, spectrum(doppler_index), fft_codes, d_fft_size);
+        }
+    else
+        {
+            volk_32fc_x2_multiply_32fc_u(out, spectrum(doppler_index), fft_codes, d_fft_size);
+        }
+}
+
+
+
+unsigned long int Pcps_Shared_Dwell::size_bytes() const
+{
+    return (unsigned long int)(d_num_doppler_bins + 1) * d_fft_size * sizeof(gr_complex);
+}
+
+
+
+Pcps_Acquisition_Grid::~Pcps_Acquisition_Grid()
+{
+    for (unsigned int i = 0; i < d_free_workspaces.size(); i++)
+        {
+            delete d_free_workspaces[i].fft;
+            free(d_free_workspaces[i].magnitude);
+        }
+}
+
+
+
+bool Pcps_Acquisition_Service::Grid_Key::operator<(const Grid_Key& other) const
+{
+    if (freq != other.freq) return freq < other.freq;
+    if (fs_in != other.fs_in) return fs_in < other.fs_in;
+    if (fft_size != other.fft_size) return fft_size < other.fft_size;
+    if (doppler_max != other.doppler_max) return doppler_max < other.doppler_max;
+    return doppler_step < other.doppler_step;
+}
+
+
+
+Pcps_Acquisition_Service* Pcps_Acquisition_Service::instance()
+{
+    // Never destroyed, so that no block can outlive it
+    static Pcps_Acquisition_Service* service = new Pcps_Acquisition_Service();
+    return service;
+}
+
+
+
+pcps_acquisition_grid_sptr Pcps_Acquisition_Service::grid(long freq, long fs_in,
+        unsigned int fft_size, unsigned int doppler_max, unsigned int doppler_step)
+{
+    Grid_Key key;
+    key.freq = freq;
+    key.fs_in = fs_in;
+    key.fft_size = fft_size;
+    key.doppler_max = doppler_max;
+    key.doppler_step = doppler_step;
+
+    boost::mutex::scoped_lock lock(d_mutex);
+    pcps_acquisition_grid_sptr grid = d_grids[key].lock();
+    if (grid)
+        {
+            return grid;
+        }
+
+    // Drop the entries of the released grids
+    std::map<Grid_Key, boost::weak_ptr<Pcps_Acquisition_Grid> >::iterator it = d_grids.begin();
+    while (it != d_grids.end())
+        {
+            if (it->second.expired())
+                {
+                    d_grids.erase(it++);
+                }
+            else
+                {
+                    ++it;
+                }
+        }
+
+    grid = pcps_acquisition_grid_sptr(new Pcps_Acquisition_Grid());
+    grid->d_fft_size = fft_size;
+
+    // Carrier Doppler wipeoff signals
+    grid->d_doppler_wipeoffs = Pcps_Wipeoff_Registry::instance()->table(freq, fs_in,
+            fft_size, doppler_max, doppler_step, 32);
+    grid->d_num_doppler_bins = grid->d_doppler_wipeoffs->num_doppler_bins();
+
+    // As many blocks as fit in the budget
+    unsigned long int dwell_bytes = (unsigned long int)(grid->d_num_doppler_bins + 1) * fft_size * sizeof(gr_complex);
+    unsigned long int max_dwells = PCPS_SERVICE_BYTES_PER_GRID / dwell_bytes;
+    if (max_dwells > PCPS_SERVICE_DWELLS_PER_GRID)
+        {
+            max_dwells = PCPS_SERVICE_DWELLS_PER_GRID;
+        }
+    grid->d_max_dwells = max_dwells > 0 ? max_dwells : 1;
+
+    d_grids[key] = grid;
+
+    DLOG(INFO) << "Acquisition service: new Doppler grid, fs_in=" << fs_in
+               << ", fft_size=" << fft_size << ", doppler bins=" << grid->d_num_doppler_bins
+               << ", " << grid->d_max_dwells << " blocks of " << dwell_bytes << " bytes";
+
+    return grid;
+}
+
+
+
+void Pcps_Acquisition_Service::compute(Pcps_Acquisition_Grid* grid,
+        Pcps_Acquisition_Grid::Workspace& workspace, Pcps_Shared_Dwell* dwell,
+        const gr_complex* in)
+{
+    unsigned int fft_size = grid->d_fft_size;
+
+    // Input signal power estimation
+    volk_32fc_magnitude_squared_32f_a(workspace.magnitude, in, fft_size);
+    volk_32f_accumulator_s32f_a(&dwell->d_input_power, workspace.magnitude, fft_size);
+    dwell->d_input_power /= (float)fft_size;
+
+    // Carrier wipe-off and FFT of every Doppler bin
+    for (unsigned int doppler_index = 0; doppler_index < grid->d_num_doppler_bins; doppler_index++)
+        {
+            grid->d_doppler_wipeoffs->wipeoff(workspace.fft->get_inbuf(), in, doppler_index);
+            workspace.fft->execute();
+            memcpy(dwell->d_spectra + doppler_index * fft_size, workspace.fft->get_outbuf(),
+                   sizeof(gr_complex) * fft_size);
+        }
+}
+
+
+
+pcps_shared_dwell_sptr Pcps_Acquisition_Service::dwell(const pcps_acquisition_grid_sptr& grid,
+        unsigned long int sample_stamp, const gr_complex* in)
+{
+    Pcps_Acquisition_Grid* g = grid.get();
+    unsigned int fft_size = g->d_fft_size;
+
+    boost::mutex::scoped_lock lock(g->d_mutex);
+
+    std::map<unsigned long int, pcps_shared_dwell_sptr>::iterator it = g->d_dwells.find(sample_stamp);
+    if (it != g->d_dwells.end())
+        {
+            pcps_shared_dwell_sptr cached = it->second;
+            if (memcmp(cached->d_samples, in, sizeof(gr_complex) * fft_size) == 0)
+                {
+                    // Channels asking for the block being computed wait for it
+                    while (!cached->d_ready)
+                        {
+                            g->d_dwell_ready.wait(lock);
+                        }
+                    return cached;
+                }
+            g->d_dwells.erase(it);
+        }
+
+    Pcps_Shared_Dwell* dwell = new Pcps_Shared_Dwell(fft_size, g->d_num_doppler_bins);
+    pcps_shared_dwell_sptr result(dwell);
+    if (dwell->d_samples == 0 || dwell->d_spectra == 0)
+        {
+            LOG(ERROR) << "Acquisition service: cannot allocate the spectra of "
+                       << g->d_num_doppler_bins << " Doppler bins x " << fft_size << " samples";
+            return pcps_shared_dwell_sptr();
+        }
+
+    // One workspace per channel computing a block of this grid
+    Pcps_Acquisition_Grid::Workspace workspace;
+    if (g->d_free_workspaces.empty())
+        {
+            if (posix_memalign((void**)&workspace.magnitude, 16, fft_size * sizeof(float)) != 0)
+                {
+                    LOG(ERROR) << "Acquisition service: cannot allocate a workspace of "
+                               << fft_size << " samples";
+                    return pcps_shared_dwell_sptr();
+                }
+            workspace.fft = new gr::fft::fft_complex(fft_size, true);
+        }
+    else
+        {
+            workspace = g->d_free_workspaces.back();
+            g->d_free_workspaces.pop_back();
+        }
+
+    // Published before it is computed, so the other channels find it
+    memcpy(dwell->d_samples, in, sizeof(gr_complex) * fft_size);
+
+    // A block older than all the kept ones is not stored
+    if (g->d_dwells.size() < g->d_max_dwells || sample_stamp > g->d_dwells.begin()->first)
+        {
+            g->d_dwells[sample_stamp] = result;
+            if (g->d_dwells.size() > g->d_max_dwells)
+                {
+                    g->d_dwells.erase(g->d_dwells.begin());
+                }
+        }
+
+    lock.unlock();
+    compute(g, workspace, dwell, in);
+    lock.lock();
+
+    g->d_free_workspaces.push_back(workspace);
+    dwell->d_ready = true;
+    g->d_dwell_ready.notify_all();
+    return result;
+}
+
+
+
+unsigned int Pcps_Acquisition_Service::size()
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+    unsigned int count = 0;
+    for (std::map<Grid_Key, boost::weak_ptr<Pcps_Acquisition_Grid> >::iterator it = d_grids.begin();
+         it != d_grids.end(); ++it)
+        {
+            if (!it->second.expired())
+                {
+                    count++;
+                }
+        }
+    return count;
+}
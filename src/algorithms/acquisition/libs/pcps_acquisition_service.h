@@ -0,0 +1,203 @@
+/*!
+ * \file pcps_acquisition_service.h
+ * \brief Acquisition service shared by all the channels of the receiver.
+ * It computes the PRN-independent part of a Parallel Code Phase Search
+ * once per block of input samples.
+ *
+ * All the acquisition blocks of the receiver are fed with the same
+ * conditioner output, vectorized in blocks of fft_size samples. For a given
+ * block of samples and Doppler grid, the input signal power estimation, the
+ * carrier wipe-off and the forward FFT of every Doppler bin do not depend on
+ * the PRN being searched. The first channel that processes a block computes
+ * them and the others reuse the result, so each channel only has to perform
+ * the multiplication by its code spectrum, the inverse FFTs and the peak
+ * search.
+ *
+ * The FFT-bin rotation mode is not served: it already computes only one or
+ * two forward FFTs per dwell.
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_PCPS_ACQUISITION_SERVICE_H_
+#define GNSS_SDR_PCPS_ACQUISITION_SERVICE_H_
+
+#include <map>
+#include <vector>
+#include <boost/shared_ptr.hpp>
+#include <boost/weak_ptr.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <gnuradio/gr_complex.h>
+#include <gnuradio/fft/fft.h>
+#include "pcps_spectrum_source.h"
+#include "pcps_wipeoff_registry.h"
+
+/*!
+ * \brief Wiped-off and Fourier transformed input spectra of every Doppler bin
+ * of a search grid, for one block of input samples.
+ */
+class Pcps_Shared_Dwell: public Pcps_Spectrum_Source
+{
+public:
+    Pcps_Shared_Dwell(unsigned int fft_size, unsigned int num_doppler_bins);
+    ~Pcps_Shared_Dwell();
+
+    /*!
+     * \brief Input signal power estimation of the block of samples.
+     */
+    float input_power() const { return d_input_power; }
+
+    /*!
+     * \brief Spectrum of the input, wiped-off with IF plus the Doppler of a bin.
+     */
+    const gr_complex* spectrum(unsigned int doppler_index) const { return d_spectra + doppler_index * d_fft_size; }
+
+    void multiply(gr_complex* out, unsigned int doppler_index, const gr_complex* fft_codes) const;
+
+    /*!
+     * \brief Memory taken by the samples and the spectra [bytes].
+     */
+    unsigned long int size_bytes() const;
+
+private:
+    friend class Pcps_Acquisition_Service;
+    unsigned int d_fft_size;
+    unsigned int d_num_doppler_bins;
+    float d_input_power;
+    gr_complex* d_samples;
+    gr_complex* d_spectra;
+    bool d_ready; // false while a channel computes the spectra (guarded by the grid mutex)
+};
+
+typedef boost::shared_ptr<const Pcps_Shared_Dwell> pcps_shared_dwell_sptr;
+
+/*!
+ * \brief Doppler grid of the acquisition service: wipe-offs, FFT workspaces
+ * and the most recent blocks of samples. It is released, with its blocks,
+ * when the last acquisition block that uses it releases it.
+ */
+class Pcps_Acquisition_Grid
+{
+public:
+    ~Pcps_Acquisition_Grid();
+
+    unsigned int num_doppler_bins() const { return d_num_doppler_bins; }
+
+    /*!
+     * \brief Number of blocks of samples kept, from the size of a block.
+     */
+    unsigned int max_dwells() const { return d_max_dwells; }
+
+private:
+    friend class Pcps_Acquisition_Service;
+    Pcps_Acquisition_Grid() {}
+
+    // FFT and power buffers of a channel computing a block
+    struct Workspace
+    {
+        gr::fft::fft_complex* fft;
+        float* magnitude;
+    };
+
+    unsigned int d_fft_size;
+    unsigned int d_num_doppler_bins;
+    unsigned int d_max_dwells;
+    pcps_wipeoff_table_sptr d_doppler_wipeoffs;
+    std::vector<Workspace> d_free_workspaces;
+    std::map<unsigned long int, pcps_shared_dwell_sptr> d_dwells;
+    boost::mutex d_mutex;
+    boost::condition_variable d_dwell_ready;
+};
+
+typedef boost::shared_ptr<Pcps_Acquisition_Grid> pcps_acquisition_grid_sptr;
+
+/*!
+ * \brief Process-wide, thread-safe cache of Pcps_Shared_Dwell objects, keyed
+ * by Doppler grid and by sample stamp of the block of samples.
+ *
+ * The most recent blocks of each grid are kept, so channels that process the
+ * stream with some delay still find them, up to a memory budget per grid.
+ * A copy of the input samples is kept as well and compared on every hit, so
+ * a stale block (e.g., from a previous flowgraph run with the same sample
+ * stamps) is never returned. The spectra are computed out of the lock of the
+ * grid: only the channels asking for the block being computed wait for it.
+ */
+class Pcps_Acquisition_Service
+{
+public:
+    /*!
+     * \brief Returns the service shared by all the acquisition blocks.
+     */
+    static Pcps_Acquisition_Service* instance();
+
+    /*!
+     * \brief Returns a Doppler grid, creating it if no other block holds it.
+     * \param freq - Intermediate frequency [Hz].
+     * \param fs_in - Sampling frequency [Hz].
+     * \param fft_size - Number of samples of the blocks.
+     * \param doppler_max - Maximum Doppler shift of the grid [Hz].
+     * \param doppler_step - Doppler step of the grid [Hz].
+     */
+    pcps_acquisition_grid_sptr grid(long freq, long fs_in, unsigned int fft_size,
+            unsigned int doppler_max, unsigned int doppler_step);
+
+    /*!
+     * \brief Returns the spectra of a block of samples, computing them if no
+     * other channel has done it before.
+     * \param grid - Doppler grid (see grid()).
+     * \param sample_stamp - Sample counter at the end of the block, which
+     * identifies the block in the stream shared by the channels.
+     * \param in - Input samples (fft_size complex samples, aligned).
+     * \return The spectra, or a null pointer if they cannot be allocated.
+     */
+    pcps_shared_dwell_sptr dwell(const pcps_acquisition_grid_sptr& grid,
+            unsigned long int sample_stamp, const gr_complex* in);
+
+    /*!
+     * \brief Number of grids currently in use.
+     */
+    unsigned int size();
+
+private:
+    struct Grid_Key
+    {
+        long freq;
+        long fs_in;
+        unsigned int fft_size;
+        unsigned int doppler_max;
+        unsigned int doppler_step;
+        bool operator<(const Grid_Key& other) const;
+    };
+
+    Pcps_Acquisition_Service() {}
+    void compute(Pcps_Acquisition_Grid* grid, Pcps_Acquisition_Grid::Workspace& workspace,
+            Pcps_Shared_Dwell* dwell, const gr_complex* in);
+
+    std::map<Grid_Key, boost::weak_ptr<Pcps_Acquisition_Grid> > d_grids;
+    boost::mutex d_mutex;
+};
+
+#endif /* GNSS_SDR_PCPS_ACQUISITION_SERVICE_H_ */
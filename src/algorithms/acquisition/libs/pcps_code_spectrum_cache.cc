@@ -0,0 +1,279 @@
+/*!
+ * \file pcps_code_spectrum_cache.cc
+ * \brief Process-wide cache of the conjugated spectra of the local codes
+ * used by the Parallel Code Phase Search acquisition blocks
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "pcps_code_spectrum_cache.h"
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <stdint.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <glog/logging.h>
+
+using google::LogMessage;
+
+/*
+ * File layout: the magic string, followed by records of
+ *   uint32 signal label length, signal label characters,
+ *   uint32 PRN, int64 sampling frequency, uint32 FFT size,
+ *   FFT size complex float samples.
+ * Fields are in host byte order.
+ */
+#define PCPS_CODE_SPECTRA_MAGIC "GSDRCS01"
+#define PCPS_CODE_SPECTRA_MAGIC_LENGTH 8
+
+bool Pcps_Code_Spectrum_Cache::Key::operator<(const Key& other) const
+{
+    if (prn != other.prn) return prn < other.prn;
+    if (fs_in != other.fs_in) return fs_in < other.fs_in;
+    if (fft_size != other.fft_size) return fft_size < other.fft_size;
+    return signal < other.signal;
+}
+
+
+
+Pcps_Code_Spectrum_Cache::Pcps_Code_Spectrum_Cache()
+{
+    d_filename = "";
+}
+
+
+
+Pcps_Code_Spectrum_Cache* Pcps_Code_Spectrum_Cache::instance()
+{
+    // Never destroyed: stored spectra are valid for the whole life of the process
+    static Pcps_Code_Spectrum_Cache* cache = new Pcps_Code_Spectrum_Cache();
+    return cache;
+}
+
+
+
+const gr_complex* Pcps_Code_Spectrum_Cache::find(const std::string& signal,
+        unsigned int prn, long fs_in, unsigned int fft_size)
+{
+    Key key;
+    key.signal = signal;
+    key.prn = prn;
+    key.fs_in = fs_in;
+    key.fft_size = fft_size;
+
+    boost::mutex::scoped_lock lock(d_mutex);
+    std::map<Key, const gr_complex*>::iterator it = d_spectra.find(key);
+    if (it == d_spectra.end())
+        {
+            return 0;
+        }
+    return it->second;
+}
+
+
+
+void Pcps_Code_Spectrum_Cache::insert(const std::string& signal, unsigned int prn,
+        long fs_in, unsigned int fft_size, const gr_complex* spectrum)
+{
+    Key key;
+    key.signal = signal;
+    key.prn = prn;
+    key.fs_in = fs_in;
+    key.fft_size = fft_size;
+
+    boost::mutex::scoped_lock lock(d_mutex);
+    if (d_spectra.find(key) != d_spectra.end())
+        {
+            return;
+        }
+
+    gr_complex* copy;
+    if (posix_memalign((void**)&copy, 16, fft_size * sizeof(gr_complex)) != 0)
+        {
+            // The channel keeps its own spectrum, only the cache misses it
+            LOG(ERROR) << "Code spectra cache: cannot allocate " << signal << " PRN " << prn
+                       << " spectrum of " << fft_size << " samples";
+            return;
+        }
+    memcpy(copy, spectrum, fft_size * sizeof(gr_complex));
+    d_spectra[key] = copy;
+
+    if (d_file.is_open())
+        {
+            uint32_t length = signal.size();
+            uint32_t prn32 = prn;
+            int64_t fs64 = fs_in;
+            uint32_t size32 = fft_size;
+            d_file.write((char*)&length, sizeof(length));
+            d_file.write(signal.c_str(), length);
+            d_file.write((char*)&prn32, sizeof(prn32));
+            d_file.write((char*)&fs64, sizeof(fs64));
+            d_file.write((char*)&size32, sizeof(size32));
+            d_file.write((char*)spectrum, fft_size * sizeof(gr_complex));
+            d_file.flush();
+        }
+}
+
+
+
+unsigned int Pcps_Code_Spectrum_Cache::size()
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+    return d_spectra.size();
+}
+
+
+
+bool Pcps_Code_Spectrum_Cache::set_persistence_file(const std::string& filename)
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+    if (!d_filename.empty())
+        {
+            if (d_filename.compare(filename) != 0)
+                {
+                    LOG(WARNING) << "Code spectra cache already backed by " << d_filename
+                                 << ", ignoring " << filename;
+                }
+            return d_file.is_open();
+        }
+    d_filename = filename;
+
+    size_t valid_length = 0;
+    if (!map_file(filename, &valid_length))
+        {
+            return false;
+        }
+
+    struct stat file_status;
+    bool new_file = (stat(filename.c_str(), &file_status) != 0) || (file_status.st_size == 0);
+    if (!new_file && (size_t)file_status.st_size > valid_length)
+        {
+            // drop a truncated last record before appending
+            if (truncate(filename.c_str(), valid_length) != 0)
+                {
+                    LOG(WARNING) << "Code spectra cache file " << filename << " cannot be repaired";
+                    return false;
+                }
+        }
+    d_file.open(filename.c_str(), std::ios::out | std::ios::binary | std::ios::app);
+    if (!d_file.is_open())
+        {
+            LOG(WARNING) << "Code spectra cache file " << filename << " cannot be written";
+            return false;
+        }
+    if (new_file)
+        {
+            d_file.write(PCPS_CODE_SPECTRA_MAGIC, PCPS_CODE_SPECTRA_MAGIC_LENGTH);
+            d_file.flush();
+        }
+    return true;
+}
+
+
+
+bool Pcps_Code_Spectrum_Cache::map_file(const std::string& filename, size_t* valid_length)
+{
+    *valid_length = 0;
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+        {
+            // the file will be created
+            return true;
+        }
+
+    struct stat file_status;
+    if (fstat(fd, &file_status) != 0 || file_status.st_size < PCPS_CODE_SPECTRA_MAGIC_LENGTH)
+        {
+            close(fd);
+            // too short to hold anything, it will be rewritten
+            if (truncate(filename.c_str(), 0) != 0)
+                {
+                    return false;
+                }
+            return true;
+        }
+
+    size_t length = file_status.st_size;
+    // The mapping is kept for the whole life of the process
+    void* mapping = mmap(0, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED)
+        {
+            LOG(WARNING) << "Code spectra cache file " << filename << " cannot be mapped";
+            return false;
+        }
+
+    const char* data = (const char*)mapping;
+    if (memcmp(data, PCPS_CODE_SPECTRA_MAGIC, PCPS_CODE_SPECTRA_MAGIC_LENGTH) != 0)
+        {
+            LOG(WARNING) << "Code spectra cache file " << filename << " has an unknown format";
+            munmap(mapping, length);
+            return false;
+        }
+
+    size_t offset = PCPS_CODE_SPECTRA_MAGIC_LENGTH;
+    unsigned int records = 0;
+    while (offset + sizeof(uint32_t) <= length)
+        {
+            uint32_t label_length;
+            memcpy(&label_length, data + offset, sizeof(label_length));
+            size_t header_length = sizeof(uint32_t) + label_length + sizeof(uint32_t)
+                    + sizeof(int64_t) + sizeof(uint32_t);
+            if (offset + header_length > length)
+                {
+                    break;
+                }
+            Key key;
+            uint32_t prn32;
+            int64_t fs64;
+            uint32_t size32;
+            const char* field = data + offset + sizeof(uint32_t);
+            key.signal = std::string(field, label_length);
+            field += label_length;
+            memcpy(&prn32, field, sizeof(prn32));
+            field += sizeof(prn32);
+            memcpy(&fs64, field, sizeof(fs64));
+            field += sizeof(fs64);
+            memcpy(&size32, field, sizeof(size32));
+            field += sizeof(size32);
+            if (offset + header_length + (size_t)size32 * sizeof(gr_complex) > length)
+                {
+                    // truncated record, e.g. from an interrupted run
+                    break;
+                }
+            key.prn = prn32;
+            key.fs_in = fs64;
+            key.fft_size = size32;
+            d_spectra[key] = (const gr_complex*)field;
+            offset += header_length + (size_t)size32 * sizeof(gr_complex);
+            records++;
+        }
+
+    *valid_length = offset;
+    LOG(INFO) << records << " code spectra loaded from " << filename;
+    return true;
+}
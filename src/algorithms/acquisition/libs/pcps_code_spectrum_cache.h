@@ -0,0 +1,114 @@
+/*!
+ * \file pcps_code_spectrum_cache.h
+ * \brief Process-wide cache of the conjugated spectra of the local codes
+ * used by the Parallel Code Phase Search acquisition blocks
+ *
+ * Each time a channel is assigned a new satellite, the acquisition adapter
+ * generates the sampled replica of the code and the acquisition block
+ * computes its FFT. With this cache, that work is done once per signal,
+ * PRN, sampling frequency and FFT size, and later assignments only copy
+ * the stored spectrum into the block.
+ *
+ * Optionally, the cache is backed by a file: the spectra stored in it are
+ * memory-mapped at startup, and the new ones are appended to it, so the
+ * next run of the receiver starts with a warm cache.
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_PCPS_CODE_SPECTRUM_CACHE_H_
+#define GNSS_SDR_PCPS_CODE_SPECTRUM_CACHE_H_
+
+#include <fstream>
+#include <map>
+#include <string>
+#include <boost/thread/mutex.hpp>
+#include <gnuradio/gr_complex.h>
+
+/*!
+ * \brief Thread-safe cache of conjugated code spectra, keyed by signal, PRN,
+ * sampling frequency and FFT size (that is, coherent integration length).
+ *
+ * The signal label must identify everything else the replica depends on
+ * (system, signal, subcarrier model, code variant), e.g. "Galileo 1B cboc".
+ * Stored spectra are never modified nor released, so the returned pointers
+ * are valid for the whole life of the process.
+ */
+class Pcps_Code_Spectrum_Cache
+{
+public:
+    /*!
+     * \brief Returns the cache shared by all the acquisition blocks.
+     */
+    static Pcps_Code_Spectrum_Cache* instance();
+
+    /*!
+     * \brief Returns the stored spectrum (fft_size complex samples, not
+     * necessarily aligned), or 0 if it is not in the cache.
+     */
+    const gr_complex* find(const std::string& signal, unsigned int prn,
+            long fs_in, unsigned int fft_size);
+
+    /*!
+     * \brief Stores a copy of a conjugated code spectrum. If the cache is
+     * backed by a file, the spectrum is appended to it. If the copy cannot
+     * be allocated, the spectrum is not stored.
+     */
+    void insert(const std::string& signal, unsigned int prn, long fs_in,
+            unsigned int fft_size, const gr_complex* spectrum);
+
+    /*!
+     * \brief Backs the cache by a file. The spectra already stored in it are
+     * memory-mapped, and the following insertions are appended to it. Only
+     * the first call has effect.
+     * \return false if the file cannot be used.
+     */
+    bool set_persistence_file(const std::string& filename);
+
+    /*!
+     * \brief Number of spectra in the cache.
+     */
+    unsigned int size();
+
+private:
+    struct Key
+    {
+        std::string signal;
+        unsigned int prn;
+        long fs_in;
+        unsigned int fft_size;
+        bool operator<(const Key& other) const;
+    };
+
+    Pcps_Code_Spectrum_Cache();
+    bool map_file(const std::string& filename, size_t* valid_length);
+
+    std::map<Key, const gr_complex*> d_spectra;
+    std::string d_filename;
+    std::ofstream d_file;
+    boost::mutex d_mutex;
+};
+
+#endif /* GNSS_SDR_PCPS_CODE_SPECTRUM_CACHE_H_ */
@@ -0,0 +1,237 @@
+/*!
+ * \file pcps_doppler_batch_engine.cc
+ * \brief Batched multi-Doppler FFT engine for Parallel Code Phase Search
+ * acquisition
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "pcps_doppler_batch_engine.h"
+#include <cstdlib>
+#include <new>
+#include <gnuradio/fft/fft.h>
+#include <glog/logging.h>
+#include <volk/volk.h>
+
+using google::LogMessage;
+
+// Rows are padded to a multiple of 8 complex samples (64 bytes)
+#define PCPS_BATCH_ROW_ALIGNMENT 8
+
+Pcps_Doppler_Batch_Engine::Pcps_Doppler_Batch_Engine(unsigned int fft_size,
+        unsigned int num_doppler_bins, unsigned int batch_size)
+{
+    d_fft_size = fft_size;
+    d_num_doppler_bins = num_doppler_bins;
+    if (batch_size == 0)
+        {
+            batch_size = 1;
+        }
+    if (batch_size > num_doppler_bins)
+        {
+            batch_size = num_doppler_bins;
+        }
+    d_batch_size = batch_size;
+    d_num_batches = (d_num_doppler_bins + d_batch_size - 1) / d_batch_size;
+    d_row_stride = ((d_fft_size + PCPS_BATCH_ROW_ALIGNMENT - 1) / PCPS_BATCH_ROW_ALIGNMENT) * PCPS_BATCH_ROW_ALIGNMENT;
+    d_current_length = 0;
+
+    size_t batch_length = (size_t)d_batch_size * d_row_stride;
+    if (posix_memalign((void**)&d_fwd_buffer, 64, batch_length * sizeof(gr_complex)) != 0) d_fwd_buffer = 0;
+    if (posix_memalign((void**)&d_inv_buffer, 64, batch_length * sizeof(gr_complex)) != 0) d_inv_buffer = 0;
+    if (posix_memalign((void**)&d_magnitude, 64, batch_length * sizeof(float)) != 0) d_magnitude = 0;
+    if (d_fwd_buffer == 0 || d_inv_buffer == 0 || d_magnitude == 0)
+        {
+            LOG(ERROR) << "Doppler batch engine: cannot allocate the buffers of "
+                       << d_batch_size << " x " << d_row_stride << " samples";
+            free(d_fwd_buffer);
+            free(d_inv_buffer);
+            free(d_magnitude);
+            throw std::bad_alloc();
+        }
+    d_peak_index = new unsigned int[d_batch_size];
+    d_peak_magnitude = new float[d_batch_size];
+
+    for (unsigned int row = 0; row < d_batch_size; row++)
+        {
+            d_peak_index[row] = 0;
+            d_peak_magnitude[row] = 0.0;
+        }
+
+    create_plans();
+
+    DLOG(INFO) << "Doppler batch engine: fft_size=" << d_fft_size
+               << ", doppler bins=" << d_num_doppler_bins
+               << ", batch size=" << d_batch_size
+               << ", batches=" << d_num_batches;
+}
+
+
+
+Pcps_Doppler_Batch_Engine::~Pcps_Doppler_Batch_Engine()
+{
+    {
+        // FFTW planner calls are not thread safe. Share the GNU Radio planner lock.
+        gr::fft::planner::scoped_lock lock(gr::fft::planner::mutex());
+        fftwf_destroy_plan(d_fwd_plan);
+        fftwf_destroy_plan(d_inv_plan);
+        if (d_fwd_plan_tail != d_fwd_plan)
+            {
+                fftwf_destroy_plan(d_fwd_plan_tail);
+                fftwf_destroy_plan(d_inv_plan_tail);
+            }
+    }
+    free(d_fwd_buffer);
+    free(d_inv_buffer);
+    free(d_magnitude);
+    delete[] d_peak_index;
+    delete[] d_peak_magnitude;
+}
+
+
+
+void Pcps_Doppler_Batch_Engine::create_plans()
+{
+    int n[1] = { (int)d_fft_size };
+    unsigned int tail_length = d_num_doppler_bins - (d_num_batches - 1) * d_batch_size;
+
+    gr::fft::planner::scoped_lock lock(gr::fft::planner::mutex());
+
+    // in-place multi-transform plans: forward over d_fwd_buffer, inverse over d_inv_buffer
+    d_fwd_plan = fftwf_plan_many_dft(1, n, (int)d_batch_size,
+            reinterpret_cast<fftwf_complex*>(d_fwd_buffer), NULL, 1, (int)d_row_stride,
+            reinterpret_cast<fftwf_complex*>(d_fwd_buffer), NULL, 1, (int)d_row_stride,
+            FFTW_FORWARD, FFTW_MEASURE);
+    d_inv_plan = fftwf_plan_many_dft(1, n, (int)d_batch_size,
+            reinterpret_cast<fftwf_complex*>(d_inv_buffer), NULL, 1, (int)d_row_stride,
+            reinterpret_cast<fftwf_complex*>(d_inv_buffer), NULL, 1, (int)d_row_stride,
+            FFTW_BACKWARD, FFTW_MEASURE);
+
+    if (tail_length == d_batch_size)
+        {
+            d_fwd_plan_tail = d_fwd_plan;
+            d_inv_plan_tail = d_inv_plan;
+        }
+    else
+        {
+            d_fwd_plan_tail = fftwf_plan_many_dft(1, n, (int)tail_length,
+                    reinterpret_cast<fftwf_complex*>(d_fwd_buffer), NULL, 1, (int)d_row_stride,
+                    reinterpret_cast<fftwf_complex*>(d_fwd_buffer), NULL, 1, (int)d_row_stride,
+                    FFTW_FORWARD, FFTW_MEASURE);
+            d_inv_plan_tail = fftwf_plan_many_dft(1, n, (int)tail_length,
+                    reinterpret_cast<fftwf_complex*>(d_inv_buffer), NULL, 1, (int)d_row_stride,
+                    reinterpret_cast<fftwf_complex*>(d_inv_buffer), NULL, 1, (int)d_row_stride,
+                    FFTW_BACKWARD, FFTW_MEASURE);
+        }
+}
+
+
+
+unsigned int Pcps_Doppler_Batch_Engine::batch_length(unsigned int batch) const
+{
+    if (batch + 1 < d_num_batches)
+        {
+            return d_batch_size;
+        }
+    return d_num_doppler_bins - (d_num_batches - 1) * d_batch_size;
+}
+
+
+
+void Pcps_Doppler_Batch_Engine::forward(unsigned int batch, const gr_complex* in,
+        const Pcps_Wipeoff_Source* wipeoffs)
+{
+    unsigned int first = first_bin(batch);
+    d_current_length = batch_length(batch);
+
+    // Carrier wipe-off of every Doppler bin of the batch
+    for (unsigned int row = 0; row < d_current_length; row++)
+        {
+            wipeoffs->wipeoff(spectrum(row), in, first + row);
+        }
+
+    // One planned multi-transform forward FFT for the whole batch
+    if (d_current_length == d_batch_size)
+        {
+            fftwf_execute(d_fwd_plan);
+        }
+    else
+        {
+            fftwf_execute(d_fwd_plan_tail);
+        }
+}
+
+
+
+void Pcps_Doppler_Batch_Engine::correlate(const gr_complex* fft_codes)
+{
+    // Multiply the Fourier transformed, carrier wiped-off signals with the local code spectrum
+    for (unsigned int row = 0; row < d_current_length; row++)
+        {
+            volk_32fc_x2_multiply_32fc_a(correlation(row), spectrum(row), fft_codes, d_fft_size);
+        }
+
+    inverse_and_search();
+}
+
+
+
+void Pcps_Doppler_Batch_Engine::correlate(unsigned int batch, const Pcps_Spectrum_Source* spectra,
+        const gr_complex* fft_codes)
+{
+    unsigned int first = first_bin(batch);
+    d_current_length = batch_length(batch);
+
+    // Multiply the provided input spectra with the local code spectrum
+    for (unsigned int row = 0; row < d_current_length; row++)
+        {
+            spectra->multiply(correlation(row), first + row, fft_codes);
+        }
+
+    inverse_and_search();
+}
+
+
+
+void Pcps_Doppler_Batch_Engine::inverse_and_search()
+{
+    // One planned multi-transform inverse FFT for the whole batch
+    if (d_current_length == d_batch_size)
+        {
+            fftwf_execute(d_inv_plan);
+        }
+    else
+        {
+            fftwf_execute(d_inv_plan_tail);
+        }
+
+    // Peak search of every correlation vector
+    for (unsigned int row = 0; row < d_current_length; row++)
+        {
+            volk_32fc_magnitude_squared_32f_a(magnitude(row), correlation(row), d_fft_size);
+            volk_32f_index_max_16u_a(&d_peak_index[row], magnitude(row), d_fft_size);
+            d_peak_magnitude[row] = magnitude(row)[d_peak_index[row]];
+        }
+}
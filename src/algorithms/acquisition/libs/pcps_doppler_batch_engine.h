@@ -0,0 +1,173 @@
+/*!
+ * \file pcps_doppler_batch_engine.h
+ * \brief Batched multi-Doppler FFT engine for Parallel Code Phase Search
+ * acquisition
+ *
+ * Instead of transforming one Doppler bin at a time through a single
+ * gr::fft::fft_complex buffer pair, the Doppler grid is split in batches
+ * of consecutive bins that are transformed with planned FFTW multi-transform
+ * (advanced interface) plans. For each batch:
+ *  <ol>
+ *  <li> Carrier wipe-off of the input with every Doppler bin of the batch
+ *  <li> One multi-transform forward FFT for the whole batch
+ *  <li> Multiplication of every spectrum with the local code spectrum
+ *  <li> One multi-transform inverse FFT for the whole batch
+ *  <li> Peak search of every correlation vector of the batch
+ *  </ol>
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_PCPS_DOPPLER_BATCH_ENGINE_H_
+#define GNSS_SDR_PCPS_DOPPLER_BATCH_ENGINE_H_
+
+#include <fftw3.h>
+#include <gnuradio/gr_complex.h>
+#include "pcps_spectrum_source.h"
+#include "pcps_wipeoff_source.h"
+
+/*!
+ * \brief Performs the Doppler search of a PCPS acquisition in batches of
+ * Doppler bins, using FFTW multi-transform plans.
+ *
+ * The engine owns the FFT plans and the working buffers. Rows of the
+ * buffers are padded to a multiple of 64 bytes, so each row keeps the
+ * alignment required by the aligned VOLK kernels.
+ *
+ * Typical use (one dwell):
+ * \code
+ * for (unsigned int batch = 0; batch < engine.num_batches(); batch++)
+ *     {
+ *         engine.forward(batch, in, wipeoffs);
+ *         engine.correlate(fft_codes);
+ *         for (unsigned int row = 0; row < engine.batch_length(batch); row++)
+ *             {
+ *                 // engine.peak_index(row), engine.peak_magnitude(row)
+ *             }
+ *     }
+ * \endcode
+ */
+class Pcps_Doppler_Batch_Engine
+{
+public:
+    /*!
+     * \brief Constructor.
+     * \param fft_size - Number of samples of each FFT.
+     * \param num_doppler_bins - Number of Doppler bins of the search grid.
+     * \param batch_size - Maximum number of Doppler bins transformed at once.
+     * Throws std::bad_alloc if the buffers of a batch cannot be allocated.
+     */
+    Pcps_Doppler_Batch_Engine(unsigned int fft_size, unsigned int num_doppler_bins,
+            unsigned int batch_size);
+    ~Pcps_Doppler_Batch_Engine();
+
+    unsigned int fft_size() const { return d_fft_size; }
+    unsigned int num_doppler_bins() const { return d_num_doppler_bins; }
+    unsigned int batch_size() const { return d_batch_size; }
+    unsigned int num_batches() const { return d_num_batches; }
+
+    /*!
+     * \brief Index of the first Doppler bin of a batch.
+     */
+    unsigned int first_bin(unsigned int batch) const { return batch * d_batch_size; }
+
+    /*!
+     * \brief Number of Doppler bins of a batch (the last one can be shorter).
+     */
+    unsigned int batch_length(unsigned int batch) const;
+
+    /*!
+     * \brief Carrier wipe-off and forward FFT of all the Doppler bins of a batch.
+     * \param batch - Batch index.
+     * \param in - Input samples (d_fft_size complex samples).
+     * \param wipeoffs - Doppler wipe-offs of the grid.
+     */
+    void forward(unsigned int batch, const gr_complex* in, const Pcps_Wipeoff_Source* wipeoffs);
+
+    /*!
+     * \brief Multiplies the spectra of the current batch by the conjugated
+     * local code spectrum, computes the inverse FFTs and searches the peak of
+     * every correlation vector.
+     */
+    void correlate(const gr_complex* fft_codes);
+
+    /*!
+     * \brief Same as correlate(), but the spectra of the Doppler bins of the
+     * batch are provided by \p spectra (for instance, rotations of the input
+     * spectrum or spectra shared among channels), so forward() is not needed.
+     */
+    void correlate(unsigned int batch, const Pcps_Spectrum_Source* spectra,
+            const gr_complex* fft_codes);
+
+    /*!
+     * \brief Forward spectrum of a row of the current batch.
+     */
+    gr_complex* spectrum(unsigned int row) { return d_fwd_buffer + row * d_row_stride; }
+
+    /*!
+     * \brief Circular correlation (inverse FFT output) of a row of the current batch.
+     */
+    gr_complex* correlation(unsigned int row) { return d_inv_buffer + row * d_row_stride; }
+
+    /*!
+     * \brief |correlation|^2 of a row of the current batch.
+     */
+    float* magnitude(unsigned int row) { return d_magnitude + row * d_row_stride; }
+
+    /*!
+     * \brief Sample index of the correlation peak of a row of the current batch.
+     */
+    unsigned int peak_index(unsigned int row) const { return d_peak_index[row]; }
+
+    /*!
+     * \brief Squared magnitude (not normalized) of the correlation peak of a row of the current batch.
+     */
+    float peak_magnitude(unsigned int row) const { return d_peak_magnitude[row]; }
+
+private:
+    void create_plans();
+    void inverse_and_search();
+
+    unsigned int d_fft_size;
+    unsigned int d_num_doppler_bins;
+    unsigned int d_batch_size;
+    unsigned int d_num_batches;
+    unsigned int d_row_stride;
+    unsigned int d_current_length;
+
+    gr_complex* d_fwd_buffer;
+    gr_complex* d_inv_buffer;
+    float* d_magnitude;
+    unsigned int* d_peak_index;
+    float* d_peak_magnitude;
+
+    // plans for full batches and for the (shorter) last batch
+    fftwf_plan d_fwd_plan;
+    fftwf_plan d_inv_plan;
+    fftwf_plan d_fwd_plan_tail;
+    fftwf_plan d_inv_plan_tail;
+};
+
+#endif /* GNSS_SDR_PCPS_DOPPLER_BATCH_ENGINE_H_ */
@@ -0,0 +1,150 @@
+/*!
+ * \file pcps_doppler_rotation.cc
+ * \brief Doppler search by circular rotation of the input spectrum
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "pcps_doppler_rotation.h"
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <glog/logging.h>
+#include <volk/volk.h>
+#include "gnss_signal_processing.h"
+
+using google::LogMessage;
+
+// Two residuals closer than this are considered the same [Hz]
+#define PCPS_ROTATION_RESIDUAL_TOLERANCE_HZ 0.01
+
+Pcps_Doppler_Rotation::Pcps_Doppler_Rotation(long freq, long fs_in,
+        unsigned int fft_size, unsigned int doppler_max, unsigned int doppler_step)
+{
+    d_fft_size = fft_size;
+    d_num_doppler_bins = 0;
+    for (int doppler = (int)(-doppler_max); doppler <= (int)doppler_max; doppler += doppler_step)
+        {
+            d_num_doppler_bins++;
+        }
+
+    double bin_hz = (double)fs_in / (double)d_fft_size;
+
+    for (unsigned int doppler_index = 0; doppler_index < d_num_doppler_bins; doppler_index++)
+        {
+            int doppler = -(int)doppler_max + doppler_step*doppler_index;
+            long k = (long)std::floor((double)doppler / bin_hz + 0.5);
+            double residual = (double)doppler - (double)k * bin_hz;
+
+            unsigned int r;
+            for (r = 0; r < d_residual_hz.size(); r++)
+                {
+                    if (std::fabs(d_residual_hz[r] - residual) < PCPS_ROTATION_RESIDUAL_TOLERANCE_HZ)
+                        {
+                            break;
+                        }
+                }
+            if (r == d_residual_hz.size())
+                {
+                    d_residual_hz.push_back(residual);
+                }
+            d_residual_index.push_back(r);
+
+            long n = (long)d_fft_size;
+            d_shift.push_back((unsigned int)(((k % n) + n) % n));
+        }
+
+    // One wipe-off and one spectrum per residual
+    for (unsigned int r = 0; r < d_residual_hz.size(); r++)
+        {
+            gr_complex* wipeoff;
+            gr_complex* spectrum;
+            if (posix_memalign((void**)&wipeoff, 16, d_fft_size * sizeof(gr_complex)) != 0) wipeoff = 0;
+            if (posix_memalign((void**)&spectrum, 16, d_fft_size * sizeof(gr_complex)) != 0) spectrum = 0;
+            if (wipeoff == 0 || spectrum == 0)
+                {
+                    LOG(ERROR) << "Doppler rotation: cannot allocate the wipe-off of "
+                               << d_fft_size << " samples of residual " << r;
+                    free(wipeoff);
+                    free(spectrum);
+                    for (unsigned int i = 0; i < d_residual_wipeoffs.size(); i++)
+                        {
+                            free(d_residual_wipeoffs[i]);
+                            free(d_spectra[i]);
+                        }
+                    throw std::bad_alloc();
+                }
+            complex_exp_gen_conj(wipeoff, (double)freq + d_residual_hz[r], (double)fs_in, d_fft_size);
+            d_residual_wipeoffs.push_back(wipeoff);
+            d_spectra.push_back(spectrum);
+        }
+
+    DLOG(INFO) << "Doppler rotation: " << d_num_doppler_bins << " Doppler bins, "
+               << d_residual_hz.size() << " forward FFTs per dwell";
+}
+
+
+
+Pcps_Doppler_Rotation::~Pcps_Doppler_Rotation()
+{
+    for (unsigned int r = 0; r < d_residual_hz.size(); r++)
+        {
+            free(d_residual_wipeoffs[r]);
+            free(d_spectra[r]);
+        }
+}
+
+
+
+void Pcps_Doppler_Rotation::forward(const gr_complex* in, gr::fft::fft_complex* fft)
+{
+    for (unsigned int r = 0; r < d_residual_hz.size(); r++)
+        {
+            volk_32fc_x2_multiply_32fc_a(fft->get_inbuf(), in, d_residual_wipeoffs[r], d_fft_size);
+            fft->execute();
+            memcpy(d_spectra[r], fft->get_outbuf(), sizeof(gr_complex)*d_fft_size);
+        }
+}
+
+
+
+void Pcps_Doppler_Rotation::multiply(gr_complex* out, unsigned int doppler_index,
+        const gr_complex* fft_codes) const
+{
+    const gr_complex* spectrum = d_spectra[d_residual_index[doppler_index]];
+    unsigned int k = d_shift[doppler_index];
+
+    if (k == 0)
+        {
+            volk_32fc_x2_multiply_32fc_a(out, spectrum, fft_codes, d_fft_size);
+        }
+    else
+        {
+            // out[m] = X[(m + k) mod N] * C[m], in two contiguous segments
+            volk_32fc_x2_multiply_32fc_u(out, spectrum + k, fft_codes, d_fft_size - k);
+            volk_32fc_x2_multiply_32fc_u(out + d_fft_size - k, spectrum, fft_codes + d_fft_size - k, k);
+        }
+}
@@ -0,0 +1,116 @@
+/*!
+ * \file pcps_doppler_rotation.h
+ * \brief Doppler search by circular rotation of the input spectrum
+ *
+ * A Doppler shift that is a whole multiple k of the FFT bin spacing fs/N
+ * is a circular shift of k bins of the spectrum of the input signal:
+ * \f$ DFT\{x[n] e^{-j2\pi kn/N}\}[m] = X[(m+k) \bmod N] \f$.
+ * Each Doppler bin of the search grid is decomposed as
+ * \f$ f_d = k f_s / N + f_r \f$, and only one forward FFT per distinct
+ * fractional residual \f$ f_r \f$ is computed in each dwell. With the usual
+ * grids (Doppler step equal to or an integer fraction of 1/T_int) this is
+ * one or two forward FFTs per dwell instead of one per Doppler bin.
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_PCPS_DOPPLER_ROTATION_H_
+#define GNSS_SDR_PCPS_DOPPLER_ROTATION_H_
+
+#include <vector>
+#include <gnuradio/gr_complex.h>
+#include <gnuradio/fft/fft.h>
+#include "pcps_spectrum_source.h"
+
+/*!
+ * \brief Decomposes a Doppler search grid in spectrum rotations plus
+ * fractional residuals, and keeps the input spectra of the residuals of
+ * the current dwell.
+ */
+class Pcps_Doppler_Rotation: public Pcps_Spectrum_Source
+{
+public:
+    /*!
+     * \brief Constructor.
+     * \param freq - Intermediate frequency [Hz].
+     * \param fs_in - Sampling frequency [Hz].
+     * \param fft_size - Number of samples of each FFT.
+     * \param doppler_max - Maximum Doppler shift of the grid [Hz].
+     * \param doppler_step - Doppler step of the grid [Hz].
+     * Throws std::bad_alloc if the wipe-offs cannot be allocated.
+     */
+    Pcps_Doppler_Rotation(long freq, long fs_in, unsigned int fft_size,
+            unsigned int doppler_max, unsigned int doppler_step);
+    ~Pcps_Doppler_Rotation();
+
+    unsigned int num_doppler_bins() const { return d_num_doppler_bins; }
+
+    /*!
+     * \brief Number of forward FFTs computed in each dwell.
+     */
+    unsigned int num_residuals() const { return d_residual_hz.size(); }
+
+    /*!
+     * \brief Circular shift (in FFT bins) associated to a Doppler bin.
+     */
+    unsigned int shift(unsigned int doppler_index) const { return d_shift[doppler_index]; }
+
+    /*!
+     * \brief Residual frequency associated to a Doppler bin [Hz].
+     */
+    double residual_hz(unsigned int doppler_index) const { return d_residual_hz[d_residual_index[doppler_index]]; }
+
+    /*!
+     * \brief Spectrum of the input, wiped-off with IF plus the residual of a Doppler bin.
+     */
+    const gr_complex* spectrum(unsigned int doppler_index) const { return d_spectra[d_residual_index[doppler_index]]; }
+
+    /*!
+     * \brief Computes the forward FFTs of the current dwell.
+     * \param in - Input samples (fft_size complex samples).
+     * \param fft - Direct FFT of fft_size samples, used as working buffer.
+     */
+    void forward(const gr_complex* in, gr::fft::fft_complex* fft);
+
+    /*!
+     * \brief Multiplies the rotated spectrum of a Doppler bin by the
+     * conjugated local code spectrum.
+     * \param out - Output vector (fft_size complex samples, aligned).
+     * \param doppler_index - Doppler bin.
+     * \param fft_codes - Conjugated local code spectrum (aligned).
+     */
+    void multiply(gr_complex* out, unsigned int doppler_index, const gr_complex* fft_codes) const;
+
+private:
+    unsigned int d_fft_size;
+    unsigned int d_num_doppler_bins;
+    std::vector<double> d_residual_hz;
+    std::vector<unsigned int> d_residual_index;
+    std::vector<unsigned int> d_shift;
+    std::vector<gr_complex*> d_residual_wipeoffs;
+    std::vector<gr_complex*> d_spectra;
+};
+
+#endif /* GNSS_SDR_PCPS_DOPPLER_ROTATION_H_ */
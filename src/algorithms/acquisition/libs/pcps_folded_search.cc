@@ -0,0 +1,187 @@
+/*!
+ * \file pcps_folded_search.cc
+ * \brief Code phase search of a Parallel Code Phase Search acquisition on
+ * a folded (time aliased) dwell, for long codes
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "pcps_folded_search.h"
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <glog/logging.h>
+#include <volk/volk.h>
+
+using google::LogMessage;
+
+bool Pcps_Folded_Search::supported(unsigned int fft_size, unsigned int fold_factor)
+{
+    return fold_factor > 1 && fft_size % fold_factor == 0;
+}
+
+
+
+Pcps_Folded_Search::Pcps_Folded_Search(unsigned int fft_size, unsigned int fold_factor,
+        unsigned int num_codes)
+{
+    d_fft_size = fft_size;
+    d_fold_factor = fold_factor;
+    d_folded_size = d_fft_size / d_fold_factor;
+    d_num_codes = num_codes;
+
+    d_folded_fft_codes = new gr_complex*[d_num_codes];
+    d_codes = new gr_complex*[d_num_codes];
+    bool allocated = true;
+    for (unsigned int code = 0; code < d_num_codes; code++)
+        {
+            if (posix_memalign((void**)&(d_folded_fft_codes[code]), 16, d_folded_size * sizeof(gr_complex)) != 0) d_folded_fft_codes[code] = 0;
+            if (posix_memalign((void**)&(d_codes[code]), 16, d_fft_size * sizeof(gr_complex)) != 0) d_codes[code] = 0;
+            allocated = allocated && d_folded_fft_codes[code] != 0 && d_codes[code] != 0;
+        }
+    if (posix_memalign((void**)&d_wiped, 16, d_fft_size * sizeof(gr_complex)) != 0) d_wiped = 0;
+    if (posix_memalign((void**)&d_magnitude, 16, d_folded_size * sizeof(float)) != 0) d_magnitude = 0;
+    if (!allocated || d_wiped == 0 || d_magnitude == 0)
+        {
+            LOG(ERROR) << "Folded search: cannot allocate the buffers of " << d_num_codes
+                       << " codes of " << d_fft_size << " samples";
+            for (unsigned int code = 0; code < d_num_codes; code++)
+                {
+                    free(d_folded_fft_codes[code]);
+                    free(d_codes[code]);
+                }
+            delete[] d_folded_fft_codes;
+            delete[] d_codes;
+            free(d_wiped);
+            free(d_magnitude);
+            throw std::bad_alloc();
+        }
+    for (unsigned int code = 0; code < d_num_codes; code++)
+        {
+            for (unsigned int i = 0; i < d_folded_size; i++)
+                {
+                    d_folded_fft_codes[code][i] = gr_complex(0.0, 0.0);
+                }
+            for (unsigned int i = 0; i < d_fft_size; i++)
+                {
+                    d_codes[code][i] = gr_complex(0.0, 0.0);
+                }
+        }
+
+    d_fft = new gr::fft::fft_complex(d_folded_size, true);
+    d_ifft = new gr::fft::fft_complex(d_folded_size, false);
+    // Only used to recover the local codes in the time domain
+    d_code_ifft = new gr::fft::fft_complex(d_fft_size, false);
+
+    DLOG(INFO) << "Folded search: " << d_fft_size << " samples folded by "
+               << d_fold_factor << " into " << d_folded_size;
+}
+
+
+
+Pcps_Folded_Search::~Pcps_Folded_Search()
+{
+    for (unsigned int code = 0; code < d_num_codes; code++)
+        {
+            free(d_folded_fft_codes[code]);
+            free(d_codes[code]);
+        }
+    delete[] d_folded_fft_codes;
+    delete[] d_codes;
+    free(d_wiped);
+    free(d_magnitude);
+    delete d_fft;
+    delete d_ifft;
+    delete d_code_ifft;
+}
+
+
+
+void Pcps_Folded_Search::set_local_code_spectrum(unsigned int code, const gr_complex* fft_code)
+{
+    // Folding in time is decimation in frequency
+    for (unsigned int i = 0; i < d_folded_size; i++)
+        {
+            d_folded_fft_codes[code][i] = fft_code[i * d_fold_factor];
+        }
+
+    // Local code samples for the time domain checks: c = IFFT(conj(fft_code)) / N
+    volk_32fc_conjugate_32fc_u(d_code_ifft->get_inbuf(), fft_code, d_fft_size);
+    d_code_ifft->execute();
+    volk_32fc_s32fc_multiply_32fc_a(d_codes[code], d_code_ifft->get_outbuf(),
+                                    gr_complex(1.0 / (float)d_fft_size, 0.0), d_fft_size);
+}
+
+
+
+void Pcps_Folded_Search::fold(const gr_complex* in, const gr_complex* doppler_wipeoff)
+{
+    volk_32fc_x2_multiply_32fc_a(d_wiped, in, doppler_wipeoff, d_fft_size);
+
+    gr_complex* folded = d_fft->get_inbuf();
+    memcpy(folded, d_wiped, d_folded_size * sizeof(gr_complex));
+    for (unsigned int segment = 1; segment < d_fold_factor; segment++)
+        {
+            // Segments are not aligned in general
+            volk_32f_x2_add_32f_u((float*)folded, (const float*)folded,
+                                  (const float*)(d_wiped + segment * d_folded_size), 2 * d_folded_size);
+        }
+    d_fft->execute();
+}
+
+
+
+float Pcps_Folded_Search::correlate(unsigned int code, unsigned int* index)
+{
+    unsigned int folded_index = 0;
+    volk_32fc_x2_multiply_32fc_a(d_ifft->get_inbuf(), d_fft->get_outbuf(),
+                                 d_folded_fft_codes[code], d_folded_size);
+    d_ifft->execute();
+    volk_32fc_magnitude_squared_32f_a(d_magnitude, d_ifft->get_outbuf(), d_folded_size);
+    volk_32f_index_max_16u_a(&folded_index, d_magnitude, d_folded_size);
+
+    // Resolve the ambiguity: circular correlation of the whole dwell,
+    // sum of x[n + tau] conj(c[n]), at each candidate code phase
+    float best_magnitude = -1.0;
+    for (unsigned int segment = 0; segment < d_fold_factor; segment++)
+        {
+            unsigned int tau = folded_index + segment * d_folded_size;
+            gr_complex head = gr_complex(0.0, 0.0);
+            gr_complex tail = gr_complex(0.0, 0.0);
+            volk_32fc_x2_conjugate_dot_prod_32fc_u(&head, d_wiped + tau, d_codes[code], d_fft_size - tau);
+            if (tau > 0)
+                {
+                    volk_32fc_x2_conjugate_dot_prod_32fc_u(&tail, d_wiped, d_codes[code] + d_fft_size - tau, tau);
+                }
+            // The unnormalized inverse FFT of the full search scales by N
+            float magnitude = std::norm(head + tail) * (float)d_fft_size * (float)d_fft_size;
+            if (magnitude > best_magnitude)
+                {
+                    best_magnitude = magnitude;
+                    *index = tau;
+                }
+        }
+    return best_magnitude;
+}
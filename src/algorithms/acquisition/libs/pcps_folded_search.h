@@ -0,0 +1,114 @@
+/*!
+ * \file pcps_folded_search.h
+ * \brief Code phase search of a Parallel Code Phase Search acquisition on
+ * a folded (time aliased) dwell, for long codes
+ *
+ * The carrier wiped-off dwell of N samples is folded into N/P samples by
+ * adding its P segments. The spectrum of the folded dwell is the spectrum of
+ * the dwell decimated by P, so its circular correlation with the decimated
+ * code spectrum is the correlation of the whole dwell folded in the same
+ * way: the peak is found with FFTs of N/P samples, up to an ambiguity of a
+ * multiple of N/P samples. The ambiguity is resolved by correlating the
+ * whole dwell in the time domain at the P candidate code phases.
+ *
+ * Folding adds the noise of the P segments to the signal of one of them, so
+ * the folded peak is found with a loss of 10*log10(P) dB. The test statistic
+ * uses the full correlation of the chosen candidate and is not affected.
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_PCPS_FOLDED_SEARCH_H_
+#define GNSS_SDR_PCPS_FOLDED_SEARCH_H_
+
+#include <gnuradio/gr_complex.h>
+#include <gnuradio/fft/fft.h>
+
+/*!
+ * \brief Folded code phase search of one Doppler bin against one or more
+ * local codes (e.g. the secondary code hypotheses of a dwell).
+ *
+ * The input is folded once per Doppler bin with fold(), then each local
+ * code is searched with correlate().
+ */
+class Pcps_Folded_Search
+{
+public:
+    /*!
+     * \brief Tells if a dwell of fft_size samples can be folded by fold_factor.
+     */
+    static bool supported(unsigned int fft_size, unsigned int fold_factor);
+
+    /*!
+     * \brief Constructor. Plans the folded FFTs.
+     * \param fft_size - Samples of the dwell (N).
+     * \param fold_factor - Number of segments added together (P).
+     * \param num_codes - Number of local codes.
+     * Throws std::bad_alloc if the buffers cannot be allocated.
+     */
+    Pcps_Folded_Search(unsigned int fft_size, unsigned int fold_factor, unsigned int num_codes);
+    ~Pcps_Folded_Search();
+
+    unsigned int folded_size() const { return d_folded_size; }
+
+    /*!
+     * \brief Sets a local code from the conjugated spectrum of the dwell
+     * (fft_size samples), as used by the full search.
+     */
+    void set_local_code_spectrum(unsigned int code, const gr_complex* fft_code);
+
+    /*!
+     * \brief Wipes off the carrier of a dwell and folds it. The wiped-off
+     * dwell is kept for the time domain checks of correlate().
+     */
+    void fold(const gr_complex* in, const gr_complex* doppler_wipeoff);
+
+    /*!
+     * \brief Searches the folded dwell against a local code and resolves the
+     * ambiguity of the peak.
+     * \param code - Local code.
+     * \param index - Code phase of the peak in the dwell [samples].
+     * \return Squared magnitude of the peak, with the same scale as the
+     * inverse FFT of the full search.
+     */
+    float correlate(unsigned int code, unsigned int* index);
+
+private:
+    unsigned int d_fft_size;
+    unsigned int d_fold_factor;
+    unsigned int d_folded_size;
+    unsigned int d_num_codes;
+
+    gr_complex** d_folded_fft_codes;
+    gr_complex** d_codes;
+    gr_complex* d_wiped;
+    float* d_magnitude;
+
+    gr::fft::fft_complex* d_fft;
+    gr::fft::fft_complex* d_ifft;
+    gr::fft::fft_complex* d_code_ifft;
+};
+
+#endif /* GNSS_SDR_PCPS_FOLDED_SEARCH_H_ */
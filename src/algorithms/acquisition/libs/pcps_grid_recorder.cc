@@ -0,0 +1,261 @@
+/*!
+ * \file pcps_grid_recorder.cc
+ * \brief Capture of the search grids of a Parallel Code Phase Search
+ * acquisition into preallocated memory, written to disk by a background thread
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "pcps_grid_recorder.h"
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdint.h>
+#include <glog/logging.h>
+
+using google::LogMessage;
+
+#define PCPS_GRID_MAGIC "GSDRAG01"
+#define PCPS_GRID_MAGIC_LENGTH 8
+
+Pcps_Grid_Recorder::Pcps_Grid_Recorder(const std::string& filename, unsigned int fft_size,
+        unsigned int num_doppler_bins, unsigned int slots)
+{
+    // Only a dot of the last path component starts an extension
+    std::string::size_type dot = filename.find_last_of(".");
+    std::string::size_type slash = filename.find_last_of("/");
+    if (dot != std::string::npos && (slash == std::string::npos || dot > slash))
+        {
+            d_basename = filename.substr(0, dot);
+        }
+    else
+        {
+            d_basename = filename;
+        }
+    d_fft_size = fft_size;
+    d_num_doppler_bins = num_doppler_bins;
+    d_num_slots = slots > 0 ? slots : 1;
+    d_current = -1;
+    d_attempts = 0;
+    d_dropped = 0;
+
+    d_enabled = true;
+
+    d_slots = new Slot[d_num_slots];
+    for (unsigned int i = 0; i < d_num_slots; i++)
+        {
+            d_slots[i].doppler_hz = new int[d_num_doppler_bins];
+            d_slots[i].recorded = new bool[d_num_doppler_bins];
+            if (posix_memalign((void**)&(d_slots[i].rows), 16,
+                               (size_t)d_num_doppler_bins * d_fft_size * sizeof(gr_complex)) != 0)
+                {
+                    d_slots[i].rows = 0;
+                    d_enabled = false;
+                }
+        }
+    if (d_enabled)
+        {
+            for (unsigned int i = 0; i < d_num_slots; i++)
+                {
+                    d_free_slots.push(i);
+                }
+        }
+    else
+        {
+            // No free slot: begin() always fails, and the acquisition goes on
+            LOG(WARNING) << "Grid recorder: cannot allocate " << d_num_slots << " slots of "
+                         << d_num_doppler_bins << " x " << d_fft_size
+                         << " samples, acquisition grids not recorded";
+            for (unsigned int i = 0; i < d_num_slots; i++)
+                {
+                    free(d_slots[i].rows);
+                    d_slots[i].rows = 0;
+                }
+        }
+
+    d_writer = boost::thread(&Pcps_Grid_Recorder::run, this);
+
+    DLOG(INFO) << "Grid recorder: " << d_num_slots << " slots of " << d_num_doppler_bins
+               << " x " << d_fft_size << " samples, files " << d_basename << "_ch_*.dat";
+}
+
+
+
+Pcps_Grid_Recorder::~Pcps_Grid_Recorder()
+{
+    d_ready_slots.push(-1);
+    d_writer.join();
+    for (unsigned int i = 0; i < d_num_slots; i++)
+        {
+            delete[] d_slots[i].doppler_hz;
+            delete[] d_slots[i].recorded;
+            free(d_slots[i].rows);
+        }
+    delete[] d_slots;
+    if (d_dropped > 0)
+        {
+            LOG(WARNING) << "Grid recorder: " << d_dropped << " acquisition attempts not recorded";
+        }
+}
+
+
+
+bool Pcps_Grid_Recorder::begin(unsigned int channel, char system, const char* signal,
+        unsigned int prn, unsigned long int sample_stamp)
+{
+    if (!d_enabled)
+        {
+            return false;
+        }
+    if (d_current >= 0)
+        {
+            // The previous attempt was not committed: reuse its slot
+            d_free_slots.push(d_current);
+        }
+    if (!d_free_slots.try_pop(d_current))
+        {
+            d_current = -1;
+            d_dropped++;
+            return false;
+        }
+    Slot& slot = d_slots[d_current];
+    slot.channel = channel;
+    slot.system = system;
+    memcpy(slot.signal, signal, 3);
+    slot.prn = prn;
+    slot.sample_stamp = sample_stamp;
+    slot.attempt = d_attempts++;
+    for (unsigned int i = 0; i < d_num_doppler_bins; i++)
+        {
+            slot.doppler_hz[i] = 0;
+            slot.recorded[i] = false;
+        }
+    return true;
+}
+
+
+
+void Pcps_Grid_Recorder::record(unsigned int doppler_index, int doppler_hz, const gr_complex* correlation)
+{
+    if (d_current < 0)
+        {
+            return;
+        }
+    Slot& slot = d_slots[d_current];
+    slot.doppler_hz[doppler_index] = doppler_hz;
+    slot.recorded[doppler_index] = true;
+    memcpy(slot.rows + (size_t)doppler_index * d_fft_size, correlation, d_fft_size * sizeof(gr_complex));
+}
+
+
+
+void Pcps_Grid_Recorder::commit(float test_statistics, float threshold)
+{
+    if (d_current < 0)
+        {
+            return;
+        }
+    d_slots[d_current].test_statistics = test_statistics;
+    d_slots[d_current].threshold = threshold;
+    d_ready_slots.push(d_current);
+    d_current = -1;
+}
+
+
+
+void Pcps_Grid_Recorder::run()
+{
+    while (true)
+        {
+            int slot = 0;
+            d_ready_slots.wait_and_pop(slot);
+            if (slot < 0)
+                {
+                    // Slots committed before the stop request have been written
+                    return;
+                }
+            write(d_slots[slot]);
+            d_free_slots.push(slot);
+        }
+}
+
+
+
+void Pcps_Grid_Recorder::write(const Slot& slot)
+{
+    std::stringstream filename;
+    filename << d_basename << "_ch_" << slot.channel << "_" << slot.system << "_" << std::string(slot.signal, 2)
+             << "_sat_" << slot.prn << "_" << slot.attempt << ".dat";
+    std::ofstream file(filename.str().c_str(), std::ios::out | std::ios::binary);
+    if (!file.is_open())
+        {
+            LOG(WARNING) << "Grid recorder: cannot open " << filename.str();
+            return;
+        }
+
+    // Header
+    uint32_t fft_size = d_fft_size;
+    uint32_t num_doppler_bins = d_num_doppler_bins;
+    uint64_t sample_stamp = slot.sample_stamp;
+    uint32_t prn = slot.prn;
+    file.write(PCPS_GRID_MAGIC, PCPS_GRID_MAGIC_LENGTH);
+    file.write((char*)&fft_size, sizeof(fft_size));
+    file.write((char*)&num_doppler_bins, sizeof(num_doppler_bins));
+    file.write((char*)&sample_stamp, sizeof(sample_stamp));
+    file.write((char*)&prn, sizeof(prn));
+    file.write(&slot.system, 1);
+    file.write(slot.signal, 3);
+    file.write((char*)&slot.test_statistics, sizeof(float));
+    file.write((char*)&slot.threshold, sizeof(float));
+
+    // Index
+    uint64_t row_bytes = (uint64_t)d_fft_size * sizeof(gr_complex);
+    uint64_t offset = PCPS_GRID_MAGIC_LENGTH + 3 * sizeof(uint32_t) + sizeof(uint64_t) + 4
+            + 2 * sizeof(float) + (uint64_t)d_num_doppler_bins * (2 * sizeof(uint32_t) + sizeof(uint64_t));
+    for (unsigned int i = 0; i < d_num_doppler_bins; i++)
+        {
+            int32_t doppler_hz = slot.doppler_hz[i];
+            uint32_t recorded = slot.recorded[i] ? 1 : 0;
+            uint64_t row_offset = slot.recorded[i] ? offset : 0;
+            file.write((char*)&doppler_hz, sizeof(doppler_hz));
+            file.write((char*)&recorded, sizeof(recorded));
+            file.write((char*)&row_offset, sizeof(row_offset));
+            if (slot.recorded[i])
+                {
+                    offset += row_bytes;
+                }
+        }
+
+    // Rows
+    for (unsigned int i = 0; i < d_num_doppler_bins; i++)
+        {
+            if (slot.recorded[i])
+                {
+                    file.write((char*)(slot.rows + (size_t)i * d_fft_size), row_bytes);
+                }
+        }
+    file.close();
+}
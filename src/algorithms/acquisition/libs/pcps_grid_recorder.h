@@ -0,0 +1,144 @@
+/*!
+ * \file pcps_grid_recorder.h
+ * \brief Capture of the search grids of a Parallel Code Phase Search
+ * acquisition into preallocated memory, written to disk by a background thread
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_PCPS_GRID_RECORDER_H_
+#define GNSS_SDR_PCPS_GRID_RECORDER_H_
+
+#include <string>
+#include <boost/thread/thread.hpp>
+#include <gnuradio/gr_complex.h>
+#include "concurrent_queue.h"
+
+/*!
+ * \brief Records the correlation of every Doppler bin of each acquisition
+ * attempt (dwell) in a ring of preallocated slots, and writes each attempt
+ * to its own file from a background thread.
+ *
+ * The signal processing thread only copies the rows into a free slot. When
+ * no slot is free (the disk cannot keep up), the attempt is not recorded
+ * and counted as dropped, so the acquisition is never blocked.
+ *
+ * Attempt k of a recorder is written to
+ * \<filename\>_ch_\<channel\>_\<system\>_\<signal\>_sat_\<PRN\>_\<k\>.dat,
+ * where \<filename\> is the configured file name without its extension, so
+ * the channels that share a file name do not overwrite each other's files.
+ * File layout (host byte order):
+ *   - Header: "GSDRAG01", uint32 fft_size, uint32 number of Doppler bins,
+ *     uint64 sample stamp, uint32 PRN, char system, char signal[3],
+ *     float test statistics, float threshold.
+ *   - Index, one entry per Doppler bin: int32 Doppler [Hz], uint32 flag
+ *     (1 if the bin was searched), uint64 offset of its row in the file.
+ *   - Rows of the searched bins: fft_size complex float samples of the
+ *     inverse FFT of the bin.
+ */
+class Pcps_Grid_Recorder
+{
+public:
+    /*!
+     * \brief Constructor. Allocates the slots and starts the writer thread.
+     * If the slots cannot be allocated, recording is disabled (see enabled()).
+     * \param filename - Base file name.
+     * \param fft_size - Samples of each row.
+     * \param num_doppler_bins - Rows of each attempt.
+     * \param slots - Number of attempts that can be pending to be written.
+     */
+    Pcps_Grid_Recorder(const std::string& filename, unsigned int fft_size,
+            unsigned int num_doppler_bins, unsigned int slots);
+
+    /*!
+     * \brief Writes the pending attempts and stops the writer thread.
+     */
+    ~Pcps_Grid_Recorder();
+
+    /*!
+     * \brief Starts recording an attempt.
+     * \return false if no slot is free or recording is disabled. The attempt
+     * is then not recorded, and record() and commit() do nothing until the
+     * next begin().
+     */
+    bool begin(unsigned int channel, char system, const char* signal, unsigned int prn,
+            unsigned long int sample_stamp);
+
+    /*!
+     * \brief Copies the correlation of a Doppler bin (fft_size complex samples).
+     */
+    void record(unsigned int doppler_index, int doppler_hz, const gr_complex* correlation);
+
+    /*!
+     * \brief Hands the attempt to the writer thread.
+     */
+    void commit(float test_statistics, float threshold);
+
+    /*!
+     * \brief Number of attempts dropped because no slot was free.
+     */
+    unsigned int dropped() const { return d_dropped; }
+
+    /*!
+     * \brief false if the slots could not be allocated: nothing is recorded.
+     */
+    bool enabled() const { return d_enabled; }
+
+private:
+    struct Slot
+    {
+        unsigned int channel;
+        char system;
+        char signal[3];
+        unsigned int prn;
+        unsigned long int sample_stamp;
+        unsigned int attempt;
+        float test_statistics;
+        float threshold;
+        int* doppler_hz;
+        bool* recorded;
+        gr_complex* rows;
+    };
+
+    void run();
+    void write(const Slot& slot);
+
+    std::string d_basename;
+    unsigned int d_fft_size;
+    unsigned int d_num_doppler_bins;
+    unsigned int d_num_slots;
+    Slot* d_slots;
+    int d_current;
+    unsigned int d_attempts;
+    unsigned int d_dropped;
+    bool d_enabled;
+
+    // Slot indexes. A negative index stops the writer
+    concurrent_queue<int> d_free_slots;
+    concurrent_queue<int> d_ready_slots;
+    boost::thread d_writer;
+};
+
+#endif /* GNSS_SDR_PCPS_GRID_RECORDER_H_ */
@@ -0,0 +1,320 @@
+/*!
+ * \file pcps_hierarchical_doppler_search.cc
+ * \brief Coarse-to-fine Doppler search of a Parallel Code Phase Search
+ * acquisition
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "pcps_hierarchical_doppler_search.h"
+#include <cstdlib>
+#include <new>
+#include <glog/logging.h>
+
+using google::LogMessage;
+
+namespace
+{
+/*
+ * Exposes a window of the regular grid, starting at bin offset, as a
+ * spectrum source whose first bin is 0.
+ */
+class Window_Spectrum_Source : public Pcps_Spectrum_Source
+{
+public:
+    Window_Spectrum_Source(const Pcps_Spectrum_Source* grid, unsigned int offset) :
+        d_grid(grid), d_offset(offset) {}
+    void multiply(gr_complex* out, unsigned int doppler_index, const gr_complex* fft_codes) const
+    {
+        d_grid->multiply(out, d_offset + doppler_index, fft_codes);
+    }
+private:
+    const Pcps_Spectrum_Source* d_grid;
+    unsigned int d_offset;
+};
+
+/*
+ * Same for the wipe-offs of the regular grid.
+ */
+class Window_Wipeoff_Source : public Pcps_Wipeoff_Source
+{
+public:
+    Window_Wipeoff_Source(const Pcps_Wipeoff_Source* grid, unsigned int offset) :
+        d_grid(grid), d_offset(offset) {}
+    void wipeoff(gr_complex* out, const gr_complex* in, unsigned int doppler_index) const
+    {
+        d_grid->wipeoff(out, in, d_offset + doppler_index);
+    }
+private:
+    const Pcps_Wipeoff_Source* d_grid;
+    unsigned int d_offset;
+};
+
+unsigned int count_bins(unsigned int doppler_max, unsigned int doppler_step)
+{
+    unsigned int bins = 0;
+    for (int doppler = (int)(-doppler_max); doppler <= (int)doppler_max; doppler += doppler_step)
+        {
+            bins++;
+        }
+    return bins;
+}
+}
+
+
+
+bool Pcps_Hierarchical_Doppler_Search::supported(unsigned int fft_size,
+        unsigned int samples_per_code, unsigned int doppler_max,
+        unsigned int doppler_step, unsigned int coarse_doppler_step,
+        unsigned int num_candidates)
+{
+    if (doppler_step == 0 || coarse_doppler_step <= doppler_step)
+        {
+            return false;
+        }
+    // With a single code period, the coarse pass integrates the whole dwell
+    if (samples_per_code == 0 || fft_size % samples_per_code != 0 || fft_size < 2 * samples_per_code)
+        {
+            return false;
+        }
+    unsigned int num_doppler_bins = count_bins(doppler_max, doppler_step);
+    unsigned int window_length = coarse_doppler_step / doppler_step + 1;
+    if (window_length >= num_doppler_bins)
+        {
+            return false;
+        }
+    // Samples correlated by both passes and by the regular grid
+    unsigned int num_coarse_bins = count_bins(doppler_max, coarse_doppler_step);
+    if (num_candidates == 0)
+        {
+            num_candidates = 1;
+        }
+    if (num_candidates > num_coarse_bins)
+        {
+            num_candidates = num_coarse_bins;
+        }
+    unsigned long int fine_bins = (unsigned long int)num_candidates * window_length;
+    if (fine_bins > num_doppler_bins)
+        {
+            fine_bins = num_doppler_bins;
+        }
+    unsigned long int hierarchical_samples = (unsigned long int)num_coarse_bins * samples_per_code + fine_bins * fft_size;
+    return hierarchical_samples < (unsigned long int)num_doppler_bins * fft_size;
+}
+
+
+
+Pcps_Hierarchical_Doppler_Search::Pcps_Hierarchical_Doppler_Search(long freq,
+        long fs_in, unsigned int fft_size, unsigned int samples_per_code,
+        unsigned int doppler_max, unsigned int doppler_step,
+        unsigned int coarse_doppler_step, unsigned int num_candidates,
+        unsigned int batch_size)
+{
+    d_fft_size = fft_size;
+    d_coarse_size = samples_per_code;
+    d_doppler_step = doppler_step;
+    d_coarse_doppler_step = coarse_doppler_step;
+    d_num_doppler_bins = count_bins(doppler_max, doppler_step);
+    d_num_coarse_bins = count_bins(doppler_max, coarse_doppler_step);
+    d_num_candidates = num_candidates;
+    if (d_num_candidates == 0)
+        {
+            d_num_candidates = 1;
+        }
+    if (d_num_candidates > d_num_coarse_bins)
+        {
+            d_num_candidates = d_num_coarse_bins;
+        }
+
+    // Bins of the regular grid within half a coarse step of a candidate
+    d_window_length = d_coarse_doppler_step / d_doppler_step + 1;
+    if (d_window_length > d_num_doppler_bins)
+        {
+            d_window_length = d_num_doppler_bins;
+        }
+
+    // Carrier Doppler wipeoff signals of the coarse grid, shared by the channels
+    d_coarse_wipeoffs = Pcps_Wipeoff_Registry::instance()->table(freq, fs_in, d_coarse_size,
+            doppler_max, d_coarse_doppler_step, 32);
+    if (posix_memalign((void**)&d_coarse_fft_codes, 16, d_coarse_size * sizeof(gr_complex)) != 0)
+        {
+            LOG(ERROR) << "Hierarchical Doppler search: cannot allocate the coarse code spectrum of "
+                       << d_coarse_size << " samples";
+            throw std::bad_alloc();
+        }
+    for (unsigned int i = 0; i < d_coarse_size; i++)
+        {
+            d_coarse_fft_codes[i] = gr_complex(0.0, 0.0);
+        }
+
+    d_coarse_engine = 0;
+    try
+    {
+            d_coarse_engine = new Pcps_Doppler_Batch_Engine(d_coarse_size, d_num_coarse_bins, batch_size);
+            // The fine windows are transformed in a single batch
+            d_fine_engine = new Pcps_Doppler_Batch_Engine(d_fft_size, d_window_length, d_window_length);
+    }
+    catch (const std::bad_alloc&)
+    {
+            delete d_coarse_engine;
+            free(d_coarse_fft_codes);
+            throw;
+    }
+
+    d_coarse_magnitude.resize(d_num_coarse_bins, 0.0);
+    d_requested.resize(d_num_doppler_bins, false);
+    d_evaluated.resize(d_num_doppler_bins, false);
+    d_peak_index.resize(d_num_doppler_bins, 0);
+    d_peak_magnitude.resize(d_num_doppler_bins, 0.0);
+
+    DLOG(INFO) << "Hierarchical Doppler search: " << d_num_coarse_bins << " coarse bins of "
+               << d_coarse_size << " samples, " << d_num_candidates << " candidates, "
+               << d_window_length << " fine bins per candidate, " << d_num_doppler_bins
+               << " bins in the regular grid";
+}
+
+
+
+Pcps_Hierarchical_Doppler_Search::~Pcps_Hierarchical_Doppler_Search()
+{
+    free(d_coarse_fft_codes);
+    delete d_coarse_engine;
+    delete d_fine_engine;
+}
+
+
+
+void Pcps_Hierarchical_Doppler_Search::set_local_code_spectrum(const gr_complex* fft_codes)
+{
+    // The dwell holds M repetitions of the code period, so its spectrum is
+    // zero except at the multiples of M, where it is M times the spectrum of
+    // a single period. The scale factor does not change the candidate ranking.
+    unsigned int decimation = d_fft_size / d_coarse_size;
+    for (unsigned int i = 0; i < d_coarse_size; i++)
+        {
+            d_coarse_fft_codes[i] = fft_codes[i * decimation];
+        }
+}
+
+
+
+void Pcps_Hierarchical_Doppler_Search::search(const gr_complex* in,
+        const Pcps_Wipeoff_Source* wipeoffs, const Pcps_Spectrum_Source* spectra,
+        const gr_complex* fft_codes)
+{
+    coarse_pass(in);
+    fine_pass(in, wipeoffs, spectra, fft_codes);
+}
+
+
+
+void Pcps_Hierarchical_Doppler_Search::coarse_pass(const gr_complex* in)
+{
+    // Short coherent integration: the first code period of the dwell
+    for (unsigned int batch = 0; batch < d_coarse_engine->num_batches(); batch++)
+        {
+            d_coarse_engine->forward(batch, in, d_coarse_wipeoffs.get());
+            d_coarse_engine->correlate(d_coarse_fft_codes);
+            for (unsigned int row = 0; row < d_coarse_engine->batch_length(batch); row++)
+                {
+                    d_coarse_magnitude[d_coarse_engine->first_bin(batch) + row] = d_coarse_engine->peak_magnitude(row);
+                }
+        }
+
+    // Select the best candidates (lowest bin first on ties) and request the
+    // bins of the regular grid around them
+    for (unsigned int i = 0; i < d_num_doppler_bins; i++)
+        {
+            d_requested[i] = false;
+            d_evaluated[i] = false;
+        }
+    std::vector<bool> selected(d_num_coarse_bins, false);
+    for (unsigned int candidate = 0; candidate < d_num_candidates; candidate++)
+        {
+            unsigned int best = d_num_coarse_bins;
+            for (unsigned int coarse_index = 0; coarse_index < d_num_coarse_bins; coarse_index++)
+                {
+                    if (!selected[coarse_index] && (best == d_num_coarse_bins
+                            || d_coarse_magnitude[coarse_index] > d_coarse_magnitude[best]))
+                        {
+                            best = coarse_index;
+                        }
+                }
+            selected[best] = true;
+
+            // Offsets from -doppler_max [Hz]
+            int center = d_coarse_doppler_step * best;
+            int first = center - (int)d_coarse_doppler_step / 2;
+            int last = center + (int)d_coarse_doppler_step / 2;
+            int first_bin = first <= 0 ? 0 : (first + (int)d_doppler_step - 1) / (int)d_doppler_step;
+            int last_bin = last / (int)d_doppler_step;
+            for (int i = first_bin; i <= last_bin && i < (int)d_num_doppler_bins; i++)
+                {
+                    d_requested[i] = true;
+                }
+        }
+}
+
+
+
+void Pcps_Hierarchical_Doppler_Search::fine_pass(const gr_complex* in,
+        const Pcps_Wipeoff_Source* wipeoffs, const Pcps_Spectrum_Source* spectra,
+        const gr_complex* fft_codes)
+{
+    // Full coherent integration over windows of the regular grid covering
+    // the requested bins. Windows are kept inside the grid, so a window may
+    // also evaluate some neighbouring bins that were not requested.
+    for (unsigned int i = 0; i < d_num_doppler_bins; i++)
+        {
+            if (!d_requested[i] || d_evaluated[i])
+                {
+                    continue;
+                }
+            unsigned int first = i;
+            if (first + d_window_length > d_num_doppler_bins)
+                {
+                    first = d_num_doppler_bins - d_window_length;
+                }
+
+            if (spectra != 0)
+                {
+                    Window_Spectrum_Source window(spectra, first);
+                    d_fine_engine->correlate(0, &window, fft_codes);
+                }
+            else
+                {
+                    Window_Wipeoff_Source window(wipeoffs, first);
+                    d_fine_engine->forward(0, in, &window);
+                    d_fine_engine->correlate(fft_codes);
+                }
+
+            for (unsigned int row = 0; row < d_window_length; row++)
+                {
+                    d_evaluated[first + row] = true;
+                    d_peak_index[first + row] = d_fine_engine->peak_index(row);
+                    d_peak_magnitude[first + row] = d_fine_engine->peak_magnitude(row);
+                }
+        }
+}
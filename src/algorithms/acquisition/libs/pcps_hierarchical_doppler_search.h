@@ -0,0 +1,149 @@
+/*!
+ * \file pcps_hierarchical_doppler_search.h
+ * \brief Coarse-to-fine Doppler search of a Parallel Code Phase Search
+ * acquisition
+ *
+ * The coarse pass correlates a single code period of the dwell (short
+ * coherent integration) over a grid of wide Doppler bins. The fine pass
+ * correlates the whole dwell only over the bins of the regular grid that lie
+ * within half a coarse step of the best coarse candidates. The cost is then
+ * driven by the number of candidates instead of the resolution of the
+ * regular grid.
+ *
+ * The local code of the dwell is a repetition of whole code periods, so the
+ * spectrum of a single period is obtained by decimation of the spectrum of
+ * the dwell, and no additional code FFT is needed.
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_PCPS_HIERARCHICAL_DOPPLER_SEARCH_H_
+#define GNSS_SDR_PCPS_HIERARCHICAL_DOPPLER_SEARCH_H_
+
+#include <vector>
+#include <gnuradio/gr_complex.h>
+#include "pcps_doppler_batch_engine.h"
+#include "pcps_spectrum_source.h"
+#include "pcps_wipeoff_source.h"
+#include "pcps_wipeoff_registry.h"
+
+/*!
+ * \brief Coarse-to-fine Doppler search over the regular grid
+ * [-doppler_max, doppler_max] with step doppler_step.
+ *
+ * After search(), only the bins reported by evaluated() hold a peak; the
+ * caller reduces them in Doppler order as in the full search.
+ */
+class Pcps_Hierarchical_Doppler_Search
+{
+public:
+    /*!
+     * \brief Tells if the coarse-to-fine search can be applied and shortens
+     * the search: the dwell must hold a whole number of code periods, and at
+     * least two, since the coarse pass correlates a single one. The samples
+     * correlated by both passes must be fewer than with the regular grid.
+     */
+    static bool supported(unsigned int fft_size, unsigned int samples_per_code,
+            unsigned int doppler_max, unsigned int doppler_step,
+            unsigned int coarse_doppler_step, unsigned int num_candidates);
+
+    /*!
+     * \brief Constructor. Builds the coarse wipe-offs and plans the FFTs of
+     * both passes.
+     * \param freq - Intermediate frequency [Hz].
+     * \param fs_in - Sampling frequency [Hz].
+     * \param fft_size - Samples of the dwell.
+     * \param samples_per_code - Samples of a code period (coarse FFT size).
+     * \param doppler_max - Half width of the Doppler search [Hz].
+     * \param doppler_step - Step of the regular (fine) grid [Hz].
+     * \param coarse_doppler_step - Step of the coarse grid [Hz].
+     * \param num_candidates - Number of coarse candidates refined.
+     * \param batch_size - Maximum number of coarse bins transformed at once.
+     * Throws std::bad_alloc if the buffers cannot be allocated.
+     */
+    Pcps_Hierarchical_Doppler_Search(long freq, long fs_in, unsigned int fft_size,
+            unsigned int samples_per_code, unsigned int doppler_max,
+            unsigned int doppler_step, unsigned int coarse_doppler_step,
+            unsigned int num_candidates, unsigned int batch_size);
+    ~Pcps_Hierarchical_Doppler_Search();
+
+    unsigned int num_coarse_bins() const { return d_num_coarse_bins; }
+    unsigned int window_length() const { return d_window_length; }
+
+    /*!
+     * \brief Derives the coarse code spectrum from the conjugated spectrum of
+     * the local code of the dwell. Must be called each time it changes.
+     */
+    void set_local_code_spectrum(const gr_complex* fft_codes);
+
+    /*!
+     * \brief Runs both passes on a dwell.
+     * \param in - Input samples.
+     * \param wipeoffs - Wipe-offs of the regular grid. Only used if \p spectra is 0.
+     * \param spectra - Precomputed input spectra of the regular grid, or 0.
+     * \param fft_codes - Conjugated local code spectrum of the dwell.
+     */
+    void search(const gr_complex* in, const Pcps_Wipeoff_Source* wipeoffs,
+            const Pcps_Spectrum_Source* spectra, const gr_complex* fft_codes);
+
+    /*!
+     * \brief Tells if a bin of the regular grid was correlated in the last search.
+     */
+    bool evaluated(unsigned int doppler_index) const { return d_evaluated[doppler_index]; }
+
+    unsigned int peak_index(unsigned int doppler_index) const { return d_peak_index[doppler_index]; }
+
+    /*!
+     * \brief Squared magnitude (not normalized) of the peak of an evaluated bin.
+     */
+    float peak_magnitude(unsigned int doppler_index) const { return d_peak_magnitude[doppler_index]; }
+
+private:
+    void coarse_pass(const gr_complex* in);
+    void fine_pass(const gr_complex* in, const Pcps_Wipeoff_Source* wipeoffs,
+            const Pcps_Spectrum_Source* spectra, const gr_complex* fft_codes);
+
+    unsigned int d_fft_size;
+    unsigned int d_coarse_size;
+    unsigned int d_doppler_step;
+    unsigned int d_coarse_doppler_step;
+    unsigned int d_num_doppler_bins;
+    unsigned int d_num_coarse_bins;
+    unsigned int d_num_candidates;
+    unsigned int d_window_length;
+
+    pcps_wipeoff_table_sptr d_coarse_wipeoffs;
+    gr_complex* d_coarse_fft_codes;
+    Pcps_Doppler_Batch_Engine* d_coarse_engine;
+    Pcps_Doppler_Batch_Engine* d_fine_engine;
+
+    std::vector<float> d_coarse_magnitude;
+    std::vector<bool> d_requested;
+    std::vector<bool> d_evaluated;
+    std::vector<unsigned int> d_peak_index;
+    std::vector<float> d_peak_magnitude;
+};
+
+#endif /* GNSS_SDR_PCPS_HIERARCHICAL_DOPPLER_SEARCH_H_ */
@@ -0,0 +1,106 @@
+/*!
+ * \file pcps_noncoherent_grid.cc
+ * \brief Arena holding the whole magnitude grid (Doppler bins x code phases)
+ * of a Parallel Code Phase Search acquisition, for non-coherent integration
+ * across dwells
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "pcps_noncoherent_grid.h"
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <glog/logging.h>
+#include <volk/volk.h>
+
+using google::LogMessage;
+
+// Rows start on 64-byte boundaries
+#define PCPS_GRID_ROW_ALIGNMENT 16
+
+Pcps_Noncoherent_Grid::Pcps_Noncoherent_Grid(unsigned int num_doppler_bins,
+        unsigned int fft_size)
+{
+    d_num_doppler_bins = num_doppler_bins;
+    d_fft_size = fft_size;
+    d_row_stride = ((d_fft_size + PCPS_GRID_ROW_ALIGNMENT - 1) / PCPS_GRID_ROW_ALIGNMENT) * PCPS_GRID_ROW_ALIGNMENT;
+    d_num_dwells = 0;
+
+    if (posix_memalign((void**)&d_grid, 64, (size_t)d_num_doppler_bins * d_row_stride * sizeof(float)) != 0) d_grid = 0;
+    if (posix_memalign((void**)&d_scratch, 64, d_row_stride * sizeof(float)) != 0) d_scratch = 0;
+    if (d_grid == 0 || d_scratch == 0)
+        {
+            LOG(ERROR) << "Non-coherent grid: cannot allocate " << d_num_doppler_bins
+                       << " Doppler bins x " << d_fft_size << " samples";
+            free(d_grid);
+            free(d_scratch);
+            throw std::bad_alloc();
+        }
+    reset();
+
+    DLOG(INFO) << "Non-coherent grid: " << d_num_doppler_bins << " Doppler bins x "
+               << d_fft_size << " samples";
+}
+
+
+
+Pcps_Noncoherent_Grid::~Pcps_Noncoherent_Grid()
+{
+    free(d_grid);
+    free(d_scratch);
+}
+
+
+
+void Pcps_Noncoherent_Grid::reset()
+{
+    memset(d_grid, 0, (size_t)d_num_doppler_bins * d_row_stride * sizeof(float));
+    d_num_dwells = 0;
+}
+
+
+
+void Pcps_Noncoherent_Grid::accumulate(unsigned int doppler_index, const float* magnitude)
+{
+    volk_32f_x2_add_32f_a(row(doppler_index), row(doppler_index), magnitude, d_fft_size);
+}
+
+
+
+void Pcps_Noncoherent_Grid::accumulate_max(unsigned int doppler_index,
+        const float* magnitude_a, const float* magnitude_b)
+{
+    volk_32f_x2_max_32f_a(d_scratch, magnitude_a, magnitude_b, d_fft_size);
+    volk_32f_x2_add_32f_a(row(doppler_index), row(doppler_index), d_scratch, d_fft_size);
+}
+
+
+
+float Pcps_Noncoherent_Grid::peak(unsigned int doppler_index, unsigned int* index)
+{
+    volk_32f_index_max_16u_a(index, row(doppler_index), d_fft_size);
+    return row(doppler_index)[*index];
+}
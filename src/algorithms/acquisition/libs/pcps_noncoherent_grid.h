@@ -0,0 +1,102 @@
+/*!
+ * \file pcps_noncoherent_grid.h
+ * \brief Arena holding the whole magnitude grid (Doppler bins x code phases)
+ * of a Parallel Code Phase Search acquisition, for non-coherent integration
+ * across dwells
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_PCPS_NONCOHERENT_GRID_H_
+#define GNSS_SDR_PCPS_NONCOHERENT_GRID_H_
+
+/*!
+ * \brief Pre-allocated grid of accumulated squared magnitudes.
+ *
+ * All the rows live in a single aligned allocation made at construction,
+ * so no memory is allocated while dwelling. Each dwell adds the squared
+ * magnitude of the correlation of every Doppler bin to its row.
+ */
+class Pcps_Noncoherent_Grid
+{
+public:
+    /*!
+     * \brief Constructor. Throws std::bad_alloc if the grid cannot be allocated.
+     */
+    Pcps_Noncoherent_Grid(unsigned int num_doppler_bins, unsigned int fft_size);
+    ~Pcps_Noncoherent_Grid();
+
+    unsigned int num_doppler_bins() const { return d_num_doppler_bins; }
+    unsigned int fft_size() const { return d_fft_size; }
+
+    /*!
+     * \brief Number of dwells accumulated since the last reset().
+     */
+    unsigned int num_dwells() const { return d_num_dwells; }
+
+    /*!
+     * \brief Clears the grid, e.g. when a new acquisition starts.
+     */
+    void reset();
+
+    /*!
+     * \brief Adds the squared magnitude of a correlation to a Doppler bin.
+     */
+    void accumulate(unsigned int doppler_index, const float* magnitude);
+
+    /*!
+     * \brief Adds, sample by sample, the greater of the squared magnitudes of
+     * two correlation hypotheses (e.g. secondary code signs) to a Doppler bin.
+     */
+    void accumulate_max(unsigned int doppler_index, const float* magnitude_a,
+            const float* magnitude_b);
+
+    /*!
+     * \brief Marks the end of a dwell.
+     */
+    void end_dwell() { d_num_dwells++; }
+
+    /*!
+     * \brief Accumulated squared magnitudes of a Doppler bin (fft_size values).
+     */
+    float* row(unsigned int doppler_index) { return d_grid + doppler_index * d_row_stride; }
+
+    /*!
+     * \brief Maximum of the accumulated squared magnitudes of a Doppler bin.
+     * \param doppler_index - Doppler bin.
+     * \param index - Sample index of the maximum.
+     */
+    float peak(unsigned int doppler_index, unsigned int* index);
+
+private:
+    unsigned int d_num_doppler_bins;
+    unsigned int d_fft_size;
+    unsigned int d_row_stride;
+    unsigned int d_num_dwells;
+    float* d_grid;
+    float* d_scratch;
+};
+
+#endif /* GNSS_SDR_PCPS_NONCOHERENT_GRID_H_ */
@@ -0,0 +1,241 @@
+/*!
+ * \file pcps_parallel_doppler_search.cc
+ * \brief Doppler search of a Parallel Code Phase Search acquisition split
+ * across a pool of worker threads
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "pcps_parallel_doppler_search.h"
+#include <boost/bind.hpp>
+#include <glog/logging.h>
+
+using google::LogMessage;
+
+Pcps_Doppler_Worker_Pool* Pcps_Doppler_Worker_Pool::instance()
+{
+    // Never destroyed, so that no block can outlive it
+    static Pcps_Doppler_Worker_Pool* pool = new Pcps_Doppler_Worker_Pool();
+    return pool;
+}
+
+
+
+void Pcps_Doppler_Worker_Pool::reserve(unsigned int num_threads)
+{
+    // The calling threads of the searches use a processor too
+    unsigned int processors = boost::thread::hardware_concurrency();
+    if (processors > 1 && num_threads > processors - 1)
+        {
+            num_threads = processors - 1;
+        }
+
+    boost::mutex::scoped_lock lock(d_mutex);
+    while (d_num_threads < num_threads)
+        {
+            d_threads.create_thread(boost::bind(&Pcps_Doppler_Worker_Pool::run, this));
+            d_num_threads++;
+        }
+}
+
+
+
+unsigned int Pcps_Doppler_Worker_Pool::num_threads()
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+    return d_num_threads;
+}
+
+
+
+void Pcps_Doppler_Worker_Pool::submit(Pcps_Parallel_Doppler_Search* search, unsigned int worker)
+{
+    {
+        boost::mutex::scoped_lock lock(d_mutex);
+        d_jobs.push_back(std::make_pair(search, worker));
+    }
+    d_job_ready.notify_one();
+}
+
+
+
+bool Pcps_Doppler_Worker_Pool::take(Pcps_Parallel_Doppler_Search* search, unsigned int& worker)
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+    for (std::deque<std::pair<Pcps_Parallel_Doppler_Search*, unsigned int> >::iterator it = d_jobs.begin();
+         it != d_jobs.end(); ++it)
+        {
+            if (it->first == search)
+                {
+                    worker = it->second;
+                    d_jobs.erase(it);
+                    return true;
+                }
+        }
+    return false;
+}
+
+
+
+void Pcps_Doppler_Worker_Pool::run()
+{
+    while (true)
+        {
+            std::pair<Pcps_Parallel_Doppler_Search*, unsigned int> job;
+            {
+                boost::mutex::scoped_lock lock(d_mutex);
+                while (d_jobs.empty())
+                    {
+                        d_job_ready.wait(lock);
+                    }
+                job = d_jobs.front();
+                d_jobs.pop_front();
+            }
+            job.first->process(job.second);
+            job.first->finished();
+        }
+}
+
+
+
+Pcps_Parallel_Doppler_Search::Pcps_Parallel_Doppler_Search(unsigned int num_workers,
+        unsigned int fft_size, unsigned int num_doppler_bins, unsigned int batch_size)
+{
+    d_in = 0;
+    d_wipeoffs = 0;
+    d_spectra = 0;
+    d_fft_codes = 0;
+    d_pending = 0;
+
+    // Each engine plans its own FFTs (under the GNU Radio planner lock)
+    d_engines.push_back(new Pcps_Doppler_Batch_Engine(fft_size, num_doppler_bins, batch_size));
+
+    // No more workers than batches
+    d_num_workers = num_workers;
+    if (d_num_workers == 0)
+        {
+            d_num_workers = 1;
+        }
+    if (d_num_workers > d_engines[0]->num_batches())
+        {
+            d_num_workers = d_engines[0]->num_batches();
+        }
+
+    for (unsigned int worker = 1; worker < d_num_workers; worker++)
+        {
+            d_engines.push_back(new Pcps_Doppler_Batch_Engine(fft_size, num_doppler_bins, batch_size));
+        }
+
+    d_peak_index.resize(num_doppler_bins, 0);
+    d_peak_magnitude.resize(num_doppler_bins, 0.0);
+
+    Pcps_Doppler_Worker_Pool::instance()->reserve(d_num_workers - 1);
+
+    DLOG(INFO) << "Parallel Doppler search: " << d_num_workers << " workers, "
+               << d_engines[0]->num_batches() << " batches, "
+               << Pcps_Doppler_Worker_Pool::instance()->num_threads() << " threads in the shared pool";
+}
+
+
+
+Pcps_Parallel_Doppler_Search::~Pcps_Parallel_Doppler_Search()
+{
+    // search() returns when all its jobs are done: none is left in the pool
+    for (unsigned int worker = 0; worker < d_engines.size(); worker++)
+        {
+            delete d_engines[worker];
+        }
+}
+
+
+
+void Pcps_Parallel_Doppler_Search::search(const gr_complex* in, const Pcps_Wipeoff_Source* wipeoffs,
+        const Pcps_Spectrum_Source* spectra, const gr_complex* fft_codes)
+{
+    d_in = in;
+    d_wipeoffs = wipeoffs;
+    d_spectra = spectra;
+    d_fft_codes = fft_codes;
+    {
+        boost::mutex::scoped_lock lock(d_mutex);
+        d_pending = d_num_workers - 1;
+    }
+    Pcps_Doppler_Worker_Pool* pool = Pcps_Doppler_Worker_Pool::instance();
+    for (unsigned int worker = 1; worker < d_num_workers; worker++)
+        {
+            pool->submit(this, worker);
+        }
+
+    // The calling thread is worker 0, and runs the jobs that the pool has
+    // not started yet (e.g. while it serves other channels)
+    process(0);
+    unsigned int worker;
+    while (pool->take(this, worker))
+        {
+            process(worker);
+            finished();
+        }
+
+    boost::mutex::scoped_lock lock(d_mutex);
+    while (d_pending > 0)
+        {
+            d_job_done.wait(lock);
+        }
+}
+
+
+
+void Pcps_Parallel_Doppler_Search::finished()
+{
+    // Notified under the lock: the search may be destroyed as soon as it is released
+    boost::mutex::scoped_lock lock(d_mutex);
+    d_pending--;
+    d_job_done.notify_one();
+}
+
+void Pcps_Parallel_Doppler_Search::process(unsigned int worker)
+{
+    Pcps_Doppler_Batch_Engine* engine = d_engines[worker];
+
+    for (unsigned int batch = worker; batch < engine->num_batches(); batch += d_num_workers)
+        {
+            if (d_spectra != 0)
+                {
+                    engine->correlate(batch, d_spectra, d_fft_codes);
+                }
+            else
+                {
+                    engine->forward(batch, d_in, d_wipeoffs);
+                    engine->correlate(d_fft_codes);
+                }
+
+            // Each Doppler bin is written by exactly one worker
+            for (unsigned int row = 0; row < engine->batch_length(batch); row++)
+                {
+                    d_peak_index[engine->first_bin(batch) + row] = engine->peak_index(row);
+                    d_peak_magnitude[engine->first_bin(batch) + row] = engine->peak_magnitude(row);
+                }
+        }
+}
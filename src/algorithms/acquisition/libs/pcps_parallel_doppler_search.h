@@ -0,0 +1,166 @@
+/*!
+ * \file pcps_parallel_doppler_search.h
+ * \brief Doppler search of a Parallel Code Phase Search acquisition split
+ * across a pool of worker threads
+ *
+ * The batches of Doppler bins of the search grid are distributed among the
+ * workers in an interleaved way (batch b is processed by worker b mod W).
+ * Each worker owns a Pcps_Doppler_Batch_Engine, that is, its own FFT plans
+ * and buffers, and stores the peak of every Doppler bin it processes. The
+ * calling thread acts as worker 0. Once all the workers are done, the caller
+ * reduces the per-bin peaks in Doppler order, so the result does not depend
+ * on the scheduling of the threads.
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_PCPS_PARALLEL_DOPPLER_SEARCH_H_
+#define GNSS_SDR_PCPS_PARALLEL_DOPPLER_SEARCH_H_
+
+#include <deque>
+#include <utility>
+#include <vector>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <gnuradio/gr_complex.h>
+#include "pcps_doppler_batch_engine.h"
+#include "pcps_spectrum_source.h"
+#include "pcps_wipeoff_source.h"
+
+class Pcps_Parallel_Doppler_Search;
+
+/*!
+ * \brief Worker threads shared by the Doppler searches of all the PCPS
+ * acquisition blocks.
+ *
+ * The pool holds the largest number of threads requested by a search (one
+ * less than its workers), capped by the number of processors, whatever the
+ * number of channels. The jobs of the searches are queued and run in order.
+ */
+class Pcps_Doppler_Worker_Pool
+{
+public:
+    /*!
+     * \brief Returns the pool shared by all the acquisition blocks.
+     */
+    static Pcps_Doppler_Worker_Pool* instance();
+
+    /*!
+     * \brief Starts threads until the pool holds num_threads of them (or
+     * one less than the number of processors).
+     */
+    void reserve(unsigned int num_threads);
+
+    unsigned int num_threads();
+
+    /*!
+     * \brief Queues the part of a search done by one of its workers.
+     */
+    void submit(Pcps_Parallel_Doppler_Search* search, unsigned int worker);
+
+    /*!
+     * \brief Removes a queued job of a search, so that the thread of the
+     * search runs it instead of waiting. Returns false if there is none.
+     */
+    bool take(Pcps_Parallel_Doppler_Search* search, unsigned int& worker);
+
+private:
+    Pcps_Doppler_Worker_Pool() : d_num_threads(0) {}
+    void run();
+
+    std::deque<std::pair<Pcps_Parallel_Doppler_Search*, unsigned int> > d_jobs;
+    boost::thread_group d_threads;
+    unsigned int d_num_threads;
+    boost::mutex d_mutex;
+    boost::condition_variable d_job_ready;
+};
+
+/*!
+ * \brief Doppler search of a PCPS acquisition block split across workers.
+ *
+ * Each worker owns a batch engine and processes every num_workers-th batch.
+ * The calling thread is worker 0; the other workers are jobs of the shared
+ * Pcps_Doppler_Worker_Pool.
+ */
+class Pcps_Parallel_Doppler_Search
+{
+public:
+    /*!
+     * \brief Constructor. Plans the FFTs of every worker and reserves the threads of the pool.
+     * \param num_workers - Number of workers, including the calling thread.
+     * \param fft_size - Number of samples of each FFT.
+     * \param num_doppler_bins - Number of Doppler bins of the search grid.
+     * \param batch_size - Maximum number of Doppler bins transformed at once.
+     */
+    Pcps_Parallel_Doppler_Search(unsigned int num_workers, unsigned int fft_size,
+            unsigned int num_doppler_bins, unsigned int batch_size);
+    ~Pcps_Parallel_Doppler_Search();
+
+    unsigned int num_workers() const { return d_num_workers; }
+
+    /*!
+     * \brief Searches the correlation peak of every Doppler bin.
+     * \param in - Input samples. Only used if \p spectra is 0.
+     * \param wipeoffs - Doppler wipe-offs of the grid. Only used if \p spectra is 0.
+     * \param spectra - Precomputed input spectra, or 0.
+     * \param fft_codes - Conjugated local code spectrum.
+     */
+    void search(const gr_complex* in, const Pcps_Wipeoff_Source* wipeoffs,
+            const Pcps_Spectrum_Source* spectra, const gr_complex* fft_codes);
+
+    /*!
+     * \brief Sample index of the correlation peak of a Doppler bin in the last search.
+     */
+    unsigned int peak_index(unsigned int doppler_index) const { return d_peak_index[doppler_index]; }
+
+    /*!
+     * \brief Squared magnitude (not normalized) of the correlation peak of a
+     * Doppler bin in the last search.
+     */
+    float peak_magnitude(unsigned int doppler_index) const { return d_peak_magnitude[doppler_index]; }
+
+private:
+    friend class Pcps_Doppler_Worker_Pool;
+    void process(unsigned int worker);
+    void finished();
+
+    unsigned int d_num_workers;
+    std::vector<Pcps_Doppler_Batch_Engine*> d_engines;
+    std::vector<unsigned int> d_peak_index;
+    std::vector<float> d_peak_magnitude;
+
+    // current job
+    const gr_complex* d_in;
+    const Pcps_Wipeoff_Source* d_wipeoffs;
+    const Pcps_Spectrum_Source* d_spectra;
+    const gr_complex* d_fft_codes;
+
+    boost::mutex d_mutex;
+    boost::condition_variable d_job_done;
+    unsigned int d_pending;
+};
+
+#endif /* GNSS_SDR_PCPS_PARALLEL_DOPPLER_SEARCH_H_ */
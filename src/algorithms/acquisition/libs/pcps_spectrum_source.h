@@ -0,0 +1,57 @@
+/*!
+ * \file pcps_spectrum_source.h
+ * \brief Interface of the providers of carrier wiped-off input spectra for
+ * Parallel Code Phase Search acquisition
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_PCPS_SPECTRUM_SOURCE_H_
+#define GNSS_SDR_PCPS_SPECTRUM_SOURCE_H_
+
+#include <gnuradio/gr_complex.h>
+
+/*!
+ * \brief This abstract class represents a set of input spectra, already
+ * wiped-off and Fourier transformed for every Doppler bin of a search grid,
+ * that can be correlated with a local code spectrum.
+ */
+class Pcps_Spectrum_Source
+{
+public:
+    virtual ~Pcps_Spectrum_Source() {}
+
+    /*!
+     * \brief Multiplies the input spectrum of a Doppler bin by the
+     * conjugated local code spectrum.
+     * \param out - Output vector (fft_size complex samples, aligned).
+     * \param doppler_index - Doppler bin.
+     * \param fft_codes - Conjugated local code spectrum (aligned).
+     */
+    virtual void multiply(gr_complex* out, unsigned int doppler_index,
+            const gr_complex* fft_codes) const = 0;
+};
+
+#endif /* GNSS_SDR_PCPS_SPECTRUM_SOURCE_H_ */
@@ -0,0 +1,55 @@
+/*!
+ * \file pcps_wipeoff_nco.cc
+ * \brief Carrier Doppler wipe-offs of a search grid generated on the fly
+ * by a numerically controlled oscillator
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "pcps_wipeoff_nco.h"
+#include <cmath>
+#include <volk/volk.h>
+#include "GPS_L1_CA.h"
+
+Pcps_Wipeoff_Nco::Pcps_Wipeoff_Nco(long freq, long fs_in, unsigned int fft_size,
+        unsigned int doppler_max, unsigned int doppler_step)
+{
+    d_fft_size = fft_size;
+    for (int doppler = (int)(-doppler_max); doppler <= (int)doppler_max; doppler += doppler_step)
+        {
+            // Same sign as complex_exp_gen_conj()
+            double phase_step = GPS_TWO_PI * (double)(freq + doppler) / (double)fs_in;
+            d_phase_increments.push_back(gr_complex(cos(phase_step), -sin(phase_step)));
+        }
+}
+
+
+
+void Pcps_Wipeoff_Nco::wipeoff(gr_complex* out, const gr_complex* in, unsigned int doppler_index) const
+{
+    // The phase is local, so concurrent calls are safe
+    gr_complex phase = gr_complex(1.0, 0.0);
+    volk_32fc_s32fc_x2_rotator_32fc(out, in, d_phase_increments[doppler_index], &phase, d_fft_size);
+}
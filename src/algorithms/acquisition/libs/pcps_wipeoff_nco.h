@@ -0,0 +1,72 @@
+/*!
+ * \file pcps_wipeoff_nco.h
+ * \brief Carrier Doppler wipe-offs of a search grid generated on the fly
+ * by a numerically controlled oscillator
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_PCPS_WIPEOFF_NCO_H_
+#define GNSS_SDR_PCPS_WIPEOFF_NCO_H_
+
+#include <vector>
+#include <gnuradio/gr_complex.h>
+#include "pcps_wipeoff_source.h"
+
+/*!
+ * \brief Wipe-offs of the grid [-doppler_max, doppler_max] with step
+ * doppler_step, without any table.
+ *
+ * The carrier is generated by a phase rotator fused with the multiplication
+ * by the input (volk_32fc_s32fc_x2_rotator_32fc), so the only memory traffic
+ * is the input and the output vectors. Only the phase increment of each bin
+ * is stored. The rotator renormalizes its phasor periodically, and the phase
+ * error at the end of a dwell of N samples is in the order of N times the
+ * single precision epsilon.
+ */
+class Pcps_Wipeoff_Nco : public Pcps_Wipeoff_Source
+{
+public:
+    /*!
+     * \brief Constructor.
+     * \param freq - Intermediate frequency [Hz].
+     * \param fs_in - Sampling frequency [Hz].
+     * \param fft_size - Samples of each wipe-off.
+     * \param doppler_max - Half width of the Doppler search [Hz].
+     * \param doppler_step - Doppler step of the grid [Hz].
+     */
+    Pcps_Wipeoff_Nco(long freq, long fs_in, unsigned int fft_size,
+            unsigned int doppler_max, unsigned int doppler_step);
+
+    unsigned int num_doppler_bins() const { return d_phase_increments.size(); }
+
+    void wipeoff(gr_complex* out, const gr_complex* in, unsigned int doppler_index) const;
+
+private:
+    unsigned int d_fft_size;
+    std::vector<gr_complex> d_phase_increments;
+};
+
+#endif /* GNSS_SDR_PCPS_WIPEOFF_NCO_H_ */
@@ -0,0 +1,110 @@
+/*!
+ * \file pcps_wipeoff_registry.cc
+ * \brief Process-wide registry of Doppler wipe-off tables, so that the
+ * channels searching the same grid share one copy of its wipe-offs
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "pcps_wipeoff_registry.h"
+#include <glog/logging.h>
+
+using google::LogMessage;
+
+bool Pcps_Wipeoff_Registry::Key::operator<(const Key& other) const
+{
+    if (freq != other.freq) return freq < other.freq;
+    if (fs_in != other.fs_in) return fs_in < other.fs_in;
+    if (fft_size != other.fft_size) return fft_size < other.fft_size;
+    if (doppler_max != other.doppler_max) return doppler_max < other.doppler_max;
+    if (doppler_step != other.doppler_step) return doppler_step < other.doppler_step;
+    return bits < other.bits;
+}
+
+
+
+Pcps_Wipeoff_Registry* Pcps_Wipeoff_Registry::instance()
+{
+    // Never destroyed, so that no block can outlive it
+    static Pcps_Wipeoff_Registry* registry = new Pcps_Wipeoff_Registry();
+    return registry;
+}
+
+
+
+pcps_wipeoff_table_sptr Pcps_Wipeoff_Registry::table(long freq, long fs_in,
+        unsigned int fft_size, unsigned int doppler_max, unsigned int doppler_step,
+        unsigned int bits)
+{
+    Key key;
+    key.freq = freq;
+    key.fs_in = fs_in;
+    key.fft_size = fft_size;
+    key.doppler_max = doppler_max;
+    key.doppler_step = doppler_step;
+    key.bits = Pcps_Wipeoff_Table::supported(bits) ? bits : 32;
+
+    boost::mutex::scoped_lock lock(d_mutex);
+    pcps_wipeoff_table_sptr table = d_tables[key].lock();
+    if (!table)
+        {
+            // Drop the entries of the released tables
+            std::map<Key, boost::weak_ptr<const Pcps_Wipeoff_Table> >::iterator it = d_tables.begin();
+            while (it != d_tables.end())
+                {
+                    if (it->second.expired())
+                        {
+                            d_tables.erase(it++);
+                        }
+                    else
+                        {
+                            ++it;
+                        }
+                }
+            table = pcps_wipeoff_table_sptr(new Pcps_Wipeoff_Table(freq, fs_in, fft_size,
+                    doppler_max, doppler_step, key.bits));
+            d_tables[key] = table;
+            DLOG(INFO) << "Wipe-off registry: new table, fs_in=" << fs_in << ", fft_size="
+                       << fft_size << ", " << key.bits << " bits, " << d_tables.size() << " tables";
+        }
+    return table;
+}
+
+
+
+unsigned int Pcps_Wipeoff_Registry::size()
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+    unsigned int count = 0;
+    for (std::map<Key, boost::weak_ptr<const Pcps_Wipeoff_Table> >::iterator it = d_tables.begin();
+         it != d_tables.end(); ++it)
+        {
+            if (!it->second.expired())
+                {
+                    count++;
+                }
+        }
+    return count;
+}
@@ -0,0 +1,95 @@
+/*!
+ * \file pcps_wipeoff_registry.h
+ * \brief Process-wide registry of Doppler wipe-off tables, so that the
+ * channels searching the same grid share one copy of its wipe-offs
+ *
+ * Every acquisition channel of a system searches the same Doppler grid with
+ * the same intermediate frequency, sampling frequency and FFT size, so their
+ * wipe-off tables are identical. A private table per channel multiplies the
+ * memory by the number of channels (e.g. 20 channels x 41 bins x 16384
+ * samples is more than 100 MB of complex floats) and evicts the rest of the
+ * working set from the caches.
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_PCPS_WIPEOFF_REGISTRY_H_
+#define GNSS_SDR_PCPS_WIPEOFF_REGISTRY_H_
+
+#include <map>
+#include <boost/shared_ptr.hpp>
+#include <boost/weak_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include "pcps_wipeoff_table.h"
+
+typedef boost::shared_ptr<const Pcps_Wipeoff_Table> pcps_wipeoff_table_sptr;
+
+/*!
+ * \brief Thread-safe registry of reference counted Pcps_Wipeoff_Table
+ * objects, keyed by intermediate frequency, sampling frequency, FFT size,
+ * Doppler grid and bits per sample.
+ *
+ * The registry only keeps weak references: a table is released when the
+ * last block that uses it releases it, and generated again if needed later.
+ */
+class Pcps_Wipeoff_Registry
+{
+public:
+    /*!
+     * \brief Returns the registry shared by all the acquisition blocks.
+     */
+    static Pcps_Wipeoff_Registry* instance();
+
+    /*!
+     * \brief Returns the table of a grid, generating it if no other block
+     * holds it. See Pcps_Wipeoff_Table for the parameters.
+     */
+    pcps_wipeoff_table_sptr table(long freq, long fs_in, unsigned int fft_size,
+            unsigned int doppler_max, unsigned int doppler_step, unsigned int bits);
+
+    /*!
+     * \brief Number of tables currently in use.
+     */
+    unsigned int size();
+
+private:
+    struct Key
+    {
+        long freq;
+        long fs_in;
+        unsigned int fft_size;
+        unsigned int doppler_max;
+        unsigned int doppler_step;
+        unsigned int bits;
+        bool operator<(const Key& other) const;
+    };
+
+    Pcps_Wipeoff_Registry() {}
+
+    std::map<Key, boost::weak_ptr<const Pcps_Wipeoff_Table> > d_tables;
+    boost::mutex d_mutex;
+};
+
+#endif /* GNSS_SDR_PCPS_WIPEOFF_REGISTRY_H_ */
@@ -0,0 +1,58 @@
+/*!
+ * \file pcps_wipeoff_source.h
+ * \brief Interface of a set of carrier Doppler wipe-offs of a Parallel
+ * Code Phase Search acquisition grid
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_PCPS_WIPEOFF_SOURCE_H_
+#define GNSS_SDR_PCPS_WIPEOFF_SOURCE_H_
+
+#include <gnuradio/gr_complex.h>
+
+/*!
+ * \brief This abstract class represents the carrier Doppler wipe-offs of
+ * every Doppler bin of a search grid, however they are stored or generated.
+ *
+ * Implementations must allow concurrent calls to wipeoff(), so that the
+ * Doppler bins can be processed by several threads.
+ */
+class Pcps_Wipeoff_Source
+{
+public:
+    virtual ~Pcps_Wipeoff_Source() {}
+
+    /*!
+     * \brief Multiplies the input samples by the carrier wipe-off of a Doppler bin.
+     * \param out - Output vector (fft_size complex samples, aligned).
+     * \param in - Input samples (aligned).
+     * \param doppler_index - Doppler bin.
+     */
+    virtual void wipeoff(gr_complex* out, const gr_complex* in,
+            unsigned int doppler_index) const = 0;
+};
+
+#endif /* GNSS_SDR_PCPS_WIPEOFF_SOURCE_H_ */
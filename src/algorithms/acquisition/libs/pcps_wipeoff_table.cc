@@ -0,0 +1,245 @@
+/*!
+ * \file pcps_wipeoff_table.cc
+ * \brief Precomputed carrier Doppler wipe-offs of a Parallel Code Phase
+ * Search acquisition grid, stored in single precision or in reduced
+ * precision (16 or 8 bit integers)
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "pcps_wipeoff_table.h"
+#include <cstdlib>
+#include <new>
+#include <glog/logging.h>
+#include <volk/volk.h>
+#include "gnss_signal_processing.h"
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+using google::LogMessage;
+
+// Full scale of the integer samples
+#define PCPS_WIPEOFF_SCALE_16 32767.0
+#define PCPS_WIPEOFF_SCALE_8 127.0
+
+
+#ifdef __SSE2__
+/*
+ * Product of two complex samples of in (I0 Q0 I1 Q1) by two samples of the
+ * wipe-off converted to float (without the SSE3 addsub)
+ */
+static inline __m128 multiply_2_samples(const float* in, __m128i w_int, __m128 scale)
+{
+    const __m128 sign = _mm_set_ps(0.0, -0.0, 0.0, -0.0);
+    __m128 w = _mm_mul_ps(_mm_cvtepi32_ps(w_int), scale);
+    __m128 x = _mm_loadu_ps(in);
+    __m128 w_re = _mm_shuffle_ps(w, w, _MM_SHUFFLE(2, 2, 0, 0));
+    __m128 w_im = _mm_shuffle_ps(w, w, _MM_SHUFFLE(3, 3, 1, 1));
+    __m128 x_swap = _mm_shuffle_ps(x, x, _MM_SHUFFLE(2, 3, 0, 1));
+    // (xr wr - xi wi, xi wr + xr wi)
+    return _mm_add_ps(_mm_mul_ps(x, w_re), _mm_xor_ps(_mm_mul_ps(x_swap, w_im), sign));
+}
+#endif
+
+
+
+/*
+ * out = in * row, with the components of the row stored as 16 or 8 bit
+ * integers of full scale 1 / scale. The row is converted to float in the
+ * registers, so it is read only once and with 2 or 4 times less bytes.
+ */
+static void multiply_16i(gr_complex* out, const gr_complex* in, const short* row, float scale, unsigned int num_samples)
+{
+    unsigned int i = 0;
+#ifdef __SSE2__
+    const __m128 scale_ps = _mm_set1_ps(scale);
+    for (; i + 4 <= num_samples; i += 4)
+        {
+            // 4 samples: 8 shorts sign extended to two vectors of 4 int32
+            __m128i w = _mm_loadu_si128((const __m128i*)(row + 2 * i));
+            __m128i w_lo = _mm_srai_epi32(_mm_unpacklo_epi16(w, w), 16);
+            __m128i w_hi = _mm_srai_epi32(_mm_unpackhi_epi16(w, w), 16);
+            _mm_storeu_ps((float*)(out + i), multiply_2_samples((const float*)(in + i), w_lo, scale_ps));
+            _mm_storeu_ps((float*)(out + i + 2), multiply_2_samples((const float*)(in + i + 2), w_hi, scale_ps));
+        }
+#endif
+    for (; i < num_samples; i++)
+        {
+            out[i] = in[i] * gr_complex((float)row[2 * i] * scale, (float)row[2 * i + 1] * scale);
+        }
+}
+
+
+
+static void multiply_8i(gr_complex* out, const gr_complex* in, const signed char* row, float scale, unsigned int num_samples)
+{
+    unsigned int i = 0;
+#ifdef __SSE2__
+    const __m128 scale_ps = _mm_set1_ps(scale);
+    for (; i + 8 <= num_samples; i += 8)
+        {
+            // 8 samples: 16 bytes sign extended to two vectors of 8 shorts
+            __m128i w = _mm_loadu_si128((const __m128i*)(row + 2 * i));
+            __m128i halves[2] = { _mm_srai_epi16(_mm_unpacklo_epi8(w, w), 8),
+                                  _mm_srai_epi16(_mm_unpackhi_epi8(w, w), 8) };
+            for (int h = 0; h < 2; h++)
+                {
+                    __m128i w_lo = _mm_srai_epi32(_mm_unpacklo_epi16(halves[h], halves[h]), 16);
+                    __m128i w_hi = _mm_srai_epi32(_mm_unpackhi_epi16(halves[h], halves[h]), 16);
+                    unsigned int k = i + 4 * h;
+                    _mm_storeu_ps((float*)(out + k), multiply_2_samples((const float*)(in + k), w_lo, scale_ps));
+                    _mm_storeu_ps((float*)(out + k + 2), multiply_2_samples((const float*)(in + k + 2), w_hi, scale_ps));
+                }
+        }
+#endif
+    for (; i < num_samples; i++)
+        {
+            out[i] = in[i] * gr_complex((float)row[2 * i] * scale, (float)row[2 * i + 1] * scale);
+        }
+}
+
+
+bool Pcps_Wipeoff_Table::supported(unsigned int bits)
+{
+    return bits == 32 || bits == 16 || bits == 8;
+}
+
+
+
+Pcps_Wipeoff_Table::Pcps_Wipeoff_Table(long freq, long fs_in, unsigned int fft_size,
+        unsigned int doppler_max, unsigned int doppler_step, unsigned int bits)
+{
+    d_fft_size = fft_size;
+    d_bits = bits;
+    if (!supported(d_bits))
+        {
+            LOG(WARNING) << "Wipe-offs with " << d_bits << " bits not supported, using 32 bits";
+            d_bits = 32;
+        }
+
+    // Count the number of bins
+    d_num_doppler_bins = 0;
+    for (int doppler = (int)(-doppler_max); doppler <= (int)doppler_max; doppler += doppler_step)
+        {
+            d_num_doppler_bins++;
+        }
+
+    gr_complex* wipeoff = 0;
+    bool allocated = true;
+    if (d_bits != 32)
+        {
+            if (posix_memalign((void**)&wipeoff, 16, d_fft_size * sizeof(gr_complex)) != 0)
+                {
+                    wipeoff = 0;
+                    allocated = false;
+                }
+        }
+    d_rows = new void*[d_num_doppler_bins];
+    for (unsigned int doppler_index = 0; doppler_index < d_num_doppler_bins; doppler_index++)
+        {
+            if (posix_memalign(&(d_rows[doppler_index]), 16, d_fft_size * 2 * d_bits / 8) != 0)
+                {
+                    d_rows[doppler_index] = 0;
+                    allocated = false;
+                }
+        }
+    if (!allocated)
+        {
+            LOG(ERROR) << "Wipe-off table: cannot allocate " << d_num_doppler_bins << " Doppler bins x "
+                       << d_fft_size << " samples of " << d_bits << " bits";
+            for (unsigned int doppler_index = 0; doppler_index < d_num_doppler_bins; doppler_index++)
+                {
+                    free(d_rows[doppler_index]);
+                }
+            delete[] d_rows;
+            free(wipeoff);
+            throw std::bad_alloc();
+        }
+
+    // Create the carrier Doppler wipeoff signals
+    for (unsigned int doppler_index = 0; doppler_index < d_num_doppler_bins; doppler_index++)
+        {
+            int doppler = -(int)doppler_max + doppler_step*doppler_index;
+            if (d_bits == 32)
+                {
+                    complex_exp_gen_conj((gr_complex*)d_rows[doppler_index], freq + doppler, fs_in, d_fft_size);
+                }
+            else if (d_bits == 16)
+                {
+                    complex_exp_gen_conj(wipeoff, freq + doppler, fs_in, d_fft_size);
+                    volk_32f_s32f_convert_16i_a((short*)d_rows[doppler_index], (const float*)wipeoff,
+                                                PCPS_WIPEOFF_SCALE_16, 2 * d_fft_size);
+                }
+            else
+                {
+                    complex_exp_gen_conj(wipeoff, freq + doppler, fs_in, d_fft_size);
+                    volk_32f_s32f_convert_8i_a((signed char*)d_rows[doppler_index], (const float*)wipeoff,
+                                               PCPS_WIPEOFF_SCALE_8, 2 * d_fft_size);
+                }
+        }
+    free(wipeoff);
+
+    DLOG(INFO) << "Wipe-off table: " << d_num_doppler_bins << " Doppler bins x "
+               << d_fft_size << " samples, " << d_bits << " bits, " << size_bytes() << " bytes";
+}
+
+
+
+Pcps_Wipeoff_Table::~Pcps_Wipeoff_Table()
+{
+    for (unsigned int doppler_index = 0; doppler_index < d_num_doppler_bins; doppler_index++)
+        {
+            free(d_rows[doppler_index]);
+        }
+    delete[] d_rows;
+}
+
+
+
+unsigned long int Pcps_Wipeoff_Table::size_bytes() const
+{
+    return (unsigned long int)d_num_doppler_bins * d_fft_size * 2 * d_bits / 8;
+}
+
+
+
+void Pcps_Wipeoff_Table::wipeoff(gr_complex* out, const gr_complex* in, unsigned int doppler_index) const
+{
+    if (d_bits == 32)
+        {
+            volk_32fc_x2_multiply_32fc_a(out, in, (const gr_complex*)d_rows[doppler_index], d_fft_size);
+            return;
+        }
+
+    if (d_bits == 16)
+        {
+            multiply_16i(out, in, (const short*)d_rows[doppler_index], 1.0 / PCPS_WIPEOFF_SCALE_16, d_fft_size);
+        }
+    else
+        {
+            multiply_8i(out, in, (const signed char*)d_rows[doppler_index], 1.0 / PCPS_WIPEOFF_SCALE_8, d_fft_size);
+        }
+}
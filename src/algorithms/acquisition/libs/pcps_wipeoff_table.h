@@ -0,0 +1,90 @@
+/*!
+ * \file pcps_wipeoff_table.h
+ * \brief Precomputed carrier Doppler wipe-offs of a Parallel Code Phase
+ * Search acquisition grid, stored in single precision or in reduced
+ * precision (16 or 8 bit integers)
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_PCPS_WIPEOFF_TABLE_H_
+#define GNSS_SDR_PCPS_WIPEOFF_TABLE_H_
+
+#include <gnuradio/gr_complex.h>
+#include "pcps_wipeoff_source.h"
+
+/*!
+ * \brief Table of the carrier Doppler wipe-offs of the grid
+ * [-doppler_max, doppler_max] with step doppler_step.
+ *
+ * With 16 or 8 bit samples the table takes 2 or 4 times less memory than
+ * with complex floats. The samples of a Doppler bin are converted to float
+ * in the registers, in the multiplication by the input (SSE2), so the
+ * wipe-off reads 2 or 4 times less bytes of the table and the FFTs and the
+ * detection still work in single precision. The quantization of
+ * the wipe-off adds a noise about 98 dB (16 bit) or 50 dB (8 bit) below the
+ * carrier, which does not change the detection statistic noticeably.
+ */
+class Pcps_Wipeoff_Table : public Pcps_Wipeoff_Source
+{
+public:
+    /*!
+     * \brief Tells if the samples can be stored with this number of bits
+     * per component (32: float, 16 or 8: integer).
+     */
+    static bool supported(unsigned int bits);
+
+    /*!
+     * \brief Constructor. Generates the wipe-offs of the whole grid.
+     * \param freq - Intermediate frequency [Hz].
+     * \param fs_in - Sampling frequency [Hz].
+     * \param fft_size - Samples of each wipe-off.
+     * \param doppler_max - Half width of the Doppler search [Hz].
+     * \param doppler_step - Doppler step of the grid [Hz].
+     * \param bits - Bits per component of the stored samples (32, 16 or 8).
+     * Throws std::bad_alloc if the table cannot be allocated.
+     */
+    Pcps_Wipeoff_Table(long freq, long fs_in, unsigned int fft_size,
+            unsigned int doppler_max, unsigned int doppler_step, unsigned int bits);
+    ~Pcps_Wipeoff_Table();
+
+    unsigned int num_doppler_bins() const { return d_num_doppler_bins; }
+    unsigned int bits() const { return d_bits; }
+
+    /*!
+     * \brief Memory taken by the samples of the table [bytes].
+     */
+    unsigned long int size_bytes() const;
+
+    void wipeoff(gr_complex* out, const gr_complex* in, unsigned int doppler_index) const;
+
+private:
+    unsigned int d_fft_size;
+    unsigned int d_num_doppler_bins;
+    unsigned int d_bits;
+    void** d_rows;
+};
+
+#endif /* GNSS_SDR_PCPS_WIPEOFF_TABLE_H_ */
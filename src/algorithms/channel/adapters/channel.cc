@@ -32,9 +32,12 @@
 #include "channel.h"
 #include <iostream>
 #include <sstream>
+#include <vector>
+#include <boost/bind.hpp>
 #include <boost/lexical_cast.hpp>
 #include <boost/thread/thread.hpp>
 #include <glog/logging.h>
+#include <gnuradio/block.h>
 #include <gnuradio/io_signature.h>
 #include <gnuradio/message.h>
 #include "acquisition_interface.h"
@@ -98,6 +101,16 @@ Channel::Channel(ConfigurationInterface *configuration, unsigned int channel,
     channel_fsm_.set_channel(channel_);
     channel_fsm_.set_queue(queue_);
 
+    // With a pool of threads for all the channels instead of a thread per channel
+    unsigned int scheduler_threads = configuration->property("Channels.scheduler_threads", 0);
+    pin_to_cores_ = configuration->property("Channels.pin_to_cores", false);
+    hosted_ = false;
+    if (scheduler_threads > 0)
+        {
+            scheduler_ = Channel_Scheduler::shared(scheduler_threads, pin_to_cores_);
+        }
+    scheduled_ = false;
+
     connected_ = false;
     message_ = 0;
     gnss_signal_ = Gnss_Signal();
@@ -129,10 +142,31 @@ void Channel::connect(gr::top_block_sptr top_block)
 
     top_block->connect(pass_through_->get_right_block(), 0, acq_->get_left_block(), 0);
     DLOG(INFO) << "pass_through_ -> acquisition";
-    top_block->connect(pass_through_->get_right_block(), 0, trk_->get_left_block(), 0);
-    DLOG(INFO) << "pass_through_ -> tracking";
-    top_block->connect(trk_->get_right_block(), 0, nav_->get_left_block(), 0);
-    DLOG(INFO) << "tracking -> telemetry_decoder";
+    if (!hosted_)
+        {
+            top_block->connect(pass_through_->get_right_block(), 0, trk_->get_left_block(), 0);
+            DLOG(INFO) << "pass_through_ -> tracking";
+            top_block->connect(trk_->get_right_block(), 0, nav_->get_left_block(), 0);
+            DLOG(INFO) << "tracking -> telemetry_decoder";
+        }
+
+    if (pin_to_cores_)
+        {
+            // Tracking and telemetry decoding of a channel on the same core
+            unsigned int num_cores = boost::thread::hardware_concurrency();
+            std::vector<int> core(1, channel_ % (num_cores > 0 ? num_cores : 1));
+            gr::block_sptr trk_block = boost::dynamic_pointer_cast<gr::block>(trk_->get_left_block());
+            gr::block_sptr nav_block = boost::dynamic_pointer_cast<gr::block>(nav_->get_left_block());
+            if (trk_block and !hosted_)
+                {
+                    trk_block->set_processor_affinity(core);
+                }
+            if (nav_block and !hosted_)
+                {
+                    nav_block->set_processor_affinity(core);
+                }
+            DLOG(INFO) << "Channel " << channel_ << " tracking and telemetry pinned to core " << core[0];
+        }
     connected_ = true;
 }
 
@@ -146,8 +180,11 @@ void Channel::disconnect(gr::top_block_sptr top_block)
             return;
         }
     top_block->disconnect(pass_through_->get_right_block(), 0, acq_->get_left_block(), 0);
-    top_block->disconnect(pass_through_->get_right_block(), 0, trk_->get_left_block(), 0);
-    top_block->disconnect(trk_->get_right_block(), 0, nav_->get_left_block(), 0);
+    if (!hosted_)
+        {
+            top_block->disconnect(pass_through_->get_right_block(), 0, trk_->get_left_block(), 0);
+            top_block->disconnect(trk_->get_right_block(), 0, nav_->get_left_block(), 0);
+        }
     pass_through_->disconnect(top_block);
     acq_->disconnect(top_block);
     trk_->disconnect(top_block);
@@ -194,7 +231,16 @@ void Channel::start_acquisition()
 
 void Channel::start()
 {
-    ch_thread_ = boost::thread(&Channel::run, this);
+    if (scheduler_)
+        {
+            channel_internal_queue_.set_notifier(boost::bind(&Channel::schedule, this));
+            // Messages pushed before the start
+            schedule();
+        }
+    else
+        {
+            ch_thread_ = boost::thread(&Channel::run, this);
+        }
 }
 
 
@@ -210,6 +256,42 @@ void Channel::run()
 
 
 
+void Channel::schedule()
+{
+    // One task at a time, so that the messages are processed in order
+    boost::mutex::scoped_lock lock(scheduled_mutex_);
+    if (!scheduled_)
+        {
+            scheduled_ = true;
+            scheduler_->submit(channel_, boost::bind(&Channel::run_messages, this));
+        }
+}
+
+
+
+void Channel::run_messages()
+{
+    while (true)
+        {
+            if (channel_internal_queue_.try_pop(message_))
+                {
+                    process_channel_messages();
+                    continue;
+                }
+            // A message pushed before this check is processed by this task,
+            // and a message pushed after it schedules a new one
+            boost::mutex::scoped_lock lock(scheduled_mutex_);
+            if (channel_internal_queue_.empty())
+                {
+                    scheduled_ = false;
+                    scheduled_condition_.notify_all();
+                    return;
+                }
+        }
+}
+
+
+
 void Channel::standby()
 {
     channel_fsm_.Event_gps_failed_tracking_standby();
@@ -225,6 +307,17 @@ void Channel::stop()
 {
     channel_internal_queue_.push(0); //message to stop channel
     stop_ = true;
+    if (scheduler_)
+        {
+            // No task of this channel can run after it is stopped
+            channel_internal_queue_.set_notifier(boost::function<void()>());
+            boost::mutex::scoped_lock lock(scheduled_mutex_);
+            while (scheduled_)
+                {
+                    scheduled_condition_.wait(lock);
+                }
+            return;
+        }
     /* When the boost::thread object that represents a thread of execution
      * is destroyed the thread becomes detached. Once a thread is detached,
      * it will continue executing until the invocation of the function or
@@ -37,8 +37,11 @@
 
 #include <string>
 #include <gnuradio/msg_queue.h>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
 #include "channel_interface.h"
 #include "gps_l1_ca_channel_fsm.h"
+#include "channel_scheduler.h"
 #include "control_message_factory.h"
 #include "concurrent_queue.h"
 #include "gnss_signal.h"
@@ -55,6 +58,16 @@ class TelemetryDecoderInterface;
  * a Tracking Interface and a TelemetryDecoderInterface, and handles
  * their interaction through a Finite State Machine
  *
+ * The messages of the acquisition and tracking blocks are processed by a
+ * thread of the channel or, when Channels.scheduler_threads is not zero,
+ * by the work-stealing pool shared by all the channels (Channel_Scheduler),
+ * one task at a time per channel.
+ *
+ * With Channels.multichannel_tracking, the tracking and telemetry decoding
+ * of the channel are hosted by the Gps_L1_Ca_Multichannel_Tracking_cc block
+ * of the flowgraph, which tracks all the channels on the same samples (see
+ * set_hosted()), and runs their per-epoch work on the pool when
+ * Channels.scheduler_threads is not zero.
  */
 class Channel: public ChannelInterface
 {
@@ -82,7 +95,13 @@ public:
     TelemetryDecoderInterface* telemetry(){ return nav_; }
     void start_acquisition();                   //!< Start the State Machine
     void set_signal(Gnss_Signal gnss_signal_);  //!< Sets the channel GNSS signal
-    void start();                               //!< Start the thread
+    void start();                               //!< Start the thread, or the scheduling of the messages
+    /*!
+     * \brief Marks the tracking and telemetry of the channel as hosted by the
+     * flowgraph. connect() then connects the acquisition only, and the
+     * flowgraph connects the host block to the observables.
+     */
+    void set_hosted(bool hosted){ hosted_ = hosted; }
     void standby();
     /*!
      * \brief Set stop_ to true and blocks the calling thread until
@@ -108,7 +127,15 @@ private:
     boost::shared_ptr<gr::msg_queue> queue_;
     concurrent_queue<int> channel_internal_queue_;
     boost::thread ch_thread_;
+    channel_scheduler_sptr scheduler_;
+    bool pin_to_cores_;
+    bool hosted_;
+    boost::mutex scheduled_mutex_;
+    boost::condition_variable scheduled_condition_;
+    bool scheduled_;
     void run();
+    void schedule();
+    void run_messages();
     void process_channel_messages();
 };
 
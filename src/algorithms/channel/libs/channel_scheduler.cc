@@ -0,0 +1,220 @@
+/*!
+ * \file channel_scheduler.cc
+ * \brief Fixed size work-stealing pool of threads that runs the work of
+ * the channels
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "channel_scheduler.h"
+#include <boost/bind.hpp>
+#include <boost/weak_ptr.hpp>
+#include <glog/logging.h>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+using google::LogMessage;
+
+channel_scheduler_sptr Channel_Scheduler::shared(unsigned int num_workers, bool pin_to_cores)
+{
+    // Never destroyed, so that no channel can outlive them
+    static boost::mutex* mutex = new boost::mutex();
+    static boost::weak_ptr<Channel_Scheduler>* scheduler = new boost::weak_ptr<Channel_Scheduler>();
+
+    boost::mutex::scoped_lock lock(*mutex);
+    channel_scheduler_sptr running = scheduler->lock();
+    if (!running)
+        {
+            running = channel_scheduler_sptr(new Channel_Scheduler(num_workers, pin_to_cores));
+            *scheduler = running;
+        }
+    return running;
+}
+
+
+
+Channel_Scheduler::Channel_Scheduler(unsigned int num_workers, bool pin_to_cores)
+{
+    d_num_workers = num_workers > 0 ? num_workers : 1;
+    d_pin_to_cores = pin_to_cores;
+    d_published = 0;
+    d_stop = false;
+    for (unsigned int worker = 0; worker < d_num_workers; worker++)
+        {
+            d_queues.push_back(new Worker_Queue());
+        }
+    for (unsigned int worker = 0; worker < d_num_workers; worker++)
+        {
+            d_workers.create_thread(boost::bind(&Channel_Scheduler::run, this, worker));
+        }
+    LOG(INFO) << "Channel scheduler with " << d_num_workers << " workers"
+              << (d_pin_to_cores ? " pinned to cores" : "");
+}
+
+
+
+Channel_Scheduler::~Channel_Scheduler()
+{
+    {
+        boost::mutex::scoped_lock lock(d_mutex);
+        d_stop = true;
+    }
+    d_condition.notify_all();
+    d_workers.join_all();
+    for (unsigned int worker = 0; worker < d_num_workers; worker++)
+        {
+            delete d_queues[worker];
+        }
+}
+
+
+
+void Channel_Scheduler::submit(unsigned int queue, boost::function<void()> task)
+{
+    Worker_Queue* worker_queue = d_queues[queue % d_num_workers];
+    {
+        boost::mutex::scoped_lock lock(worker_queue->mutex);
+        worker_queue->tasks.push_back(task);
+    }
+    // Counted after it is published: a worker that did not find it has
+    // not waited yet, or is woken up
+    {
+        boost::mutex::scoped_lock lock(d_mutex);
+        d_published++;
+    }
+    d_condition.notify_one();
+}
+
+
+
+void Channel_Scheduler::run_epoch(const std::vector<unsigned int>& queues, const std::vector<boost::function<void()> >& tasks)
+{
+    Epoch_Batch batch;
+    batch.remaining = tasks.size();
+    for (unsigned int i = 0; i < tasks.size(); i++)
+        {
+            submit(queues[i], boost::bind(&Channel_Scheduler::run_epoch_task, &batch, tasks[i]));
+        }
+    boost::mutex::scoped_lock lock(batch.mutex);
+    while (batch.remaining > 0)
+        {
+            batch.condition.wait(lock);
+        }
+}
+
+
+
+void Channel_Scheduler::run_epoch_task(Epoch_Batch* batch, const boost::function<void()>& task)
+{
+    task();
+    boost::mutex::scoped_lock lock(batch->mutex);
+    batch->remaining--;
+    if (batch->remaining == 0)
+        {
+            batch->condition.notify_all();
+        }
+}
+
+
+
+bool Channel_Scheduler::pop(unsigned int worker, boost::function<void()>& task)
+{
+    // Newest first: its data is the most likely to be in the cache
+    Worker_Queue* worker_queue = d_queues[worker];
+    boost::mutex::scoped_lock lock(worker_queue->mutex);
+    if (worker_queue->tasks.empty())
+        {
+            return false;
+        }
+    task = worker_queue->tasks.back();
+    worker_queue->tasks.pop_back();
+    return true;
+}
+
+
+
+bool Channel_Scheduler::steal(unsigned int worker, boost::function<void()>& task)
+{
+    // Oldest first, from the next workers
+    for (unsigned int i = 1; i < d_num_workers; i++)
+        {
+            Worker_Queue* victim = d_queues[(worker + i) % d_num_workers];
+            boost::mutex::scoped_lock lock(victim->mutex);
+            if (!victim->tasks.empty())
+                {
+                    task = victim->tasks.front();
+                    victim->tasks.pop_front();
+                    return true;
+                }
+        }
+    return false;
+}
+
+
+
+void Channel_Scheduler::run(unsigned int worker)
+{
+#ifdef __linux__
+    if (d_pin_to_cores)
+        {
+            unsigned int num_cores = boost::thread::hardware_concurrency();
+            cpu_set_t cpu_set;
+            CPU_ZERO(&cpu_set);
+            CPU_SET(worker % (num_cores > 0 ? num_cores : 1), &cpu_set);
+            if (pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpu_set) != 0)
+                {
+                    LOG(WARNING) << "Channel scheduler worker " << worker << " could not be pinned to a core";
+                }
+        }
+#endif
+
+    boost::function<void()> task;
+    while (true)
+        {
+            unsigned long published;
+            {
+                boost::mutex::scoped_lock lock(d_mutex);
+                published = d_published;
+            }
+            if (pop(worker, task) || steal(worker, task))
+                {
+                    task();
+                    continue;
+                }
+            boost::mutex::scoped_lock lock(d_mutex);
+            if (d_published != published)
+                {
+                    // A task was published while the queues were searched
+                    continue;
+                }
+            if (d_stop)
+                {
+                    return;
+                }
+            d_condition.wait(lock);
+        }
+}
@@ -0,0 +1,140 @@
+/*!
+ * \file channel_scheduler.h
+ * \brief Fixed size work-stealing pool of threads that runs the work of
+ * the channels
+ *
+ * Each channel runs a thread that waits for the messages of its
+ * acquisition and tracking blocks, and sleeps most of the time. With many
+ * channels those threads add up to hundreds, and the context switches
+ * and cache migrations limit the scaling of the receiver. The scheduler
+ * runs the work of all the channels on a fixed number of workers instead.
+ *
+ * Each worker owns a queue. A task is submitted to the queue of a worker
+ * chosen by the submitter (e.g. the channel number), so the work of a
+ * channel tends to stay on the same worker and on its cache. A worker runs
+ * the newest task of its own queue first, and when its queue is empty it
+ * steals the oldest task of the queues of the other workers. Optionally,
+ * each worker is pinned to a core.
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_CHANNEL_SCHEDULER_H_
+#define GNSS_SDR_CHANNEL_SCHEDULER_H_
+
+#include <deque>
+#include <vector>
+#include <boost/function.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+
+class Channel_Scheduler;
+
+typedef boost::shared_ptr<Channel_Scheduler> channel_scheduler_sptr;
+
+/*!
+ * \brief Work-stealing pool of threads shared by the channels.
+ *
+ * It runs the state machine messages of the channels and, when the channels
+ * are hosted by a multichannel tracking block, their per-epoch tracking and
+ * telemetry work (see run_epoch()). Otherwise the signal processing blocks
+ * of the channels are run by the GNU Radio scheduler, which creates a thread
+ * per block.
+ *
+ * A task must not block waiting for another task, since the number of
+ * workers is fixed. The tasks of one channel are not serialized by the
+ * pool: a channel that needs it submits a new task only when the previous
+ * one has finished (see Channel).
+ */
+class Channel_Scheduler
+{
+public:
+    /*!
+     * \brief Returns the scheduler shared by all the channels, and starts it
+     * if it is not running. The parameters of the first call are used.
+     * \param num_workers - Number of threads of the pool.
+     * \param pin_to_cores - Pins worker i to core i modulo the number of cores.
+     */
+    static channel_scheduler_sptr shared(unsigned int num_workers, bool pin_to_cores);
+
+    Channel_Scheduler(unsigned int num_workers, bool pin_to_cores);
+
+    /*!
+     * \brief Runs the pending tasks and stops the workers.
+     */
+    ~Channel_Scheduler();
+
+    /*!
+     * \brief Submits a task to the queue of worker (queue modulo num_workers()).
+     */
+    void submit(unsigned int queue, boost::function<void()> task);
+
+    /*!
+     * \brief Runs the work of an epoch of several channels, and waits until
+     * all of it has finished. Task i is submitted to the queue of worker
+     * queues[i] modulo num_workers() (e.g. the channel number, so that a
+     * channel stays on the same worker unless another one steals its task).
+     * Not to be called from a task.
+     */
+    void run_epoch(const std::vector<unsigned int>& queues, const std::vector<boost::function<void()> >& tasks);
+
+    unsigned int num_workers() const { return d_num_workers; }
+
+private:
+    struct Worker_Queue
+    {
+        boost::mutex mutex;
+        std::deque<boost::function<void()> > tasks;
+    };
+
+    struct Epoch_Batch
+    {
+        boost::mutex mutex;
+        boost::condition_variable condition;
+        unsigned int remaining;
+    };
+
+    Channel_Scheduler(const Channel_Scheduler&);
+    Channel_Scheduler& operator=(const Channel_Scheduler&);
+
+    void run(unsigned int worker);
+    bool pop(unsigned int worker, boost::function<void()>& task);
+    bool steal(unsigned int worker, boost::function<void()>& task);
+    static void run_epoch_task(Epoch_Batch* batch, const boost::function<void()>& task);
+
+    unsigned int d_num_workers;
+    bool d_pin_to_cores;
+    std::vector<Worker_Queue*> d_queues;
+    boost::thread_group d_workers;
+
+    boost::mutex d_mutex;
+    boost::condition_variable d_condition;
+    unsigned long d_published;
+    bool d_stop;
+};
+
+#endif /* GNSS_SDR_CHANNEL_SCHEDULER_H_ */
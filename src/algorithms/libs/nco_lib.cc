@@ -33,6 +33,11 @@
  */
 
 #include "nco_lib.h"
+#include <algorithm>
+#include <volk/volk.h>
+
+// Samples generated by the rotator from each exact phase
+#define NCO_ROTATOR_BLOCK 1024
 
 
 typedef ALIGN16_BEG union {
@@ -154,3 +159,20 @@ void std_nco(std::complex<float> *dest, int n_samples, float start_phase_rad, fl
             phase_rad = phase_rad+phase_step_rad;
         }
 }
+
+
+
+void rotator_nco(std::complex<float> *dest, int n_samples, float start_phase_rad, float phase_step_rad)
+{
+    // The rotator multiplies its input by the phasor, so it rotates a vector of ones
+    std::fill(dest, dest + n_samples, std::complex<float>(1.0, 0.0));
+    lv_32fc_t phase_inc = lv_cmake((float)std::cos((double)phase_step_rad), (float)-std::sin((double)phase_step_rad));
+
+    for(int first = 0; first < n_samples; first += NCO_ROTATOR_BLOCK)
+        {
+            double phase_rad = (double)start_phase_rad + (double)first * (double)phase_step_rad;
+            lv_32fc_t phase = lv_cmake((float)std::cos(phase_rad), (float)-std::sin(phase_rad));
+            int block_samples = std::min(NCO_ROTATOR_BLOCK, n_samples - first);
+            volk_32fc_s32fc_x2_rotator_32fc(dest + first, dest + first, phase_inc, &phase, block_samples);
+        }
+}
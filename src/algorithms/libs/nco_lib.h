@@ -86,4 +86,15 @@ void fxp_nco_cpyref(std::complex<float> *dest, int n_samples,float start_phase_r
 
 void fxp_nco_IQ_split(float* I, float* Q, int n_samples,float start_phase_rad, float phase_step_rad);
 
+/*!
+ * \brief Implements a complex conjugate exponential vector in std::complex<float> *dest
+ * containing int n_samples, with the starting phase float start_phase_rad and the phase step between vector elements
+ * float phase_step_rad. This function rotates a phasor by the phase step with the VOLK rotator kernel
+ * (volk_32fc_s32fc_x2_rotator_32fc), which uses the SIMD instruction set of the processor. The phasor
+ * is renormalized by the kernel, and it is set again from the exact phase every 1024 samples,
+ * so the phase error does not grow with n_samples.
+ *
+ */
+void rotator_nco(std::complex<float> *dest, int n_samples, float start_phase_rad, float phase_step_rad);
+
 #endif //NCO_LIB_CC_H
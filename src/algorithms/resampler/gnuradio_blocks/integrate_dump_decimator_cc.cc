@@ -0,0 +1,129 @@
+/*!
+ * \file integrate_dump_decimator_cc.cc
+ *
+ * \brief Integrate-and-dump decimator with gr_complex input and
+ *        gr_complex output, for any input to output rate ratio
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include "integrate_dump_decimator_cc.h"
+#include <cmath>
+#include <gnuradio/io_signature.h>
+#include <glog/logging.h>
+
+using google::LogMessage;
+
+integrate_dump_decimator_cc_sptr integrate_dump_make_decimator_cc(
+        double sample_freq_in, double sample_freq_out)
+{
+    return integrate_dump_decimator_cc_sptr(
+            new integrate_dump_decimator_cc(sample_freq_in, sample_freq_out));
+}
+
+
+
+integrate_dump_decimator_cc::integrate_dump_decimator_cc(
+        double sample_freq_in, double sample_freq_out) :
+            gr::block("integrate_dump_decimator_cc", gr::io_signature::make(1, 1,
+                    sizeof(gr_complex)), gr::io_signature::make(1, 1,
+                            sizeof(gr_complex))), d_sample_freq_in(sample_freq_in),
+                            d_sample_freq_out(sample_freq_out), d_offset(0.0)
+{
+    if (d_sample_freq_out <= 0.0 or d_sample_freq_out > d_sample_freq_in)
+        {
+            LOG(WARNING) << "Integrate and dump decimator: sample_freq_out " << d_sample_freq_out
+                         << " is not in (0, sample_freq_in], the input is not decimated";
+            d_sample_freq_out = d_sample_freq_in;
+        }
+    d_ratio = d_sample_freq_in / d_sample_freq_out;
+    d_gain = (float)(1.0 / d_ratio);
+    set_relative_rate(1.0 / d_ratio);
+    set_output_multiple(1);
+    LOG(INFO) << "Integrate and dump decimator from " << d_sample_freq_in << " to "
+              << d_sample_freq_out << " Sps, " << d_ratio << " input samples per output sample";
+}
+
+
+
+integrate_dump_decimator_cc::~integrate_dump_decimator_cc()
+{
+
+}
+
+
+
+void integrate_dump_decimator_cc::forecast(int noutput_items,
+        gr_vector_int &ninput_items_required)
+{
+    // The last output sample also reads the input sample where its period ends
+    int nreqd = (int)std::ceil((double)noutput_items * d_ratio) + 2;
+    unsigned ninputs = ninput_items_required.size();
+    for (unsigned i = 0; i < ninputs; i++)
+        {
+            ninput_items_required[i] = nreqd;
+        }
+}
+
+
+
+int integrate_dump_decimator_cc::general_work(int noutput_items,
+        gr_vector_int &ninput_items, gr_vector_const_void_star &input_items,
+        gr_vector_void_star &output_items)
+{
+    const gr_complex *in = (const gr_complex *)input_items[0];
+    gr_complex *out = (gr_complex *)output_items[0];
+
+    int first = 0; // input sample where the period of the next output sample starts
+    int lcv = 0;
+    while (lcv < noutput_items)
+        {
+            // The period spans [first + d_offset, first + end) in input samples
+            double end = d_offset + d_ratio;
+            int last = (int)end;
+            if (first + last >= ninput_items[0])
+                {
+                    break;
+                }
+            float weight_last = (float)(end - (double)last);
+
+            // Part of the first sample before the period, whole samples, part of the last sample
+            gr_complex accu = in[first] * (float)-d_offset;
+            for (int i = first; i < first + last; i++)
+                {
+                    accu += in[i];
+                }
+            accu += in[first + last] * weight_last;
+            out[lcv] = accu * d_gain;
+            lcv++;
+
+            first += last;
+            d_offset = end - (double)last;
+        }
+
+    consume_each(first);
+    return lcv;
+}
@@ -0,0 +1,93 @@
+/*!
+ * \file integrate_dump_decimator_cc.h
+ *
+ * \brief Integrate-and-dump decimator with gr_complex input and
+ *        gr_complex output, for any input to output rate ratio
+ *
+ * Each output sample is the mean of the input signal over one output
+ * sample period. The period is in general not a whole number of input
+ * samples, so the input samples at the edges of the period are weighted
+ * by the fraction of them that falls inside it. The output samples are
+ * thus exactly 1/sample_freq_out apart (no jitter of one input sample, as
+ * with the nearest neighbour resampler), and the tracking loops, which
+ * keep the code phase to a fraction of a sample, see no loss of code phase
+ * resolution. The output is delayed by half an output period, the same for
+ * all the channels.
+ *
+ * It goes in front of the channels (e.g. as the Resampler of the signal
+ * conditioner), so that acquisition and tracking correlate at
+ * sample_freq_out whatever the rate of the front end.
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_INTEGRATE_DUMP_DECIMATOR_CC_H
+#define	GNSS_SDR_INTEGRATE_DUMP_DECIMATOR_CC_H
+
+#include <gnuradio/block.h>
+
+class integrate_dump_decimator_cc;
+typedef boost::shared_ptr<integrate_dump_decimator_cc> integrate_dump_decimator_cc_sptr;
+integrate_dump_decimator_cc_sptr
+integrate_dump_make_decimator_cc(double sample_freq_in,
+        double sample_freq_out);
+
+/*!
+ * \brief This class implements an integrate-and-dump decimator for complex data
+ *
+ * Decimation by sample_freq_in / sample_freq_out >= 1, with fractional
+ * weighting of the input samples at the edges of each output period
+ */
+class integrate_dump_decimator_cc: public gr::block
+{
+private:
+    friend integrate_dump_decimator_cc_sptr
+    integrate_dump_make_decimator_cc(double sample_freq_in,
+            double sample_freq_out);
+    double d_sample_freq_in;  //! Specifies the sampling frequency of the input signal
+    double d_sample_freq_out; //! Specifies the sampling frequency of the output signal
+    double d_ratio;           //! Input samples per output sample
+    double d_offset;          //! Part of the first input sample already in the previous output [0, 1)
+    float d_gain;             //! 1 / d_ratio
+    integrate_dump_decimator_cc(double sample_freq_in,
+            double sample_freq_out);
+
+public:
+    ~integrate_dump_decimator_cc();
+    double sample_freq_in() const
+    {
+        return d_sample_freq_in;
+    }
+    double sample_freq_out() const
+    {
+        return d_sample_freq_out;
+    }
+    void forecast(int noutput_items, gr_vector_int &ninput_items_required);
+    int general_work(int noutput_items, gr_vector_int &ninput_items,
+            gr_vector_const_void_star &input_items,
+            gr_vector_void_star &output_items);
+};
+
+#endif /* GNSS_SDR_INTEGRATE_DUMP_DECIMATOR_CC_H */
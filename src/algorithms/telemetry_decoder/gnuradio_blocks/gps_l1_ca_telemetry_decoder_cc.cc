@@ -168,21 +168,27 @@ bool gps_l1_ca_telemetry_decoder_cc::gps_word_parityCheck(unsigned int gpsword)
 
 int gps_l1_ca_telemetry_decoder_cc::general_work (int noutput_items, gr_vector_int &ninput_items,
         gr_vector_const_void_star &input_items,	gr_vector_void_star &output_items)
+{
+    // ########### Output the tracking data to navigation and PVT ##########
+    decode((const Gnss_Synchro*) input_items[0], (Gnss_Synchro*) output_items[0]);
+    consume_each(1); //one by one
+    return 1;
+}
+
+
+
+void gps_l1_ca_telemetry_decoder_cc::decode(const Gnss_Synchro* in, Gnss_Synchro* out)
 {
     int corr_value = 0;
     int preamble_diff = 0;
 
-    Gnss_Synchro **out = (Gnss_Synchro **) &output_items[0];
     d_sample_counter++; //count for the processed samples
 
-    // ########### Output the tracking data to navigation and PVT ##########
-    const Gnss_Synchro **in = (const Gnss_Synchro **)  &input_items[0]; //Get the input samples pointer
-
     // TODO Optimize me!
     //******* preamble correlation ********
     for (unsigned int i = 0; i < d_samples_per_bit*8; i++)
         {
-            if (in[0][i].Prompt_I < 0)	// symbols clipping
+            if (in[i].Prompt_I < 0)	// symbols clipping
                 {
                     corr_value -= d_preambles_symbols[i];
                 }
@@ -215,7 +221,7 @@ int gps_l1_ca_telemetry_decoder_cc::general_work (int noutput_items, gr_vector_i
                             d_GPS_FSM.Event_gps_word_preamble();
                             d_flag_preamble = true;
                             d_preamble_index = d_sample_counter;  //record the preamble sample stamp (t_P)
-                            d_preamble_time_seconds = in[0][0].Tracking_timestamp_secs;// - d_preamble_duration_seconds; //record the PRN start sample index associated to the preamble
+                            d_preamble_time_seconds = in[0].Tracking_timestamp_secs;// - d_preamble_duration_seconds; //record the PRN start sample index associated to the preamble
 
                             if (!d_flag_frame_sync)
                                 {
@@ -241,7 +247,7 @@ int gps_l1_ca_telemetry_decoder_cc::general_work (int noutput_items, gr_vector_i
         }
 
     //******* SYMBOL TO BIT *******
-    d_symbol_accumulator += in[0][d_samples_per_bit*8 - 1].Prompt_I; // accumulate the input value in d_symbol_accumulator
+    d_symbol_accumulator += in[d_samples_per_bit*8 - 1].Prompt_I; // accumulate the input value in d_symbol_accumulator
     d_symbol_accumulator_counter++;
     if (d_symbol_accumulator_counter == 20)
         {
@@ -296,16 +302,15 @@ int gps_l1_ca_telemetry_decoder_cc::general_work (int noutput_items, gr_vector_i
                 }
         }
     // output the frame
-    consume_each(1); //one by one
     Gnss_Synchro current_synchro_data; //structure to save the synchronization information and send the output object to the next block
     //1. Copy the current tracking output
-    current_synchro_data = in[0][0];
+    current_synchro_data = in[0];
     //2. Add the telemetry decoder information
     if (this->d_flag_preamble == true and d_GPS_FSM.d_nav.d_TOW > 0) //update TOW at the preamble instant (todo: check for valid d_TOW)
         {
             d_TOW_at_Preamble = d_GPS_FSM.d_nav.d_TOW + GPS_SUBFRAME_SECONDS; //we decoded the current TOW when the last word of the subframe arrive, so, we have a lag of ONE SUBFRAME
             d_TOW_at_current_symbol = d_TOW_at_Preamble + GPS_CA_PREAMBLE_LENGTH_BITS/GPS_CA_TELEMETRY_RATE_BITS_SECOND;
-            Prn_timestamp_at_preamble_ms = in[0][0].Tracking_timestamp_secs * 1000.0;
+            Prn_timestamp_at_preamble_ms = in[0].Tracking_timestamp_secs * 1000.0;
             if (flag_TOW_set == false)
                 {
                     flag_TOW_set = true;
@@ -320,7 +325,7 @@ int gps_l1_ca_telemetry_decoder_cc::general_work (int noutput_items, gr_vector_i
     current_synchro_data.d_TOW_at_current_symbol = d_TOW_at_current_symbol;
     current_synchro_data.Flag_valid_word = (d_flag_frame_sync == true and d_flag_parity == true and flag_TOW_set==true);
     current_synchro_data.Flag_preamble = d_flag_preamble;
-    current_synchro_data.Prn_timestamp_ms = in[0][0].Tracking_timestamp_secs * 1000.0;
+    current_synchro_data.Prn_timestamp_ms = in[0].Tracking_timestamp_secs * 1000.0;
     current_synchro_data.Prn_timestamp_at_preamble_ms = Prn_timestamp_at_preamble_ms;
 
     if(d_dump == true)
@@ -342,8 +347,7 @@ int gps_l1_ca_telemetry_decoder_cc::general_work (int noutput_items, gr_vector_i
             }
         }
     //3. Make the output (copy the object contents to the GNURadio reserved memory)
-    *out[0] = current_synchro_data;
-    return 1;
+    *out = current_synchro_data;
 }
 
 
@@ -39,6 +39,7 @@
 #include "gps_l1_ca_subframe_fsm.h"
 #include "concurrent_queue.h"
 #include "gnss_satellite.h"
+#include "gnss_synchro.h"
 
 
 
@@ -81,6 +82,18 @@ public:
      */
     void forecast (int noutput_items, gr_vector_int &ninput_items_required);
 
+    /*!
+     * \brief Number of outputs of the tracking that decode() reads
+     */
+    int decode_input_items() const { return d_samples_per_bit * 8; }
+
+    /*!
+     * \brief Processes the next output of the tracking. in holds the last
+     * decode_input_items() outputs of the tracking, and out is the output
+     * for the first one. general_work() runs it on the input of the block.
+     */
+    void decode(const Gnss_Synchro* in, Gnss_Synchro* out);
+
 private:
     friend gps_l1_ca_telemetry_decoder_cc_sptr
     gps_l1_ca_make_telemetry_decoder_cc(Gnss_Satellite satellite, long if_freq, long fs_in,unsigned
@@ -63,6 +63,8 @@ GalileoE1DllPllVemlTracking::GalileoE1DllPllVemlTracking(
     float dll_bw_hz;
     float early_late_space_chips;
     float very_early_late_space_chips;
+    bool bit_packed_correlator;
+    float magnitude_threshold;
 
     item_type = configuration->property(role + ".item_type",default_item_type);
     fs_in = configuration->property("GNSS-SDR.internal_fs_hz", 2048000);
@@ -72,6 +74,8 @@ GalileoE1DllPllVemlTracking::GalileoE1DllPllVemlTracking(
     dll_bw_hz = configuration->property(role + ".dll_bw_hz", 2.0);
     early_late_space_chips = configuration->property(role + ".early_late_space_chips", 0.15);
     very_early_late_space_chips = configuration->property(role + ".very_early_late_space_chips", 0.6);
+    bit_packed_correlator = configuration->property(role + ".bit_packed_correlator", false);
+    magnitude_threshold = configuration->property(role + ".magnitude_threshold", 0.0);
 
     std::string default_dump_filename = "./track_ch";
     dump_filename = configuration->property(role + ".dump_filename",
@@ -92,7 +96,9 @@ GalileoE1DllPllVemlTracking::GalileoE1DllPllVemlTracking(
                     pll_bw_hz,
                     dll_bw_hz,
                     early_late_space_chips,
-                    very_early_late_space_chips);
+                    very_early_late_space_chips,
+                    bit_packed_correlator,
+                    magnitude_threshold);
         }
     else
         {
@@ -65,6 +65,8 @@ GalileoE1TcpConnectorTracking::GalileoE1TcpConnectorTracking(
     float early_late_space_chips;
     float very_early_late_space_chips;
     size_t port_ch0;
+    int batch_epochs;
+    int pipeline_depth;
     item_type = configuration->property(role + ".item_type",default_item_type);
     fs_in = configuration->property("GNSS-SDR.internal_fs_hz", 2048000);
     f_if = configuration->property(role + ".if", 0);
@@ -74,6 +76,8 @@ GalileoE1TcpConnectorTracking::GalileoE1TcpConnectorTracking(
     early_late_space_chips = configuration->property(role + ".early_late_space_chips", 0.15);
     very_early_late_space_chips = configuration->property(role + ".very_early_late_space_chips", 0.6);
     port_ch0 = configuration->property(role + ".port_ch0", 2060);
+    batch_epochs = configuration->property(role + ".batch_epochs", 1);
+    pipeline_depth = configuration->property(role + ".pipeline_depth", 0);
     std::string default_dump_filename = "./track_ch";
     dump_filename = configuration->property(role + ".dump_filename", default_dump_filename); //unused!
     vector_length = std::round(fs_in / (Galileo_E1_CODE_CHIP_RATE_HZ / Galileo_E1_B_CODE_LENGTH_CHIPS));
@@ -93,7 +97,9 @@ GalileoE1TcpConnectorTracking::GalileoE1TcpConnectorTracking(
                     dll_bw_hz,
                     early_late_space_chips,
                     very_early_late_space_chips,
-                    port_ch0);
+                    port_ch0,
+                    batch_epochs,
+                    pipeline_depth);
         }
     else
         {
@@ -63,6 +63,12 @@ GpsL1CaDllPllTracking::GpsL1CaDllPllTracking(
     float pll_bw_hz;
     float dll_bw_hz;
     float early_late_space_chips;
+    int extend_correlation_ms;
+    float pll_bw_narrow_hz;
+    float dll_bw_narrow_hz;
+    bool vector_tracking;
+    bool bit_packed_correlator;
+    float magnitude_threshold;
     item_type = configuration->property(role + ".item_type", default_item_type);
     //vector_length = configuration->property(role + ".vector_length", 2048);
     fs_in = configuration->property("GNSS-SDR.internal_fs_hz", 2048000);
@@ -71,6 +77,12 @@ GpsL1CaDllPllTracking::GpsL1CaDllPllTracking(
     pll_bw_hz = configuration->property(role + ".pll_bw_hz", 50.0);
     dll_bw_hz = configuration->property(role + ".dll_bw_hz", 2.0);
     early_late_space_chips = configuration->property(role + ".early_late_space_chips", 0.5);
+    extend_correlation_ms = configuration->property(role + ".extend_correlation_ms", 1);
+    pll_bw_narrow_hz = configuration->property(role + ".pll_bw_narrow_hz", 4.0);
+    dll_bw_narrow_hz = configuration->property(role + ".dll_bw_narrow_hz", 1.0);
+    vector_tracking = configuration->property(role + ".vector_tracking", false);
+    bit_packed_correlator = configuration->property(role + ".bit_packed_correlator", false);
+    magnitude_threshold = configuration->property(role + ".magnitude_threshold", 0.0);
     std::string default_dump_filename = "./track_ch";
     dump_filename = configuration->property(role + ".dump_filename",
             default_dump_filename); //unused!
@@ -89,7 +101,13 @@ GpsL1CaDllPllTracking::GpsL1CaDllPllTracking(
                     dump_filename,
                     pll_bw_hz,
                     dll_bw_hz,
-                    early_late_space_chips);
+                    early_late_space_chips,
+                    extend_correlation_ms,
+                    pll_bw_narrow_hz,
+                    dll_bw_narrow_hz,
+                    vector_tracking,
+                    bit_packed_correlator,
+                    magnitude_threshold);
         }
     else
         {
@@ -63,6 +63,8 @@ GpsL1CaTcpConnectorTracking::GpsL1CaTcpConnectorTracking(
     float dll_bw_hz;
     float early_late_space_chips;
     size_t port_ch0;
+    int batch_epochs;
+    int pipeline_depth;
     item_type = configuration->property(role + ".item_type",default_item_type);
     //vector_length = configuration->property(role + ".vector_length", 2048);
     fs_in = configuration->property("GNSS-SDR.internal_fs_hz", 2048000);
@@ -72,6 +74,8 @@ GpsL1CaTcpConnectorTracking::GpsL1CaTcpConnectorTracking(
     dll_bw_hz = configuration->property(role + ".dll_bw_hz", 2.0);
     early_late_space_chips = configuration->property(role + ".early_late_space_chips", 0.5);
     port_ch0 = configuration->property(role + ".port_ch0", 2060);
+    batch_epochs = configuration->property(role + ".batch_epochs", 1);
+    pipeline_depth = configuration->property(role + ".pipeline_depth", 0);
     std::string default_dump_filename = "./track_ch";
     dump_filename = configuration->property(role + ".dump_filename", default_dump_filename); //unused!
     vector_length = std::round(fs_in / (GPS_L1_CA_CODE_RATE_HZ / GPS_L1_CA_CODE_LENGTH_CHIPS));
@@ -90,7 +94,9 @@ GpsL1CaTcpConnectorTracking::GpsL1CaTcpConnectorTracking(
                     pll_bw_hz,
                     dll_bw_hz,
                     early_late_space_chips,
-                    port_ch0);
+                    port_ch0,
+                    batch_epochs,
+                    pipeline_depth);
         }
     else
         {
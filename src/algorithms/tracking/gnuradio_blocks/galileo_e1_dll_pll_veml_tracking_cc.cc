@@ -43,8 +43,9 @@
 #include <glog/logging.h>
 #include "gnss_synchro.h"
 #include "galileo_e1_signal_processing.h"
+#include "code_replica.h"
+#include "nco_lib.h"
 #include "tracking_discriminators.h"
-#include "lock_detectors.h"
 #include "Galileo_E1.h"
 #include "control_message_factory.h"
 
@@ -72,17 +73,20 @@ galileo_e1_dll_pll_veml_make_tracking_cc(
         float pll_bw_hz,
         float dll_bw_hz,
         float early_late_space_chips,
-        float very_early_late_space_chips)
+        float very_early_late_space_chips,
+        bool bit_packed_correlator,
+        float magnitude_threshold)
 {
     return galileo_e1_dll_pll_veml_tracking_cc_sptr(new galileo_e1_dll_pll_veml_tracking_cc(if_freq,
-            fs_in, vector_length, queue, dump, dump_filename, pll_bw_hz, dll_bw_hz, early_late_space_chips, very_early_late_space_chips));
+            fs_in, vector_length, queue, dump, dump_filename, pll_bw_hz, dll_bw_hz, early_late_space_chips, very_early_late_space_chips,
+            bit_packed_correlator, magnitude_threshold));
 }
 
 
 void galileo_e1_dll_pll_veml_tracking_cc::forecast (int noutput_items,
         gr_vector_int &ninput_items_required)
 {
-    ninput_items_required[0] = (int)d_vector_length*2; //set the required available samples in each call
+    ninput_items_required[0] = (int)d_vector_length*2 + Tracking_Window::history() - 1; //set the required available samples in each call
 }
 
 
@@ -96,11 +100,16 @@ galileo_e1_dll_pll_veml_tracking_cc::galileo_e1_dll_pll_veml_tracking_cc(
         float pll_bw_hz,
         float dll_bw_hz,
         float early_late_space_chips,
-        float very_early_late_space_chips):
+        float very_early_late_space_chips,
+        bool bit_packed_correlator,
+        float magnitude_threshold):
         gr::block("galileo_e1_dll_pll_veml_tracking_cc", gr::io_signature::make(1, 1, sizeof(gr_complex)),
-                gr::io_signature::make(1, 1, sizeof(Gnss_Synchro)))
+                gr::io_signature::make(1, 1, sizeof(Gnss_Synchro))),
+        d_lock_detector(CN0_ESTIMATION_SAMPLES, fs_in, Galileo_E1_B_CODE_LENGTH_CHIPS)
 {
     this->set_relative_rate(1.0/vector_length);
+    // keep the samples before the epoch, to start the correlation at an aligned sample
+    this->set_history(Tracking_Window::history());
     // initialize internal vars
     d_queue = queue;
     d_dump = dump;
@@ -131,14 +140,15 @@ galileo_e1_dll_pll_veml_tracking_cc::galileo_e1_dll_pll_veml_tracking_cc(
      * (gr_comlex array of size 2*d_vector_length) aligned to cache of 16 bytes
      */
     // todo: do something if posix_memalign fails
-    // Get space for the resampled early / prompt / late local replicas
+    // Get space for the resampled local replica. The taps are views of it,
+    // set by update_local_code()
     if (posix_memalign((void**)&d_very_early_code, 16, d_vector_length * sizeof(gr_complex) * 2) == 0){};
-    if (posix_memalign((void**)&d_early_code, 16, d_vector_length * sizeof(gr_complex) * 2) == 0){};
-    if (posix_memalign((void**)&d_prompt_code, 16, d_vector_length * sizeof(gr_complex) * 2) == 0){};
-    if (posix_memalign((void**)&d_late_code, 16, d_vector_length * sizeof(gr_complex) * 2) == 0){};
-    if (posix_memalign((void**)&d_very_late_code, 16, d_vector_length * sizeof(gr_complex) * 2) == 0){};
-    // space for carrier wipeoff and signal baseband vectors
-    if (posix_memalign((void**)&d_carr_sign, 16, d_vector_length * sizeof(gr_complex) * 2) == 0){};
+    d_early_code = d_very_early_code;
+    d_prompt_code = d_very_early_code;
+    d_late_code = d_very_early_code;
+    d_very_late_code = d_very_early_code;
+    // space for carrier wipeoff and signal baseband vectors, aligned as the input windows
+    if (posix_memalign((void**)&d_carr_sign, Tracking_Window::alignment(), d_vector_length * sizeof(gr_complex) * 2) == 0){};
     // correlator outputs (scalar)
     if (posix_memalign((void**)&d_Very_Early, 16, sizeof(gr_complex)) == 0){};
     if (posix_memalign((void**)&d_Early, 16, sizeof(gr_complex)) == 0){};
@@ -146,6 +156,20 @@ galileo_e1_dll_pll_veml_tracking_cc::galileo_e1_dll_pll_veml_tracking_cc(
     if (posix_memalign((void**)&d_Late, 16, sizeof(gr_complex)) == 0){};
     if (posix_memalign((void**)&d_Very_Late, 16, sizeof(gr_complex)) == 0){};
 
+    // packed code replicas of the epochs, for the bit-packed correlator
+    d_bit_packed_correlator = bit_packed_correlator;
+    int packed_words = code_replica_packed_words(2 * d_vector_length);
+    d_packed_code.resize(5 * packed_words);
+    for (int tap = 0; tap < 5; tap++)
+        {
+            d_packed_code_taps[tap] = &d_packed_code[tap * packed_words];
+        }
+    if (d_bit_packed_correlator == true)
+        {
+            d_correlator.set_bit_packed(2 * d_vector_length, magnitude_threshold);
+            LOG(INFO) << "Bit-packed correlator, " << (magnitude_threshold > 0 ? "2-bit" : "1-bit") << " samples";
+        }
+
     //--- Initializations ------------------------------
     // Initial code frequency basis of NCO
     d_code_freq_chips = Galileo_E1_CODE_CHIP_RATE_HZ;
@@ -167,7 +191,6 @@ galileo_e1_dll_pll_veml_tracking_cc::galileo_e1_dll_pll_veml_tracking_cc(
 
     // CN0 estimation and lock detector buffers
     d_cn0_estimation_counter = 0;
-    d_Prompt_buffer = new gr_complex[CN0_ESTIMATION_SAMPLES];
     d_carrier_lock_test = 1;
     d_CN0_SNV_dB_Hz = 0;
     d_carrier_lock_fail_counter = 0;
@@ -205,6 +228,8 @@ void galileo_e1_dll_pll_veml_tracking_cc::start_tracking()
     d_ca_code[(int)(2*Galileo_E1_B_CODE_LENGTH_CHIPS + 3)] = d_ca_code[3];
 
     d_carrier_lock_fail_counter = 0;
+    d_cn0_estimation_counter = 0;
+    d_lock_detector.reset();
     d_rem_code_phase_samples = 0.0;
     d_rem_carr_phase_rad = 0;
     d_acc_carrier_phase_rad = 0;
@@ -233,7 +258,6 @@ void galileo_e1_dll_pll_veml_tracking_cc::update_local_code()
 {
     double tcode_half_chips;
     float rem_code_phase_half_chips;
-    int associated_chip_index;
     int code_length_half_chips = (int)(2*Galileo_E1_B_CODE_LENGTH_CHIPS);
     double code_phase_step_chips;
     double code_phase_step_half_chips;
@@ -251,32 +275,43 @@ void galileo_e1_dll_pll_veml_tracking_cc::update_local_code()
     early_late_spc_samples = round(d_early_late_spc_chips / code_phase_step_chips);
     very_early_late_spc_samples = round(d_very_early_late_spc_chips / code_phase_step_chips);
 
-    epl_loop_length_samples = d_current_prn_length_samples + very_early_late_spc_samples*2;
+    // the replica covers the whole input window, starting at its first (lead) sample
+    epl_loop_length_samples = d_window.length() + very_early_late_spc_samples*2;
 
-    for (int i = 0; i < epl_loop_length_samples; i++)
+    code_replica_gen(d_very_early_code, &d_ca_code[2], code_length_half_chips,
+            tcode_half_chips - 2*d_very_early_late_spc_chips - d_window.lead()*code_phase_step_half_chips,
+            code_phase_step_half_chips, epl_loop_length_samples);
+    d_early_code = &d_very_early_code[very_early_late_spc_samples - early_late_spc_samples];
+    d_prompt_code = &d_very_early_code[very_early_late_spc_samples];
+    d_late_code = &d_very_early_code[very_early_late_spc_samples + early_late_spc_samples];
+    d_very_late_code = &d_very_early_code[2*very_early_late_spc_samples];
+}
+
+void galileo_e1_dll_pll_veml_tracking_cc::update_local_code_packed()
+{
+    int code_length_half_chips = (int)(2*Galileo_E1_B_CODE_LENGTH_CHIPS);
+    double code_phase_step_half_chips = (2.0*(double)d_code_freq_chips) / ((double)d_fs_in);
+    double tcode_half_chips = -(double)d_rem_code_phase_samples * (2*d_code_freq_chips / d_fs_in);
+    double spc_half_chips[5] = { -2*d_very_early_late_spc_chips, -2*d_early_late_spc_chips, 0.0,
+            2*d_early_late_spc_chips, 2*d_very_early_late_spc_chips };
+
+    // the packed replicas start at the first sample of the epoch, not of the window
+    for (int tap = 0; tap < 5; tap++)
         {
-            associated_chip_index = 2 + round(fmod(tcode_half_chips - 2*d_very_early_late_spc_chips, code_length_half_chips));
-            d_very_early_code[i] = d_ca_code[associated_chip_index];
-            tcode_half_chips = tcode_half_chips + code_phase_step_half_chips;
+            code_replica_gen_packed(d_packed_code_taps[tap], &d_ca_code[2], code_length_half_chips,
+                    tcode_half_chips + spc_half_chips[tap], code_phase_step_half_chips, d_current_prn_length_samples);
         }
-    memcpy(d_early_code, &d_very_early_code[very_early_late_spc_samples - early_late_spc_samples], d_current_prn_length_samples* sizeof(gr_complex));
-    memcpy(d_prompt_code, &d_very_early_code[very_early_late_spc_samples], d_current_prn_length_samples* sizeof(gr_complex));
-    memcpy(d_late_code, &d_very_early_code[very_early_late_spc_samples + early_late_spc_samples], d_current_prn_length_samples* sizeof(gr_complex));
-    memcpy(d_very_late_code, &d_very_early_code[2*very_early_late_spc_samples], d_current_prn_length_samples* sizeof(gr_complex));
 }
 
 void galileo_e1_dll_pll_veml_tracking_cc::update_local_carrier()
 {
-    float phase_rad, phase_step_rad;
+    float phase_step_rad;
     // Compute the carrier phase step for the K-1 carrier doppler estimation
     phase_step_rad = (float)GPS_TWO_PI*d_carrier_doppler_hz / (float)d_fs_in;
-    // Initialize the carrier phase with the remanent carrier phase of the K-2 loop
-    phase_rad = d_rem_carr_phase_rad;
-    for(int i = 0; i < d_current_prn_length_samples; i++)
-        {
-            d_carr_sign[i] = gr_complex(cos(phase_rad), -sin(phase_rad));
-            phase_rad += phase_step_rad;
-        }
+    // Start from the remanent carrier phase of the K-2 loop
+    rotator_nco(&d_carr_sign[d_window.lead()], d_current_prn_length_samples, d_rem_carr_phase_rad, phase_step_rad);
+    // the samples of the window out of the epoch do not contribute to the correlations
+    d_window.clear_padding(d_carr_sign);
 }
 
 galileo_e1_dll_pll_veml_tracking_cc::~galileo_e1_dll_pll_veml_tracking_cc()
@@ -284,10 +319,6 @@ galileo_e1_dll_pll_veml_tracking_cc::~galileo_e1_dll_pll_veml_tracking_cc()
     d_dump_file.close();
 
     free(d_very_early_code);
-    free(d_early_code);
-    free(d_prompt_code);
-    free(d_late_code);
-    free(d_very_late_code);
     free(d_carr_sign);
     free(d_Very_Early);
     free(d_Early);
@@ -296,7 +327,6 @@ galileo_e1_dll_pll_veml_tracking_cc::~galileo_e1_dll_pll_veml_tracking_cc()
     free(d_Very_Late);
 
     delete[] d_ca_code;
-    delete[] d_Prompt_buffer;
 }
 
 
@@ -333,29 +363,50 @@ int galileo_e1_dll_pll_veml_tracking_cc::general_work (int noutput_items,gr_vect
             // Fill the acquisition data
             current_synchro_data = *d_acquisition_gnss_synchro;
 
-            // Block input data and block output stream pointers
-            const gr_complex* in = (gr_complex*) input_items[0];
+            // Block output stream pointer. The input is read through an aligned window
+            // that contains the samples of the epoch
             Gnss_Synchro **out = (Gnss_Synchro **) &output_items[0];
+            d_window.set((gr_complex*) input_items[0], d_current_prn_length_samples);
 
-            // Generate local code and carrier replicas (using \hat{f}_d(k-1))
-            update_local_code();
-            update_local_carrier();
-
-            // perform carrier wipe-off and compute Very Early, Early, Prompt, Late and Very Late correlation
-            d_correlator.Carrier_wipeoff_and_VEPL_volk(d_current_prn_length_samples,
-                    in,
-                    d_carr_sign,
-                    d_very_early_code,
-                    d_early_code,
-                    d_prompt_code,
-                    d_late_code,
-                    d_very_late_code,
-                    d_Very_Early,
-                    d_Early,
-                    d_Prompt,
-                    d_Late,
-                    d_Very_Late,
-                    is_unaligned());
+            if (d_bit_packed_correlator == true)
+                {
+                    // Generate the packed local code replicas (using \hat{f}_d(k-1)), and perform carrier
+                    // wipe-off and compute Very Early, Early, Prompt, Late and Very Late correlation on the packed epoch
+                    update_local_code_packed();
+                    gr_complex veml[5];
+                    d_correlator.Carrier_wipeoff_and_multicorrelator_packed(d_current_prn_length_samples,
+                            d_window.data() + d_window.lead(),
+                            d_rem_carr_phase_rad,
+                            GPS_TWO_PI * (double)d_carrier_doppler_hz / (double)d_fs_in,
+                            5, d_packed_code_taps, veml);
+                    *d_Very_Early = veml[0];
+                    *d_Early = veml[1];
+                    *d_Prompt = veml[2];
+                    *d_Late = veml[3];
+                    *d_Very_Late = veml[4];
+                }
+            else
+                {
+                    // Generate local code and carrier replicas (using \hat{f}_d(k-1))
+                    update_local_code();
+                    update_local_carrier();
+
+                    // perform carrier wipe-off and compute Very Early, Early, Prompt, Late and Very Late correlation
+                    d_correlator.Carrier_wipeoff_and_VEPL_volk(d_window.length(),
+                            d_window.data(),
+                            d_carr_sign,
+                            d_very_early_code,
+                            d_early_code,
+                            d_prompt_code,
+                            d_late_code,
+                            d_very_late_code,
+                            d_Very_Early,
+                            d_Early,
+                            d_Prompt,
+                            d_Late,
+                            d_Very_Late,
+                            is_unaligned());
+                }
 
             // ################## PLL ##########################################################
             // PLL discriminator
@@ -398,22 +449,17 @@ int galileo_e1_dll_pll_veml_tracking_cc::general_work (int noutput_items,gr_vect
             d_rem_code_phase_samples = K_blk_samples - d_current_prn_length_samples; //rounding error < 1 sample
 
             // ####### CN0 ESTIMATION AND LOCK DETECTORS ######
-            if (d_cn0_estimation_counter < CN0_ESTIMATION_SAMPLES)
-                {
-                    // fill buffer with prompt correlator output values
-                    d_Prompt_buffer[d_cn0_estimation_counter] = *d_Prompt;
-                    d_cn0_estimation_counter++;
-                }
-            else
+            d_lock_detector.update((*d_Prompt).real(), (*d_Prompt).imag());
+            d_cn0_estimation_counter++;
+            // The indicators are evaluated once per window of CN0_ESTIMATION_SAMPLES epochs,
+            // and the lock fail counter counts these windows
+            if (d_cn0_estimation_counter >= CN0_ESTIMATION_SAMPLES and d_lock_detector.full() == true)
                 {
                     d_cn0_estimation_counter = 0;
-
-                    // Code lock indicator
-                    d_CN0_SNV_dB_Hz = cn0_svn_estimator(d_Prompt_buffer, CN0_ESTIMATION_SAMPLES, d_fs_in, Galileo_E1_B_CODE_LENGTH_CHIPS);
-
+                    // Code lock indicator, on the last CN0_ESTIMATION_SAMPLES epochs
+                    d_CN0_SNV_dB_Hz = d_lock_detector.cn0_db_hz();
                     // Carrier lock indicator
-                    d_carrier_lock_test = carrier_lock_detector(d_Prompt_buffer, CN0_ESTIMATION_SAMPLES);
-
+                    d_carrier_lock_test = d_lock_detector.carrier_lock();
                     // Loss of lock detection
                     if (d_carrier_lock_test < d_carrier_lock_threshold or d_CN0_SNV_dB_Hz < MINIMUM_VALID_CN0)
                         {
@@ -36,6 +36,8 @@
 #include <queue>
 #include <string>
 #include <map>
+#include <vector>
+#include <stdint.h>
 #include <boost/thread/mutex.hpp>
 #include <boost/thread/thread.hpp>
 #include <gnuradio/block.h>
@@ -45,6 +47,8 @@
 #include "tracking_2nd_DLL_filter.h"
 #include "tracking_2nd_PLL_filter.h"
 #include "correlator.h"
+#include "streaming_lock_detector.h"
+#include "tracking_window.h"
 
 class galileo_e1_dll_pll_veml_tracking_cc;
 
@@ -60,11 +64,16 @@ galileo_e1_dll_pll_veml_make_tracking_cc(long if_freq,
                                    float pll_bw_hz,
                                    float dll_bw_hz,
                                    float early_late_space_chips,
-                                   float very_early_late_space_chips);
+                                   float very_early_late_space_chips,
+                                   bool bit_packed_correlator,
+                                   float magnitude_threshold);
 
 /*!
  * \brief This class implements a code DLL + carrier PLL VEML (Very Early
  *  Minus Late) tracking block for Galileo E1 signals
+ *
+ * With bit_packed_correlator, the samples are correlated as 1-bit or 2-bit
+ * samples with bit-packed replicas (see Correlator::set_bit_packed()).
  */
 class galileo_e1_dll_pll_veml_tracking_cc: public gr::block
 {
@@ -97,7 +106,9 @@ private:
             float pll_bw_hz,
             float dll_bw_hz,
             float early_late_space_chips,
-            float very_early_late_space_chips);
+            float very_early_late_space_chips,
+            bool bit_packed_correlator,
+            float magnitude_threshold);
 
     galileo_e1_dll_pll_veml_tracking_cc(long if_freq,
             long fs_in, unsigned
@@ -108,10 +119,14 @@ private:
             float pll_bw_hz,
             float dll_bw_hz,
             float early_late_space_chips,
-            float very_early_late_space_chips);
+            float very_early_late_space_chips,
+            bool bit_packed_correlator,
+            float magnitude_threshold);
 
     void update_local_code();
 
+    void update_local_code_packed();
+
     void update_local_carrier();
 
     // tracking configuration vars
@@ -158,6 +173,12 @@ private:
 
     // correlator
     Correlator d_correlator;
+    // aligned input window of the current epoch
+    Tracking_Window d_window;
+    // bit-packed version of the correlator, and VE, E, P, L and VL code replicas of the epoch
+    bool d_bit_packed_correlator;
+    std::vector<uint64_t> d_packed_code;
+    uint64_t* d_packed_code_taps[5];
 
     // tracking vars
     float d_code_freq_chips;
@@ -174,7 +195,7 @@ private:
 
     // CN0 estimation and lock detector
     int d_cn0_estimation_counter;
-    gr_complex* d_Prompt_buffer;
+    Streaming_Lock_Detector_32f d_lock_detector;
     float d_carrier_lock_test;
     float d_CN0_SNV_dB_Hz;
     float d_carrier_lock_threshold;
@@ -46,12 +46,14 @@
 #include <glog/logging.h>
 #include "gnss_synchro.h"
 #include "galileo_e1_signal_processing.h"
+#include "code_replica.h"
+#include "nco_lib.h"
 #include "tracking_discriminators.h"
-#include "lock_detectors.h"
 #include "GPS_L1_CA.h"
 #include "Galileo_E1.h"
 #include "control_message_factory.h"
 #include "tcp_communication.h"
+#include "tcp_tracking_transport.h"
 #include "tcp_packet_data.h"
 
 /*!
@@ -75,10 +77,12 @@ galileo_e1_tcp_connector_tracking_cc_sptr galileo_e1_tcp_connector_make_tracking
         float dll_bw_hz,
         float early_late_space_chips,
         float very_early_late_space_chips,
-        size_t port_ch0)
+        size_t port_ch0,
+        int batch_epochs,
+        int pipeline_depth)
 {
     return galileo_e1_tcp_connector_tracking_cc_sptr(new Galileo_E1_Tcp_Connector_Tracking_cc(if_freq,
-            fs_in, vector_length, queue, dump, dump_filename, pll_bw_hz, dll_bw_hz, early_late_space_chips, very_early_late_space_chips, port_ch0));
+            fs_in, vector_length, queue, dump, dump_filename, pll_bw_hz, dll_bw_hz, early_late_space_chips, very_early_late_space_chips, port_ch0, batch_epochs, pipeline_depth));
 }
 
 
@@ -100,9 +104,12 @@ Galileo_E1_Tcp_Connector_Tracking_cc::Galileo_E1_Tcp_Connector_Tracking_cc(
         float dll_bw_hz,
         float early_late_space_chips,
         float very_early_late_space_chips,
-        size_t port_ch0):
+        size_t port_ch0,
+        int batch_epochs,
+        int pipeline_depth):
         gr::block("Galileo_E1_Tcp_Connector_Tracking_cc", gr::io_signature::make(1, 1, sizeof(gr_complex)),
-                gr::io_signature::make(1, 1, sizeof(Gnss_Synchro)))
+                gr::io_signature::make(1, 1, sizeof(Gnss_Synchro))),
+        d_lock_detector(CN0_ESTIMATION_SAMPLES, fs_in, Galileo_E1_B_CODE_LENGTH_CHIPS)
 {
     this->set_relative_rate(1.0/vector_length);
     // initialize internal vars
@@ -120,6 +127,10 @@ Galileo_E1_Tcp_Connector_Tracking_cc::Galileo_E1_Tcp_Connector_Tracking_cc(
 
     //--- TCP CONNECTOR variables --------------------------------------------------------
     d_port_ch0 = port_ch0;
+    d_batch_epochs = batch_epochs;
+    d_pipeline_depth = pipeline_depth;
+    // With the default batch and depth each channel keeps its own connection and the original packets
+    d_legacy_tcp = (batch_epochs <= 1 and pipeline_depth <= 0);
     d_port = 0;
     d_listen_connection = true;
     d_control_id = 0;
@@ -134,12 +145,13 @@ Galileo_E1_Tcp_Connector_Tracking_cc::Galileo_E1_Tcp_Connector_Tracking_cc(
      * (gr_comlex array of size 2*d_vector_length) aligned to cache of 16 bytes
      */
     // todo: do something if posix_memalign fails
-    // Get space for the resampled early / prompt / late local replicas
+    // Get space for the resampled local replica. The taps are views of it,
+    // set by update_local_code()
     if (posix_memalign((void**)&d_very_early_code, 16, d_vector_length * sizeof(gr_complex) * 2) == 0){};
-    if (posix_memalign((void**)&d_early_code, 16, d_vector_length * sizeof(gr_complex) * 2) == 0){};
-    if (posix_memalign((void**)&d_prompt_code, 16, d_vector_length * sizeof(gr_complex) * 2) == 0){};
-    if (posix_memalign((void**)&d_late_code, 16, d_vector_length * sizeof(gr_complex) * 2) == 0){};
-    if (posix_memalign((void**)&d_very_late_code, 16, d_vector_length * sizeof(gr_complex) * 2) == 0){};
+    d_early_code = d_very_early_code;
+    d_prompt_code = d_very_early_code;
+    d_late_code = d_very_early_code;
+    d_very_late_code = d_very_early_code;
     // space for carrier wipeoff and signal baseband vectors
     if (posix_memalign((void**)&d_carr_sign, 16, d_vector_length * sizeof(gr_complex) * 2) == 0){};
     // correlator outputs (scalar)
@@ -169,7 +181,6 @@ Galileo_E1_Tcp_Connector_Tracking_cc::Galileo_E1_Tcp_Connector_Tracking_cc(
 
     // CN0 estimation and lock detector buffers
     d_cn0_estimation_counter = 0;
-    d_Prompt_buffer = new gr_complex[CN0_ESTIMATION_SAMPLES];
     d_carrier_lock_test = 1;
     d_CN0_SNV_dB_Hz = 0;
     d_carrier_lock_fail_counter = 0;
@@ -199,6 +210,8 @@ void Galileo_E1_Tcp_Connector_Tracking_cc::start_tracking()
     d_ca_code[(int)(2*Galileo_E1_B_CODE_LENGTH_CHIPS+3)] = d_ca_code[3];
 
     d_carrier_lock_fail_counter = 0;
+    d_cn0_estimation_counter = 0;
+    d_lock_detector.reset();
     d_rem_code_phase_samples = 0.0;
     d_rem_carr_phase_rad = 0;
     d_acc_carrier_phase_rad = 0;
@@ -216,6 +229,11 @@ void Galileo_E1_Tcp_Connector_Tracking_cc::start_tracking()
 
     // enable tracking
     d_pull_in = true;
+    if (d_transport)
+        {
+            // The responses still in the pipeline are for the previous satellite
+            d_transport->reset_channel(d_channel);
+        }
     d_enable_tracking = true;
 
     LOG(INFO) << "PULL-IN Doppler [Hz]=" << d_carrier_doppler_hz << " PULL-IN Code Phase [samples]=" << d_acq_code_phase_samples;
@@ -226,7 +244,6 @@ void Galileo_E1_Tcp_Connector_Tracking_cc::update_local_code()
 {
     double tcode_half_chips;
     float rem_code_phase_half_chips;
-    int associated_chip_index;
     int code_length_half_chips = (int)(2*Galileo_E1_B_CODE_LENGTH_CHIPS);
     double code_phase_step_chips;
     double code_phase_step_half_chips;
@@ -246,31 +263,22 @@ void Galileo_E1_Tcp_Connector_Tracking_cc::update_local_code()
 
     epl_loop_length_samples = d_current_prn_length_samples + very_early_late_spc_samples*2;
 
-    for (int i = 0; i < epl_loop_length_samples; i++)
-        {
-            associated_chip_index = 2 + round(fmod(tcode_half_chips - 2*d_very_early_late_spc_chips, code_length_half_chips));
-            d_very_early_code[i] = d_ca_code[associated_chip_index];
-            tcode_half_chips = tcode_half_chips + code_phase_step_half_chips;
-        }
-    memcpy(d_early_code, &d_very_early_code[very_early_late_spc_samples - early_late_spc_samples], d_current_prn_length_samples* sizeof(gr_complex));
-    memcpy(d_prompt_code, &d_very_early_code[very_early_late_spc_samples], d_current_prn_length_samples* sizeof(gr_complex));
-    memcpy(d_late_code, &d_very_early_code[2*very_early_late_spc_samples - early_late_spc_samples], d_current_prn_length_samples* sizeof(gr_complex));
-    memcpy(d_very_late_code, &d_very_early_code[2*very_early_late_spc_samples], d_current_prn_length_samples* sizeof(gr_complex));
+    code_replica_gen(d_very_early_code, &d_ca_code[2], code_length_half_chips,
+            tcode_half_chips - 2*d_very_early_late_spc_chips, code_phase_step_half_chips, epl_loop_length_samples);
+    d_early_code = &d_very_early_code[very_early_late_spc_samples - early_late_spc_samples];
+    d_prompt_code = &d_very_early_code[very_early_late_spc_samples];
+    d_late_code = &d_very_early_code[2*very_early_late_spc_samples - early_late_spc_samples];
+    d_very_late_code = &d_very_early_code[2*very_early_late_spc_samples];
 }
 
 
 void Galileo_E1_Tcp_Connector_Tracking_cc::update_local_carrier()
 {
-    float phase_rad, phase_step_rad;
+    float phase_step_rad;
     // Compute the carrier phase step for the K-1 carrier Doppler estimation
     phase_step_rad = (float)GPS_TWO_PI*d_carrier_doppler_hz / (float)d_fs_in;
-    // Initialize the carrier phase with the remnant carrier phase of the K-2 loop
-    phase_rad = d_rem_carr_phase_rad;
-    for(int i = 0; i < d_current_prn_length_samples; i++)
-        {
-            d_carr_sign[i] = gr_complex(cos(phase_rad), -sin(phase_rad));
-            phase_rad += phase_step_rad;
-        }
+    // Start from the remnant carrier phase of the K-2 loop
+    rotator_nco(d_carr_sign, d_current_prn_length_samples, d_rem_carr_phase_rad, phase_step_rad);
 }
 
 
@@ -279,10 +287,6 @@ Galileo_E1_Tcp_Connector_Tracking_cc::~Galileo_E1_Tcp_Connector_Tracking_cc()
     d_dump_file.close();
 
     free(d_very_early_code);
-    free(d_early_code);
-    free(d_prompt_code);
-    free(d_late_code);
-    free(d_very_late_code);
     free(d_carr_sign);
     free(d_Very_Early);
     free(d_Early);
@@ -291,9 +295,11 @@ Galileo_E1_Tcp_Connector_Tracking_cc::~Galileo_E1_Tcp_Connector_Tracking_cc()
     free(d_Very_Late);
 
     delete[] d_ca_code;
-    delete[] d_Prompt_buffer;
 
-    d_tcp_com.close_tcp_connection(d_port);
+    if (d_legacy_tcp == true)
+        {
+            d_tcp_com.close_tcp_connection(d_port);
+        }
 }
 
 
@@ -301,8 +307,8 @@ int Galileo_E1_Tcp_Connector_Tracking_cc::general_work (int noutput_items, gr_ve
         gr_vector_const_void_star &input_items, gr_vector_void_star &output_items)
 {
     // process vars
-    float carr_error_filt_hz;
-    float code_error_filt_chips;
+    float carr_error_filt_hz = 0.0;
+    float code_error_filt_chips = 0.0;
 
     tcp_packet_data tcp_data;
 
@@ -357,7 +363,7 @@ int Galileo_E1_Tcp_Connector_Tracking_cc::general_work (int noutput_items, gr_ve
             //! Variable used for control
             d_control_id++;
 
-            //! Send and receive a TCP packet
+            //! Queue the request of this epoch, and get the response of the epoch pipeline_depth epochs before
             boost::array<float, NUM_TX_VARIABLES_GALILEO_E1> tx_variables_array = {{d_control_id,
                                                                                     (*d_Very_Early).real(),
                                                                                     (*d_Very_Early).imag(),
@@ -371,11 +377,26 @@ int Galileo_E1_Tcp_Connector_Tracking_cc::general_work (int noutput_items, gr_ve
                                                                                     (*d_Prompt).imag(),
                                                                                     d_acq_carrier_doppler_hz,
                                                                                     1}};
-            d_tcp_com.send_receive_tcp_packet_galileo_e1(tx_variables_array, &tcp_data);
+            bool response;
+            if (d_legacy_tcp == true)
+                {
+                    //! Send and receive a TCP packet
+                    d_tcp_com.send_receive_tcp_packet_galileo_e1(tx_variables_array, &tcp_data);
+                    response = true;
+                }
+            else
+                {
+                    response = d_transport->exchange(d_channel, tx_variables_array.data(), NUM_TX_VARIABLES_GALILEO_E1, &tcp_data);
+                }
+            if (response == true)
+                {
+                    carr_error_filt_hz = tcp_data.proc_pack_carr_error;
+                    code_error_filt_chips = tcp_data.proc_pack_code_error;
+                }
+            // else no response is due yet: open loop at the acquisition Doppler
 
             // ################## PLL ##########################################################
             // PLL discriminator, carrier loop filter implementation and NCO command generation (TCP_connector)
-            carr_error_filt_hz = tcp_data.proc_pack_carr_error;
             // New carrier Doppler frequency estimation
             d_carrier_doppler_hz = d_acq_carrier_doppler_hz + carr_error_filt_hz;
             // New code Doppler frequency estimation
@@ -388,7 +409,6 @@ int Galileo_E1_Tcp_Connector_Tracking_cc::general_work (int noutput_items, gr_ve
 
             // ################## DLL ##########################################################
             // DLL discriminator, carrier loop filter implementation and NCO command generation (TCP_connector)
-            code_error_filt_chips = tcp_data.proc_pack_code_error;
             //Code phase accumulator
             float code_error_filt_secs;
             code_error_filt_secs=(Galileo_E1_CODE_PERIOD*code_error_filt_chips)/Galileo_E1_CODE_CHIP_RATE_HZ; //[seconds]
@@ -409,22 +429,17 @@ int Galileo_E1_Tcp_Connector_Tracking_cc::general_work (int noutput_items, gr_ve
             d_rem_code_phase_samples = K_blk_samples - d_current_prn_length_samples; //rounding error < 1 sample
 
             // ####### CN0 ESTIMATION AND LOCK DETECTORS ######
-            if (d_cn0_estimation_counter < CN0_ESTIMATION_SAMPLES)
-                {
-                    // fill buffer with prompt correlator output values
-                    d_Prompt_buffer[d_cn0_estimation_counter] = *d_Prompt;
-                    d_cn0_estimation_counter++;
-                }
-            else
+            d_lock_detector.update((*d_Prompt).real(), (*d_Prompt).imag());
+            d_cn0_estimation_counter++;
+            // The indicators are evaluated once per window of CN0_ESTIMATION_SAMPLES epochs,
+            // and the lock fail counter counts these windows
+            if (d_cn0_estimation_counter >= CN0_ESTIMATION_SAMPLES and d_lock_detector.full() == true)
                 {
                     d_cn0_estimation_counter = 0;
-
-                    // Code lock indicator
-                    d_CN0_SNV_dB_Hz = cn0_svn_estimator(d_Prompt_buffer, CN0_ESTIMATION_SAMPLES, d_fs_in, Galileo_E1_B_CODE_LENGTH_CHIPS);
-
+                    // Code lock indicator, on the last CN0_ESTIMATION_SAMPLES epochs
+                    d_CN0_SNV_dB_Hz = d_lock_detector.cn0_db_hz();
                     // Carrier lock indicator
-                    d_carrier_lock_test = carrier_lock_detector(d_Prompt_buffer, CN0_ESTIMATION_SAMPLES);
-
+                    d_carrier_lock_test = d_lock_detector.carrier_lock();
                     // Loss of lock detection
                     if (d_carrier_lock_test < d_carrier_lock_threshold or d_CN0_SNV_dB_Hz < MINIMUM_VALID_CN0)
                         {
@@ -513,9 +528,13 @@ int Galileo_E1_Tcp_Connector_Tracking_cc::general_work (int noutput_items, gr_ve
             // GNSS_SYNCHRO OBJECT to interchange data between tracking->telemetry_decoder
             *out[0] = *d_acquisition_gnss_synchro;
 
-            //! When tracking is disabled an array of 1's is sent to maintain the TCP connection
-            boost::array<float, NUM_TX_VARIABLES_GALILEO_E1> tx_variables_array = {{1,1,1,1,1,1,1,1,1,1,1,1,0}};
-            d_tcp_com.send_receive_tcp_packet_galileo_e1(tx_variables_array, &tcp_data);
+            //! When tracking is disabled an array of 1's is sent to maintain the TCP connection.
+            //! Nothing is sent on the shared connection
+            if (d_legacy_tcp == true)
+                {
+                    boost::array<float, NUM_TX_VARIABLES_GALILEO_E1> tx_variables_array = {{1,1,1,1,1,1,1,1,1,1,1,1,0}};
+                    d_tcp_com.send_receive_tcp_packet_galileo_e1(tx_variables_array, &tcp_data);
+                }
         }
 
     if(d_dump)
@@ -610,10 +629,18 @@ void Galileo_E1_Tcp_Connector_Tracking_cc::set_channel(unsigned int channel)
         }
 
     //! Listen for connections on a TCP port
-    if (d_listen_connection == true)
+    if (d_legacy_tcp == true)
+        {
+            if (d_listen_connection == true)
+                {
+                    d_port = d_port_ch0 + d_channel;
+                    d_listen_connection = d_tcp_com.listen_tcp_connection(d_port, d_port_ch0);
+                }
+        }
+    //! All the channels share the connection on port_ch0, the first one waits for it
+    else if (!d_transport)
         {
-            d_port = d_port_ch0 + d_channel;
-            d_listen_connection = d_tcp_com.listen_tcp_connection(d_port, d_port_ch0);
+            d_transport = Tcp_Tracking_Transport::shared(d_port_ch0, d_batch_epochs, d_pipeline_depth);
         }
 }
 
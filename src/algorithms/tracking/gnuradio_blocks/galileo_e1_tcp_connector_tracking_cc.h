@@ -50,7 +50,9 @@
 #include "concurrent_queue.h"
 #include "gnss_synchro.h"
 #include "correlator.h"
+#include "streaming_lock_detector.h"
 #include "tcp_communication.h"
+#include "tcp_tracking_transport.h"
 
 
 class Galileo_E1_Tcp_Connector_Tracking_cc;
@@ -68,7 +70,9 @@ galileo_e1_tcp_connector_make_tracking_cc(long if_freq,
                                    float dll_bw_hz,
                                    float early_late_space_chips,
                                    float very_early_late_space_chips,
-                                   size_t port_ch0);
+                                   size_t port_ch0,
+                                   int batch_epochs,
+                                   int pipeline_depth);
 
 /*!
  * \brief This class implements a code DLL + carrier PLL VEML (Very Early
@@ -100,7 +104,9 @@ private:
             float dll_bw_hz,
             float early_late_space_chips,
             float very_early_late_space_chips,
-            size_t port_ch0);
+            size_t port_ch0,
+            int batch_epochs,
+            int pipeline_depth);
 
     Galileo_E1_Tcp_Connector_Tracking_cc(long if_freq,
             long fs_in, unsigned
@@ -112,7 +118,9 @@ private:
             float dll_bw_hz,
             float early_late_space_chips,
             float very_early_late_space_chips,
-            size_t port_ch0);
+            size_t port_ch0,
+            int batch_epochs,
+            int pipeline_depth);
 
     void update_local_code();
 
@@ -167,10 +175,14 @@ private:
     float d_acc_code_phase_secs;
     float d_code_phase_samples;
     size_t d_port_ch0;
+    int d_batch_epochs;
+    int d_pipeline_depth;
+    float d_control_id;
+    bool d_legacy_tcp;
     size_t d_port;
     int d_listen_connection;
-    float d_control_id;
     tcp_communication d_tcp_com;
+    tcp_tracking_transport_sptr d_transport;
 
     //PRN period in samples
     int d_current_prn_length_samples;
@@ -183,7 +195,7 @@ private:
 
     // CN0 estimation and lock detector
     int d_cn0_estimation_counter;
-    gr_complex* d_Prompt_buffer;
+    Streaming_Lock_Detector_32f d_lock_detector;
     float d_carrier_lock_test;
     float d_CN0_SNV_dB_Hz;
     float d_carrier_lock_threshold;
@@ -44,8 +44,9 @@
 #include "gnss_synchro.h"
 #include "gps_sdr_signal_processing.h"
 #include "GPS_L1_CA.h"
+#include "code_replica.h"
+#include "nco_lib.h"
 #include "tracking_discriminators.h"
-#include "lock_detectors.h"
 #include "tracking_FLL_PLL_filter.h"
 #include "control_message_factory.h"
 #include "gnss_flowgraph.h"
@@ -101,7 +102,8 @@ Gps_L1_Ca_Dll_Fll_Pll_Tracking_cc::Gps_L1_Ca_Dll_Fll_Pll_Tracking_cc(
         float dll_bw_hz,
         float early_late_space_chips) :
         gr::block("Gps_L1_Ca_Dll_Fll_Pll_Tracking_cc", gr::io_signature::make(1, 1, sizeof(gr_complex)),
-                gr::io_signature::make(1, 1, sizeof(Gnss_Synchro)))
+                gr::io_signature::make(1, 1, sizeof(Gnss_Synchro))),
+        d_lock_detector(CN0_ESTIMATION_SAMPLES, fs_in, GPS_L1_CA_CODE_LENGTH_CHIPS)
 {
     // initialize internal vars
     d_queue = queue;
@@ -130,10 +132,11 @@ Gps_L1_Ca_Dll_Fll_Pll_Tracking_cc::Gps_L1_Ca_Dll_Fll_Pll_Tracking_cc(
      * (gr_comlex array of size 2*d_vector_length) aligned to cache of 16 bytes
      */
     // todo: do something if posix_memalign fails
-    // Get space for the resampled early / prompt / late local replicas
+    // Get space for the resampled local replica. The taps are views of it,
+    // set by update_local_code()
     if (posix_memalign((void**)&d_early_code, 16, d_vector_length * sizeof(gr_complex) * 2) == 0){};
-    if (posix_memalign((void**)&d_late_code, 16, d_vector_length * sizeof(gr_complex) * 2) == 0){};
-    if (posix_memalign((void**)&d_prompt_code, 16, d_vector_length * sizeof(gr_complex) * 2) == 0){};
+    d_prompt_code = d_early_code;
+    d_late_code = d_early_code;
     // space for carrier wipeoff and signal baseband vectors
     if (posix_memalign((void**)&d_carr_sign, 16, d_vector_length * sizeof(gr_complex) * 2) == 0){};
     if (posix_memalign((void**)&d_Early, 16, sizeof(gr_complex)) == 0){};
@@ -150,7 +153,6 @@ Gps_L1_Ca_Dll_Fll_Pll_Tracking_cc::Gps_L1_Ca_Dll_Fll_Pll_Tracking_cc(
 
     // CN0 estimation and lock detector buffers
     d_cn0_estimation_counter = 0;
-    d_Prompt_buffer = new gr_complex[CN0_ESTIMATION_SAMPLES];
     d_carrier_lock_test = 1;
     d_CN0_SNV_dB_Hz = 0;
     d_carrier_lock_fail_counter = 0;
@@ -221,6 +223,8 @@ void Gps_L1_Ca_Dll_Fll_Pll_Tracking_cc::start_tracking()
     d_ca_code[(int)GPS_L1_CA_CODE_LENGTH_CHIPS + 1] = d_ca_code[1];
 
     d_carrier_lock_fail_counter = 0;
+    d_cn0_estimation_counter = 0;
+    d_lock_detector.reset();
     d_Prompt_prev = 0;
     d_rem_code_phase_samples = 0;
     d_rem_carr_phase = 0;
@@ -256,7 +260,6 @@ void Gps_L1_Ca_Dll_Fll_Pll_Tracking_cc::update_local_code()
     int early_late_spc_samples;
     int epl_loop_length_samples;
 
-    int associated_chip_index;
     int code_length_chips = (int)GPS_L1_CA_CODE_LENGTH_CHIPS;
     code_phase_step_chips = d_code_freq_hz / d_fs_in;
     rem_code_phase_chips = d_rem_code_phase_samples * (d_code_freq_hz / d_fs_in);
@@ -265,15 +268,10 @@ void Gps_L1_Ca_Dll_Fll_Pll_Tracking_cc::update_local_code()
     // Alternative EPL code generation (40% of speed improvement!)
     early_late_spc_samples = round(d_early_late_spc_chips/code_phase_step_chips);
     epl_loop_length_samples = d_current_prn_length_samples + early_late_spc_samples*2;
-    for (int i = 0; i < epl_loop_length_samples; i++)
-        {
-            associated_chip_index = 1 + round(fmod(tcode_chips - d_early_late_spc_chips, code_length_chips));
-            d_early_code[i] = d_ca_code[associated_chip_index];
-            tcode_chips = tcode_chips + code_phase_step_chips;
-        }
-
-    memcpy(d_prompt_code,&d_early_code[early_late_spc_samples],d_current_prn_length_samples* sizeof(gr_complex));
-    memcpy(d_late_code,&d_early_code[early_late_spc_samples*2],d_current_prn_length_samples* sizeof(gr_complex));
+    code_replica_gen(d_early_code, &d_ca_code[1], code_length_chips,
+            tcode_chips - d_early_late_spc_chips, code_phase_step_chips, epl_loop_length_samples);
+    d_prompt_code = &d_early_code[early_late_spc_samples];
+    d_late_code = &d_early_code[early_late_spc_samples*2];
 
     //    for (int i=0; i<d_current_prn_length_samples; i++)
     //        {
@@ -295,12 +293,8 @@ void Gps_L1_Ca_Dll_Fll_Pll_Tracking_cc::update_local_carrier()
 {
     double phase, phase_step;
     phase_step = GPS_TWO_PI * d_carrier_doppler_hz / d_fs_in;
-    phase = d_rem_carr_phase;
-    for(int i = 0; i < d_current_prn_length_samples; i++)
-        {
-            d_carr_sign[i] = gr_complex(cos(phase), -sin(phase));
-            phase += phase_step;
-        }
+    rotator_nco(d_carr_sign, d_current_prn_length_samples, d_rem_carr_phase, phase_step);
+    phase = d_rem_carr_phase + (double)d_current_prn_length_samples * phase_step;
     d_rem_carr_phase = fmod(phase, GPS_TWO_PI);
     d_acc_carrier_phase_rad = d_acc_carrier_phase_rad + phase;
 }
@@ -312,14 +306,11 @@ Gps_L1_Ca_Dll_Fll_Pll_Tracking_cc::~Gps_L1_Ca_Dll_Fll_Pll_Tracking_cc()
     d_dump_file.close();
     delete[] d_ca_code;
 
-    free(d_prompt_code);
-    free(d_late_code);
     free(d_early_code);
     free(d_carr_sign);
     free(d_Early);
     free(d_Prompt);
     free(d_Late);
-    delete[] d_Prompt_buffer;
 }
 
 
@@ -448,19 +439,17 @@ int Gps_L1_Ca_Dll_Fll_Pll_Tracking_cc::general_work (int noutput_items, gr_vecto
              * \todo Improve the lock detection algorithm!
              */
             // ####### CN0 ESTIMATION AND LOCK DETECTORS ######
-            if (d_cn0_estimation_counter < CN0_ESTIMATION_SAMPLES)
-                {
-                    // fill buffer with prompt correlator output values
-                    d_Prompt_buffer[d_cn0_estimation_counter] = *d_Prompt;
-                    d_cn0_estimation_counter++;
-                }
-            else
+            d_lock_detector.update((*d_Prompt).real(), (*d_Prompt).imag());
+            d_cn0_estimation_counter++;
+            // The indicators are evaluated once per window of CN0_ESTIMATION_SAMPLES epochs,
+            // and the lock fail counter counts these windows
+            if (d_cn0_estimation_counter >= CN0_ESTIMATION_SAMPLES and d_lock_detector.full() == true)
                 {
                     d_cn0_estimation_counter = 0;
-                    //d_CN0_SNV_dB_Hz = gps_l1_ca_CN0_SNV(d_Prompt_buffer, CN0_ESTIMATION_SAMPLES, d_fs_in);
-                    d_CN0_SNV_dB_Hz = cn0_svn_estimator(d_Prompt_buffer, CN0_ESTIMATION_SAMPLES, d_fs_in, GPS_L1_CA_CODE_LENGTH_CHIPS);
-
-                    d_carrier_lock_test = carrier_lock_detector(d_Prompt_buffer, CN0_ESTIMATION_SAMPLES);
+                    // Code lock indicator, on the last CN0_ESTIMATION_SAMPLES epochs
+                    d_CN0_SNV_dB_Hz = d_lock_detector.cn0_db_hz();
+                    // Carrier lock indicator
+                    d_carrier_lock_test = d_lock_detector.carrier_lock();
                     // ###### TRACKING UNLOCK NOTIFICATION #####
                     if (d_carrier_lock_test < d_carrier_lock_threshold or d_CN0_SNV_dB_Hz < MINIMUM_VALID_CN0)
                         {
@@ -51,6 +51,7 @@
 #include "tracking_2nd_DLL_filter.h"
 #include "gnss_synchro.h"
 #include "correlator.h"
+#include "streaming_lock_detector.h"
 
 class Gps_L1_Ca_Dll_Fll_Pll_Tracking_cc;
 
@@ -190,7 +191,7 @@ private:
 
     // CN0 estimation and lock detector
     int d_cn0_estimation_counter;
-    gr_complex* d_Prompt_buffer;
+    Streaming_Lock_Detector_64f d_lock_detector;
     double d_carrier_lock_test;
     double d_CN0_SNV_dB_Hz;
 
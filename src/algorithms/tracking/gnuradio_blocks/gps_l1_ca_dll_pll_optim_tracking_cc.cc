@@ -42,8 +42,8 @@
 #include <glog/logging.h>
 #include "gnss_synchro.h"
 #include "gps_sdr_signal_processing.h"
+#include "code_replica.h"
 #include "tracking_discriminators.h"
-#include "lock_detectors.h"
 #include "GPS_L1_CA.h"
 #include "nco_lib.h"
 #include "control_message_factory.h"
@@ -98,7 +98,8 @@ Gps_L1_Ca_Dll_Pll_Optim_Tracking_cc::Gps_L1_Ca_Dll_Pll_Optim_Tracking_cc(
         float early_late_space_chips) :
         gr::block("Gps_L1_Ca_Dll_Pll_Tracking_cc",
                   gr::io_signature::make(1, 1, sizeof(gr_complex)),
-                  gr::io_signature::make(1, 1, sizeof(Gnss_Synchro)))
+                  gr::io_signature::make(1, 1, sizeof(Gnss_Synchro))),
+        d_lock_detector(CN0_ESTIMATION_SAMPLES, fs_in, GPS_L1_CA_CODE_LENGTH_CHIPS)
 {
     // initialize internal vars
     d_queue = queue;
@@ -127,10 +128,11 @@ Gps_L1_Ca_Dll_Pll_Optim_Tracking_cc::Gps_L1_Ca_Dll_Pll_Optim_Tracking_cc(
      */
 
     // todo: do something if posix_memalign fails
-    // Get space for the resampled early / prompt / late local replicas
+    // Get space for the resampled local replica. The taps are views of it,
+    // set by update_local_code()
     if (posix_memalign((void**)&d_early_code, 16, d_vector_length * sizeof(gr_complex) * 2) == 0){};
-    if (posix_memalign((void**)&d_late_code, 16, d_vector_length * sizeof(gr_complex) * 2) == 0){};
-    if (posix_memalign((void**)&d_prompt_code, 16, d_vector_length * sizeof(gr_complex) * 2) == 0){};
+    d_prompt_code = d_early_code;
+    d_late_code = d_early_code;
     // space for carrier wipeoff and signal baseband vectors
     if (posix_memalign((void**)&d_carr_sign, 16, d_vector_length * sizeof(gr_complex) * 2) == 0){};
     if (posix_memalign((void**)&d_Early, 16, sizeof(gr_complex)) == 0){};
@@ -158,7 +160,6 @@ Gps_L1_Ca_Dll_Pll_Optim_Tracking_cc::Gps_L1_Ca_Dll_Pll_Optim_Tracking_cc(
 
     // CN0 estimation and lock detector buffers
     d_cn0_estimation_counter = 0;
-    d_Prompt_buffer = new gr_complex[CN0_ESTIMATION_SAMPLES];
     d_carrier_lock_test = 1;
     d_CN0_SNV_dB_Hz = 0;
     d_carrier_lock_fail_counter = 0;
@@ -227,7 +228,6 @@ void Gps_L1_Ca_Dll_Pll_Optim_Tracking_cc::start_tracking()
     // Experimental: pre-sampled local signal replica at nominal code frequency.
     // No code doppler correction
     double tcode_chips;
-    int associated_chip_index;
     int code_length_chips = (int)GPS_L1_CA_CODE_LENGTH_CHIPS;
     double code_phase_step_chips;
     int early_late_spc_samples;
@@ -240,18 +240,15 @@ void Gps_L1_Ca_Dll_Pll_Optim_Tracking_cc::start_tracking()
     // Alternative EPL code generation (40% of speed improvement!)
     early_late_spc_samples = round(d_early_late_spc_chips / code_phase_step_chips);
     epl_loop_length_samples = d_current_prn_length_samples  +early_late_spc_samples*2;
-    for (int i = 0; i < epl_loop_length_samples; i++)
-        {
-            associated_chip_index = 1 + round(fmod(tcode_chips - d_early_late_spc_chips, code_length_chips));
-            d_early_code[i] = d_ca_code[associated_chip_index];
-            tcode_chips = tcode_chips + code_phase_step_chips;
-        }
-
-    memcpy(d_prompt_code, &d_early_code[early_late_spc_samples], d_current_prn_length_samples* sizeof(gr_complex));
-    memcpy(d_late_code, &d_early_code[early_late_spc_samples*2], d_current_prn_length_samples* sizeof(gr_complex));
+    code_replica_gen(d_early_code, &d_ca_code[1], code_length_chips,
+            tcode_chips - d_early_late_spc_chips, code_phase_step_chips, epl_loop_length_samples);
+    d_prompt_code = &d_early_code[early_late_spc_samples];
+    d_late_code = &d_early_code[early_late_spc_samples*2];
     //******************************************************************************
 
     d_carrier_lock_fail_counter = 0;
+    d_cn0_estimation_counter = 0;
+    d_lock_detector.reset();
     d_rem_code_phase_samples = 0;
     d_rem_carr_phase_rad = 0;
     d_acc_carrier_phase_rad = 0;
@@ -280,7 +277,6 @@ void Gps_L1_Ca_Dll_Pll_Optim_Tracking_cc::update_local_code()
 {
     double tcode_chips;
     double rem_code_phase_chips;
-    int associated_chip_index;
     int code_length_chips = (int)GPS_L1_CA_CODE_LENGTH_CHIPS;
     double code_phase_step_chips;
     int early_late_spc_samples;
@@ -294,15 +290,10 @@ void Gps_L1_Ca_Dll_Pll_Optim_Tracking_cc::update_local_code()
     //EPL code generation
     early_late_spc_samples = round(d_early_late_spc_chips / code_phase_step_chips);
     epl_loop_length_samples = d_current_prn_length_samples + early_late_spc_samples*2;
-    for (int i = 0; i < epl_loop_length_samples; i++)
-        {
-            associated_chip_index = 1 + round(fmod(tcode_chips - d_early_late_spc_chips, code_length_chips));
-            d_early_code[i] = d_ca_code[associated_chip_index];
-            tcode_chips = tcode_chips + code_phase_step_chips;
-        }
-
-    memcpy(d_prompt_code, &d_early_code[early_late_spc_samples], d_current_prn_length_samples* sizeof(gr_complex));
-    memcpy(d_late_code, &d_early_code[early_late_spc_samples*2], d_current_prn_length_samples* sizeof(gr_complex));
+    code_replica_gen(d_early_code, &d_ca_code[1], code_length_chips,
+            tcode_chips - d_early_late_spc_chips, code_phase_step_chips, epl_loop_length_samples);
+    d_prompt_code = &d_early_code[early_late_spc_samples];
+    d_late_code = &d_early_code[early_late_spc_samples*2];
 }
 
 
@@ -310,7 +301,7 @@ void Gps_L1_Ca_Dll_Pll_Optim_Tracking_cc::update_local_carrier()
 {
     float phase_step_rad;
     phase_step_rad = (float)GPS_TWO_PI*d_carrier_doppler_hz / (float)d_fs_in;
-    fxp_nco(d_carr_sign, d_current_prn_length_samples, d_rem_carr_phase_rad, phase_step_rad);
+    rotator_nco(d_carr_sign, d_current_prn_length_samples, d_rem_carr_phase_rad, phase_step_rad);
     //sse_nco(d_carr_sign, d_current_prn_length_samples,d_rem_carr_phase_rad, phase_step_rad);
 }
 
@@ -319,8 +310,6 @@ Gps_L1_Ca_Dll_Pll_Optim_Tracking_cc::~Gps_L1_Ca_Dll_Pll_Optim_Tracking_cc()
 {
     d_dump_file.close();
 
-    free(d_prompt_code);
-    free(d_late_code);
     free(d_early_code);
     free(d_carr_sign);
     free(d_Early);
@@ -328,7 +317,6 @@ Gps_L1_Ca_Dll_Pll_Optim_Tracking_cc::~Gps_L1_Ca_Dll_Pll_Optim_Tracking_cc()
     free(d_Late);
 
     delete[] d_ca_code;
-    delete[] d_Prompt_buffer;
 }
 
 
@@ -426,19 +414,17 @@ int Gps_L1_Ca_Dll_Pll_Optim_Tracking_cc::general_work (int noutput_items, gr_vec
             d_rem_code_phase_samples = K_blk_samples - d_current_prn_length_samples; //rounding error < 1 sample
 
             // ####### CN0 ESTIMATION AND LOCK DETECTORS ######
-            if (d_cn0_estimation_counter < CN0_ESTIMATION_SAMPLES)
-                {
-                    // fill buffer with prompt correlator output values
-                    d_Prompt_buffer[d_cn0_estimation_counter] = *d_Prompt;
-                    d_cn0_estimation_counter++;
-                }
-            else
+            d_lock_detector.update((*d_Prompt).real(), (*d_Prompt).imag());
+            d_cn0_estimation_counter++;
+            // The indicators are evaluated once per window of CN0_ESTIMATION_SAMPLES epochs,
+            // and the lock fail counter counts these windows
+            if (d_cn0_estimation_counter >= CN0_ESTIMATION_SAMPLES and d_lock_detector.full() == true)
                 {
                     d_cn0_estimation_counter = 0;
-                    // Code lock indicator
-                    d_CN0_SNV_dB_Hz = cn0_svn_estimator(d_Prompt_buffer, CN0_ESTIMATION_SAMPLES, d_fs_in, GPS_L1_CA_CODE_LENGTH_CHIPS);
+                    // Code lock indicator, on the last CN0_ESTIMATION_SAMPLES epochs
+                    d_CN0_SNV_dB_Hz = d_lock_detector.cn0_db_hz();
                     // Carrier lock indicator
-                    d_carrier_lock_test = carrier_lock_detector(d_Prompt_buffer, CN0_ESTIMATION_SAMPLES);
+                    d_carrier_lock_test = d_lock_detector.carrier_lock();
                     // Loss of lock detection
                     if (d_carrier_lock_test < d_carrier_lock_threshold or d_CN0_SNV_dB_Hz < MINIMUM_VALID_CN0)
                         {
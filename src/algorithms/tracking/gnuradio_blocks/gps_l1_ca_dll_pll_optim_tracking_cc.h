@@ -51,6 +51,7 @@
 #include "tracking_2nd_DLL_filter.h"
 #include "tracking_2nd_PLL_filter.h"
 #include "correlator.h"
+#include "streaming_lock_detector.h"
 
 class Gps_L1_Ca_Dll_Pll_Optim_Tracking_cc;
 
@@ -163,7 +164,7 @@ private:
 
     // CN0 estimation and lock detector
     int d_cn0_estimation_counter;
-    gr_complex* d_Prompt_buffer;
+    Streaming_Lock_Detector_32f d_lock_detector;
     float d_carrier_lock_test;
     float d_CN0_SNV_dB_Hz;
     float d_carrier_lock_threshold;
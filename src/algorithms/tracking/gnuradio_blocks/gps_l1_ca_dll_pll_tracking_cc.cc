@@ -35,6 +35,7 @@
  */
 
 #include "gps_l1_ca_dll_pll_tracking_cc.h"
+#include <algorithm>
 #include <cmath>
 #include <iostream>
 #include <sstream>
@@ -43,10 +44,12 @@
 #include <glog/logging.h>
 #include "gnss_synchro.h"
 #include "gps_sdr_signal_processing.h"
+#include "code_replica.h"
+#include "nco_lib.h"
 #include "tracking_discriminators.h"
-#include "lock_detectors.h"
 #include "GPS_L1_CA.h"
 #include "control_message_factory.h"
+#include "gps_vector_tracking.h"
 
 
 /*!
@@ -56,10 +59,28 @@
 #define MINIMUM_VALID_CN0 25
 #define MAXIMUM_LOCK_FAIL_COUNTER 50
 #define CARRIER_LOCK_THRESHOLD 0.85
+#define BIT_SYNC_MIN_TRANSITIONS 10
+#define VECTOR_TRACKING_UPDATE_PERIODS 20
+#define VECTOR_TRACKING_LOCK_FAIL_FACTOR 4
+#define MAX_LOOP_BW_PDI_PRODUCT 0.1
 
 
 using google::LogMessage;
 
+// Limits a loop bandwidth to MAX_LOOP_BW_PDI_PRODUCT / pdi_s, above which the
+// bilinear loop filters are unstable
+static float stable_loop_bw(const char* loop, float bw_hz, float pdi_s)
+{
+    float max_bw_hz = MAX_LOOP_BW_PDI_PRODUCT / pdi_s;
+    if (bw_hz > max_bw_hz)
+        {
+            LOG(WARNING) << loop << " bandwidth of " << bw_hz << " Hz too wide for a summation interval of "
+                         << pdi_s * 1000.0 << " ms, using " << max_bw_hz << " Hz";
+            return max_bw_hz;
+        }
+    return bw_hz;
+}
+
 gps_l1_ca_dll_pll_tracking_cc_sptr
 gps_l1_ca_dll_pll_make_tracking_cc(
         long if_freq,
@@ -70,10 +91,18 @@ gps_l1_ca_dll_pll_make_tracking_cc(
         std::string dump_filename,
         float pll_bw_hz,
         float dll_bw_hz,
-        float early_late_space_chips)
+        float early_late_space_chips,
+        int extend_correlation_ms,
+        float pll_bw_narrow_hz,
+        float dll_bw_narrow_hz,
+        bool vector_tracking,
+        bool bit_packed_correlator,
+        float magnitude_threshold)
 {
     return gps_l1_ca_dll_pll_tracking_cc_sptr(new Gps_L1_Ca_Dll_Pll_Tracking_cc(if_freq,
-            fs_in, vector_length, queue, dump, dump_filename, pll_bw_hz, dll_bw_hz, early_late_space_chips));
+            fs_in, vector_length, queue, dump, dump_filename, pll_bw_hz, dll_bw_hz, early_late_space_chips,
+            extend_correlation_ms, pll_bw_narrow_hz, dll_bw_narrow_hz, vector_tracking, bit_packed_correlator,
+            magnitude_threshold));
 }
 
 
@@ -81,7 +110,7 @@ gps_l1_ca_dll_pll_make_tracking_cc(
 void Gps_L1_Ca_Dll_Pll_Tracking_cc::forecast (int noutput_items,
         gr_vector_int &ninput_items_required)
 {
-    ninput_items_required[0] = (int)d_vector_length*2; //set the required available samples in each call
+    ninput_items_required[0] = epoch_input_items(); //set the required available samples in each call
 }
 
 
@@ -95,9 +124,17 @@ Gps_L1_Ca_Dll_Pll_Tracking_cc::Gps_L1_Ca_Dll_Pll_Tracking_cc(
         std::string dump_filename,
         float pll_bw_hz,
         float dll_bw_hz,
-        float early_late_space_chips) :
+        float early_late_space_chips,
+        int extend_correlation_ms,
+        float pll_bw_narrow_hz,
+        float dll_bw_narrow_hz,
+        bool vector_tracking,
+        bool bit_packed_correlator,
+        float magnitude_threshold) :
         gr::block("Gps_L1_Ca_Dll_Pll_Tracking_cc", gr::io_signature::make(1, 1, sizeof(gr_complex)),
-                gr::io_signature::make(1, 1, sizeof(Gnss_Synchro)))
+                gr::io_signature::make(1, 1, sizeof(Gnss_Synchro))),
+        d_bit_synchronizer(GPS_CA_TELEMETRY_RATE_SYMBOLS_SECOND / GPS_CA_TELEMETRY_RATE_BITS_SECOND, BIT_SYNC_MIN_TRANSITIONS),
+        d_lock_detector(CN0_ESTIMATION_SAMPLES, fs_in, GPS_L1_CA_CODE_LENGTH_CHIPS)
 {
     // initialize internal vars
     d_queue = queue;
@@ -107,13 +144,58 @@ Gps_L1_Ca_Dll_Pll_Tracking_cc::Gps_L1_Ca_Dll_Pll_Tracking_cc(
     d_vector_length = vector_length;
     d_dump_filename = dump_filename;
 
+    // keep the samples before the epoch, to start the correlation at an aligned sample
+    this->set_history(Tracking_Window::history());
+
     // Initialize tracking  ==========================================
-    d_code_loop_filter.set_DLL_BW(dll_bw_hz);
-    d_carrier_loop_filter.set_PLL_BW(pll_bw_hz);
+    d_pll_bw_hz = stable_loop_bw("PLL", pll_bw_hz, GPS_L1_CA_CODE_PERIOD);
+    d_dll_bw_hz = stable_loop_bw("DLL", dll_bw_hz, GPS_L1_CA_CODE_PERIOD);
+    d_code_loop_filter.set_DLL_BW(d_dll_bw_hz);
+    d_carrier_loop_filter.set_PLL_BW(d_pll_bw_hz);
 
     //--- DLL variables --------------------------------------------------------
     d_early_late_spc_chips = early_late_space_chips; // Define early-late offset (in chips)
 
+    // The extended integration cannot cross a bit edge: it has to divide the bit
+    int symbols_per_bit = GPS_CA_TELEMETRY_RATE_SYMBOLS_SECOND / GPS_CA_TELEMETRY_RATE_BITS_SECOND;
+    d_extend_correlation_ms = std::max(1, std::min(extend_correlation_ms, symbols_per_bit));
+    while (symbols_per_bit % d_extend_correlation_ms != 0)
+        {
+            d_extend_correlation_ms--;
+        }
+    if (d_extend_correlation_ms != extend_correlation_ms)
+        {
+            LOG(WARNING) << "Extended correlation of " << extend_correlation_ms << " ms not supported, using "
+                         << d_extend_correlation_ms << " ms";
+        }
+    d_pll_bw_narrow_hz = stable_loop_bw("PLL", pll_bw_narrow_hz, d_extend_correlation_ms * GPS_L1_CA_CODE_PERIOD);
+    d_dll_bw_narrow_hz = stable_loop_bw("DLL", dll_bw_narrow_hz, d_extend_correlation_ms * GPS_L1_CA_CODE_PERIOD);
+    d_enable_extended_integration = false;
+    d_extended_integration_counter = 0;
+    d_Early_accu = gr_complex(0.0, 0.0);
+    d_Prompt_accu = gr_complex(0.0, 0.0);
+    d_Late_accu = gr_complex(0.0, 0.0);
+
+    d_vector_tracking = vector_tracking;
+    d_vector_aided = false;
+    d_vector_tracking_counter = 0;
+    d_aid_carrier_doppler_hz = 0.0;
+    d_aid_code_freq_chips = 0.0;
+
+    d_epoch_batched = false;
+    d_bit_packed_correlator = bit_packed_correlator;
+    int packed_words = code_replica_packed_words(2 * d_vector_length);
+    d_packed_code.resize(3 * packed_words);
+    for (int tap = 0; tap < 3; tap++)
+        {
+            d_packed_code_taps[tap] = &d_packed_code[tap * packed_words];
+        }
+    if (d_bit_packed_correlator == true)
+        {
+            d_correlator.set_bit_packed(2 * d_vector_length, magnitude_threshold);
+            LOG(INFO) << "Bit-packed correlator, " << (magnitude_threshold > 0 ? "2-bit" : "1-bit") << " samples";
+        }
+
     // Initialization of local code replica
     // Get space for a vector with the C/A code replica sampled 1x/chip
     d_ca_code = new gr_complex[(int)GPS_L1_CA_CODE_LENGTH_CHIPS + 2];
@@ -124,12 +206,13 @@ Gps_L1_Ca_Dll_Pll_Tracking_cc::Gps_L1_Ca_Dll_Pll_Tracking_cc(
      * (gr_comlex array of size 2*d_vector_length) aligned to cache of 16 bytes
      */
     // todo: do something if posix_memalign fails
-    // Get space for the resampled early / prompt / late local replicas
+    // Get space for the resampled local replica. The taps are views of it,
+    // set by update_local_code()
     if (posix_memalign((void**)&d_early_code, 16, d_vector_length * sizeof(gr_complex) * 2) == 0){};
-    if (posix_memalign((void**)&d_late_code, 16, d_vector_length * sizeof(gr_complex) * 2) == 0){};
-    if (posix_memalign((void**)&d_prompt_code, 16, d_vector_length * sizeof(gr_complex) * 2) == 0){};
-    // space for carrier wipeoff and signal baseband vectors
-    if (posix_memalign((void**)&d_carr_sign, 16, d_vector_length * sizeof(gr_complex) * 2) == 0){};
+    d_prompt_code = d_early_code;
+    d_late_code = d_early_code;
+    // space for carrier wipeoff and signal baseband vectors, aligned as the input windows
+    if (posix_memalign((void**)&d_carr_sign, Tracking_Window::alignment(), d_vector_length * sizeof(gr_complex) * 2) == 0){};
     if (posix_memalign((void**)&d_Early, 16, sizeof(gr_complex)) == 0){};
     if (posix_memalign((void**)&d_Prompt, 16, sizeof(gr_complex)) == 0){};
     if (posix_memalign((void**)&d_Late, 16, sizeof(gr_complex)) == 0){};
@@ -155,7 +238,6 @@ Gps_L1_Ca_Dll_Pll_Tracking_cc::Gps_L1_Ca_Dll_Pll_Tracking_cc(
 
     // CN0 estimation and lock detector buffers
     d_cn0_estimation_counter = 0;
-    d_Prompt_buffer = new gr_complex[CN0_ESTIMATION_SAMPLES];
     d_carrier_lock_test = 1;
     d_CN0_SNV_dB_Hz = 0;
     d_carrier_lock_fail_counter = 0;
@@ -219,6 +301,16 @@ void Gps_L1_Ca_Dll_Pll_Tracking_cc::start_tracking()
     // DLL/PLL filter initialization
     d_carrier_loop_filter.initialize(); // initialize the carrier filter
     d_code_loop_filter.initialize();    // initialize the code filter
+    // the loops are closed every code period until the bit synchronization
+    d_carrier_loop_filter.set_pdi(GPS_L1_CA_CODE_PERIOD);
+    d_code_loop_filter.set_pdi(GPS_L1_CA_CODE_PERIOD);
+    d_carrier_loop_filter.set_PLL_BW(d_pll_bw_hz);
+    d_code_loop_filter.set_DLL_BW(d_dll_bw_hz);
+    d_bit_synchronizer.reset();
+    d_enable_extended_integration = false;
+    d_extended_integration_counter = 0;
+    d_vector_aided = false;
+    d_vector_tracking_counter = 0;
 
     // generate local reference ALWAYS starting at chip 1 (1 sample per chip)
     gps_l1_ca_code_gen_complex(&d_ca_code[1], d_acquisition_gnss_synchro->PRN, 0);
@@ -226,6 +318,8 @@ void Gps_L1_Ca_Dll_Pll_Tracking_cc::start_tracking()
     d_ca_code[(int)GPS_L1_CA_CODE_LENGTH_CHIPS + 1] = d_ca_code[1];
 
     d_carrier_lock_fail_counter = 0;
+    d_cn0_estimation_counter = 0;
+    d_lock_detector.reset();
     d_rem_code_phase_samples = 0;
     d_rem_carr_phase_rad = 0;
     d_acc_carrier_phase_rad = 0;
@@ -258,7 +352,6 @@ void Gps_L1_Ca_Dll_Pll_Tracking_cc::update_local_code()
 {
     double tcode_chips;
     double rem_code_phase_chips;
-    int associated_chip_index;
     int code_length_chips = (int)GPS_L1_CA_CODE_LENGTH_CHIPS;
     double code_phase_step_chips;
     int early_late_spc_samples;
@@ -271,16 +364,31 @@ void Gps_L1_Ca_Dll_Pll_Tracking_cc::update_local_code()
 
     // Alternative EPL code generation (40% of speed improvement!)
     early_late_spc_samples = round(d_early_late_spc_chips / code_phase_step_chips);
-    epl_loop_length_samples = d_current_prn_length_samples + early_late_spc_samples*2;
-    for (int i = 0; i < epl_loop_length_samples; i++)
+    // the replica covers the whole input window, starting at its first (lead) sample
+    epl_loop_length_samples = d_window.length() + early_late_spc_samples*2;
+    code_replica_gen(d_early_code, &d_ca_code[1], code_length_chips,
+            tcode_chips - d_early_late_spc_chips - d_window.lead()*code_phase_step_chips,
+            code_phase_step_chips, epl_loop_length_samples);
+    d_prompt_code = &d_early_code[early_late_spc_samples];
+    d_late_code = &d_early_code[early_late_spc_samples*2];
+}
+
+
+
+
+void Gps_L1_Ca_Dll_Pll_Tracking_cc::update_local_code_packed()
+{
+    int code_length_chips = (int)GPS_L1_CA_CODE_LENGTH_CHIPS;
+    double code_phase_step_chips = ((double)d_code_freq_chips) / ((double)d_fs_in);
+    double tcode_chips = -d_rem_code_phase_samples * (d_code_freq_chips / d_fs_in);
+    double spc_chips[3] = { -d_early_late_spc_chips, 0.0, d_early_late_spc_chips };
+
+    // the packed replicas start at the first sample of the epoch, not of the window
+    for (int tap = 0; tap < 3; tap++)
         {
-            associated_chip_index = 1 + round(fmod(tcode_chips - d_early_late_spc_chips, code_length_chips));
-            d_early_code[i] = d_ca_code[associated_chip_index];
-            tcode_chips = tcode_chips + code_phase_step_chips;
+            code_replica_gen_packed(d_packed_code_taps[tap], &d_ca_code[1], code_length_chips,
+                    tcode_chips + spc_chips[tap], code_phase_step_chips, d_current_prn_length_samples);
         }
-
-    memcpy(d_prompt_code,&d_early_code[early_late_spc_samples],d_current_prn_length_samples* sizeof(gr_complex));
-    memcpy(d_late_code,&d_early_code[early_late_spc_samples*2],d_current_prn_length_samples* sizeof(gr_complex));
 }
 
 
@@ -288,15 +396,12 @@ void Gps_L1_Ca_Dll_Pll_Tracking_cc::update_local_code()
 
 void Gps_L1_Ca_Dll_Pll_Tracking_cc::update_local_carrier()
 {
-    float phase_rad, phase_step_rad;
+    float phase_step_rad;
 
     phase_step_rad = (float)GPS_TWO_PI*d_carrier_doppler_hz / (float)d_fs_in;
-    phase_rad = d_rem_carr_phase_rad;
-    for(int i = 0; i < d_current_prn_length_samples; i++)
-        {
-            d_carr_sign[i] = gr_complex(cos(phase_rad), -sin(phase_rad));
-            phase_rad += phase_step_rad;
-        }
+    rotator_nco(&d_carr_sign[d_window.lead()], d_current_prn_length_samples, d_rem_carr_phase_rad, phase_step_rad);
+    // the samples of the window out of the epoch do not contribute to the correlations
+    d_window.clear_padding(d_carr_sign);
     //d_rem_carr_phase_rad = fmod(phase_rad, GPS_TWO_PI);
     //d_acc_carrier_phase_rad = d_acc_carrier_phase_rad + d_rem_carr_phase_rad;
 }
@@ -304,12 +409,39 @@ void Gps_L1_Ca_Dll_Pll_Tracking_cc::update_local_carrier()
 
 
 
+void Gps_L1_Ca_Dll_Pll_Tracking_cc::update_vector_tracking()
+{
+    double carrier_doppler_hz;
+    double code_freq_chips;
+    bool aided = Gps_Vector_Tracking::instance()->get_prediction(d_acquisition_gnss_synchro->PRN,
+            (double)d_sample_counter / (double)d_fs_in, &carrier_doppler_hz, &code_freq_chips);
+    if (aided == true)
+        {
+            if (d_vector_aided == false)
+                {
+                    // the PLL continues from the current Doppler, relative to the prediction
+                    d_carrier_loop_filter.set_carrier_nco(d_carrier_doppler_hz - (float)carrier_doppler_hz);
+                    LOG(INFO) << "Vector tracking enabled in channel " << d_channel;
+                }
+            d_aid_carrier_doppler_hz = (float)carrier_doppler_hz;
+            d_aid_code_freq_chips = (float)code_freq_chips;
+        }
+    else if (d_vector_aided == true)
+        {
+            // back to the scalar loop, relative to the acquisition Doppler
+            d_carrier_loop_filter.set_carrier_nco(d_carrier_doppler_hz - d_acq_carrier_doppler_hz);
+            LOG(INFO) << "Vector tracking disabled in channel " << d_channel << " (no recent PVT prediction)";
+        }
+    d_vector_aided = aided;
+}
+
+
+
+
 Gps_L1_Ca_Dll_Pll_Tracking_cc::~Gps_L1_Ca_Dll_Pll_Tracking_cc()
 {
     d_dump_file.close();
 
-    free(d_prompt_code);
-    free(d_late_code);
     free(d_early_code);
     free(d_carr_sign);
     free(d_Early);
@@ -317,7 +449,6 @@ Gps_L1_Ca_Dll_Pll_Tracking_cc::~Gps_L1_Ca_Dll_Pll_Tracking_cc()
     free(d_Late);
 
     delete[] d_ca_code;
-    delete[] d_Prompt_buffer;
 }
 
 
@@ -325,11 +456,115 @@ Gps_L1_Ca_Dll_Pll_Tracking_cc::~Gps_L1_Ca_Dll_Pll_Tracking_cc()
 int Gps_L1_Ca_Dll_Pll_Tracking_cc::general_work (int noutput_items, gr_vector_int &ninput_items,
         gr_vector_const_void_star &input_items, gr_vector_void_star &output_items)
 {
-    // process vars
-    float carr_error_hz;
-    float carr_error_filt_hz;
-    float code_error_chips;
-    float code_error_filt_chips;
+    if (begin_epoch((const gr_complex*) input_items[0]) == true)
+        {
+            correlate_epoch();
+        }
+    consume_each(end_epoch(ninput_items[0], (Gnss_Synchro*) output_items[0])); // this is necessary in gr::block derivates
+    return 1; //output tracking result ALWAYS even in the case of d_enable_tracking==false
+}
+
+
+
+int Gps_L1_Ca_Dll_Pll_Tracking_cc::epoch_input_items() const
+{
+    return (int)d_vector_length*2 + Tracking_Window::history() - 1;
+}
+
+
+
+bool Gps_L1_Ca_Dll_Pll_Tracking_cc::begin_epoch(const gr_complex* input)
+{
+    d_epoch_batched = false;
+    if (d_enable_tracking == false or d_pull_in == true)
+        {
+            return false;
+        }
+    // The input is read through an aligned window that contains the samples
+    // of the epoch (PRN start block alignment)
+    d_window.set(input, d_current_prn_length_samples);
+    // Generate the local code replicas (using \hat{f}_d(k-1))
+    if (d_bit_packed_correlator == true)
+        {
+            update_local_code_packed();
+        }
+    else
+        {
+            update_local_code();
+        }
+    return true;
+}
+
+
+
+bool Gps_L1_Ca_Dll_Pll_Tracking_cc::batch_epoch(Multichannel_Correlator* batch, int first_sample)
+{
+    // The batch correlates the float replicas only
+    if (d_bit_packed_correlator == true)
+        {
+            return false;
+        }
+    // The replicas start at the first sample of the window
+    d_epoch_codes[0] = d_early_code + d_window.lead();
+    d_epoch_codes[1] = d_prompt_code + d_window.lead();
+    d_epoch_codes[2] = d_late_code + d_window.lead();
+    d_epoch_batched = batch->add_channel(first_sample, d_current_prn_length_samples, d_rem_carr_phase_rad,
+            (float)GPS_TWO_PI * d_carrier_doppler_hz / (float)d_fs_in, 3, d_epoch_codes, d_epoch_epl);
+    return d_epoch_batched;
+}
+
+
+
+void Gps_L1_Ca_Dll_Pll_Tracking_cc::correlate_epoch()
+{
+    if (d_bit_packed_correlator == true)
+        {
+            // Perform carrier wipe-off and compute Early, Prompt and Late correlation on the packed epoch
+            gr_complex epl[3];
+            d_correlator.Carrier_wipeoff_and_multicorrelator_packed(d_current_prn_length_samples,
+                    d_window.data() + d_window.lead(),
+                    d_rem_carr_phase_rad,
+                    GPS_TWO_PI * (double)d_carrier_doppler_hz / (double)d_fs_in,
+                    3, d_packed_code_taps, epl);
+            *d_Early = epl[0];
+            *d_Prompt = epl[1];
+            *d_Late = epl[2];
+        }
+    else
+        {
+            // Generate the local carrier replica, perform carrier wipe-off and compute
+            // Early, Prompt and Late correlation
+            update_local_carrier();
+            d_correlator.Carrier_wipeoff_and_EPL_volk(d_window.length(),
+                    d_window.data(),
+                    d_carr_sign,
+                    d_early_code,
+                    d_prompt_code,
+                    d_late_code,
+                    d_Early,
+                    d_Prompt,
+                    d_Late,
+                    is_unaligned());
+        }
+}
+
+
+
+int Gps_L1_Ca_Dll_Pll_Tracking_cc::end_epoch(int ninput_items, Gnss_Synchro* out)
+{
+    // process vars (zero when the loops are not closed)
+    float carr_error_hz = 0.0;
+    float carr_error_filt_hz = 0.0;
+    float code_error_chips = 0.0;
+    float code_error_filt_chips = 0.0;
+
+    if (d_epoch_batched == true)
+        {
+            *d_Early = d_epoch_epl[0];
+            *d_Prompt = d_epoch_epl[1];
+            *d_Late = d_epoch_epl[2];
+            d_epoch_batched = false;
+        }
 
     if (d_enable_tracking == true)
         {
@@ -347,8 +582,7 @@ int Gps_L1_Ca_Dll_Pll_Tracking_cc::general_work (int noutput_items, gr_vector_in
                     d_sample_counter = d_sample_counter + samples_offset; //count for the processed samples
                     d_pull_in = false;
                     //std::cout<<" samples_offset="<<samples_offset<<"\r\n";
-                    consume_each(samples_offset); //shift input to perform alignment with local replica
-                    return 1;
+                    return samples_offset; //shift input to perform alignment with local replica
                 }
 
             // GNSS_SYNCHRO OBJECT to interchange data between tracking->telemetry_decoder
@@ -356,33 +590,12 @@ int Gps_L1_Ca_Dll_Pll_Tracking_cc::general_work (int noutput_items, gr_vector_in
             // Fill the acquisition data
             current_synchro_data = *d_acquisition_gnss_synchro;
 
-            // Block input data and block output stream pointers
-            const gr_complex* in = (gr_complex*) input_items[0]; //PRN start block alignment
-            Gnss_Synchro **out = (Gnss_Synchro **) &output_items[0];
-
-            // Generate local code and carrier replicas (using \hat{f}_d(k-1))
-            update_local_code();
-            update_local_carrier();
-
-            // perform carrier wipe-off and compute Early, Prompt and Late correlation
-            d_correlator.Carrier_wipeoff_and_EPL_volk(d_current_prn_length_samples,
-                    in,
-                    d_carr_sign,
-                    d_early_code,
-                    d_prompt_code,
-                    d_late_code,
-                    d_Early,
-                    d_Prompt,
-                    d_Late,
-                    is_unaligned());
-
             // check for samples consistency (this should be done before in the receiver / here only if the source is a file)
             if (std::isnan((*d_Prompt).real()) == true or std::isnan((*d_Prompt).imag()) == true ) // or std::isinf(in[i].real())==true or std::isinf(in[i].imag())==true)
                 {
-                    const int samples_available = ninput_items[0];
+                    const int samples_available = ninput_items - (Tracking_Window::history() - 1);
                     d_sample_counter = d_sample_counter + samples_available;
                     LOG(WARNING) << "Detected NaN samples at sample number " << d_sample_counter;
-                    consume_each(samples_available);
 
                     // make an output to not stop the rest of the processing blocks
                     current_synchro_data.Prompt_I = 0.0;
@@ -393,36 +606,100 @@ int Gps_L1_Ca_Dll_Pll_Tracking_cc::general_work (int noutput_items, gr_vector_in
                     current_synchro_data.CN0_dB_hz = 0.0;
                     current_synchro_data.Flag_valid_tracking = false;
 
-                    *out[0] = current_synchro_data;
+                    *out = current_synchro_data;
+
+                    return samples_available;
+                }
+
+            // ################## EXTENDED COHERENT INTEGRATION ###############################
+            // After the bit synchronization, the loops are closed once every
+            // d_extend_correlation_ms code periods of the same bit
+            bool close_loops = true;
+            gr_complex Early = *d_Early;
+            gr_complex Prompt = *d_Prompt;
+            gr_complex Late = *d_Late;
+            float loop_period_s = GPS_L1_CA_CODE_PERIOD;
+            if (d_enable_extended_integration == true)
+                {
+                    d_Early_accu += *d_Early;
+                    d_Prompt_accu += *d_Prompt;
+                    d_Late_accu += *d_Late;
+                    d_extended_integration_counter++;
+                    close_loops = (d_extended_integration_counter == d_extend_correlation_ms);
+                    if (close_loops == true)
+                        {
+                            Early = d_Early_accu;
+                            Prompt = d_Prompt_accu;
+                            Late = d_Late_accu;
+                            loop_period_s = d_extend_correlation_ms * GPS_L1_CA_CODE_PERIOD;
+                            d_Early_accu = gr_complex(0.0, 0.0);
+                            d_Prompt_accu = gr_complex(0.0, 0.0);
+                            d_Late_accu = gr_complex(0.0, 0.0);
+                            d_extended_integration_counter = 0;
+                        }
+                }
+            else if (d_extend_correlation_ms > 1)
+                {
+                    if (d_bit_synchronizer.update((*d_Prompt).real()) == true and d_bit_synchronizer.next_starts_bit() == true)
+                        {
+                            d_enable_extended_integration = true;
+                            d_carrier_loop_filter.set_pdi(d_extend_correlation_ms * GPS_L1_CA_CODE_PERIOD);
+                            d_code_loop_filter.set_pdi(d_extend_correlation_ms * GPS_L1_CA_CODE_PERIOD);
+                            d_carrier_loop_filter.set_PLL_BW(d_pll_bw_narrow_hz);
+                            d_code_loop_filter.set_DLL_BW(d_dll_bw_narrow_hz);
+                            LOG(INFO) << "Bit synchronization in channel " << d_channel << ", extended integration of "
+                                      << d_extend_correlation_ms << " ms";
+                        }
+                }
+
+            // ################## VECTOR TRACKING ##############################################
+            if (d_vector_tracking == true)
+                {
+                    if (d_vector_tracking_counter == 0)
+                        {
+                            update_vector_tracking();
+                        }
+                    d_vector_tracking_counter = (d_vector_tracking_counter + 1) % VECTOR_TRACKING_UPDATE_PERIODS;
+                }
+
+            float code_error_filt_secs = 0.0;
+            if (close_loops == true)
+                {
+                    // ################## PLL ##########################################################
+                    // PLL discriminator
+                    carr_error_hz = pll_cloop_two_quadrant_atan(Prompt) / (float)GPS_TWO_PI;
+                    // Carrier discriminator filter
+                    carr_error_filt_hz = d_carrier_loop_filter.get_carrier_nco(carr_error_hz);
+                    if (d_vector_aided == true)
+                        {
+                            // The NCOs follow the prediction, the PLL tracks the residual
+                            d_carrier_doppler_hz = d_aid_carrier_doppler_hz + carr_error_filt_hz;
+                            d_code_freq_chips = d_aid_code_freq_chips + ((carr_error_filt_hz * GPS_L1_CA_CODE_RATE_HZ) / GPS_L1_FREQ_HZ);
+                        }
+                    else
+                        {
+                            // New carrier Doppler frequency estimation
+                            d_carrier_doppler_hz = d_acq_carrier_doppler_hz + carr_error_filt_hz;
+                            // New code Doppler frequency estimation
+                            d_code_freq_chips = GPS_L1_CA_CODE_RATE_HZ + ((d_carrier_doppler_hz * GPS_L1_CA_CODE_RATE_HZ) / GPS_L1_FREQ_HZ);
+                        }
 
-                    return 1;
+                    // ################## DLL ##########################################################
+                    // DLL discriminator
+                    code_error_chips = dll_nc_e_minus_l_normalized(Early, Late); //[chips/Ti]
+                    // Code discriminator filter
+                    code_error_filt_chips = d_code_loop_filter.get_code_nco(code_error_chips); //[chips/second]
+                    //Code phase accumulator
+                    code_error_filt_secs = (loop_period_s*code_error_filt_chips)/GPS_L1_CA_CODE_RATE_HZ; //[seconds]
+                    d_acc_code_phase_secs = d_acc_code_phase_secs + code_error_filt_secs;
                 }
 
-            // ################## PLL ##########################################################
-            // PLL discriminator
-            carr_error_hz = pll_cloop_two_quadrant_atan(*d_Prompt) / (float)GPS_TWO_PI;
-            // Carrier discriminator filter
-            carr_error_filt_hz = d_carrier_loop_filter.get_carrier_nco(carr_error_hz);
-            // New carrier Doppler frequency estimation
-            d_carrier_doppler_hz = d_acq_carrier_doppler_hz + carr_error_filt_hz;
-            // New code Doppler frequency estimation
-            d_code_freq_chips = GPS_L1_CA_CODE_RATE_HZ + ((d_carrier_doppler_hz * GPS_L1_CA_CODE_RATE_HZ) / GPS_L1_FREQ_HZ);
             //carrier phase accumulator for (K) doppler estimation
             d_acc_carrier_phase_rad = d_acc_carrier_phase_rad + GPS_TWO_PI*d_carrier_doppler_hz*GPS_L1_CA_CODE_PERIOD;
             //remanent carrier phase to prevent overflow in the code NCO
             d_rem_carr_phase_rad = d_rem_carr_phase_rad+GPS_TWO_PI*d_carrier_doppler_hz*GPS_L1_CA_CODE_PERIOD;
             d_rem_carr_phase_rad = fmod(d_rem_carr_phase_rad, GPS_TWO_PI);
 
-            // ################## DLL ##########################################################
-            // DLL discriminator
-            code_error_chips = dll_nc_e_minus_l_normalized(*d_Early, *d_Late); //[chips/Ti]
-            // Code discriminator filter
-            code_error_filt_chips = d_code_loop_filter.get_code_nco(code_error_chips); //[chips/second]
-            //Code phase accumulator
-            float code_error_filt_secs;
-            code_error_filt_secs = (GPS_L1_CA_CODE_PERIOD*code_error_filt_chips)/GPS_L1_CA_CODE_RATE_HZ; //[seconds]
-            d_acc_code_phase_secs = d_acc_code_phase_secs + code_error_filt_secs;
-
             // ################## CARRIER AND CODE NCO BUFFER ALIGNEMENT #######################
             // keep alignment parameters for the next input buffer
             float T_chip_seconds;
@@ -438,19 +715,17 @@ int Gps_L1_Ca_Dll_Pll_Tracking_cc::general_work (int noutput_items, gr_vector_in
             d_rem_code_phase_samples = K_blk_samples - d_current_prn_length_samples; //rounding error < 1 sample
 
             // ####### CN0 ESTIMATION AND LOCK DETECTORS ######
-            if (d_cn0_estimation_counter < CN0_ESTIMATION_SAMPLES)
-                {
-                    // fill buffer with prompt correlator output values
-                    d_Prompt_buffer[d_cn0_estimation_counter] = *d_Prompt;
-                    d_cn0_estimation_counter++;
-                }
-            else
+            d_lock_detector.update((*d_Prompt).real(), (*d_Prompt).imag());
+            d_cn0_estimation_counter++;
+            // The indicators are evaluated once per window of CN0_ESTIMATION_SAMPLES epochs,
+            // and the lock fail counter counts these windows
+            if (d_cn0_estimation_counter >= CN0_ESTIMATION_SAMPLES and d_lock_detector.full() == true)
                 {
                     d_cn0_estimation_counter = 0;
-                    // Code lock indicator
-                    d_CN0_SNV_dB_Hz = cn0_svn_estimator(d_Prompt_buffer, CN0_ESTIMATION_SAMPLES, d_fs_in, GPS_L1_CA_CODE_LENGTH_CHIPS);
+                    // Code lock indicator, on the last CN0_ESTIMATION_SAMPLES epochs
+                    d_CN0_SNV_dB_Hz = d_lock_detector.cn0_db_hz();
                     // Carrier lock indicator
-                    d_carrier_lock_test = carrier_lock_detector(d_Prompt_buffer, CN0_ESTIMATION_SAMPLES);
+                    d_carrier_lock_test = d_lock_detector.carrier_lock();
                     // Loss of lock detection
                     if (d_carrier_lock_test < d_carrier_lock_threshold or d_CN0_SNV_dB_Hz < MINIMUM_VALID_CN0)
                         {
@@ -460,7 +735,13 @@ int Gps_L1_Ca_Dll_Pll_Tracking_cc::general_work (int noutput_items, gr_vector_in
                         {
                             if (d_carrier_lock_fail_counter > 0) d_carrier_lock_fail_counter--;
                         }
-                    if (d_carrier_lock_fail_counter > MAXIMUM_LOCK_FAIL_COUNTER)
+                    // The predictions of the other channels hold the NCOs through longer outages
+                    int maximum_lock_fail_counter = MAXIMUM_LOCK_FAIL_COUNTER;
+                    if (d_vector_aided == true)
+                        {
+                            maximum_lock_fail_counter = MAXIMUM_LOCK_FAIL_COUNTER * VECTOR_TRACKING_LOCK_FAIL_FACTOR;
+                        }
+                    if (d_carrier_lock_fail_counter > maximum_lock_fail_counter)
                         {
                             std::cout << "Loss of lock in channel " << d_channel << "!" << std::endl;
                             LOG(INFO) << "Loss of lock in channel " << d_channel << "!";
@@ -484,7 +765,7 @@ int Gps_L1_Ca_Dll_Pll_Tracking_cc::general_work (int noutput_items, gr_vector_in
             current_synchro_data.Carrier_phase_rads = (double)d_acc_carrier_phase_rad;
             current_synchro_data.Carrier_Doppler_hz = (double)d_carrier_doppler_hz;
             current_synchro_data.CN0_dB_hz = (double)d_CN0_SNV_dB_Hz;
-            *out[0] = current_synchro_data;
+            *out = current_synchro_data;
 
             // ########## DEBUG OUTPUT
             /*!
@@ -535,9 +816,8 @@ int Gps_L1_Ca_Dll_Pll_Tracking_cc::general_work (int noutput_items, gr_vector_in
             *d_Early = gr_complex(0,0);
             *d_Prompt = gr_complex(0,0);
             *d_Late = gr_complex(0,0);
-            Gnss_Synchro **out = (Gnss_Synchro **) &output_items[0]; //block output streams pointer
             // GNSS_SYNCHRO OBJECT to interchange data between tracking->telemetry_decoder
-            *out[0] = *d_acquisition_gnss_synchro;
+            *out = *d_acquisition_gnss_synchro;
         }
 
     if(d_dump)
@@ -596,9 +876,8 @@ int Gps_L1_Ca_Dll_Pll_Tracking_cc::general_work (int noutput_items, gr_vector_in
             }
         }
 
-    consume_each(d_current_prn_length_samples); // this is necessary in gr::block derivates
     d_sample_counter += d_current_prn_length_samples; //count for the processed samples
-    return 1; //output tracking result ALWAYS even in the case of d_enable_tracking==false
+    return d_current_prn_length_samples;
 }
 
 
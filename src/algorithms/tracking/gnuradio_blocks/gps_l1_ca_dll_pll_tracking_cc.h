@@ -41,6 +41,7 @@
 #include <queue>
 #include <map>
 #include <string>
+#include <vector>
 #include <boost/thread/mutex.hpp>
 #include <boost/thread/thread.hpp>
 #include <gnuradio/block.h>
@@ -51,6 +52,11 @@
 #include "tracking_2nd_DLL_filter.h"
 #include "tracking_2nd_PLL_filter.h"
 #include "correlator.h"
+#include "multichannel_correlator.h"
+#include "code_replica.h"
+#include "streaming_lock_detector.h"
+#include "tracking_window.h"
+#include "bit_synchronizer.h"
 
 class Gps_L1_Ca_Dll_Pll_Tracking_cc;
 
@@ -66,12 +72,39 @@ gps_l1_ca_dll_pll_make_tracking_cc(long if_freq,
                                    std::string dump_filename,
                                    float pll_bw_hz,
                                    float dll_bw_hz,
-                                   float early_late_space_chips);
+                                   float early_late_space_chips,
+                                   int extend_correlation_ms,
+                                   float pll_bw_narrow_hz,
+                                   float dll_bw_narrow_hz,
+                                   bool vector_tracking,
+                                   bool bit_packed_correlator,
+                                   float magnitude_threshold);
 
 
 
 /*!
  * \brief This class implements a DLL + PLL tracking loop block
+ *
+ * With extend_correlation_ms > 1, once the bit edges are found the loops
+ * are closed on the correlations accumulated over extend_correlation_ms
+ * code periods of the same bit, with the narrower bandwidths
+ * pll_bw_narrow_hz and dll_bw_narrow_hz. The bandwidths are limited to
+ * 0.1 / (summation interval), above which the loops are unstable. The
+ * block still outputs one Gnss_Synchro per code period for the telemetry
+ * decoder.
+ *
+ * With vector_tracking, the carrier and code NCOs follow the frequencies
+ * predicted by the PVT solution of all the channels (see
+ * Gps_Vector_Tracking), and the PLL only tracks the residual.
+ *
+ * With bit_packed_correlator, the samples are correlated as 1-bit or 2-bit
+ * samples with bit-packed replicas (see Correlator::set_bit_packed()), for the
+ * front ends that deliver 1-bit or 2-bit samples.
+ *
+ * general_work() runs one epoch as begin_epoch(), correlate_epoch() and
+ * end_epoch(). Gps_L1_Ca_Multichannel_Tracking_cc runs the same steps for
+ * all the channels on one shared sample block, and correlates the epochs of
+ * the channels together with batch_epoch().
  */
 class Gps_L1_Ca_Dll_Pll_Tracking_cc: public gr::block
 {
@@ -88,6 +121,37 @@ public:
 
     void forecast (int noutput_items, gr_vector_int &ninput_items_required);
 
+    /*!
+     * \brief Number of input samples (with the history) that one epoch needs
+     */
+    int epoch_input_items() const;
+
+    /*!
+     * \brief Generates the local code replicas of the epoch whose window
+     * starts at input (input_items[0] of the block). Returns false if the
+     * epoch is not correlated (tracking disabled, or pull-in).
+     */
+    bool begin_epoch(const gr_complex* input);
+
+    /*!
+     * \brief Adds the epoch to batch, whose sample block has the first
+     * sample of the epoch at first_sample. Returns false if the epoch has to be correlated with
+     * correlate_epoch() instead (bit-packed correlator, or batch full).
+     */
+    bool batch_epoch(Multichannel_Correlator* batch, int first_sample);
+
+    /*!
+     * \brief Correlates the epoch with the correlator of the block
+     */
+    void correlate_epoch();
+
+    /*!
+     * \brief Closes the loops of the epoch and writes its output. ninput_items
+     * is the number of samples available from the window. Returns the number
+     * of samples to consume.
+     */
+    int end_epoch(int ninput_items, Gnss_Synchro* out);
+
 private:
     friend gps_l1_ca_dll_pll_tracking_cc_sptr
     gps_l1_ca_dll_pll_make_tracking_cc(long if_freq,
@@ -98,7 +162,13 @@ private:
             std::string dump_filename,
             float pll_bw_hz,
             float dll_bw_hz,
-            float early_late_space_chips);
+            float early_late_space_chips,
+            int extend_correlation_ms,
+            float pll_bw_narrow_hz,
+            float dll_bw_narrow_hz,
+            bool vector_tracking,
+            bool bit_packed_correlator,
+            float magnitude_threshold);
 
     Gps_L1_Ca_Dll_Pll_Tracking_cc(long if_freq,
             long fs_in, unsigned
@@ -108,9 +178,17 @@ private:
             std::string dump_filename,
             float pll_bw_hz,
             float dll_bw_hz,
-            float early_late_space_chips);
+            float early_late_space_chips,
+            int extend_correlation_ms,
+            float pll_bw_narrow_hz,
+            float dll_bw_narrow_hz,
+            bool vector_tracking,
+            bool bit_packed_correlator,
+            float magnitude_threshold);
     void update_local_code();
     void update_local_carrier();
+    void update_local_code_packed();
+    void update_vector_tracking();
 
     // tracking configuration vars
     boost::shared_ptr<gr::msg_queue> d_queue;
@@ -137,6 +215,11 @@ private:
     gr_complex *d_Prompt;
     gr_complex *d_Late;
 
+    // epoch correlated by a Multichannel_Correlator
+    const gr_complex* d_epoch_codes[3];
+    gr_complex d_epoch_epl[3];
+    bool d_epoch_batched;
+
     // remaining code phase and carrier phase between tracking loops
     float d_rem_code_phase_samples;
     float d_rem_carr_phase_rad;
@@ -150,6 +233,34 @@ private:
     float d_acq_carrier_doppler_hz;
     // correlator
     Correlator d_correlator;
+    // aligned input window of the current epoch
+    Tracking_Window d_window;
+    // bit-packed version of the correlator, and E, P and L code replicas of the epoch
+    bool d_bit_packed_correlator;
+    std::vector<uint64_t> d_packed_code;
+    uint64_t* d_packed_code_taps[3];
+
+    // loop bandwidths before and after the bit synchronization
+    float d_pll_bw_hz;
+    float d_dll_bw_hz;
+    float d_pll_bw_narrow_hz;
+    float d_dll_bw_narrow_hz;
+
+    // extended coherent integration (code periods), after the bit synchronization
+    int d_extend_correlation_ms;
+    Bit_Synchronizer d_bit_synchronizer;
+    bool d_enable_extended_integration;
+    int d_extended_integration_counter;
+    gr_complex d_Early_accu;
+    gr_complex d_Prompt_accu;
+    gr_complex d_Late_accu;
+
+    // vector tracking: NCOs steered by the frequencies predicted by the PVT solution
+    bool d_vector_tracking;
+    bool d_vector_aided;
+    int d_vector_tracking_counter;
+    float d_aid_carrier_doppler_hz;
+    float d_aid_code_freq_chips;
 
     // tracking vars
     float d_code_freq_chips;
@@ -167,7 +278,7 @@ private:
 
     // CN0 estimation and lock detector
     int d_cn0_estimation_counter;
-    gr_complex* d_Prompt_buffer;
+    Streaming_Lock_Detector_32f d_lock_detector;
     float d_carrier_lock_test;
     float d_CN0_SNV_dB_Hz;
     float d_carrier_lock_threshold;
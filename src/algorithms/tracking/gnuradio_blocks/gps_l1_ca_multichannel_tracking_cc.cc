@@ -0,0 +1,234 @@
+/*!
+ * \file gps_l1_ca_multichannel_tracking_cc.cc
+ * \brief Implementation of a block that runs the GPS L1 C/A DLL + PLL
+ * tracking and the telemetry decoding of all the channels on one shared
+ * block of samples
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "gps_l1_ca_multichannel_tracking_cc.h"
+#include <algorithm>
+#include <boost/bind.hpp>
+#include <boost/function.hpp>
+#include <gnuradio/io_signature.h>
+#include <glog/logging.h>
+#include "tracking_window.h"
+
+using google::LogMessage;
+
+gps_l1_ca_multichannel_tracking_cc_sptr
+gps_l1_ca_make_multichannel_tracking_cc(const std::vector<gps_l1_ca_dll_pll_tracking_cc_sptr>& tracking,
+                                        const std::vector<gps_l1_ca_telemetry_decoder_cc_sptr>& telemetry,
+                                        int tile_samples,
+                                        channel_scheduler_sptr scheduler)
+{
+    return gps_l1_ca_multichannel_tracking_cc_sptr(new Gps_L1_Ca_Multichannel_Tracking_cc(tracking, telemetry, tile_samples, scheduler));
+}
+
+
+
+void Gps_L1_Ca_Multichannel_Tracking_cc::forecast (int noutput_items,
+        gr_vector_int &ninput_items_required)
+{
+    // the channel that is the furthest ahead needs one epoch after its position
+    boost::uint64_t first = d_channels[0].next_sample;
+    boost::uint64_t last = d_channels[0].next_sample;
+    for (unsigned int i = 1; i < d_channels.size(); i++)
+        {
+            first = std::min(first, d_channels[i].next_sample);
+            last = std::max(last, d_channels[i].next_sample);
+        }
+    ninput_items_required[0] = (int)(last - first) + d_epoch_input_items;
+}
+
+
+
+Gps_L1_Ca_Multichannel_Tracking_cc::Gps_L1_Ca_Multichannel_Tracking_cc(
+        const std::vector<gps_l1_ca_dll_pll_tracking_cc_sptr>& tracking,
+        const std::vector<gps_l1_ca_telemetry_decoder_cc_sptr>& telemetry,
+        int tile_samples,
+        channel_scheduler_sptr scheduler) :
+        gr::block("Gps_L1_Ca_Multichannel_Tracking_cc", gr::io_signature::make(1, 1, sizeof(gr_complex)),
+                gr::io_signature::make(tracking.size(), tracking.size(), sizeof(Gnss_Synchro))),
+        d_batch(tracking.size(), tile_samples)
+{
+    // the channels read their epochs from the input as their own blocks do
+    this->set_history(Tracking_Window::history());
+    d_scheduler = scheduler;
+    d_epoch_input_items = tracking[0]->epoch_input_items();
+    d_decode_input_items = telemetry[0]->decode_input_items();
+    d_channels.resize(tracking.size());
+    for (unsigned int i = 0; i < d_channels.size(); i++)
+        {
+            d_channels[i].tracking = tracking[i];
+            d_channels[i].telemetry = telemetry[i];
+            d_channels[i].next_sample = 0;
+            d_channels[i].offset = 0;
+            d_channels[i].running = false;
+            d_channels[i].correlate = false;
+            // output k is stored at k and k + d_decode_input_items modulo 2 * d_decode_input_items,
+            // so that the last d_decode_input_items outputs are contiguous
+            d_channels[i].tracking_outputs.resize(2 * d_decode_input_items);
+            d_channels[i].num_tracking_outputs = 0;
+            d_channels[i].out = 0;
+            d_channels[i].produced = 0;
+        }
+    d_in = 0;
+    d_ninput_items = 0;
+    LOG(INFO) << "Multichannel tracking of " << d_channels.size() << " channels, tiles of " << tile_samples << " samples, "
+              << (d_scheduler ? "on the channel scheduler" : "in the thread of the block");
+}
+
+
+
+Gps_L1_Ca_Multichannel_Tracking_cc::~Gps_L1_Ca_Multichannel_Tracking_cc()
+{}
+
+
+
+void Gps_L1_Ca_Multichannel_Tracking_cc::begin_channel(unsigned int channel)
+{
+    Hosted_Channel& ch = d_channels[channel];
+    ch.correlate = ch.tracking->begin_epoch(d_in + ch.offset);
+}
+
+
+
+void Gps_L1_Ca_Multichannel_Tracking_cc::end_channel(unsigned int channel)
+{
+    Hosted_Channel& ch = d_channels[channel];
+    if (ch.correlate == true)
+        {
+            ch.tracking->correlate_epoch();
+        }
+    const int k = ch.num_tracking_outputs % d_decode_input_items;
+    ch.next_sample += ch.tracking->end_epoch(d_ninput_items - ch.offset, &ch.tracking_outputs[k]);
+    ch.tracking_outputs[k + d_decode_input_items] = ch.tracking_outputs[k];
+    ch.num_tracking_outputs++;
+    // the telemetry decoder outputs the first of its last d_decode_input_items inputs
+    if (ch.num_tracking_outputs >= (unsigned long)d_decode_input_items)
+        {
+            ch.telemetry->decode(&ch.tracking_outputs[(k + 1) % d_decode_input_items], &ch.out[ch.produced]);
+            ch.produced++;
+        }
+}
+
+
+
+void Gps_L1_Ca_Multichannel_Tracking_cc::run_channels(void (Gps_L1_Ca_Multichannel_Tracking_cc::*step)(unsigned int))
+{
+    if (!d_scheduler)
+        {
+            for (unsigned int i = 0; i < d_channels.size(); i++)
+                {
+                    if (d_channels[i].running == true)
+                        {
+                            (this->*step)(i);
+                        }
+                }
+            return;
+        }
+    // one task per channel, on the queue of the channel
+    std::vector<unsigned int> queues;
+    std::vector<boost::function<void()> > tasks;
+    for (unsigned int i = 0; i < d_channels.size(); i++)
+        {
+            if (d_channels[i].running == true)
+                {
+                    queues.push_back(i);
+                    tasks.push_back(boost::bind(step, this, i));
+                }
+        }
+    d_scheduler->run_epoch(queues, tasks);
+}
+
+
+
+int Gps_L1_Ca_Multichannel_Tracking_cc::general_work (int noutput_items, gr_vector_int &ninput_items,
+        gr_vector_const_void_star &input_items, gr_vector_void_star &output_items)
+{
+    const boost::uint64_t first = nitems_read(0);
+    d_in = (const gr_complex*) input_items[0];
+    d_ninput_items = ninput_items[0];
+    for (unsigned int i = 0; i < d_channels.size(); i++)
+        {
+            d_channels[i].out = (Gnss_Synchro*) output_items[i];
+            d_channels[i].produced = 0;
+        }
+
+    // each round outputs at most one epoch per channel
+    for (int round = 0; round < noutput_items; round++)
+        {
+            int running = 0;
+            for (unsigned int i = 0; i < d_channels.size(); i++)
+                {
+                    Hosted_Channel& ch = d_channels[i];
+                    ch.offset = (int)(ch.next_sample - first);
+                    ch.running = (d_ninput_items - ch.offset >= d_epoch_input_items);
+                    ch.correlate = false;
+                    if (ch.running == true)
+                        {
+                            running++;
+                        }
+                }
+            if (running == 0)
+                {
+                    break;
+                }
+            run_channels(&Gps_L1_Ca_Multichannel_Tracking_cc::begin_channel);
+
+            // one pass over the samples for the epochs of all the channels
+            d_batch.clear();
+            for (unsigned int i = 0; i < d_channels.size(); i++)
+                {
+                    Hosted_Channel& ch = d_channels[i];
+                    // the first sample of the epoch is after the history of the channel
+                    if (ch.correlate == true and ch.tracking->batch_epoch(&d_batch, ch.offset + Tracking_Window::history() - 1) == true)
+                        {
+                            ch.correlate = false;
+                        }
+                }
+            if (d_batch.num_channels() > 0)
+                {
+                    d_batch.correlate(d_in);
+                }
+
+            run_channels(&Gps_L1_Ca_Multichannel_Tracking_cc::end_channel);
+        }
+
+    // the samples before the channel that is the furthest behind are not needed anymore
+    boost::uint64_t last_needed = d_channels[0].next_sample;
+    for (unsigned int i = 1; i < d_channels.size(); i++)
+        {
+            last_needed = std::min(last_needed, d_channels[i].next_sample);
+        }
+    consume_each((int)(last_needed - first));
+    for (unsigned int i = 0; i < d_channels.size(); i++)
+        {
+            produce(i, d_channels[i].produced);
+        }
+    return WORK_CALLED_PRODUCE;
+}
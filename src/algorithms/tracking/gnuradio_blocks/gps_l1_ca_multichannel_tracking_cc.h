@@ -0,0 +1,125 @@
+/*!
+ * \file gps_l1_ca_multichannel_tracking_cc.h
+ * \brief Interface of a block that runs the GPS L1 C/A DLL + PLL tracking
+ * and the telemetry decoding of all the channels on one shared block of
+ * samples
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_GPS_L1_CA_MULTICHANNEL_TRACKING_CC_H
+#define GNSS_SDR_GPS_L1_CA_MULTICHANNEL_TRACKING_CC_H
+
+#include <vector>
+#include <boost/cstdint.hpp>
+#include <gnuradio/block.h>
+#include "gnss_synchro.h"
+#include "multichannel_correlator.h"
+#include "channel_scheduler.h"
+#include "gps_l1_ca_dll_pll_tracking_cc.h"
+#include "gps_l1_ca_telemetry_decoder_cc.h"
+
+class Gps_L1_Ca_Multichannel_Tracking_cc;
+
+typedef boost::shared_ptr<Gps_L1_Ca_Multichannel_Tracking_cc>
+        gps_l1_ca_multichannel_tracking_cc_sptr;
+
+gps_l1_ca_multichannel_tracking_cc_sptr
+gps_l1_ca_make_multichannel_tracking_cc(const std::vector<gps_l1_ca_dll_pll_tracking_cc_sptr>& tracking,
+                                        const std::vector<gps_l1_ca_telemetry_decoder_cc_sptr>& telemetry,
+                                        int tile_samples,
+                                        channel_scheduler_sptr scheduler);
+
+/*!
+ * \brief Runs the tracking and the telemetry decoding of all the channels on
+ * the same input.
+ *
+ * The block hosts the Gps_L1_Ca_Dll_Pll_Tracking_cc and
+ * gps_l1_ca_telemetry_decoder_cc blocks of the channels, which are not
+ * connected to the flowgraph. Each channel keeps its own position in the
+ * input. At each round, every channel with an epoch in the input generates
+ * its replicas, one Multichannel_Correlator correlates the epochs of all of
+ * them on the shared block of samples, and then each channel closes its
+ * loops (see Gps_L1_Ca_Dll_Pll_Tracking_cc::begin_epoch()) and decodes the
+ * new output of its tracking. Output i is the output of the telemetry
+ * decoder of channel i. The block consumes the samples that all the channels
+ * have processed.
+ *
+ * With a scheduler, the work of the channels before and after the batched
+ * correlation runs on its pool (Channel_Scheduler::run_epoch()), one task
+ * per channel. Otherwise it runs in the thread of the block.
+ */
+class Gps_L1_Ca_Multichannel_Tracking_cc: public gr::block
+{
+public:
+    ~Gps_L1_Ca_Multichannel_Tracking_cc();
+
+    int general_work (int noutput_items, gr_vector_int &ninput_items,
+            gr_vector_const_void_star &input_items, gr_vector_void_star &output_items);
+
+    void forecast (int noutput_items, gr_vector_int &ninput_items_required);
+
+private:
+    friend gps_l1_ca_multichannel_tracking_cc_sptr
+    gps_l1_ca_make_multichannel_tracking_cc(const std::vector<gps_l1_ca_dll_pll_tracking_cc_sptr>& tracking,
+            const std::vector<gps_l1_ca_telemetry_decoder_cc_sptr>& telemetry,
+            int tile_samples,
+            channel_scheduler_sptr scheduler);
+
+    Gps_L1_Ca_Multichannel_Tracking_cc(const std::vector<gps_l1_ca_dll_pll_tracking_cc_sptr>& tracking,
+            const std::vector<gps_l1_ca_telemetry_decoder_cc_sptr>& telemetry,
+            int tile_samples,
+            channel_scheduler_sptr scheduler);
+
+    struct Hosted_Channel
+    {
+        gps_l1_ca_dll_pll_tracking_cc_sptr tracking;
+        gps_l1_ca_telemetry_decoder_cc_sptr telemetry;
+        boost::uint64_t next_sample;                // next sample of the channel, as nitems_read()
+        int offset;                                 // position of the channel in the input of the round
+        bool running;                               // the channel has an epoch in this round
+        bool correlate;                             // the channel correlates the epoch itself
+        std::vector<Gnss_Synchro> tracking_outputs; // last outputs of the tracking, stored twice
+        unsigned long num_tracking_outputs;
+        Gnss_Synchro* out;
+        int produced;
+    };
+
+    void begin_channel(unsigned int channel);
+    void end_channel(unsigned int channel);
+    void run_channels(void (Gps_L1_Ca_Multichannel_Tracking_cc::*step)(unsigned int));
+
+    std::vector<Hosted_Channel> d_channels;
+    Multichannel_Correlator d_batch;
+    channel_scheduler_sptr d_scheduler;
+    int d_epoch_input_items;
+    int d_decode_input_items;
+
+    // input of the round
+    const gr_complex* d_in;
+    int d_ninput_items;
+};
+
+#endif //GNSS_SDR_GPS_L1_CA_MULTICHANNEL_TRACKING_CC_H
@@ -45,11 +45,13 @@
 #include <glog/logging.h>
 #include "gnss_synchro.h"
 #include "gps_sdr_signal_processing.h"
+#include "code_replica.h"
+#include "nco_lib.h"
 #include "tracking_discriminators.h"
-#include "lock_detectors.h"
 #include "GPS_L1_CA.h"
 #include "control_message_factory.h"
 #include "tcp_communication.h"
+#include "tcp_tracking_transport.h"
 #include "tcp_packet_data.h"
 
 /*!
@@ -73,10 +75,12 @@ gps_l1_ca_tcp_connector_make_tracking_cc(
         float pll_bw_hz,
         float dll_bw_hz,
         float early_late_space_chips,
-        size_t port_ch0)
+        size_t port_ch0,
+        int batch_epochs,
+        int pipeline_depth)
 {
     return gps_l1_ca_tcp_connector_tracking_cc_sptr(new Gps_L1_Ca_Tcp_Connector_Tracking_cc(if_freq,
-            fs_in, vector_length, queue, dump, dump_filename, pll_bw_hz, dll_bw_hz, early_late_space_chips, port_ch0));
+            fs_in, vector_length, queue, dump, dump_filename, pll_bw_hz, dll_bw_hz, early_late_space_chips, port_ch0, batch_epochs, pipeline_depth));
 }
 
 
@@ -99,9 +103,12 @@ Gps_L1_Ca_Tcp_Connector_Tracking_cc::Gps_L1_Ca_Tcp_Connector_Tracking_cc(
         float pll_bw_hz,
         float dll_bw_hz,
         float early_late_space_chips,
-        size_t port_ch0) :
+        size_t port_ch0,
+        int batch_epochs,
+        int pipeline_depth) :
         gr::block("Gps_L1_Ca_Tcp_Connector_Tracking_cc", gr::io_signature::make(1, 1, sizeof(gr_complex)),
-                gr::io_signature::make(1, 1, sizeof(Gnss_Synchro)))
+                gr::io_signature::make(1, 1, sizeof(Gnss_Synchro))),
+        d_lock_detector(CN0_ESTIMATION_SAMPLES, fs_in, GPS_L1_CA_CODE_LENGTH_CHIPS)
 {
     // initialize internal vars
     d_queue = queue;
@@ -120,6 +127,10 @@ Gps_L1_Ca_Tcp_Connector_Tracking_cc::Gps_L1_Ca_Tcp_Connector_Tracking_cc(
 
     //--- TCP CONNECTOR variables --------------------------------------------------------
     d_port_ch0 = port_ch0;
+    d_batch_epochs = batch_epochs;
+    d_pipeline_depth = pipeline_depth;
+    // With the default batch and depth each channel keeps its own connection and the original packets
+    d_legacy_tcp = (batch_epochs <= 1 and pipeline_depth <= 0);
     d_port = 0;
     d_listen_connection = true;
     d_control_id = 0;
@@ -135,10 +146,11 @@ Gps_L1_Ca_Tcp_Connector_Tracking_cc::Gps_L1_Ca_Tcp_Connector_Tracking_cc(
      * (gr_comlex array of size 2*d_vector_length) aligned to cache of 16 bytes
      */
     // todo: do something if posix_memalign fails
-    // Get space for the resampled early / prompt / late local replicas
+    // Get space for the resampled local replica. The taps are views of it,
+    // set by update_local_code()
     if (posix_memalign((void**)&d_early_code, 16, d_vector_length * sizeof(gr_complex) * 2) == 0){};
-    if (posix_memalign((void**)&d_late_code, 16, d_vector_length * sizeof(gr_complex) * 2) == 0){};
-    if (posix_memalign((void**)&d_prompt_code, 16, d_vector_length * sizeof(gr_complex) * 2) == 0){};
+    d_prompt_code = d_early_code;
+    d_late_code = d_early_code;
     // space for carrier wipeoff and signal baseband vectors
     if (posix_memalign((void**)&d_carr_sign, 16, d_vector_length * sizeof(gr_complex) * 2) == 0){};
     // correlator outputs (scalar)
@@ -167,7 +179,6 @@ Gps_L1_Ca_Tcp_Connector_Tracking_cc::Gps_L1_Ca_Tcp_Connector_Tracking_cc(
 
     // CN0 estimation and lock detector buffers
     d_cn0_estimation_counter = 0;
-    d_Prompt_buffer = new gr_complex[CN0_ESTIMATION_SAMPLES];
     d_carrier_lock_test = 1;
     d_CN0_SNV_dB_Hz = 0;
     d_carrier_lock_fail_counter = 0;
@@ -246,6 +257,8 @@ void Gps_L1_Ca_Tcp_Connector_Tracking_cc::start_tracking()
     d_ca_code[(int)GPS_L1_CA_CODE_LENGTH_CHIPS + 1] = d_ca_code[1];
 
     d_carrier_lock_fail_counter = 0;
+    d_cn0_estimation_counter = 0;
+    d_lock_detector.reset();
     d_rem_code_phase_samples = 0;
     d_rem_carr_phase_rad = 0;
     d_rem_code_phase_samples = 0;
@@ -263,6 +276,11 @@ void Gps_L1_Ca_Tcp_Connector_Tracking_cc::start_tracking()
 
     // enable tracking
     d_pull_in = true;
+    if (d_transport)
+        {
+            // The responses still in the pipeline are for the previous satellite
+            d_transport->reset_channel(d_channel);
+        }
     d_enable_tracking = true;
 
     LOG(INFO) << "PULL-IN Doppler [Hz]=" << d_carrier_doppler_hz
@@ -278,7 +296,6 @@ void Gps_L1_Ca_Tcp_Connector_Tracking_cc::update_local_code()
 {
     double tcode_chips;
     double rem_code_phase_chips;
-    int associated_chip_index;
     int code_length_chips = (int)GPS_L1_CA_CODE_LENGTH_CHIPS;
     double code_phase_step_chips;
     int early_late_spc_samples;
@@ -292,15 +309,10 @@ void Gps_L1_Ca_Tcp_Connector_Tracking_cc::update_local_code()
     // Alternative EPL code generation (40% of speed improvement!)
     early_late_spc_samples = round(d_early_late_spc_chips/code_phase_step_chips);
     epl_loop_length_samples = d_current_prn_length_samples+early_late_spc_samples*2;
-    for (int i = 0; i < epl_loop_length_samples; i++)
-        {
-            associated_chip_index = 1 + round(fmod(tcode_chips - d_early_late_spc_chips, code_length_chips));
-            d_early_code[i] = d_ca_code[associated_chip_index];
-            tcode_chips = tcode_chips + d_code_phase_step_chips;
-        }
-
-    memcpy(d_prompt_code,&d_early_code[early_late_spc_samples], d_current_prn_length_samples* sizeof(gr_complex));
-    memcpy(d_late_code,&d_early_code[early_late_spc_samples*2], d_current_prn_length_samples* sizeof(gr_complex));
+    code_replica_gen(d_early_code, &d_ca_code[1], code_length_chips,
+            tcode_chips - d_early_late_spc_chips, d_code_phase_step_chips, epl_loop_length_samples);
+    d_prompt_code = &d_early_code[early_late_spc_samples];
+    d_late_code = &d_early_code[early_late_spc_samples*2];
 }
 
 
@@ -311,12 +323,8 @@ void Gps_L1_Ca_Tcp_Connector_Tracking_cc::update_local_carrier()
     float phase_rad, phase_step_rad;
 
     phase_step_rad = (float)GPS_TWO_PI*d_carrier_doppler_hz / (float)d_fs_in;
-    phase_rad = d_rem_carr_phase_rad;
-    for(int i = 0; i < d_current_prn_length_samples; i++)
-        {
-            d_carr_sign[i] = gr_complex(cos(phase_rad), -sin(phase_rad));
-            phase_rad += phase_step_rad;
-        }
+    rotator_nco(d_carr_sign, d_current_prn_length_samples, d_rem_carr_phase_rad, phase_step_rad);
+    phase_rad = d_rem_carr_phase_rad + (float)d_current_prn_length_samples * phase_step_rad;
     d_rem_carr_phase_rad = fmod(phase_rad, GPS_TWO_PI);
     d_acc_carrier_phase_rad = d_acc_carrier_phase_rad + d_rem_carr_phase_rad;
 }
@@ -328,8 +336,6 @@ Gps_L1_Ca_Tcp_Connector_Tracking_cc::~Gps_L1_Ca_Tcp_Connector_Tracking_cc()
 {
     d_dump_file.close();
 
-    free(d_prompt_code);
-    free(d_late_code);
     free(d_early_code);
     free(d_carr_sign);
     free(d_Early);
@@ -337,9 +343,11 @@ Gps_L1_Ca_Tcp_Connector_Tracking_cc::~Gps_L1_Ca_Tcp_Connector_Tracking_cc()
     free(d_Late);
 
     delete[] d_ca_code;
-    delete[] d_Prompt_buffer;
 
-    d_tcp_com.close_tcp_connection(d_port);
+    if (d_legacy_tcp == true)
+        {
+            d_tcp_com.close_tcp_connection(d_port);
+        }
 }
 
 
@@ -349,10 +357,10 @@ int Gps_L1_Ca_Tcp_Connector_Tracking_cc::general_work (int noutput_items, gr_vec
         gr_vector_const_void_star &input_items, gr_vector_void_star &output_items)
 {
     // process vars
-    float carr_error;
+    float carr_error = 0.0;
     float carr_nco;
-    float code_error;
-    float code_nco;
+    float code_error = 0.0;
+    float code_nco = d_code_freq_hz;
 
     tcp_packet_data tcp_data;
 
@@ -432,7 +440,7 @@ int Gps_L1_Ca_Tcp_Connector_Tracking_cc::general_work (int noutput_items, gr_vec
             //! Variable used for control
             d_control_id++;
 
-            //! Send and receive a TCP packet
+            //! Queue the request of this epoch, and get the response of the epoch pipeline_depth epochs before
             boost::array<float, NUM_TX_VARIABLES_GPS_L1_CA> tx_variables_array = {{d_control_id,
                                                                                    (*d_Early).real(),
                                                                                    (*d_Early).imag(),
@@ -442,16 +450,29 @@ int Gps_L1_Ca_Tcp_Connector_Tracking_cc::general_work (int noutput_items, gr_vec
                                                                                    (*d_Prompt).imag(),
                                                                                    d_acq_carrier_doppler_hz,
                                                                                    1}};
-            d_tcp_com.send_receive_tcp_packet_gps_l1_ca(tx_variables_array, &tcp_data);
-
-            //! Recover the tracking data
-            code_error = tcp_data.proc_pack_code_error;
-            carr_error = tcp_data.proc_pack_carr_error;
-            // Modify carrier freq based on NCO command
-            d_carrier_doppler_hz = tcp_data.proc_pack_carrier_doppler_hz;
-            // Modify code freq based on NCO command
-            code_nco = 1/(1/GPS_L1_CA_CODE_RATE_HZ - code_error/GPS_L1_CA_CODE_LENGTH_CHIPS);
-            d_code_freq_hz = code_nco;
+            bool response;
+            if (d_legacy_tcp == true)
+                {
+                    //! Send and receive a TCP packet
+                    d_tcp_com.send_receive_tcp_packet_gps_l1_ca(tx_variables_array, &tcp_data);
+                    response = true;
+                }
+            else
+                {
+                    response = d_transport->exchange(d_channel, tx_variables_array.data(), NUM_TX_VARIABLES_GPS_L1_CA, &tcp_data);
+                }
+            if (response == true)
+                {
+                    //! Recover the tracking data
+                    code_error = tcp_data.proc_pack_code_error;
+                    carr_error = tcp_data.proc_pack_carr_error;
+                    // Modify carrier freq based on NCO command
+                    d_carrier_doppler_hz = tcp_data.proc_pack_carrier_doppler_hz;
+                    // Modify code freq based on NCO command
+                    code_nco = 1/(1/GPS_L1_CA_CODE_RATE_HZ - code_error/GPS_L1_CA_CODE_LENGTH_CHIPS);
+                    d_code_freq_hz = code_nco;
+                }
+            // else no response is due yet: keep the NCO commands
 
             // Update the phasestep based on code freq (variable) and
             // sampling frequency (fixed)
@@ -484,18 +505,17 @@ int Gps_L1_Ca_Tcp_Connector_Tracking_cc::general_work (int noutput_items, gr_vec
              * \todo Improve the lock detection algorithm!
              */
             // ####### CN0 ESTIMATION AND LOCK DETECTORS ######
-            if (d_cn0_estimation_counter < CN0_ESTIMATION_SAMPLES)
-                {
-                    // fill buffer with prompt correlator output values
-                    d_Prompt_buffer[d_cn0_estimation_counter] = *d_Prompt;
-                    d_cn0_estimation_counter++;
-                }
-            else
+            d_lock_detector.update((*d_Prompt).real(), (*d_Prompt).imag());
+            d_cn0_estimation_counter++;
+            // The indicators are evaluated once per window of CN0_ESTIMATION_SAMPLES epochs,
+            // and the lock fail counter counts these windows
+            if (d_cn0_estimation_counter >= CN0_ESTIMATION_SAMPLES and d_lock_detector.full() == true)
                 {
                     d_cn0_estimation_counter = 0;
-                    d_CN0_SNV_dB_Hz = cn0_svn_estimator(d_Prompt_buffer, CN0_ESTIMATION_SAMPLES, d_fs_in, GPS_L1_CA_CODE_LENGTH_CHIPS);
-                    d_carrier_lock_test = carrier_lock_detector(d_Prompt_buffer, CN0_ESTIMATION_SAMPLES);
-
+                    // Code lock indicator, on the last CN0_ESTIMATION_SAMPLES epochs
+                    d_CN0_SNV_dB_Hz = d_lock_detector.cn0_db_hz();
+                    // Carrier lock indicator
+                    d_carrier_lock_test = d_lock_detector.carrier_lock();
                     // ###### TRACKING UNLOCK NOTIFICATION #####
                     if (d_carrier_lock_test < d_carrier_lock_threshold or d_CN0_SNV_dB_Hz < MINIMUM_VALID_CN0)
                         {
@@ -582,9 +602,13 @@ int Gps_L1_Ca_Tcp_Connector_Tracking_cc::general_work (int noutput_items, gr_vec
             // GNSS_SYNCHRO OBJECT to interchange data between tracking->telemetry_decoder
             *out[0] = *d_acquisition_gnss_synchro;
 
-            //! When tracking is disabled an array of 1's is sent to maintain the TCP connection
-            boost::array<float, NUM_TX_VARIABLES_GPS_L1_CA> tx_variables_array = {{1,1,1,1,1,1,1,1,0}};
-            d_tcp_com.send_receive_tcp_packet_gps_l1_ca(tx_variables_array, &tcp_data);
+            //! When tracking is disabled an array of 1's is sent to maintain the TCP connection.
+            //! Nothing is sent on the shared connection
+            if (d_legacy_tcp == true)
+                {
+                    boost::array<float, NUM_TX_VARIABLES_GPS_L1_CA> tx_variables_array = {{1,1,1,1,1,1,1,1,0}};
+                    d_tcp_com.send_receive_tcp_packet_gps_l1_ca(tx_variables_array, &tcp_data);
+                }
         }
 
     if(d_dump)
@@ -674,10 +698,18 @@ void Gps_L1_Ca_Tcp_Connector_Tracking_cc::set_channel(unsigned int channel)
         }
 
     //! Listen for connections on a TCP port
-    if (d_listen_connection == true)
+    if (d_legacy_tcp == true)
+        {
+            if (d_listen_connection == true)
+                {
+                    d_port = d_port_ch0 + d_channel;
+                    d_listen_connection = d_tcp_com.listen_tcp_connection(d_port, d_port_ch0);
+                }
+        }
+    //! All the channels share the connection on port_ch0, the first one waits for it
+    else if (!d_transport)
         {
-            d_port = d_port_ch0 + d_channel;
-            d_listen_connection = d_tcp_com.listen_tcp_connection(d_port, d_port_ch0);
+            d_transport = Tcp_Tracking_Transport::shared(d_port_ch0, d_batch_epochs, d_pipeline_depth);
         }
 }
 
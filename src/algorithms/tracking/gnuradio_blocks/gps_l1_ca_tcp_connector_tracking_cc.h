@@ -51,7 +51,9 @@
 #include "tracking_2nd_DLL_filter.h"
 #include "tracking_2nd_PLL_filter.h"
 #include "correlator.h"
+#include "streaming_lock_detector.h"
 #include "tcp_communication.h"
+#include "tcp_tracking_transport.h"
 
 
 
@@ -69,7 +71,9 @@ gps_l1_ca_tcp_connector_make_tracking_cc(long if_freq,
                                    float pll_bw_hz,
                                    float dll_bw_hz,
                                    float early_late_space_chips,
-                                   size_t port_ch0);
+                                   size_t port_ch0,
+                                   int batch_epochs,
+                                   int pipeline_depth);
 
 
 /*!
@@ -105,7 +109,9 @@ private:
             float pll_bw_hz,
             float dll_bw_hz,
             float early_late_space_chips,
-            size_t port_ch0);
+            size_t port_ch0,
+            int batch_epochs,
+            int pipeline_depth);
 
     Gps_L1_Ca_Tcp_Connector_Tracking_cc(long if_freq,
             long fs_in, unsigned
@@ -116,7 +122,9 @@ private:
             float pll_bw_hz,
             float dll_bw_hz,
             float early_late_space_chips,
-            size_t port_ch0);
+            size_t port_ch0,
+            int batch_epochs,
+            int pipeline_depth);
     void update_local_code();
     void update_local_carrier();
 
@@ -168,10 +176,14 @@ private:
     float d_acc_carrier_phase_rad;
     float d_code_phase_samples;
     size_t d_port_ch0;
+    int d_batch_epochs;
+    int d_pipeline_depth;
+    float d_control_id;
+    bool d_legacy_tcp;
     size_t d_port;
     int d_listen_connection;
-    float d_control_id;
     tcp_communication d_tcp_com;
+    tcp_tracking_transport_sptr d_transport;
 
     //PRN period in samples
     int d_current_prn_length_samples;
@@ -184,7 +196,7 @@ private:
 
     // CN0 estimation and lock detector
     int d_cn0_estimation_counter;
-    gr_complex* d_Prompt_buffer;
+    Streaming_Lock_Detector_32f d_lock_detector;
     float d_carrier_lock_test;
     float d_CN0_SNV_dB_Hz;
     float d_carrier_lock_threshold;
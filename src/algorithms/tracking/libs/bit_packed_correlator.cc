@@ -0,0 +1,274 @@
+/*!
+ * \file bit_packed_correlator.cc
+ * \brief Carrier wipe-off and multi-tap correlation of 1-bit or 2-bit
+ * samples with bit-packed replicas (XOR and popcount)
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "bit_packed_correlator.h"
+#include <cmath>
+#include <glog/logging.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+using google::LogMessage;
+
+static inline int popcount64(uint64_t x)
+{
+#if defined(__GNUC__)
+    return __builtin_popcountll(x);
+#else
+    x = x - ((x >> 1) & 0x5555555555555555ULL);
+    x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+    x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return (int)((x * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+
+/*
+ * Signs and magnitude bits of the components of num_samples samples (up to
+ * 64), and signs of the cosine and sine of the carrier exp(-j * phase) from
+ * phase_fxp, in steps of step_fxp. phase_fxp is advanced by num_samples steps.
+ */
+static inline void pack_samples(const gr_complex* in, int num_samples, float magnitude_threshold, bool two_bit,
+        uint32_t& phase_fxp, uint32_t step_fxp, uint64_t& i_sign, uint64_t& q_sign,
+        uint64_t& i_mag, uint64_t& q_mag, uint64_t& cos_sign, uint64_t& sin_sign)
+{
+    for (int b = 0; b < num_samples; b++)
+        {
+            uint64_t bit = (uint64_t)1 << b;
+            float re = in[b].real();
+            float im = in[b].imag();
+            if (re < 0) i_sign |= bit;
+            if (im < 0) q_sign |= bit;
+            if (two_bit)
+                {
+                    if (std::abs(re) >= magnitude_threshold) i_mag |= bit;
+                    if (std::abs(im) >= magnitude_threshold) q_mag |= bit;
+                }
+            if (((phase_fxp >> 31) ^ (phase_fxp >> 30)) & 1) cos_sign |= bit;
+            if (phase_fxp >> 31) sin_sign |= bit;
+            phase_fxp += step_fxp;
+        }
+}
+
+
+
+// pack_samples() of a whole word
+static inline void pack_word(const gr_complex* in, float magnitude_threshold, bool two_bit,
+        uint32_t& phase_fxp, uint32_t step_fxp, uint64_t& i_sign, uint64_t& q_sign,
+        uint64_t& i_mag, uint64_t& q_mag, uint64_t& cos_sign, uint64_t& sin_sign)
+{
+#ifdef __SSE2__
+    // Four samples per step: the sign bits come from _mm_movemask_ps
+    const float* x = (const float*)in;
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 abs_mask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+    const __m128 threshold = _mm_set1_ps(magnitude_threshold);
+    __m128i phase = _mm_set_epi32((int)(phase_fxp + 3 * step_fxp), (int)(phase_fxp + 2 * step_fxp),
+            (int)(phase_fxp + step_fxp), (int)phase_fxp);
+    const __m128i step = _mm_set1_epi32((int)(4 * step_fxp));
+    for (int b = 0; b < 64; b += 4)
+        {
+            __m128 x0 = _mm_loadu_ps(x + 2 * b);     // I0 Q0 I1 Q1
+            __m128 x1 = _mm_loadu_ps(x + 2 * b + 4); // I2 Q2 I3 Q3
+            __m128 re = _mm_shuffle_ps(x0, x1, _MM_SHUFFLE(2, 0, 2, 0));
+            __m128 im = _mm_shuffle_ps(x0, x1, _MM_SHUFFLE(3, 1, 3, 1));
+            i_sign |= (uint64_t)_mm_movemask_ps(_mm_cmplt_ps(re, zero)) << b;
+            q_sign |= (uint64_t)_mm_movemask_ps(_mm_cmplt_ps(im, zero)) << b;
+            if (two_bit)
+                {
+                    i_mag |= (uint64_t)_mm_movemask_ps(_mm_cmpge_ps(_mm_and_ps(re, abs_mask), threshold)) << b;
+                    q_mag |= (uint64_t)_mm_movemask_ps(_mm_cmpge_ps(_mm_and_ps(im, abs_mask), threshold)) << b;
+                }
+            // bit 31 of the phase, and bit 31 xor bit 30
+            sin_sign |= (uint64_t)_mm_movemask_ps(_mm_castsi128_ps(phase)) << b;
+            cos_sign |= (uint64_t)_mm_movemask_ps(_mm_castsi128_ps(_mm_xor_si128(phase, _mm_slli_epi32(phase, 1)))) << b;
+            phase = _mm_add_epi32(phase, step);
+        }
+    phase_fxp += 64 * step_fxp;
+#else
+    pack_samples(in, 64, magnitude_threshold, two_bit, phase_fxp, step_fxp,
+            i_sign, q_sign, i_mag, q_mag, cos_sign, sin_sign);
+#endif
+}
+
+
+
+bool Bit_Packed_Correlator::quantized(const gr_complex* input, int num_samples, float magnitude_threshold)
+{
+    // Absolute values of the components: one level, or one on each side of the threshold
+    float levels[2] = { -1.0, -1.0 };
+    int num_levels = 0;
+    for (int i = 0; i < 2 * num_samples; i++)
+        {
+            float level = std::abs(i % 2 == 0 ? input[i / 2].real() : input[i / 2].imag());
+            if (num_levels > 0 && level == levels[0]) continue;
+            if (num_levels > 1 && level == levels[1]) continue;
+            if (num_levels == 2 || level == 0) return false;
+            levels[num_levels++] = level;
+        }
+    if (magnitude_threshold > 0)
+        {
+            return num_levels < 2 || ((levels[0] < magnitude_threshold) != (levels[1] < magnitude_threshold));
+        }
+    return num_levels < 2;
+}
+
+
+
+Bit_Packed_Correlator::Bit_Packed_Correlator(int max_signal_length_samples, float magnitude_threshold)
+{
+    d_max_words = code_replica_packed_words(max_signal_length_samples);
+    d_magnitude_threshold = magnitude_threshold;
+    d_signal_length_samples = 0;
+    d_i_mag_count = 0;
+    d_q_mag_count = 0;
+    d_input_checked = false;
+    d_i_cos.resize(d_max_words, 0);
+    d_q_sin.resize(d_max_words, 0);
+    d_q_cos.resize(d_max_words, 0);
+    d_i_sin.resize(d_max_words, 0);
+    d_i_mag.resize(d_max_words, 0);
+    d_q_mag.resize(d_max_words, 0);
+}
+
+
+Bit_Packed_Correlator::~Bit_Packed_Correlator()
+{}
+
+
+void Bit_Packed_Correlator::Carrier_wipeoff_packed(int signal_length_samples, const gr_complex* input,
+        double carrier_phase_rad, double carrier_phase_step_rad)
+{
+    if (signal_length_samples > d_max_words * 64)
+        {
+            signal_length_samples = d_max_words * 64;
+        }
+    d_signal_length_samples = signal_length_samples;
+
+    // Carrier phase accumulator: 2^32 per cycle. The sine is negative in the
+    // second half of the cycle, the cosine in the second and third quarters.
+    const double cycle = 4294967296.0;
+    double phase_cycles = carrier_phase_rad / (2.0 * M_PI);
+    phase_cycles -= std::floor(phase_cycles);
+    uint32_t phase_fxp = (uint32_t)(phase_cycles * cycle);
+    double step_cycles = carrier_phase_step_rad / (2.0 * M_PI);
+    step_cycles -= std::floor(step_cycles);
+    const uint32_t step_fxp = (uint32_t)(step_cycles * cycle + 0.5);
+
+    if (d_input_checked == false)
+        {
+            // The samples are quantized, not the output of a filter
+            d_input_checked = true;
+            if (quantized(input, signal_length_samples, d_magnitude_threshold) == false)
+                {
+                    LOG(WARNING) << "Bit-packed correlator: the samples are not " << (d_magnitude_threshold > 0 ? "2-bit" : "1-bit")
+                                 << " samples, they lose " << (d_magnitude_threshold > 0 ? "about 0.5" : "about 2")
+                                 << " dB of CN0 in the quantization";
+                }
+        }
+
+    const bool two_bit = d_magnitude_threshold > 0;
+    d_i_mag_count = 0;
+    d_q_mag_count = 0;
+    const int num_words = code_replica_packed_words(signal_length_samples);
+    for (int w = 0; w < num_words; w++)
+        {
+            int word_samples = signal_length_samples - w * 64 < 64 ? signal_length_samples - w * 64 : 64;
+            const gr_complex* in = input + w * 64;
+            uint64_t i_sign = 0;
+            uint64_t q_sign = 0;
+            uint64_t cos_sign = 0;
+            uint64_t sin_sign = 0;
+            uint64_t i_mag = 0;
+            uint64_t q_mag = 0;
+            if (word_samples == 64)
+                {
+                    pack_word(in, d_magnitude_threshold, two_bit, phase_fxp, step_fxp,
+                            i_sign, q_sign, i_mag, q_mag, cos_sign, sin_sign);
+                }
+            else
+                {
+                    pack_samples(in, word_samples, d_magnitude_threshold, two_bit, phase_fxp, step_fxp,
+                            i_sign, q_sign, i_mag, q_mag, cos_sign, sin_sign);
+                }
+            // (I + jQ) * (cos - j sin) = (I cos + Q sin) + j (Q cos - I sin)
+            d_i_cos[w] = i_sign ^ cos_sign;
+            d_q_sin[w] = q_sign ^ sin_sign;
+            d_q_cos[w] = q_sign ^ cos_sign;
+            d_i_sin[w] = i_sign ^ sin_sign;
+            d_i_mag[w] = i_mag;
+            d_q_mag[w] = q_mag;
+            d_i_mag_count += popcount64(i_mag);
+            d_q_mag_count += popcount64(q_mag);
+        }
+}
+
+
+void Bit_Packed_Correlator::Multicorrelator_packed(int n_taps, const uint64_t* const* codes, gr_complex* out) const
+{
+    const int num_words = code_replica_packed_words(d_signal_length_samples);
+    const int last_samples = d_signal_length_samples - (num_words - 1) * 64;
+    const uint64_t last_mask = last_samples == 64 ? ~(uint64_t)0 : ((uint64_t)1 << last_samples) - 1;
+
+    for (int tap = 0; tap < n_taps; tap++)
+        {
+            // Negative products of each plane, in all the samples and in the +-3 samples
+            const uint64_t* code = codes[tap];
+            int i_cos = 0, q_sin = 0, q_cos = 0, i_sin = 0;
+            int i_cos_mag = 0, q_sin_mag = 0, q_cos_mag = 0, i_sin_mag = 0;
+            for (int w = 0; w < num_words; w++)
+                {
+                    uint64_t mask = w == num_words - 1 ? last_mask : ~(uint64_t)0;
+                    uint64_t x_i_cos = (d_i_cos[w] ^ code[w]) & mask;
+                    uint64_t x_q_sin = (d_q_sin[w] ^ code[w]) & mask;
+                    uint64_t x_q_cos = (d_q_cos[w] ^ code[w]) & mask;
+                    uint64_t x_i_sin = (d_i_sin[w] ^ code[w]) & mask;
+                    i_cos += popcount64(x_i_cos);
+                    q_sin += popcount64(x_q_sin);
+                    q_cos += popcount64(x_q_cos);
+                    i_sin += popcount64(x_i_sin);
+                    if (d_i_mag_count + d_q_mag_count > 0)
+                        {
+                            i_cos_mag += popcount64(x_i_cos & d_i_mag[w]);
+                            q_sin_mag += popcount64(x_q_sin & d_q_mag[w]);
+                            q_cos_mag += popcount64(x_q_cos & d_q_mag[w]);
+                            i_sin_mag += popcount64(x_i_sin & d_i_mag[w]);
+                        }
+                }
+            // A sum of n signs with k negative ones is n - 2k, and the +-3 samples
+            // add twice their sign to the sums of the +-1 levels
+            int n = d_signal_length_samples;
+            int re = (n - 2 * i_cos) + (n - 2 * q_sin)
+                    + 2 * ((d_i_mag_count - 2 * i_cos_mag) + (d_q_mag_count - 2 * q_sin_mag));
+            int im = (n - 2 * q_cos) - (n - 2 * i_sin)
+                    + 2 * ((d_q_mag_count - 2 * q_cos_mag) - (d_i_mag_count - 2 * i_sin_mag));
+            out[tap] = gr_complex((float)re, (float)im);
+        }
+}
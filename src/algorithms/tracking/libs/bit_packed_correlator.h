@@ -0,0 +1,116 @@
+/*!
+ * \file bit_packed_correlator.h
+ * \brief Carrier wipe-off and multi-tap correlation of 1-bit or 2-bit
+ * samples with bit-packed replicas (XOR and popcount)
+ *
+ * The samples of an epoch are quantized to a sign bit (1-bit) or to a sign
+ * and a magnitude bit (2-bit, levels +-1 and +-3), and packed 64 samples per
+ * word. The carrier replica is reduced to the signs of its cosine and sine,
+ * generated by a fixed point phase accumulator, and the code replica of each
+ * tap to the sign of its chips. The product of two signs is then the XOR of
+ * their bits, and the sum of 64 products is 64 - 2 * popcount, as in the
+ * correlators of the hardware receivers. The carrier wipe-off is done once
+ * per word for all the taps, and each tap only reads one bit per sample.
+ *
+ * The correlations are in units of the quantized levels: their scale is not
+ * the one of Correlator, but the discriminators and lock detectors of the
+ * tracking loops are normalized. The quantization of the carrier costs about
+ * 0.9 dB of CN0, the 2-bit quantization of the samples about 0.5 dB more
+ * than a float correlator (1.96 dB with 1-bit samples).
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_BIT_PACKED_CORRELATOR_H_
+#define GNSS_SDR_BIT_PACKED_CORRELATOR_H_
+
+#include <vector>
+#include <stdint.h>
+#include <gnuradio/gr_complex.h>
+#include "code_replica.h"
+
+/*!
+ * \brief Bit-packed carrier wipe-off and correlators.
+ *
+ * Each tracking block owns its Bit_Packed_Correlator, which cannot be copied.
+ */
+class Bit_Packed_Correlator
+{
+public:
+    /*!
+     * \brief Constructor.
+     * \param max_signal_length_samples - Samples of the longest epoch.
+     * \param magnitude_threshold - Absolute value from which a sample component
+     * is a +-3 level (2-bit samples). With 0, the samples are 1-bit (signs only).
+     */
+    Bit_Packed_Correlator(int max_signal_length_samples, float magnitude_threshold);
+    ~Bit_Packed_Correlator();
+
+    /*!
+     * \brief Quantizes and packs the samples of an epoch and wipes off the carrier exp(-j * phase).
+     * \param signal_length_samples - Samples of the epoch (up to max_signal_length_samples).
+     * \param input - Samples of the epoch (no alignment required).
+     * \param carrier_phase_rad - Carrier phase at the first sample [rad].
+     * \param carrier_phase_step_rad - Carrier phase step per sample [rad].
+     */
+    void Carrier_wipeoff_packed(int signal_length_samples, const gr_complex* input,
+            double carrier_phase_rad, double carrier_phase_step_rad);
+
+    /*!
+     * \brief Correlates the last wiped-off epoch with n_taps packed code replicas.
+     * \param codes - Packed code replica of each tap, starting at the first sample of the epoch
+     * (see code_replica_gen_packed()).
+     * \param out - Correlation of each tap (n_taps values).
+     */
+    void Multicorrelator_packed(int n_taps, const uint64_t* const* codes, gr_complex* out) const;
+
+    /*!
+     * \brief Checks that the samples are 1-bit samples (magnitude_threshold 0: a single absolute
+     * value of the components) or 2-bit samples (two absolute values, one on each side of
+     * magnitude_threshold). Filtered or resampled samples are not.
+     */
+    static bool quantized(const gr_complex* input, int num_samples, float magnitude_threshold);
+
+private:
+    Bit_Packed_Correlator(const Bit_Packed_Correlator&);
+    Bit_Packed_Correlator& operator=(const Bit_Packed_Correlator&);
+
+    int d_max_words;
+    float d_magnitude_threshold;
+    int d_signal_length_samples;
+    bool d_input_checked; // warns once if the samples are not quantized
+    // Wiped-off signal: one sign plane per product of a sample component by a
+    // carrier component, and the magnitude bits of the sample component
+    std::vector<uint64_t> d_i_cos;
+    std::vector<uint64_t> d_q_sin;
+    std::vector<uint64_t> d_q_cos;
+    std::vector<uint64_t> d_i_sin;
+    std::vector<uint64_t> d_i_mag;
+    std::vector<uint64_t> d_q_mag;
+    int d_i_mag_count; // +-3 samples of the epoch
+    int d_q_mag_count;
+};
+
+#endif /* GNSS_SDR_BIT_PACKED_CORRELATOR_H_ */
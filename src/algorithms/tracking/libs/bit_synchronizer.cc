@@ -0,0 +1,81 @@
+/*!
+ * \file bit_synchronizer.cc
+ * \brief Histogram bit synchronization on the prompt correlator outputs
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "bit_synchronizer.h"
+
+
+Bit_Synchronizer::Bit_Synchronizer(int symbols_per_bit, int min_transitions)
+{
+    d_symbols_per_bit = symbols_per_bit;
+    d_min_transitions = min_transitions;
+    reset();
+}
+
+
+
+void Bit_Synchronizer::reset()
+{
+    d_histogram.assign(d_symbols_per_bit, 0);
+    d_transitions = 0;
+    d_position = 0;
+    d_edge = 0;
+    d_synchronized = false;
+    d_last_prompt_i = 0.0;
+}
+
+
+
+bool Bit_Synchronizer::update(float prompt_i)
+{
+    if (d_synchronized == false)
+        {
+            // a sign change means that a bit starts at this code period
+            if ((d_last_prompt_i < 0 and prompt_i > 0) or (d_last_prompt_i > 0 and prompt_i < 0))
+                {
+                    d_histogram.at(d_position)++;
+                    d_transitions++;
+                    // the edge has to collect most of the transitions, the others are noise
+                    if (d_histogram.at(d_position) >= d_min_transitions and 2 * d_histogram.at(d_position) > d_transitions)
+                        {
+                            d_edge = d_position;
+                            d_synchronized = true;
+                        }
+                }
+            d_last_prompt_i = prompt_i;
+        }
+    d_position = (d_position + 1) % d_symbols_per_bit;
+    return d_synchronized;
+}
+
+
+
+bool Bit_Synchronizer::next_starts_bit() const
+{
+    return d_synchronized and d_position == d_edge;
+}
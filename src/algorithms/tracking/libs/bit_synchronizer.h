@@ -0,0 +1,84 @@
+/*!
+ * \file bit_synchronizer.h
+ * \brief Histogram bit synchronization on the prompt correlator outputs
+ *
+ * The navigation bits last several code periods (20 for GPS L1 C/A), and
+ * the sign of the prompt correlation can only change at a bit edge. The
+ * sign changes between consecutive code periods are counted by position in
+ * the bit, and the position that collects most of them is the bit edge.
+ * Once the edge is known, the coherent integration of the tracking loops
+ * can be extended over several code periods of the same bit.
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_BIT_SYNCHRONIZER_H_
+#define GNSS_SDR_BIT_SYNCHRONIZER_H_
+
+#include <vector>
+
+/*!
+ * \brief Finds the bit edges in the sequence of prompt correlator outputs.
+ */
+class Bit_Synchronizer
+{
+public:
+    /*!
+     * \brief Constructor.
+     * \param symbols_per_bit - Code periods of a bit (e.g. 20 for GPS L1 C/A).
+     * \param min_transitions - Sign changes of the bit edge position needed to synchronize.
+     */
+    Bit_Synchronizer(int symbols_per_bit, int min_transitions);
+
+    /*!
+     * \brief Starts a new synchronization (e.g. at the start of the tracking).
+     */
+    void reset();
+
+    /*!
+     * \brief Adds the in-phase prompt correlation of the next code period.
+     * \return true if the bit edge is known.
+     */
+    bool update(float prompt_i);
+
+    bool synchronized() const { return d_synchronized; }
+
+    /*!
+     * \brief True if the next code period is the first of a bit (only when synchronized).
+     */
+    bool next_starts_bit() const;
+
+private:
+    int d_symbols_per_bit;
+    int d_min_transitions;
+    std::vector<int> d_histogram;
+    int d_transitions;
+    int d_position;
+    int d_edge;
+    bool d_synchronized;
+    float d_last_prompt_i;
+};
+
+#endif /* GNSS_SDR_BIT_SYNCHRONIZER_H_ */
@@ -0,0 +1,106 @@
+/*!
+ * \file code_replica.cc
+ * \brief Generation of the sampled local code replica of the tracking
+ * loops by fixed point accumulation of the code phase
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "code_replica.h"
+#include <cmath>
+#include <stdint.h>
+
+// Fractional bits of the code phase accumulator
+#define CODE_REPLICA_FRAC_BITS 32
+
+// Code phase accumulator of the first sample, in fixed point
+static uint64_t code_replica_start_fxp(int code_length, double start_phase)
+{
+    const double scale = (double)((uint64_t)1 << CODE_REPLICA_FRAC_BITS);
+    const uint64_t wrap = (uint64_t)code_length << CODE_REPLICA_FRAC_BITS;
+
+    // The half entry turns the truncation of the integer part into a rounding
+    double phase = fmod(start_phase + 0.5, (double)code_length);
+    if (phase < 0)
+        {
+            phase += (double)code_length;
+        }
+    uint64_t phase_fxp = (uint64_t)(phase * scale);
+    if (phase_fxp >= wrap)
+        {
+            phase_fxp -= wrap;
+        }
+    return phase_fxp;
+}
+
+
+void code_replica_gen(gr_complex* replica, const gr_complex* code, int code_length,
+        double start_phase, double phase_step, int num_samples)
+{
+    const double scale = (double)((uint64_t)1 << CODE_REPLICA_FRAC_BITS);
+    const uint64_t wrap = (uint64_t)code_length << CODE_REPLICA_FRAC_BITS;
+    uint64_t phase_fxp = code_replica_start_fxp(code_length, start_phase);
+    const uint64_t step_fxp = (uint64_t)(phase_step * scale + 0.5);
+
+    for (int i = 0; i < num_samples; i++)
+        {
+            replica[i] = code[phase_fxp >> CODE_REPLICA_FRAC_BITS];
+            phase_fxp += step_fxp;
+            if (phase_fxp >= wrap)
+                {
+                    phase_fxp -= wrap;
+                }
+        }
+}
+
+
+void code_replica_gen_packed(uint64_t* replica, const gr_complex* code, int code_length,
+        double start_phase, double phase_step, int num_samples)
+{
+    const double scale = (double)((uint64_t)1 << CODE_REPLICA_FRAC_BITS);
+    const uint64_t wrap = (uint64_t)code_length << CODE_REPLICA_FRAC_BITS;
+    uint64_t phase_fxp = code_replica_start_fxp(code_length, start_phase);
+    const uint64_t step_fxp = (uint64_t)(phase_step * scale + 0.5);
+
+    const int num_words = code_replica_packed_words(num_samples);
+    for (int w = 0; w < num_words; w++)
+        {
+            int word_samples = num_samples - w * 64 < 64 ? num_samples - w * 64 : 64;
+            uint64_t word = 0;
+            for (int b = 0; b < word_samples; b++)
+                {
+                    if (code[phase_fxp >> CODE_REPLICA_FRAC_BITS].real() < 0)
+                        {
+                            word |= (uint64_t)1 << b;
+                        }
+                    phase_fxp += step_fxp;
+                    if (phase_fxp >= wrap)
+                        {
+                            phase_fxp -= wrap;
+                        }
+                }
+            replica[w] = word;
+        }
+}
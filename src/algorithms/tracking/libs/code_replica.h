@@ -0,0 +1,85 @@
+/*!
+ * \file code_replica.h
+ * \brief Generation of the sampled local code replica of the tracking
+ * loops by fixed point accumulation of the code phase
+ *
+ * The code phase is accumulated as an unsigned 64 bit number with 32
+ * fractional bits, and the chip of each sample is its integer part, so the
+ * inner loop has no fmod() nor round() per sample: only an addition, a
+ * shift, a compare and a table read.
+ *
+ * All the taps of a tracking loop (VE, E, P, L, VL) are generated in a
+ * single replica that starts at the earliest tap and is long enough for the
+ * latest one. Each tap is then a view of the replica at an offset of
+ * (tap spacing) samples, which the correlators read without alignment
+ * requirements, so no tap is copied.
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_CODE_REPLICA_H_
+#define GNSS_SDR_CODE_REPLICA_H_
+
+#include <stdint.h>
+#include <gnuradio/gr_complex.h>
+
+/*!
+ * \brief Samples a code table with a constant code phase step.
+ *
+ * Sample i of the replica is code[round(start_phase + i * phase_step) mod code_length],
+ * the nearest entry of the table, as the tracking loops did with
+ * round(fmod(...)) and guard entries at both ends of the table.
+ *
+ * \param replica - Output replica (num_samples samples).
+ * \param code - One period of the code (code_length entries, without guard entries),
+ * e.g. chips for GPS L1 C/A or half chips for Galileo E1.
+ * \param code_length - Entries of the table.
+ * \param start_phase - Code phase of the first sample, in table entries. It can be negative.
+ * \param phase_step - Code phase step per sample, in table entries (less than code_length).
+ * \param num_samples - Samples of the replica.
+ */
+void code_replica_gen(gr_complex* replica, const gr_complex* code, int code_length,
+        double start_phase, double phase_step, int num_samples);
+
+/*!
+ * \brief Words of a replica of num_samples samples packed by code_replica_gen_packed().
+ */
+inline int code_replica_packed_words(int num_samples)
+{
+    return (num_samples + 63) / 64;
+}
+
+/*!
+ * \brief Samples a code table as code_replica_gen(), and packs the signs of the samples.
+ *
+ * Bit i % 64 of word i / 64 of the replica is set when the real part of sample i
+ * is negative. The bits after the last sample are zero.
+ *
+ * \param replica - Output replica (code_replica_packed_words(num_samples) words).
+ */
+void code_replica_gen_packed(uint64_t* replica, const gr_complex* code, int code_length,
+        double start_phase, double phase_step, int num_samples);
+
+#endif /* GNSS_SDR_CODE_REPLICA_H_ */
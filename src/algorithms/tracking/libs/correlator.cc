@@ -36,8 +36,16 @@
 
 #include "correlator.h"
 #include <iostream>
+#include <new>
+#include <stdint.h>
+#include <glog/logging.h>
+#include "bit_packed_correlator.h"
+#include "tracking_window.h"
 #define LV_HAVE_SSE3
 #include "volk_cw_epl_corr.h"
+#include "volk_cw_multi_corr.h"
+
+using google::LogMessage;
 
 unsigned long Correlator::next_power_2(unsigned long v)
 {
@@ -78,39 +86,15 @@ void Correlator::Carrier_wipeoff_and_EPL_generic(int signal_length_samples, cons
 
 void Correlator::Carrier_wipeoff_and_EPL_volk(int signal_length_samples, const gr_complex* input, gr_complex* carrier, gr_complex* E_code, gr_complex* P_code, gr_complex* L_code, gr_complex* E_out, gr_complex* P_out, gr_complex* L_out, bool input_vector_unaligned)
 {
-    gr_complex* bb_signal;
-    //gr_complex* input_aligned;
-
-    //todo: do something if posix_memalign fails
-    if (posix_memalign((void**)&bb_signal, 16, signal_length_samples * sizeof(gr_complex)) == 0) {};
-
-    if (input_vector_unaligned == true)
-        {
-            //todo: do something if posix_memalign fails
-            //if (posix_memalign((void**)&input_aligned, 16, signal_length_samples * sizeof(gr_complex)) == 0){};
-            //memcpy(input_aligned,input,signal_length_samples * sizeof(gr_complex));
+    // The single pass kernel does not need aligned vectors
+    const gr_complex* codes[3] = {E_code, P_code, L_code};
+    gr_complex out[3];
 
-            volk_32fc_x2_multiply_32fc_u(bb_signal, input, carrier, signal_length_samples);
-        }
-    else
-        {
-            /*
-             * todo: There is a problem with the aligned version of volk_32fc_x2_multiply_32fc_a.
-             * It crashes even if the is_aligned() work function returns true. Im keeping the unaligned version in both cases..
-             */
-            //use directly the input vector
-            volk_32fc_x2_multiply_32fc_u(bb_signal, input, carrier, signal_length_samples);
-        }
+    Carrier_wipeoff_and_multicorrelator_volk(signal_length_samples, input, carrier, 3, codes, out);
 
-    volk_32fc_x2_dot_prod_32fc_a(E_out, bb_signal, E_code, signal_length_samples);
-    volk_32fc_x2_dot_prod_32fc_a(P_out, bb_signal, P_code, signal_length_samples);
-    volk_32fc_x2_dot_prod_32fc_a(L_out, bb_signal, L_code, signal_length_samples);
-
-    free(bb_signal);
-    //if (input_vector_unaligned==false)
-    //{
-    //	free(input_aligned);
-    //}
+    *E_out = out[0];
+    *P_out = out[1];
+    *L_out = out[2];
 }
 
 void Correlator::Carrier_wipeoff_and_EPL_volk_custom(int signal_length_samples, const gr_complex* input, gr_complex* carrier,gr_complex* E_code, gr_complex* P_code, gr_complex* L_code, gr_complex* E_out, gr_complex* P_out, gr_complex* L_out, bool input_vector_unaligned)
@@ -120,37 +104,47 @@ void Correlator::Carrier_wipeoff_and_EPL_volk_custom(int signal_length_samples,
 
 void Correlator::Carrier_wipeoff_and_VEPL_volk(int signal_length_samples, const gr_complex* input, gr_complex* carrier, gr_complex* VE_code, gr_complex* E_code, gr_complex* P_code, gr_complex* L_code, gr_complex* VL_code, gr_complex* VE_out, gr_complex* E_out, gr_complex* P_out, gr_complex* L_out, gr_complex* VL_out, bool input_vector_unaligned)
 {
-    gr_complex* bb_signal;
-    //gr_complex* input_aligned;
+    // The single pass kernel does not need aligned vectors
+    const gr_complex* codes[5] = {VE_code, E_code, P_code, L_code, VL_code};
+    gr_complex out[5];
 
-    //todo: do something if posix_memalign fails
-    if (posix_memalign((void**)&bb_signal, 16, signal_length_samples * sizeof(gr_complex)) == 0) {};
+    Carrier_wipeoff_and_multicorrelator_volk(signal_length_samples, input, carrier, 5, codes, out);
+
+    *VE_out = out[0];
+    *E_out = out[1];
+    *P_out = out[2];
+    *L_out = out[3];
+    *VL_out = out[4];
+}
 
-    if (input_vector_unaligned == false)
-        {
-            //todo: do something if posix_memalign fails
-            //if (posix_memalign((void**)&input_aligned, 16, signal_length_samples * sizeof(gr_complex)) == 0){};
-            //memcpy(input_aligned,input,signal_length_samples * sizeof(gr_complex));
 
-            volk_32fc_x2_multiply_32fc_u(bb_signal, input, carrier, signal_length_samples);
+
+void Correlator::Carrier_wipeoff_and_multicorrelator_volk(int signal_length_samples, const gr_complex* input, const gr_complex* carrier, int n_taps, const gr_complex* const* codes, gr_complex* out)
+{
+    if ((((uintptr_t)input | (uintptr_t)carrier) % Tracking_Window::alignment()) == 0)
+        {
+            volk_cw_multi_corr_scratch_a(input, carrier, codes, out, d_bb_signal_tile, n_taps, signal_length_samples);
         }
     else
         {
-            //use directly the input vector
-            volk_32fc_x2_multiply_32fc_u(bb_signal, input, carrier, signal_length_samples);
+            volk_cw_multi_corr_scratch_u(input, carrier, codes, out, d_bb_signal_tile, n_taps, signal_length_samples);
         }
+}
+
+
+
+void Correlator::Carrier_wipeoff_and_multicorrelator_packed(int signal_length_samples, const gr_complex* input, double carrier_phase_rad, double carrier_phase_step_rad, int n_taps, const uint64_t* const* codes, gr_complex* out)
+{
+    d_packed_correlator->Carrier_wipeoff_packed(signal_length_samples, input, carrier_phase_rad, carrier_phase_step_rad);
+    d_packed_correlator->Multicorrelator_packed(n_taps, codes, out);
+}
+
 
-    volk_32fc_x2_dot_prod_32fc_a(VE_out, bb_signal, VE_code, signal_length_samples);
-    volk_32fc_x2_dot_prod_32fc_a(E_out, bb_signal, E_code, signal_length_samples);
-    volk_32fc_x2_dot_prod_32fc_a(P_out, bb_signal, P_code, signal_length_samples);
-    volk_32fc_x2_dot_prod_32fc_a(L_out, bb_signal, L_code, signal_length_samples);
-    volk_32fc_x2_dot_prod_32fc_a(VL_out, bb_signal, VL_code, signal_length_samples);
-
-    free(bb_signal);
-    //if (input_vector_unaligned == false)
-        //{
-            //free(input_aligned);
-        //}
+
+void Correlator::set_bit_packed(int max_signal_length_samples, float magnitude_threshold)
+{
+    delete d_packed_correlator;
+    d_packed_correlator = new Bit_Packed_Correlator(max_signal_length_samples, magnitude_threshold);
 }
 
 /*
@@ -230,7 +224,18 @@ Correlator::Correlator ()
 {
     //cpu_arch_test_volk_32fc_x2_dot_prod_32fc_a();
     //cpu_arch_test_volk_32fc_x2_multiply_32fc_a();
+
+    // Aligned for the aligned VOLK kernels
+    if (posix_memalign((void**)&d_bb_signal_tile, Tracking_Window::alignment(), VOLK_CW_MULTI_CORR_TILE * sizeof(gr_complex)) != 0)
+        {
+            LOG(ERROR) << "Correlator: cannot allocate the scratch buffer of " << VOLK_CW_MULTI_CORR_TILE << " samples";
+            throw std::bad_alloc();
+        }
+    d_packed_correlator = 0;
 }
 
 Correlator::~Correlator ()
-{}
+{
+    free(d_bb_signal_tile);
+    delete d_packed_correlator;
+}
@@ -38,9 +38,12 @@
 #define GNSS_SDR_CORRELATOR_H_
 
 #include <string>
+#include <stdint.h>
 #include <volk/volk.h>
 #include <gnuradio/gr_complex.h>
 
+class Bit_Packed_Correlator;
+
 
 /*!
  * \brief Class that implements carrier wipe-off and correlators.
@@ -48,7 +51,15 @@
  * Implemented versions:
  * - Generic: Standard C++ implementation.
  * - Volk: uses VOLK (Vector-Optimized Library of Kernels) and uses the processor's SIMD instruction sets. See http://gnuradio.org/redmine/projects/gnuradio/wiki/Volk
+ * - Bit-packed: for 1-bit or 2-bit samples, XOR and popcount of the packed samples and
+ *   code replicas (see Bit_Packed_Correlator). Enabled by set_bit_packed().
  *
+ * The Volk versions perform the carrier wipe-off and all the correlations in
+ * a single pass over the input (see volk_cw_multi_corr.h), for any number of
+ * taps. The wiped-off signal only goes through an aligned scratch buffer
+ * owned by the object and allocated by the constructor, so no correlation
+ * allocates memory, whatever the length of the signal. Each tracking block
+ * owns its Correlator, which cannot be copied.
  */
 class Correlator
 {
@@ -57,9 +68,38 @@ public:
     void Carrier_wipeoff_and_EPL_volk(int signal_length_samples, const gr_complex* input, gr_complex* carrier, gr_complex* E_code, gr_complex* P_code, gr_complex* L_code, gr_complex* E_out, gr_complex* P_out, gr_complex* L_out, bool input_vector_unaligned);
     void Carrier_wipeoff_and_EPL_volk_custom(int signal_length_samples, const gr_complex* input, gr_complex* carrier, gr_complex* E_code, gr_complex* P_code, gr_complex* L_code, gr_complex* E_out, gr_complex* P_out, gr_complex* L_out, bool input_vector_unaligned);
     void Carrier_wipeoff_and_VEPL_volk(int signal_length_samples, const gr_complex* input, gr_complex* carrier, gr_complex* VE_code, gr_complex* E_code, gr_complex* P_code, gr_complex* L_code, gr_complex* VL_code, gr_complex* VE_out, gr_complex* E_out, gr_complex* P_out, gr_complex* L_out, gr_complex* VL_out, bool input_vector_unaligned);
+    /*!
+     * \brief Carrier wipe-off and correlation with n_taps code replicas (e.g. E/P/L, VE/E/P/L/VL,
+     * or a bank of taps for multipath monitoring), reading the input only once.
+     * The aligned kernel is used when the input and the carrier are aligned to Tracking_Window::alignment().
+     * \param codes - Code replica of each tap (signal_length_samples samples each, no alignment required).
+     * \param out - Correlation of each tap (n_taps values).
+     */
+    void Carrier_wipeoff_and_multicorrelator_volk(int signal_length_samples, const gr_complex* input, const gr_complex* carrier, int n_taps, const gr_complex* const* codes, gr_complex* out);
+    /*!
+     * \brief Bit-packed version of Carrier_wipeoff_and_multicorrelator_volk(), which generates the
+     * signs of the carrier exp(-j * phase) and reads packed code replicas (see code_replica_gen_packed()).
+     * \param carrier_phase_rad - Carrier phase at the first sample [rad].
+     * \param carrier_phase_step_rad - Carrier phase step per sample [rad].
+     * \param codes - Packed code replica of each tap, starting at the first sample of the signal.
+     */
+    void Carrier_wipeoff_and_multicorrelator_packed(int signal_length_samples, const gr_complex* input, double carrier_phase_rad, double carrier_phase_step_rad, int n_taps, const uint64_t* const* codes, gr_complex* out);
+    /*!
+     * \brief Enables the bit-packed version, for signals of up to max_signal_length_samples samples.
+     * \param magnitude_threshold - Absolute value from which a sample component is a +-3 level
+     * (2-bit samples). With 0, the samples are 1-bit.
+     */
+    void set_bit_packed(int max_signal_length_samples, float magnitude_threshold);
+    /*!
+     * \brief Constructor. Throws std::bad_alloc if the scratch buffer cannot be allocated.
+     */
     Correlator();
     ~Correlator();
 private:
+    Correlator(const Correlator&);
+    Correlator& operator=(const Correlator&);
+    gr_complex* d_bb_signal_tile;
+    Bit_Packed_Correlator* d_packed_correlator;
     std::string volk_32fc_x2_multiply_32fc_a_best_arch;
     std::string volk_32fc_x2_dot_prod_32fc_a_best_arch;
     unsigned long next_power_2(unsigned long v);
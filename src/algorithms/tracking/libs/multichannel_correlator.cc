@@ -0,0 +1,141 @@
+/*!
+ * \file multichannel_correlator.cc
+ * \brief Carrier wipe-off and correlation of several tracking channels on
+ * one shared block of samples
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "multichannel_correlator.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <new>
+#include <glog/logging.h>
+#include <volk/volk.h>
+#include "tracking_window.h"
+
+using google::LogMessage;
+
+
+Multichannel_Correlator::Multichannel_Correlator(int max_channels, int tile_samples)
+{
+    d_max_channels = max_channels;
+    d_tile_samples = tile_samples;
+    d_channels.reserve(d_max_channels);
+    if (posix_memalign((void**)&d_bb_signal_tile, Tracking_Window::alignment(), d_tile_samples * sizeof(gr_complex)) != 0)
+        {
+            LOG(ERROR) << "Multichannel correlator: cannot allocate the tile of " << d_tile_samples << " samples";
+            throw std::bad_alloc();
+        }
+}
+
+
+
+Multichannel_Correlator::~Multichannel_Correlator()
+{
+    free(d_bb_signal_tile);
+}
+
+
+
+void Multichannel_Correlator::clear()
+{
+    d_channels.clear();
+}
+
+
+
+bool Multichannel_Correlator::add_channel(int first_sample, int num_samples, float carrier_phase_rad,
+        float carrier_phase_step_rad, int n_taps, const gr_complex* const* codes, gr_complex* out)
+{
+    if (d_channels.size() >= d_max_channels)
+        {
+            return false;
+        }
+    Channel channel;
+    channel.first_sample = first_sample;
+    channel.num_samples = num_samples;
+    channel.carrier_phase_rad = carrier_phase_rad;
+    channel.carrier_phase_step_rad = carrier_phase_step_rad;
+    channel.n_taps = n_taps;
+    channel.codes = codes;
+    channel.out = out;
+    d_channels.push_back(channel);
+
+    for (int tap = 0; tap < n_taps; tap++)
+        {
+            out[tap] = gr_complex(0.0, 0.0);
+        }
+    return true;
+}
+
+
+
+void Multichannel_Correlator::correlate(const gr_complex* block)
+{
+    if (d_channels.empty())
+        {
+            return;
+        }
+    // The tiles cover the intervals of the channels only
+    int block_start = d_channels[0].first_sample;
+    int block_end = 0;
+    for (unsigned int ch = 0; ch < d_channels.size(); ch++)
+        {
+            block_start = std::min(block_start, d_channels[ch].first_sample);
+            block_end = std::max(block_end, d_channels[ch].first_sample + d_channels[ch].num_samples);
+        }
+
+    for (int tile_start = block_start; tile_start < block_end; tile_start += d_tile_samples)
+        {
+            int tile_end = std::min(tile_start + d_tile_samples, block_end);
+            for (unsigned int ch = 0; ch < d_channels.size(); ch++)
+                {
+                    const Channel& channel = d_channels[ch];
+                    int start = std::max(tile_start, channel.first_sample);
+                    int end = std::min(tile_end, channel.first_sample + channel.num_samples);
+                    if (start >= end)
+                        {
+                            continue;
+                        }
+                    int offset = start - channel.first_sample;
+
+                    // Carrier wipe-off of the tile, from the exact phase of its first sample
+                    double phase_rad = (double)channel.carrier_phase_rad + (double)offset * (double)channel.carrier_phase_step_rad;
+                    lv_32fc_t phase = lv_cmake((float)std::cos(phase_rad), (float)-std::sin(phase_rad));
+                    lv_32fc_t phase_inc = lv_cmake((float)std::cos((double)channel.carrier_phase_step_rad),
+                                                   (float)-std::sin((double)channel.carrier_phase_step_rad));
+                    volk_32fc_s32fc_x2_rotator_32fc(d_bb_signal_tile, block + start, phase_inc, &phase, end - start);
+
+                    for (int tap = 0; tap < channel.n_taps; tap++)
+                        {
+                            gr_complex partial;
+                            volk_32fc_x2_dot_prod_32fc_u(&partial, d_bb_signal_tile, channel.codes[tap] + offset, end - start);
+                            channel.out[tap] += partial;
+                        }
+                }
+        }
+}
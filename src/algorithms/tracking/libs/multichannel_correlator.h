@@ -0,0 +1,118 @@
+/*!
+ * \file multichannel_correlator.h
+ * \brief Carrier wipe-off and correlation of several tracking channels on
+ * one shared block of samples
+ *
+ * The channels of a receiver track different satellites on the same
+ * samples. Correlating them one after the other reads the block of samples
+ * once per channel. This engine walks the block in tiles that fit in the
+ * L1 cache, and correlates every channel on each tile before moving to the
+ * next one (sample tile outer loop, channel inner loop), so the input is
+ * read from memory once for all the channels.
+ *
+ * Each channel correlates its own interval of the block (its current code
+ * period), with its own carrier and code replicas, and accumulates the
+ * correlation of its taps. The loop filters of the channels are not part
+ * of the engine: the caller adds the channels of a block with their NCO
+ * state, runs correlate() and feeds the outputs to the loops as usual.
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_MULTICHANNEL_CORRELATOR_H_
+#define GNSS_SDR_MULTICHANNEL_CORRELATOR_H_
+
+#include <vector>
+#include <gnuradio/gr_complex.h>
+
+/*!
+ * \brief Batched carrier wipe-off and multi-tap correlation of the channels
+ * that track on the same block of samples.
+ *
+ * The carrier of each channel is generated on the fly with a phase rotator,
+ * set again from the exact phase at each tile, so no carrier vector is
+ * stored. Not thread safe: each batch is run by one thread.
+ */
+class Multichannel_Correlator
+{
+public:
+    /*!
+     * \brief Constructor. Throws std::bad_alloc if the tile cannot be allocated.
+     * \param max_channels - Channels of a batch.
+     * \param tile_samples - Samples of a tile (e.g. 1024 samples, 8 kB).
+     */
+    Multichannel_Correlator(int max_channels, int tile_samples);
+    ~Multichannel_Correlator();
+
+    /*!
+     * \brief Removes all the channels of the batch.
+     */
+    void clear();
+
+    /*!
+     * \brief Adds a channel to the batch.
+     * \param first_sample - First sample of the interval of the channel in the block.
+     * \param num_samples - Samples of the interval.
+     * \param carrier_phase_rad - Carrier phase at the first sample [rad].
+     * \param carrier_phase_step_rad - Carrier phase step per sample [rad]. The carrier is
+     * exp(-j * phase), as generated by rotator_nco().
+     * \param n_taps - Taps of the channel.
+     * \param codes - Code replica of each tap (num_samples samples each, no alignment required).
+     * \param out - Correlation of each tap (n_taps values), written by correlate().
+     * \return false if the batch is full.
+     */
+    bool add_channel(int first_sample, int num_samples, float carrier_phase_rad,
+            float carrier_phase_step_rad, int n_taps, const gr_complex* const* codes, gr_complex* out);
+
+    int num_channels() const { return (int)d_channels.size(); }
+
+    /*!
+     * \brief Correlates all the channels of the batch on a block of samples.
+     * \param block - Shared samples. The intervals of all the channels must lie in it.
+     */
+    void correlate(const gr_complex* block);
+
+private:
+    struct Channel
+    {
+        int first_sample;
+        int num_samples;
+        float carrier_phase_rad;
+        float carrier_phase_step_rad;
+        int n_taps;
+        const gr_complex* const* codes;
+        gr_complex* out;
+    };
+
+    Multichannel_Correlator(const Multichannel_Correlator&);
+    Multichannel_Correlator& operator=(const Multichannel_Correlator&);
+
+    unsigned int d_max_channels;
+    int d_tile_samples;
+    std::vector<Channel> d_channels;
+    gr_complex* d_bb_signal_tile;
+};
+
+#endif /* GNSS_SDR_MULTICHANNEL_CORRELATOR_H_ */
@@ -0,0 +1,175 @@
+/*!
+ * \file streaming_lock_detector.h
+ * \brief CN0 estimator and carrier lock detector updated at each epoch
+ *
+ * The same estimators as cn0_svn_estimator() and carrier_lock_detector()
+ * (see lock_detectors.h), computed on a window of the last prompt
+ * correlator outputs that slides one epoch at a time. The sums of the
+ * estimators are kept as running sums: each epoch adds the new prompt and
+ * removes the one that leaves the window, so an update costs the same
+ * whatever the window length, and the CN0 and lock metrics are available
+ * at every epoch instead of once per window. The sums are computed again
+ * from the window each time it wraps, so the rounding errors of the
+ * running sums do not accumulate.
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_STREAMING_LOCK_DETECTOR_H_
+#define GNSS_SDR_STREAMING_LOCK_DETECTOR_H_
+
+#include <cmath>
+#include <vector>
+
+/*!
+ * \brief Sliding window CN0 (SNV) estimator and carrier lock detector,
+ * in float (Streaming_Lock_Detector_32f) or double (Streaming_Lock_Detector_64f).
+ */
+template<typename T>
+class Streaming_Lock_Detector
+{
+public:
+    /*!
+     * \brief Constructor.
+     * \param window - Epochs of the estimation (e.g. CN0_ESTIMATION_SAMPLES).
+     * \param fs_in - Sampling frequency [Hz].
+     * \param code_length - Chips of the PRN code of an epoch.
+     */
+    Streaming_Lock_Detector(int window, long fs_in, double code_length)
+    {
+        d_window = window > 0 ? window : 1;
+        d_prompt_i.resize(d_window);
+        d_prompt_q.resize(d_window);
+        // Receiver bandwidth and code gain, 10*log10(fs/2) - 10*log10(L_PRN)
+        d_bandwidth_db = (T)(10.0 * std::log10((double)(fs_in / 2)) - 10.0 * std::log10(code_length));
+        reset();
+    }
+
+    /*!
+     * \brief Empties the window (e.g. at the start of the tracking).
+     */
+    void reset()
+    {
+        d_count = 0;
+        d_next = 0;
+        d_sum_abs_i = 0;
+        d_sum_power = 0;
+        d_sum_i = 0;
+        d_sum_q = 0;
+    }
+
+    /*!
+     * \brief Adds the prompt correlator output of an epoch.
+     */
+    void update(T prompt_i, T prompt_q)
+    {
+        if (d_count == d_window)
+            {
+                // The oldest epoch leaves the window
+                T old_i = d_prompt_i[d_next];
+                T old_q = d_prompt_q[d_next];
+                d_sum_abs_i -= std::abs(old_i);
+                d_sum_power -= old_i * old_i + old_q * old_q;
+                d_sum_i -= old_i;
+                d_sum_q -= old_q;
+            }
+        else
+            {
+                d_count++;
+            }
+        d_prompt_i[d_next] = prompt_i;
+        d_prompt_q[d_next] = prompt_q;
+        d_sum_abs_i += std::abs(prompt_i);
+        d_sum_power += prompt_i * prompt_i + prompt_q * prompt_q;
+        d_sum_i += prompt_i;
+        d_sum_q += prompt_q;
+        d_next++;
+        if (d_next == d_window)
+            {
+                d_next = 0;
+                resum();
+            }
+    }
+
+    /*!
+     * \brief True once the window holds window epochs.
+     */
+    bool full() const { return d_count == d_window; }
+
+    /*!
+     * \brief CN0 of the window [dB-Hz], as cn0_svn_estimator(). It takes a
+     * logarithm: evaluate it at the rate of the lock checks, not every epoch.
+     */
+    T cn0_db_hz() const
+    {
+        T psig = d_sum_abs_i / (T)d_count;
+        psig = psig * psig;
+        T ptot = d_sum_power / (T)d_count;
+        return (T)10.0 * std::log10(psig / (ptot - psig)) + d_bandwidth_db;
+    }
+
+    /*!
+     * \brief Estimate of the cosine of twice the carrier phase error on the
+     * window, as carrier_lock_detector().
+     */
+    T carrier_lock() const
+    {
+        T nbp = d_sum_i * d_sum_i + d_sum_q * d_sum_q;
+        T nbd = d_sum_i * d_sum_i - d_sum_q * d_sum_q;
+        return nbd / nbp;
+    }
+
+private:
+    void resum()
+    {
+        d_sum_abs_i = 0;
+        d_sum_power = 0;
+        d_sum_i = 0;
+        d_sum_q = 0;
+        for (int i = 0; i < d_count; i++)
+            {
+                d_sum_abs_i += std::abs(d_prompt_i[i]);
+                d_sum_power += d_prompt_i[i] * d_prompt_i[i] + d_prompt_q[i] * d_prompt_q[i];
+                d_sum_i += d_prompt_i[i];
+                d_sum_q += d_prompt_q[i];
+            }
+    }
+
+    int d_window;
+    int d_count;
+    int d_next;
+    std::vector<T> d_prompt_i;
+    std::vector<T> d_prompt_q;
+    T d_bandwidth_db;
+    T d_sum_abs_i;
+    T d_sum_power;
+    T d_sum_i;
+    T d_sum_q;
+};
+
+typedef Streaming_Lock_Detector<float> Streaming_Lock_Detector_32f;
+typedef Streaming_Lock_Detector<double> Streaming_Lock_Detector_64f;
+
+#endif /* GNSS_SDR_STREAMING_LOCK_DETECTOR_H_ */
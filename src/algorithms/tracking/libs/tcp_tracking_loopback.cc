@@ -0,0 +1,156 @@
+/*!
+ * \file tcp_tracking_loopback.cc
+ * \brief Stand-in for the external loop filter program of the TCP
+ * connector tracking, for the tests
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "tcp_tracking_loopback.h"
+#include <vector>
+#include <boost/bind.hpp>
+#include <glog/logging.h>
+#include "tcp_tracking_transport.h"
+
+// Connection attempts, 10 ms apart
+#define TCP_TRACKING_LOOPBACK_RETRIES 500
+
+using google::LogMessage;
+
+Tcp_Tracking_Loopback::Tcp_Tracking_Loopback(unsigned short port, bool stalled) : d_socket(d_io_service)
+{
+    d_port = port;
+    d_stalled = stalled;
+    d_packets = 0;
+    d_records = 0;
+    d_thread = boost::thread(boost::bind(&Tcp_Tracking_Loopback::run, this));
+}
+
+
+
+Tcp_Tracking_Loopback::~Tcp_Tracking_Loopback()
+{
+    boost::system::error_code error;
+    d_socket.shutdown(boost::asio::ip::tcp::socket::shutdown_both, error);
+    join();
+    d_socket.close(error);
+}
+
+
+
+void Tcp_Tracking_Loopback::join()
+{
+    if (d_thread.joinable())
+        {
+            d_thread.join();
+        }
+}
+
+
+
+unsigned int Tcp_Tracking_Loopback::packets()
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+    return d_packets;
+}
+
+
+
+unsigned int Tcp_Tracking_Loopback::records()
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+    return d_records;
+}
+
+
+
+void Tcp_Tracking_Loopback::run()
+{
+    boost::asio::ip::tcp::endpoint endpoint(boost::asio::ip::address_v4::loopback(), d_port);
+    boost::system::error_code error;
+    for (int retry = 0; retry < TCP_TRACKING_LOOPBACK_RETRIES; retry++)
+        {
+            d_socket.close(error);
+            d_socket.connect(endpoint, error);
+            if (!error)
+                {
+                    break;
+                }
+            boost::this_thread::sleep(boost::posix_time::milliseconds(10));
+        }
+    if (error)
+        {
+            LOG(ERROR) << "TCP tracking loopback: no connection on port " << d_port;
+            return;
+        }
+    if (d_stalled == true)
+        {
+            // Connected, but the requests are never read
+            return;
+        }
+
+    std::vector<float> request;
+    std::vector<float> response;
+    while (true)
+        {
+            float header;
+            boost::asio::read(d_socket, boost::asio::buffer(&header, sizeof(float)), error);
+            if (error)
+                {
+                    break;
+                }
+            int num_records = (int)header;
+            request.resize(num_records * TCP_TRACKING_REQUEST_RECORD);
+            boost::asio::read(d_socket, boost::asio::buffer(request), error);
+            if (error)
+                {
+                    break;
+                }
+
+            response.resize(1 + num_records * TCP_TRACKING_RESPONSE_RECORD);
+            response[0] = header;
+            for (int i = 0; i < num_records; i++)
+                {
+                    const float* in = &request[i * TCP_TRACKING_REQUEST_RECORD];
+                    float* out = &response[1 + i * TCP_TRACKING_RESPONSE_RECORD];
+                    int num_variables = (int)in[1];
+                    out[0] = in[0];                                  // channel
+                    out[1] = in[2];                                  // control id
+                    out[2] = 0.0;                                    // code error
+                    out[3] = 0.0;                                    // carrier error
+                    out[4] = num_variables >= 2 ? in[2 + num_variables - 2] : 0.0; // carrier Doppler
+                }
+            {
+                boost::mutex::scoped_lock lock(d_mutex);
+                d_packets++;
+                d_records += num_records;
+            }
+            boost::asio::write(d_socket, boost::asio::buffer(response), error);
+            if (error)
+                {
+                    break;
+                }
+        }
+}
@@ -0,0 +1,87 @@
+/*!
+ * \file tcp_tracking_loopback.h
+ * \brief Stand-in for the external loop filter program of the TCP
+ * connector tracking, for the tests
+ *
+ * It connects to the Tcp_Tracking_Transport and answers each request with
+ * zero code and carrier errors and the carrier Doppler sent by the channel
+ * (the penultimate variable of the request, the acquisition Doppler of the
+ * TCP connector blocks), that is, an open loop.
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_TCP_TRACKING_LOOPBACK_H_
+#define GNSS_SDR_TCP_TRACKING_LOOPBACK_H_
+
+#include <boost/asio.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+
+/*!
+ * \brief Open loop answering the requests of a Tcp_Tracking_Transport on
+ * the local host.
+ */
+class Tcp_Tracking_Loopback
+{
+public:
+    /*!
+     * \brief Starts a thread that connects to 127.0.0.1:port (retrying
+     * while the transport is not listening) and answers the requests until
+     * the transport closes the connection. A stalled loopback keeps the
+     * connection open but never reads the requests.
+     */
+    Tcp_Tracking_Loopback(unsigned short port, bool stalled = false);
+
+    /*!
+     * \brief Closes the connection and waits for the thread.
+     */
+    ~Tcp_Tracking_Loopback();
+
+    /*!
+     * \brief Waits until the transport closes the connection.
+     */
+    void join();
+
+    unsigned int packets();
+    unsigned int records();
+
+private:
+    Tcp_Tracking_Loopback(const Tcp_Tracking_Loopback&);
+    Tcp_Tracking_Loopback& operator=(const Tcp_Tracking_Loopback&);
+
+    void run();
+
+    unsigned short d_port;
+    bool d_stalled;
+    boost::asio::io_service d_io_service;
+    boost::asio::ip::tcp::socket d_socket;
+    boost::thread d_thread;
+    boost::mutex d_mutex;
+    unsigned int d_packets;
+    unsigned int d_records;
+};
+
+#endif /* GNSS_SDR_TCP_TRACKING_LOOPBACK_H_ */
@@ -0,0 +1,354 @@
+/*!
+ * \file tcp_tracking_transport.cc
+ * \brief Pipelined and batched TCP transport shared by the TCP connector
+ * tracking channels
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "tcp_tracking_transport.h"
+#include <iostream>
+#include <boost/bind.hpp>
+#include <boost/thread/thread_time.hpp>
+#include <boost/weak_ptr.hpp>
+#include <glog/logging.h>
+
+// A response packet never carries more records than this
+#define TCP_TRACKING_MAX_RECORDS 65536
+
+// Time given to the last requests to go out when the transport is closed
+#define TCP_TRACKING_CLOSE_TIMEOUT_MS 1000
+
+using google::LogMessage;
+
+tcp_tracking_transport_sptr Tcp_Tracking_Transport::shared(unsigned short port, int batch_epochs, int pipeline_depth)
+{
+    // Never destroyed, so that no channel can outlive them
+    static boost::mutex* mutex = new boost::mutex();
+    static std::map<unsigned short, boost::weak_ptr<Tcp_Tracking_Transport> >* transports =
+            new std::map<unsigned short, boost::weak_ptr<Tcp_Tracking_Transport> >();
+
+    // The other channels wait here while the first one waits for the connection
+    boost::mutex::scoped_lock lock(*mutex);
+    tcp_tracking_transport_sptr running = (*transports)[port].lock();
+    if (!running)
+        {
+            running = tcp_tracking_transport_sptr(new Tcp_Tracking_Transport(port, batch_epochs, pipeline_depth));
+            (*transports)[port] = running;
+        }
+    return running;
+}
+
+
+
+Tcp_Tracking_Transport::Tcp_Tracking_Transport(unsigned short port, int batch_epochs, int pipeline_depth) :
+        d_socket(d_io_service)
+{
+    d_port = port;
+    d_batch_epochs = batch_epochs > 0 ? batch_epochs : 1;
+    d_pipeline_depth = pipeline_depth > 0 ? pipeline_depth : 0;
+    d_connected = false;
+    d_writing = false;
+    d_batch_records = 0;
+    d_batch.push_back(0.0);
+    d_read_header = 0.0;
+
+    try
+    {
+            boost::asio::ip::tcp::endpoint endpoint(boost::asio::ip::tcp::v4(), d_port);
+            boost::asio::ip::tcp::acceptor acceptor(d_io_service);
+            acceptor.open(endpoint.protocol());
+            acceptor.set_option(boost::asio::ip::tcp::acceptor::reuse_address(true));
+            acceptor.bind(endpoint);
+            acceptor.listen();
+            std::cout << "Server ready. Listening for TCP connections on port " << d_port << "..." << std::endl;
+            acceptor.accept(d_socket);
+            d_socket.set_option(boost::asio::ip::tcp::no_delay(true));
+            d_connected = true;
+            std::cout << "Socket accepted on port " << d_port << std::endl;
+    }
+    catch(std::exception& e)
+    {
+            LOG(ERROR) << "TCP tracking transport on port " << d_port << ": " << e.what();
+            std::cerr << "Exception: " << e.what() << std::endl;
+            return;
+    }
+
+    LOG(INFO) << "TCP tracking transport on port " << d_port << ", " << d_batch_epochs
+              << " epochs per packet, pipeline depth " << d_pipeline_depth;
+    start_read();
+    d_io_thread = boost::thread(boost::bind(&boost::asio::io_service::run, &d_io_service));
+}
+
+
+
+Tcp_Tracking_Transport::~Tcp_Tracking_Transport()
+{
+    {
+        // Let the last requests go out, unless the program stopped reading them
+        boost::mutex::scoped_lock lock(d_mutex);
+        flush_batch();
+        boost::system_time deadline = boost::get_system_time() + boost::posix_time::milliseconds(TCP_TRACKING_CLOSE_TIMEOUT_MS);
+        while (d_connected && (d_writing || !d_write_queue.empty()))
+            {
+                if (d_condition.timed_wait(lock, deadline) == false)
+                    {
+                        LOG(WARNING) << "TCP tracking transport on port " << d_port << ": "
+                                     << d_write_queue.size() + (d_writing ? 1 : 0) << " packets not sent";
+                        break;
+                    }
+            }
+    }
+    // The pending writes are cancelled when the socket is closed
+    d_io_service.stop();
+    if (d_io_thread.joinable())
+        {
+            d_io_thread.join();
+        }
+    boost::system::error_code error;
+    d_socket.close(error);
+    std::cout << "Socket closed on port " << d_port << std::endl;
+}
+
+
+
+bool Tcp_Tracking_Transport::connected()
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+    return d_connected;
+}
+
+
+
+bool Tcp_Tracking_Transport::exchange(unsigned int channel, const float* tx_variables, int num_tx_variables, tcp_packet_data* tcp_data)
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+    if (d_connected == false)
+        {
+            return false;
+        }
+
+    // Queue the request in the current batch
+    Channel_Pipeline& pipeline = d_channels[channel];
+    d_batch.push_back((float)channel);
+    d_batch.push_back((float)num_tx_variables);
+    for (int i = 0; i < NUM_TX_VARIABLES_GALILEO_E1; i++)
+        {
+            d_batch.push_back(i < num_tx_variables ? tx_variables[i] : 0.0);
+        }
+    d_batch_records++;
+    pipeline.outstanding++;
+    pipeline.control_ids.push_back(tx_variables[0]);
+    if (d_batch_records >= d_batch_epochs)
+        {
+            flush_batch();
+        }
+
+    // The response of the epoch pipeline_depth epochs before is due
+    if (pipeline.outstanding - pipeline.discard <= d_pipeline_depth)
+        {
+            return false;
+        }
+    if (pipeline.responses.empty())
+        {
+            // Its request may still be waiting in the batch
+            flush_batch();
+        }
+    while (pipeline.responses.empty() && d_connected)
+        {
+            d_condition.wait(lock);
+        }
+    if (pipeline.responses.empty())
+        {
+            return false;
+        }
+    *tcp_data = pipeline.responses.front();
+    pipeline.responses.pop_front();
+    pipeline.outstanding--;
+    return true;
+}
+
+
+
+void Tcp_Tracking_Transport::reset_channel(unsigned int channel)
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+    Channel_Pipeline& pipeline = d_channels[channel];
+    pipeline.outstanding -= pipeline.responses.size();
+    pipeline.responses.clear();
+    pipeline.control_ids.clear();
+    pipeline.discard = pipeline.outstanding;
+}
+
+
+
+void Tcp_Tracking_Transport::flush()
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+    flush_batch();
+}
+
+
+
+void Tcp_Tracking_Transport::flush_batch()
+{
+    // d_mutex is held by the caller
+    if (d_batch_records == 0 || d_connected == false)
+        {
+            return;
+        }
+    d_batch[0] = (float)d_batch_records;
+    d_write_queue.push_back(std::vector<float>());
+    d_write_queue.back().swap(d_batch);
+    d_batch.reserve(1 + d_batch_epochs * TCP_TRACKING_REQUEST_RECORD);
+    d_batch.push_back(0.0);
+    d_batch_records = 0;
+    d_io_service.post(boost::bind(&Tcp_Tracking_Transport::start_write, this));
+}
+
+
+
+void Tcp_Tracking_Transport::start_write()
+{
+    {
+        boost::mutex::scoped_lock lock(d_mutex);
+        if (d_writing || d_write_queue.empty())
+            {
+                return;
+            }
+        d_writing = true;
+        d_write_packet.swap(d_write_queue.front());
+        d_write_queue.pop_front();
+    }
+    boost::asio::async_write(d_socket, boost::asio::buffer(d_write_packet),
+            boost::bind(&Tcp_Tracking_Transport::handle_write, this, boost::asio::placeholders::error));
+}
+
+
+
+void Tcp_Tracking_Transport::handle_write(const boost::system::error_code& error)
+{
+    if (error)
+        {
+            fail(error);
+            return;
+        }
+    {
+        boost::mutex::scoped_lock lock(d_mutex);
+        d_writing = false;
+        d_condition.notify_all();
+    }
+    start_write();
+}
+
+
+
+void Tcp_Tracking_Transport::start_read()
+{
+    boost::asio::async_read(d_socket, boost::asio::buffer(&d_read_header, sizeof(float)),
+            boost::bind(&Tcp_Tracking_Transport::handle_read_header, this, boost::asio::placeholders::error));
+}
+
+
+
+void Tcp_Tracking_Transport::handle_read_header(const boost::system::error_code& error)
+{
+    if (error)
+        {
+            fail(error);
+            return;
+        }
+    int num_records = (int)d_read_header;
+    if (num_records < 0 || num_records > TCP_TRACKING_MAX_RECORDS)
+        {
+            LOG(ERROR) << "TCP tracking transport on port " << d_port << ": packet error, " << d_read_header << " records";
+            fail(boost::asio::error::invalid_argument);
+            return;
+        }
+    d_read_records.resize(num_records * TCP_TRACKING_RESPONSE_RECORD);
+    boost::asio::async_read(d_socket, boost::asio::buffer(d_read_records),
+            boost::bind(&Tcp_Tracking_Transport::handle_read_records, this, boost::asio::placeholders::error));
+}
+
+
+
+void Tcp_Tracking_Transport::handle_read_records(const boost::system::error_code& error)
+{
+    if (error)
+        {
+            fail(error);
+            return;
+        }
+    {
+        boost::mutex::scoped_lock lock(d_mutex);
+        for (unsigned int i = 0; i < d_read_records.size(); i += TCP_TRACKING_RESPONSE_RECORD)
+            {
+                const float* record = &d_read_records[i];
+                std::map<unsigned int, Channel_Pipeline>::iterator it = d_channels.find((unsigned int)record[0]);
+                if (it == d_channels.end() || it->second.outstanding <= (int)it->second.responses.size())
+                    {
+                        LOG(ERROR) << "TCP tracking transport: unexpected response for channel " << record[0];
+                        continue;
+                    }
+                Channel_Pipeline& pipeline = it->second;
+                if (pipeline.discard > 0)
+                    {
+                        // Request of the previous satellite of the channel
+                        pipeline.discard--;
+                        pipeline.outstanding--;
+                        continue;
+                    }
+                //! Control. The responses of a channel come in the order of its requests
+                if (pipeline.control_ids.front() != record[1])
+                    {
+                        LOG(ERROR) << "TCP tracking transport: packet error on channel " << record[0]
+                                   << ", control id " << record[1] << " instead of " << pipeline.control_ids.front();
+                    }
+                pipeline.control_ids.pop_front();
+                tcp_packet_data response;
+                response.proc_pack_code_error = record[2];
+                response.proc_pack_carr_error = record[3];
+                response.proc_pack_carrier_doppler_hz = record[4];
+                pipeline.responses.push_back(response);
+            }
+        d_condition.notify_all();
+    }
+    start_read();
+}
+
+
+
+void Tcp_Tracking_Transport::fail(const boost::system::error_code& error)
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+    if (d_connected)
+        {
+            LOG(ERROR) << "TCP tracking transport on port " << d_port << ": " << error.message();
+            std::cerr << "TCP connection lost on port " << d_port << ": " << error.message() << std::endl;
+        }
+    d_connected = false;
+    d_writing = false;
+    d_condition.notify_all();
+}
@@ -0,0 +1,179 @@
+/*!
+ * \file tcp_tracking_transport.h
+ * \brief Pipelined and batched TCP transport shared by the TCP connector
+ * tracking channels
+ *
+ * All the channels exchange their epochs with the external loop filter
+ * program through one TCP connection. The requests of several epochs (of
+ * any channel) are sent in one packet, and the channels do not wait for the
+ * response of an epoch before the next one: the response of the epoch k is
+ * applied at the epoch k + pipeline_depth, so a channel only blocks if the
+ * round trip is longer than pipeline_depth epochs. The I/O runs
+ * asynchronously in a thread of the transport.
+ *
+ * The tracking blocks use it only when batch_epochs > 1 or
+ * pipeline_depth > 0. With the defaults each channel keeps its own
+ * connection on port_ch0 + channel (tcp_communication) and the packets of
+ * the blocking protocol, so the existing loop filter programs still work.
+ * The programs that enable the batching have to implement the packets
+ * below, on the single connection on port_ch0.
+ *
+ * Request packet (floats): number of records, then one record of
+ * TCP_TRACKING_REQUEST_RECORD floats per epoch:
+ * [channel, number of variables, variables (zero padded)].
+ * The variables are those of the blocking protocol, starting with the
+ * control id.
+ *
+ * Response packet (floats): number of records, then one record of
+ * TCP_TRACKING_RESPONSE_RECORD floats per epoch:
+ * [channel, control id, code error, carrier error, carrier Doppler].
+ * The responses of a channel come in the order of its requests.
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_TCP_TRACKING_TRANSPORT_H_
+#define GNSS_SDR_TCP_TRACKING_TRANSPORT_H_
+
+#include <deque>
+#include <map>
+#include <vector>
+#include <boost/asio.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include "tcp_communication.h"
+#include "tcp_packet_data.h"
+
+#define TCP_TRACKING_REQUEST_RECORD (2 + NUM_TX_VARIABLES_GALILEO_E1)
+#define TCP_TRACKING_RESPONSE_RECORD (1 + NUM_RX_VARIABLES)
+
+class Tcp_Tracking_Transport;
+
+typedef boost::shared_ptr<Tcp_Tracking_Transport> tcp_tracking_transport_sptr;
+
+/*!
+ * \brief TCP connection to the external loop filter program, shared by
+ * all the channels.
+ */
+class Tcp_Tracking_Transport
+{
+public:
+    /*!
+     * \brief Returns the transport of a port, shared by all the channels, and
+     * waits for the connection if it is not open. The parameters of the first
+     * call are used.
+     * \param port - TCP port (port_ch0 of the configuration).
+     * \param batch_epochs - Requests sent in one packet.
+     * \param pipeline_depth - Epochs between a request and the use of its response.
+     */
+    static tcp_tracking_transport_sptr shared(unsigned short port, int batch_epochs, int pipeline_depth);
+
+    /*!
+     * \brief Listens on the port and waits for the connection of the loop filter program.
+     */
+    Tcp_Tracking_Transport(unsigned short port, int batch_epochs, int pipeline_depth);
+
+    /*!
+     * \brief Sends the pending requests and closes the connection. The
+     * requests that cannot be sent within one second (e.g. the program
+     * stopped reading) are dropped.
+     */
+    ~Tcp_Tracking_Transport();
+
+    /*!
+     * \brief Queues the request of an epoch of a channel, and gets the
+     * response of the epoch pipeline_depth() epochs before.
+     * \param channel - Channel of the request.
+     * \param tx_variables - Variables of the request, starting with the control id.
+     * \param num_tx_variables - Number of variables (at most NUM_TX_VARIABLES_GALILEO_E1).
+     * \param tcp_data - Response of the older epoch.
+     * \return false if no response is due yet (the first epochs of the
+     * channel) or the connection failed. The channel keeps its NCO commands.
+     */
+    bool exchange(unsigned int channel, const float* tx_variables, int num_tx_variables, tcp_packet_data* tcp_data);
+
+    /*!
+     * \brief Drops the responses of the channel still in the pipeline (e.g.
+     * when the channel starts tracking another satellite).
+     */
+    void reset_channel(unsigned int channel);
+
+    /*!
+     * \brief Sends the requests queued in the current batch.
+     */
+    void flush();
+
+    int batch_epochs() const { return d_batch_epochs; }
+    int pipeline_depth() const { return d_pipeline_depth; }
+    bool connected();
+
+private:
+    struct Channel_Pipeline
+    {
+        Channel_Pipeline() : outstanding(0), discard(0) {}
+        int outstanding;
+        int discard;
+        std::deque<float> control_ids;
+        std::deque<tcp_packet_data> responses;
+    };
+
+    Tcp_Tracking_Transport(const Tcp_Tracking_Transport&);
+    Tcp_Tracking_Transport& operator=(const Tcp_Tracking_Transport&);
+
+    void flush_batch();
+    void start_write();
+    void handle_write(const boost::system::error_code& error);
+    void start_read();
+    void handle_read_header(const boost::system::error_code& error);
+    void handle_read_records(const boost::system::error_code& error);
+    void fail(const boost::system::error_code& error);
+
+    unsigned short d_port;
+    int d_batch_epochs;
+    int d_pipeline_depth;
+
+    boost::asio::io_service d_io_service;
+    boost::asio::ip::tcp::socket d_socket;
+    boost::thread d_io_thread;
+
+    // Shared with the channels, protected by d_mutex
+    boost::mutex d_mutex;
+    boost::condition_variable d_condition;
+    bool d_connected;
+    bool d_writing;
+    std::vector<float> d_batch;
+    int d_batch_records;
+    std::deque<std::vector<float> > d_write_queue;
+    std::map<unsigned int, Channel_Pipeline> d_channels;
+
+    // Used only by the I/O thread
+    std::vector<float> d_write_packet;
+    float d_read_header;
+    std::vector<float> d_read_records;
+};
+
+#endif /* GNSS_SDR_TCP_TRACKING_TRANSPORT_H_ */
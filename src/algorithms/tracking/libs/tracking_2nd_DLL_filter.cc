@@ -59,6 +59,13 @@ void Tracking_2nd_DLL_filter::set_DLL_BW(float dll_bw_hz)
 
 
 
+void Tracking_2nd_DLL_filter::set_pdi(float pdi_code)
+{
+    d_pdi_code = pdi_code; // Summation interval for code
+}
+
+
+
 void Tracking_2nd_DLL_filter::initialize()
 {
     // code tracking loop parameters
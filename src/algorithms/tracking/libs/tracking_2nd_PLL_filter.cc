@@ -58,6 +58,13 @@ void Tracking_2nd_PLL_filter::set_PLL_BW(float pll_bw_hz)
 
 
 
+void Tracking_2nd_PLL_filter::set_pdi(float pdi_carr)
+{
+    d_pdi_carr = pdi_carr; // Summation interval for carrier
+}
+
+
+
 void Tracking_2nd_PLL_filter::initialize()
 {
     // carrier/Costas loop parameters
@@ -80,6 +87,11 @@ float Tracking_2nd_PLL_filter::get_carrier_nco(float PLL_discriminator)
     return carr_nco;
 }
 
+void Tracking_2nd_PLL_filter::set_carrier_nco(float carr_nco)
+{
+    d_old_carr_nco = carr_nco;
+}
+
 Tracking_2nd_PLL_filter::Tracking_2nd_PLL_filter (float pdi_carr)
 {
     //--- PLL variables --------------------------------------------------------
@@ -62,8 +62,10 @@ private:
 
 public:
 	void set_PLL_BW(float pll_bw_hz);  //! Set PLL loop bandwidth [Hz]
+	void set_pdi(float pdi_carr);  //! Set the summation interval of the discriminator input [s]
 	void initialize();
 	float get_carrier_nco(float PLL_discriminator);
+	void set_carrier_nco(float carr_nco);  //! Continue from a given output [Hz], e.g. when the base frequency changes
         Tracking_2nd_PLL_filter(float pdi_carr);
 	Tracking_2nd_PLL_filter();
 	~Tracking_2nd_PLL_filter();
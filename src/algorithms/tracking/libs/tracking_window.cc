@@ -0,0 +1,86 @@
+/*!
+ * \file tracking_window.cc
+ * \brief Aligned window over the input samples of a tracking epoch
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "tracking_window.h"
+#include <stdint.h>
+#include <volk/volk.h>
+
+// Samples of a SIMD word
+#define TRACKING_WINDOW_WORD_SAMPLES (alignment() / (int)sizeof(gr_complex))
+
+
+Tracking_Window::Tracking_Window()
+{
+    d_data = 0;
+    d_lead = 0;
+    d_length = 0;
+    d_num_samples = 0;
+}
+
+
+
+int Tracking_Window::alignment()
+{
+    int volk_alignment = (int)volk_get_alignment();
+    return volk_alignment > (int)sizeof(gr_complex) ? volk_alignment : (int)sizeof(gr_complex);
+}
+
+
+
+int Tracking_Window::history()
+{
+    // Up to one SIMD word minus one sample before the epoch, plus the first sample
+    return TRACKING_WINDOW_WORD_SAMPLES;
+}
+
+
+
+void Tracking_Window::set(const gr_complex* input, int num_samples)
+{
+    const gr_complex* first = input + history() - 1;
+    // The samples are gr_complex aligned, so the misalignment is a whole number of samples
+    d_lead = (int)(((uintptr_t)first % alignment()) / sizeof(gr_complex));
+    d_data = first - d_lead;
+    d_num_samples = num_samples;
+    d_length = ((d_lead + num_samples + TRACKING_WINDOW_WORD_SAMPLES - 1) / TRACKING_WINDOW_WORD_SAMPLES) * TRACKING_WINDOW_WORD_SAMPLES;
+}
+
+
+
+void Tracking_Window::clear_padding(gr_complex* carrier) const
+{
+    for (int i = 0; i < d_lead; i++)
+        {
+            carrier[i] = gr_complex(0.0, 0.0);
+        }
+    for (int i = d_lead + d_num_samples; i < d_length; i++)
+        {
+            carrier[i] = gr_complex(0.0, 0.0);
+        }
+}
@@ -0,0 +1,94 @@
+/*!
+ * \file tracking_window.h
+ * \brief Aligned window over the input samples of a tracking epoch
+ *
+ * The tracking blocks consume a code period per call, which is not a
+ * multiple of the SIMD width, so the first sample of an epoch is rarely at
+ * an aligned address and the correlators had to use the unaligned kernels.
+ *
+ * The window starts at the aligned address at or before the first sample
+ * of the epoch (the block keeps the previous samples with set_history()),
+ * and its length is rounded up to whole SIMD words. The samples of the
+ * window that are not part of the epoch (lead and tail) are cancelled by a
+ * zero carrier, so the correlation is the one of the epoch. The input is
+ * never copied.
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_TRACKING_WINDOW_H_
+#define GNSS_SDR_TRACKING_WINDOW_H_
+
+#include <gnuradio/gr_complex.h>
+
+/*!
+ * \brief Aligned view of the input of a tracking block for one epoch.
+ */
+class Tracking_Window
+{
+public:
+    Tracking_Window();
+
+    /*!
+     * \brief Alignment of the windows, in bytes. It is the alignment that the
+     * aligned VOLK kernels need on this machine (volk_get_alignment(), e.g. 64
+     * with AVX-512), and at least one sample. The carrier replicas and the
+     * scratch buffers used with the windows have to be allocated with it.
+     */
+    static int alignment();
+
+    /*!
+     * \brief History the block has to keep with set_history(), in samples.
+     * The first sample of the epoch is input_items[0][history() - 1], and the
+     * forecast has to ask for history() - 1 samples more.
+     */
+    static int history();
+
+    /*!
+     * \brief Sets the window of an epoch.
+     * \param input - Input of the block (input_items[0], starting with the history).
+     * \param num_samples - Samples of the epoch.
+     */
+    void set(const gr_complex* input, int num_samples);
+
+    /*!
+     * \brief Zeroes the lead and tail samples of a window-sized carrier
+     * replica, whose epoch samples start at carrier + lead().
+     */
+    void clear_padding(gr_complex* carrier) const;
+
+    const gr_complex* data() const { return d_data; }   //!< First sample of the window (aligned)
+    int lead() const { return d_lead; }                 //!< Samples before the first sample of the epoch
+    int length() const { return d_length; }             //!< Samples of the window
+    int num_samples() const { return d_num_samples; }   //!< Samples of the epoch
+
+private:
+    const gr_complex* d_data;
+    int d_lead;
+    int d_length;
+    int d_num_samples;
+};
+
+#endif /* GNSS_SDR_TRACKING_WINDOW_H_ */
@@ -109,7 +109,7 @@ static inline void volk_cw_epl_corr_u(const lv_32fc_t* input, const lv_32fc_t* c
       //x = _mm_load_ps((float*)_input_BB); // Load the ar + ai, br + bi as ar,ai,br,bi
       x = z;
 
-      y = _mm_load_ps((float*)_E_code); // Load the cr + ci, dr + di as cr,ci,dr,di
+      y = _mm_loadu_ps((float*)_E_code); // Load the cr + ci, dr + di as cr,ci,dr,di
 
       yl = _mm_moveldup_ps(y); // Load yl with cr,cr,dr,dr
       yh = _mm_movehdup_ps(y); // Load yh with ci,ci,di,di
@@ -126,7 +126,7 @@ static inline void volk_cw_epl_corr_u(const lv_32fc_t* input, const lv_32fc_t* c
 
       // Prompt
       //x = _mm_load_ps((float*)_input_BB); // Load the ar + ai, br + bi as ar,ai,br,bi
-      y = _mm_load_ps((float*)_P_code); // Load the cr + ci, dr + di as cr,ci,dr,di
+      y = _mm_loadu_ps((float*)_P_code); // Load the cr + ci, dr + di as cr,ci,dr,di
 
       yl = _mm_moveldup_ps(y); // Load yl with cr,cr,dr,dr
       yh = _mm_movehdup_ps(y); // Load yh with ci,ci,di,di
@@ -145,7 +145,7 @@ static inline void volk_cw_epl_corr_u(const lv_32fc_t* input, const lv_32fc_t* c
 
       // Late
       //x = _mm_load_ps((float*)_input_BB); // Load the ar + ai, br + bi as ar,ai,br,bi
-      y = _mm_load_ps((float*)_L_code); // Load the cr + ci, dr + di as cr,ci,dr,di
+      y = _mm_loadu_ps((float*)_L_code); // Load the cr + ci, dr + di as cr,ci,dr,di
 
       yl = _mm_moveldup_ps(y); // Load yl with cr,cr,dr,dr
       yh = _mm_movehdup_ps(y); // Load yh with ci,ci,di,di
@@ -0,0 +1,168 @@
+/*!
+ * \file volk_cw_multi_corr.h
+ * \brief Implements the carrier wipe-off function and any number of
+ * correlators in a single pass over the input signal.
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_VOLK_CW_MULTI_CORR_H_
+#define GNSS_SDR_VOLK_CW_MULTI_CORR_H_
+
+#include <volk/volk.h>
+#include <volk/volk_complex.h>
+
+/*!
+ * \brief Samples of the carrier wiped-off signal kept at a time by
+ * volk_cw_multi_corr_u (2 KB, so they stay in the L1 cache). This is the
+ * size of the scratch buffer of volk_cw_multi_corr_scratch_u.
+ */
+#define VOLK_CW_MULTI_CORR_TILE 256
+
+
+/*!
+  \brief Performs the carrier wipe-off mixing and the correlation with
+  num_taps code replicas, sample by sample.
+  \param input The input signal input
+  \param carrier The carrier signal input
+  \param codes The code replica of each tap
+  \param out The correlation output of each tap
+  \param num_taps The number of correlators
+  \param num_points The number of complex values in vectors
+*/
+static inline void volk_cw_multi_corr_generic(const lv_32fc_t* input, const lv_32fc_t* carrier,
+        const lv_32fc_t* const* codes, lv_32fc_t* out, unsigned int num_taps, unsigned int num_points)
+{
+    for (unsigned int tap = 0; tap < num_taps; tap++)
+        {
+            out[tap] = lv_cmake(0.0, 0.0);
+        }
+    for (unsigned int i = 0; i < num_points; i++)
+        {
+            lv_32fc_t bb_signal_sample = input[i] * carrier[i];
+            for (unsigned int tap = 0; tap < num_taps; tap++)
+                {
+                    out[tap] += bb_signal_sample * codes[tap][i];
+                }
+        }
+}
+
+
+/*!
+  \brief Performs the carrier wipe-off mixing and the correlation with
+  num_taps code replicas, reading the input and the carrier only once.
+
+  The signal is processed in tiles of VOLK_CW_MULTI_CORR_TILE samples: the
+  carrier wiped-off tile is computed once in a buffer that stays in the L1
+  cache, and it is correlated with the matching tile of every code replica.
+  The wiped-off signal is never written to memory, so the cost is one read
+  of the input, the carrier and each replica, whatever the number of taps.
+  The products use the VOLK kernels, so the SIMD implementation (SSE, AVX,
+  NEON...) is the best one of the machine, selected at run time. No vector
+  needs to be aligned.
+  \param input The input signal input
+  \param carrier The carrier signal input
+  \param codes The code replica of each tap
+  \param out The correlation output of each tap
+  \param bb_signal Scratch buffer of VOLK_CW_MULTI_CORR_TILE samples
+  \param num_taps The number of correlators
+  \param num_points The number of complex values in vectors
+*/
+static inline void volk_cw_multi_corr_scratch_u(const lv_32fc_t* input, const lv_32fc_t* carrier,
+        const lv_32fc_t* const* codes, lv_32fc_t* out, lv_32fc_t* bb_signal,
+        unsigned int num_taps, unsigned int num_points)
+{
+    lv_32fc_t partial;
+
+    for (unsigned int tap = 0; tap < num_taps; tap++)
+        {
+            out[tap] = lv_cmake(0.0, 0.0);
+        }
+    for (unsigned int first = 0; first < num_points; first += VOLK_CW_MULTI_CORR_TILE)
+        {
+            unsigned int length = num_points - first;
+            if (length > VOLK_CW_MULTI_CORR_TILE)
+                {
+                    length = VOLK_CW_MULTI_CORR_TILE;
+                }
+            // carrier wipe-off of the tile
+            volk_32fc_x2_multiply_32fc_u(bb_signal, input + first, carrier + first, length);
+            // correlation of the tile with every replica
+            for (unsigned int tap = 0; tap < num_taps; tap++)
+                {
+                    volk_32fc_x2_dot_prod_32fc_u(&partial, bb_signal, codes[tap] + first, length);
+                    out[tap] += partial;
+                }
+        }
+}
+
+
+/*!
+  \brief Same as volk_cw_multi_corr_scratch_u, for an input and a carrier
+  aligned to the SIMD width (e.g. the aligned windows of the tracking
+  blocks, see tracking_window.h). The carrier wipe-off uses the aligned
+  kernel. The code replicas do not need to be aligned.
+*/
+static inline void volk_cw_multi_corr_scratch_a(const lv_32fc_t* input, const lv_32fc_t* carrier,
+        const lv_32fc_t* const* codes, lv_32fc_t* out, lv_32fc_t* bb_signal,
+        unsigned int num_taps, unsigned int num_points)
+{
+    lv_32fc_t partial;
+
+    for (unsigned int tap = 0; tap < num_taps; tap++)
+        {
+            out[tap] = lv_cmake(0.0, 0.0);
+        }
+    for (unsigned int first = 0; first < num_points; first += VOLK_CW_MULTI_CORR_TILE)
+        {
+            unsigned int length = num_points - first;
+            if (length > VOLK_CW_MULTI_CORR_TILE)
+                {
+                    length = VOLK_CW_MULTI_CORR_TILE;
+                }
+            // carrier wipe-off of the tile (the tiles keep the alignment)
+            volk_32fc_x2_multiply_32fc_a(bb_signal, input + first, carrier + first, length);
+            // correlation of the tile with every replica
+            for (unsigned int tap = 0; tap < num_taps; tap++)
+                {
+                    volk_32fc_x2_dot_prod_32fc_u(&partial, bb_signal, codes[tap] + first, length);
+                    out[tap] += partial;
+                }
+        }
+}
+
+
+/*!
+  \brief Same as volk_cw_multi_corr_scratch_u, with the scratch buffer in
+  the stack.
+*/
+static inline void volk_cw_multi_corr_u(const lv_32fc_t* input, const lv_32fc_t* carrier,
+        const lv_32fc_t* const* codes, lv_32fc_t* out, unsigned int num_taps, unsigned int num_points)
+{
+    __VOLK_ATTR_ALIGNED(32) lv_32fc_t bb_signal[VOLK_CW_MULTI_CORR_TILE];
+    volk_cw_multi_corr_scratch_u(input, carrier, codes, out, bb_signal, num_taps, num_points);
+}
+
+#endif /* GNSS_SDR_VOLK_CW_MULTI_CORR_H_ */
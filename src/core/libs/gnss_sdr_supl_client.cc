@@ -176,6 +176,12 @@ int gnss_sdr_supl_client::get_assistance(int i_mcc, int i_mns, int i_lac, int i_
     return err;
 }
 
+void gnss_sdr_supl_client::read_supl_data(const supl_assist_t& assist_data)
+{
+    assist = assist_data;
+    read_supl_data();
+}
+
 void gnss_sdr_supl_client::read_supl_data()
 {
     // READ REFERENCE LOCATION
@@ -252,7 +258,7 @@ void gnss_sdr_supl_client::read_supl_data()
                     gps_almanac_iterator->second.d_sqrt_A = ((double)a->A_sqrt)*pow(2.0, -11);
                     gps_almanac_iterator->second.d_OMEGA_DOT = ((double)a->OMEGA_dot)*pow(2.0, -38);
                     gps_almanac_iterator->second.d_Toa = ((double)a->toa)*pow(2.0, 12);
-                    gps_almanac_iterator->second.d_e_eccentricity = ((double)a->toa)*pow(2.0, -21);
+                    gps_almanac_iterator->second.d_e_eccentricity = ((double)a->e)*pow(2.0, -21);
                     gps_almanac_iterator->second.d_M_0 = ((double)a->M0)*pow(2.0, -23);
                 }
         }
@@ -104,6 +104,10 @@ public:
      *
      */
     void read_supl_data();
+    /*
+     * \brief Same as read_supl_data(), with assistance data not received from the SUPL server (e.g. recorded)
+     */
+    void read_supl_data(const supl_assist_t& assist_data);
 
     /*!
      * \brief Read ephemeris map from XML file
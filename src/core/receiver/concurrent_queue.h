@@ -32,6 +32,7 @@
 #define GNSS_SDR_CONCURRENT_QUEUE_H
 
 #include <queue>
+#include <boost/function.hpp>
 #include <boost/thread/mutex.hpp>
 #include <boost/thread/thread.hpp>
 
@@ -50,13 +51,29 @@ private:
     std::queue<Data> the_queue;
     mutable boost::mutex the_mutex;
     boost::condition_variable the_condition_variable;
+    boost::function<void()> the_notifier;
 public:
     void push(Data const& data)
     {
         boost::mutex::scoped_lock lock(the_mutex);
         the_queue.push(data);
+        boost::function<void()> notifier = the_notifier;
         lock.unlock();
         the_condition_variable.notify_one();
+        if(notifier)
+            {
+                notifier();
+            }
+    }
+
+    /*!
+     * \brief Sets a function called after each push, to schedule a consumer
+     * that does not wait on the queue (an empty function removes it)
+     */
+    void set_notifier(boost::function<void()> notifier)
+    {
+        boost::mutex::scoped_lock lock(the_mutex);
+        the_notifier = notifier;
     }
 
     bool empty() const
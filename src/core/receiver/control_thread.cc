@@ -51,6 +51,7 @@
 #include "galileo_iono.h"
 #include "galileo_utc_model.h"
 #include "galileo_almanac.h"
+#include "gps_acquisition_assistance.h"
 #include "concurrent_queue.h"
 #include "concurrent_map.h"
 #include "gnss_flowgraph.h"
@@ -155,6 +156,7 @@ void ControlThread::run()
     //start the GNSS SV data collector thread
     gps_ephemeris_data_collector_thread_ = boost::thread(&ControlThread::gps_ephemeris_data_collector, this);
     gps_iono_data_collector_thread_ = boost::thread(&ControlThread::gps_iono_data_collector, this);
+    gps_almanac_data_collector_thread_ = boost::thread(&ControlThread::gps_almanac_data_collector, this);
     gps_utc_model_data_collector_thread_ = boost::thread(&ControlThread::gps_utc_model_data_collector, this);
     gps_acq_assist_data_collector_thread_= boost::thread(&ControlThread::gps_acq_assist_data_collector, this);
     gps_ref_location_data_collector_thread_ = boost::thread(&ControlThread::gps_ref_location_data_collector, this);
@@ -176,6 +178,7 @@ void ControlThread::run()
     // Join GPS threads
     gps_ephemeris_data_collector_thread_.timed_join(boost::posix_time::seconds(1));
     gps_iono_data_collector_thread_.timed_join(boost::posix_time::seconds(1));
+    gps_almanac_data_collector_thread_.timed_join(boost::posix_time::seconds(1));
     gps_utc_model_data_collector_thread_.timed_join(boost::posix_time::seconds(1));
     gps_acq_assist_data_collector_thread_.timed_join(boost::posix_time::seconds(1));
     gps_ref_location_data_collector_thread_.timed_join(boost::posix_time::seconds(1));
@@ -658,6 +661,12 @@ void ControlThread::gps_ephemeris_data_collector()
                               << gps_eph.i_GPS_week;
                     global_gps_ephemeris_map.write(gps_eph.i_satellite_PRN, gps_eph);
                 }
+
+            // The acquisition assistance follows the ephemeris kept in the map
+            if (global_gps_ephemeris_map.read(gps_eph.i_satellite_PRN, gps_eph_old))
+                {
+                    Gps_Acquisition_Assistance::instance()->set_ephemeris(gps_eph_old);
+                }
         }
 }
 
@@ -729,6 +738,21 @@ void ControlThread::gps_iono_data_collector()
 }
 
 
+void ControlThread::gps_almanac_data_collector()
+{
+    Gps_Almanac gps_almanac;
+    while(stop_ == false)
+        {
+            global_gps_almanac_queue.wait_and_pop(gps_almanac);
+
+            LOG(INFO) << "New almanac record has arrived from SAT ID " << gps_almanac.i_satellite_PRN;
+            // there is no week number in the almanac record, new entries must always be added
+            global_gps_almanac_map.write(gps_almanac.i_satellite_PRN, gps_almanac);
+            Gps_Acquisition_Assistance::instance()->set_almanac(gps_almanac);
+        }
+}
+
+
 void ControlThread::galileo_iono_data_collector()
 {
     Galileo_Iono galileo_iono;
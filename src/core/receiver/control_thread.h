@@ -158,6 +158,11 @@ private:
      */
     void gps_iono_data_collector();
 
+    /*
+     * Blocking function that reads the GPS almanac queue and updates the shared almanac map, accessible from the acquisition assistance
+     */
+    void gps_almanac_data_collector();
+
     /*
      * Blocking function that reads the GPS assistance queue
      */
@@ -192,6 +197,7 @@ private:
 
     boost::thread gps_ephemeris_data_collector_thread_;
     boost::thread gps_iono_data_collector_thread_;
+    boost::thread gps_almanac_data_collector_thread_;
     boost::thread gps_utc_model_data_collector_thread_;
     boost::thread gps_acq_assist_data_collector_thread_;
     boost::thread gps_ref_location_data_collector_thread_;
@@ -53,6 +53,7 @@
 #include "array_signal_conditioner.h"
 #include "ishort_to_complex.h"
 #include "direct_resampler_conditioner.h"
+#include "integrate_dump_decimator.h"
 #include "fir_filter.h"
 #include "freq_xlating_fir_filter.h"
 #include "beamformer_filter.h"
@@ -387,6 +388,12 @@ std::unique_ptr<GNSSBlockInterface> GNSSBlockFactory::GetBlock(
                     in_streams, out_streams));
             block = std::move(block_);
         }
+    else if (implementation.compare("Integrate_Dump_Decimator") == 0)
+        {
+            std::unique_ptr<GNSSBlockInterface> block_(new IntegrateDumpDecimator(configuration.get(), role,
+                    in_streams, out_streams));
+            block = std::move(block_);
+        }
 
     // ACQUISITION BLOCKS ---------------------------------------------------------
     else if (implementation.compare("GPS_L1_CA_PCPS_Acquisition") == 0)
@@ -42,7 +42,10 @@
 #include "configuration_interface.h"
 #include "gnss_block_interface.h"
 #include "channel_interface.h"
+#include "channel.h"
+#include "gps_l1_ca_multichannel_tracking_cc.h"
 #include "gnss_block_factory.h"
+#include "pcps_code_spectrum_cache.h"
 
 #define GNSS_SDR_ARRAY_SIGNAL_CONDITIONER_CHANNELS 8
 
@@ -149,13 +152,21 @@ void GNSSFlowgraph::connect()
             return;
     }
 
+    for (unsigned int i = 0; i < channels_count_; i++)
+        {
+            auto chan_ = std::move(blocks_->at(i + 5));
+            std::shared_ptr<ChannelInterface> chan = std::dynamic_pointer_cast<ChannelInterface>(chan_);
+            channels_.push_back(chan);
+        }
+    if (configuration_->property("Channels.multichannel_tracking", false))
+        {
+            set_multichannel_tracking();
+        }
+
     for (unsigned int i = 0; i < channels_count_; i++)
         {
             try
             {
-                    auto chan_ = std::move(blocks_->at(i + 5));
-                    std::shared_ptr<ChannelInterface> chan = std::dynamic_pointer_cast<ChannelInterface>(chan_);
-                    channels_.push_back(chan);
                     channels_.at(i)->connect(top_block_);
             }
             catch (std::exception& e)
@@ -239,6 +250,23 @@ void GNSSFlowgraph::connect()
     }
     DLOG(INFO) << "Signal source connected to signal conditioner";
 
+    // Signal Source > Signal conditioner > Multichannel tracking
+    if (multichannel_tracking_)
+        {
+            try
+            {
+                    top_block_->connect(sig_conditioner_->get_right_block(), 0, multichannel_tracking_, 0);
+            }
+            catch (std::exception& e)
+            {
+                    LOG(WARNING) << "Can't connect signal conditioner to multichannel tracking";
+                    LOG(ERROR) << e.what();
+                    top_block_->disconnect_all();
+                    return;
+            }
+            DLOG(INFO) << "signal conditioner connected to multichannel tracking";
+        }
+
     // Signal Source > Signal conditioner >> channels_count_ number of Channels in parallel
     for (unsigned int i = 0; i < channels_count_; i++)
         {
@@ -258,10 +286,19 @@ void GNSSFlowgraph::connect()
             DLOG(INFO) << "signal conditioner connected to channel " << i;
 
             // Signal Source > Signal conditioner >> Channels >> Observables
+            // (Multichannel tracking >> Observables when it hosts the tracking and telemetry of the Channels)
             try
             {
-                    top_block_->connect(channels_.at(i)->get_right_block(), 0,
-                            observables_->get_left_block(), i);
+                    if (multichannel_tracking_)
+                        {
+                            top_block_->connect(multichannel_tracking_, i,
+                                    observables_->get_left_block(), i);
+                        }
+                    else
+                        {
+                            top_block_->connect(channels_.at(i)->get_right_block(), 0,
+                                    observables_->get_left_block(), i);
+                        }
             }
             catch (std::exception& e)
             {
@@ -448,6 +485,14 @@ void GNSSFlowgraph::init()
      */
     std::shared_ptr<GNSSBlockFactory> block_factory_ = std::make_shared<GNSSBlockFactory>();
 
+    // Optional file backing the cache of acquisition code spectra
+    std::string default_code_spectra_file = "";
+    std::string code_spectra_file = configuration_->property("Acquisition.code_spectra_file", default_code_spectra_file);
+    if (!code_spectra_file.empty())
+        {
+            Pcps_Code_Spectrum_Cache::instance()->set_persistence_file(code_spectra_file);
+        }
+
     std::shared_ptr<GNSSBlockInterface> signal_source_ = block_factory_->GetSignalSource(configuration_, queue_);
     std::shared_ptr<GNSSBlockInterface> cond_ = block_factory_->GetSignalConditioner(configuration_, queue_);
     std::shared_ptr<GNSSBlockInterface> obs_ = block_factory_->GetObservables(configuration_, queue_);
@@ -603,6 +648,48 @@ void GNSSFlowgraph::set_signals_list()
 
 
 
+void GNSSFlowgraph::set_multichannel_tracking()
+{
+    // All the channels have to run the GPS L1 C/A DLL + PLL tracking and the GPS L1 C/A telemetry decoder
+    std::vector<gps_l1_ca_dll_pll_tracking_cc_sptr> tracking;
+    std::vector<gps_l1_ca_telemetry_decoder_cc_sptr> telemetry;
+    for (unsigned int i = 0; i < channels_count_; i++)
+        {
+            std::shared_ptr<Channel> chan = std::dynamic_pointer_cast<Channel>(channels_.at(i));
+            gps_l1_ca_dll_pll_tracking_cc_sptr trk;
+            gps_l1_ca_telemetry_decoder_cc_sptr tlm;
+            if (chan)
+                {
+                    trk = boost::dynamic_pointer_cast<Gps_L1_Ca_Dll_Pll_Tracking_cc>(chan->tracking()->get_left_block());
+                    tlm = boost::dynamic_pointer_cast<gps_l1_ca_telemetry_decoder_cc>(chan->telemetry()->get_left_block());
+                }
+            if (!trk or !tlm)
+                {
+                    LOG(WARNING) << "Channel " << i << " does not use GPS_L1_CA_DLL_PLL_Tracking and GPS_L1_CA_Telemetry_Decoder, "
+                                 << "the tracking and telemetry of the channels are not hosted";
+                    return;
+                }
+            tracking.push_back(trk);
+            telemetry.push_back(tlm);
+        }
+    int tile_samples = configuration_->property("Channels.multichannel_tile_samples", 1024);
+    // The work of the channels runs on the pool of the channels, if any
+    channel_scheduler_sptr scheduler;
+    unsigned int scheduler_threads = configuration_->property("Channels.scheduler_threads", 0);
+    if (scheduler_threads > 0)
+        {
+            scheduler = Channel_Scheduler::shared(scheduler_threads, configuration_->property("Channels.pin_to_cores", false));
+        }
+    multichannel_tracking_ = gps_l1_ca_make_multichannel_tracking_cc(tracking, telemetry, tile_samples, scheduler);
+    for (unsigned int i = 0; i < channels_count_; i++)
+        {
+            std::dynamic_pointer_cast<Channel>(channels_.at(i))->set_hosted(true);
+        }
+    LOG(INFO) << "Tracking and telemetry of the " << channels_count_ << " channels hosted by " << multichannel_tracking_->name();
+}
+
+
+
 void GNSSFlowgraph::set_channels_state()
 {
     max_acq_channels_ = (configuration_->property("Channels.in_acquisition", channels_count_));
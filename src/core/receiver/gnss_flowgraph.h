@@ -41,6 +41,7 @@
 #include <queue>
 #include <string>
 #include <vector>
+#include <gnuradio/block.h>
 #include <gnuradio/top_block.h>
 #include <gnuradio/msg_queue.h>
 #include "GPS_L1_CA.h"
@@ -113,6 +114,7 @@ private:
     void set_signals_list();
     void set_channels_state(); // Initializes the channels state (start acquisition or keep standby)
                                // using the configuration parameters (number of channels and max channels in acquisition)
+    void set_multichannel_tracking(); // Hosts the tracking and telemetry of all the channels in one block (Channels.multichannel_tracking)
     bool connected_;
     bool running_;
     unsigned int channels_count_;
@@ -129,6 +131,7 @@ private:
     std::shared_ptr<GNSSBlockInterface> pvt_;
     std::shared_ptr<GNSSBlockInterface> output_filter_;
     std::vector<std::shared_ptr<ChannelInterface>> channels_;
+    gr::block_sptr multichannel_tracking_;
     gr::top_block_sptr top_block_;
     boost::shared_ptr<gr::msg_queue> queue_;
     std::list<Gnss_Signal> available_GNSS_signals_;
@@ -0,0 +1,253 @@
+/*!
+ * \file gps_acquisition_assistance.cc
+ * \brief Prediction of the Doppler shift and elevation of the GPS satellites
+ * from the decoded ephemeris and almanac data and the last position fix,
+ * used to narrow the acquisition search
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "gps_acquisition_assistance.h"
+#include <cmath>
+
+// WGS84 ellipsoid
+#define WGS84_A 6378137.0
+#define WGS84_F (1.0 / 298.257223563)
+
+namespace
+{
+double check_tow(double time)
+{
+    double half_week = 302400.0;
+    if (time > half_week)
+        {
+            time = time - 2 * half_week;
+        }
+    else if (time < -half_week)
+        {
+            time = time + 2 * half_week;
+        }
+    return time;
+}
+
+double distance(const double* a, const double* b)
+{
+    return sqrt((a[0] - b[0])*(a[0] - b[0]) + (a[1] - b[1])*(a[1] - b[1]) + (a[2] - b[2])*(a[2] - b[2]));
+}
+}
+
+
+
+Gps_Acquisition_Assistance* Gps_Acquisition_Assistance::instance()
+{
+    // Never destroyed, so that no channel can outlive it
+    static Gps_Acquisition_Assistance* assistance = new Gps_Acquisition_Assistance();
+    return assistance;
+}
+
+
+
+Gps_Acquisition_Assistance::Gps_Acquisition_Assistance()
+{
+    d_valid_fix = false;
+    d_receiver_xyz[0] = 0.0;
+    d_receiver_xyz[1] = 0.0;
+    d_receiver_xyz[2] = 0.0;
+    d_latitude_rad = 0.0;
+    d_longitude_rad = 0.0;
+    d_fix_tow_s = 0.0;
+    d_fix_rx_time_s = 0.0;
+    d_clock_offset_sum_hz = 0.0;
+    d_clock_offset_count = 0;
+}
+
+
+
+void Gps_Acquisition_Assistance::set_ephemeris(const Gps_Ephemeris& ephemeris)
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+    d_ephemeris_map[ephemeris.i_satellite_PRN] = ephemeris;
+}
+
+
+
+void Gps_Acquisition_Assistance::set_almanac(const Gps_Almanac& almanac)
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+    d_almanac_map[almanac.i_satellite_PRN] = almanac;
+}
+
+
+
+void Gps_Acquisition_Assistance::set_receiver_fix(double latitude_deg, double longitude_deg,
+        double height_m, double tow_s, double rx_time_s)
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+    d_latitude_rad = latitude_deg * GPS_PI / 180.0;
+    d_longitude_rad = longitude_deg * GPS_PI / 180.0;
+
+    // Geodetic to Earth-fixed coordinates
+    double e2 = WGS84_F * (2.0 - WGS84_F);
+    double N = WGS84_A / sqrt(1.0 - e2 * sin(d_latitude_rad) * sin(d_latitude_rad));
+    d_receiver_xyz[0] = (N + height_m) * cos(d_latitude_rad) * cos(d_longitude_rad);
+    d_receiver_xyz[1] = (N + height_m) * cos(d_latitude_rad) * sin(d_longitude_rad);
+    d_receiver_xyz[2] = (N * (1.0 - e2) + height_m) * sin(d_latitude_rad);
+
+    d_fix_tow_s = tow_s;
+    d_fix_rx_time_s = rx_time_s;
+    d_valid_fix = true;
+
+    // The clock offset is estimated again from the measurements of this fix
+    d_clock_offset_sum_hz = 0.0;
+    d_clock_offset_count = 0;
+}
+
+
+
+void Gps_Acquisition_Assistance::report_doppler(unsigned int prn, double doppler_hz)
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+    if (!d_valid_fix)
+        {
+            return;
+        }
+    // The measurements are those of the fix
+    double xyz[3];
+    if (!satellite_position(prn, d_fix_tow_s, xyz))
+        {
+            return;
+        }
+    d_clock_offset_sum_hz += doppler_hz - geometric_doppler(prn, d_fix_tow_s);
+    d_clock_offset_count++;
+}
+
+
+
+bool Gps_Acquisition_Assistance::predict(unsigned int prn, double rx_time_s, double* doppler_hz,
+        double* doppler_uncertainty_hz, double* elevation_deg, bool* clock_calibrated)
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+    if (!d_valid_fix)
+        {
+            return false;
+        }
+    double age_s = rx_time_s - d_fix_rx_time_s;
+    double tow_s = d_fix_tow_s + age_s;
+    double xyz[3];
+    if (!satellite_position(prn, tow_s, xyz))
+        {
+            return false;
+        }
+
+    // Elevation over the local horizon
+    double los[3];
+    for (int i = 0; i < 3; i++)
+        {
+            los[i] = xyz[i] - d_receiver_xyz[i];
+        }
+    double up = cos(d_latitude_rad) * cos(d_longitude_rad) * los[0]
+              + cos(d_latitude_rad) * sin(d_longitude_rad) * los[1]
+              + sin(d_latitude_rad) * los[2];
+    *elevation_deg = asin(up / distance(xyz, d_receiver_xyz)) * 180.0 / GPS_PI;
+
+    *doppler_hz = geometric_doppler(prn, tow_s);
+    *doppler_uncertainty_hz = fabs(age_s) * GPS_ASSISTANCE_DOPPLER_DRIFT_HZ_S;
+    *clock_calibrated = d_clock_offset_count > 0;
+    if (*clock_calibrated)
+        {
+            *doppler_hz += d_clock_offset_sum_hz / (double)d_clock_offset_count;
+        }
+    return true;
+}
+
+
+
+bool Gps_Acquisition_Assistance::satellite_position(unsigned int prn, double tow_s, double* xyz)
+{
+    std::map<int, Gps_Ephemeris>::iterator ephemeris = d_ephemeris_map.find(prn);
+    if (ephemeris != d_ephemeris_map.end())
+        {
+            ephemeris->second.satellitePosition(tow_s);
+            xyz[0] = ephemeris->second.d_satpos_X;
+            xyz[1] = ephemeris->second.d_satpos_Y;
+            xyz[2] = ephemeris->second.d_satpos_Z;
+            return true;
+        }
+    std::map<int, Gps_Almanac>::iterator almanac = d_almanac_map.find(prn);
+    if (almanac != d_almanac_map.end())
+        {
+            almanac_position(almanac->second, tow_s, xyz);
+            return true;
+        }
+    return false;
+}
+
+
+
+void Gps_Acquisition_Assistance::almanac_position(const Gps_Almanac& almanac, double tow_s, double* xyz)
+{
+    // IS-GPS-200E, 20.3.3.5.2.1. The angles of the almanac are in semi-circles
+    double a = almanac.d_sqrt_A * almanac.d_sqrt_A;
+    double tk = check_tow(tow_s - almanac.d_Toa);
+    double n = sqrt(GM / (a*a*a));
+    double M = fmod(almanac.d_M_0 * GPS_PI + n * tk + 2*GPS_PI, 2*GPS_PI);
+
+    double E = M;
+    for (int ii = 1; ii < 20; ii++)
+        {
+            double E_old = E;
+            E = M + almanac.d_e_eccentricity * sin(E);
+            if (fabs(fmod(E - E_old, 2*GPS_PI)) < 1e-12)
+                {
+                    break;
+                }
+        }
+
+    double nu = atan2(sqrt(1.0 - almanac.d_e_eccentricity * almanac.d_e_eccentricity) * sin(E),
+                      cos(E) - almanac.d_e_eccentricity);
+    double u = nu + almanac.d_OMEGA * GPS_PI;
+    double r = a * (1.0 - almanac.d_e_eccentricity * cos(E));
+    // Reference inclination of 0.3 semi-circles
+    double i = (0.3 + almanac.d_Delta_i) * GPS_PI;
+    double Omega = almanac.d_OMEGA0 * GPS_PI + (almanac.d_OMEGA_DOT * GPS_PI - OMEGA_EARTH_DOT) * tk
+            - OMEGA_EARTH_DOT * almanac.d_Toa;
+
+    xyz[0] = cos(u) * r * cos(Omega) - sin(u) * r * cos(i) * sin(Omega);
+    xyz[1] = cos(u) * r * sin(Omega) + sin(u) * r * cos(i) * cos(Omega);
+    xyz[2] = sin(u) * r * sin(i);
+}
+
+
+
+double Gps_Acquisition_Assistance::geometric_doppler(unsigned int prn, double tow_s)
+{
+    // Range rate by central difference over one second
+    double before[3];
+    double after[3];
+    satellite_position(prn, tow_s - 0.5, before);
+    satellite_position(prn, tow_s + 0.5, after);
+    double range_rate = distance(after, d_receiver_xyz) - distance(before, d_receiver_xyz);
+    return -range_rate / GPS_C_m_s * GPS_L1_FREQ_HZ;
+}
@@ -0,0 +1,129 @@
+/*!
+ * \file gps_acquisition_assistance.h
+ * \brief Prediction of the Doppler shift and elevation of the GPS satellites
+ * from the decoded ephemeris and almanac data and the last position fix,
+ * used to narrow the acquisition search
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_GPS_ACQUISITION_ASSISTANCE_H_
+#define GNSS_SDR_GPS_ACQUISITION_ASSISTANCE_H_
+
+#include <map>
+#include <boost/thread/mutex.hpp>
+#include "gps_ephemeris.h"
+#include "gps_almanac.h"
+
+/*!
+ * \brief Growth of the uncertainty of the predicted Doppler shifts with
+ * the age of the fix, for the drift of the front-end clock and the motion
+ * of the receiver since the fix [Hz/s]
+ */
+#define GPS_ASSISTANCE_DOPPLER_DRIFT_HZ_S 1.0
+
+/*!
+ * \brief Predicts, for each GPS satellite, the Doppler shift and the
+ * elevation seen from the last position fix.
+ *
+ * The orbit comes from the ephemeris when available, and from the almanac
+ * otherwise. The time of a prediction is the time of the last fix plus the
+ * receiver time elapsed since the fix, counted in samples as
+ * Gnss_Synchro::Tracking_timestamp_secs, so the predictions follow the
+ * samples whatever the speed of the processing (e.g. with file sources).
+ * The uncertainty of the Doppler shift grows with the age of the fix. The
+ * geometric Doppler is biased by the frequency offset
+ * of the front-end clock, which is estimated as the mean difference between
+ * the Doppler shifts measured by the channels and the geometric prediction.
+ * Until that offset is known, only the elevation can be used.
+ *
+ * The data is fed by the control thread (ephemeris and almanac) and by the
+ * PVT block (fix and measured Doppler shifts), and read by the acquisition
+ * blocks of any channel, so all the methods are thread safe.
+ */
+class Gps_Acquisition_Assistance
+{
+public:
+    /*!
+     * \brief Returns the assistance shared by all the channels.
+     */
+    static Gps_Acquisition_Assistance* instance();
+
+    void set_ephemeris(const Gps_Ephemeris& ephemeris);
+    void set_almanac(const Gps_Almanac& almanac);
+
+    /*!
+     * \brief Sets a valid position fix.
+     * \param latitude_deg - Latitude [deg].
+     * \param longitude_deg - Longitude [deg].
+     * \param height_m - Height over the WGS84 ellipsoid [m].
+     * \param tow_s - GPS time of week of the fix [s].
+     * \param rx_time_s - Receiver time of the fix (sample counter / sampling frequency) [s].
+     */
+    void set_receiver_fix(double latitude_deg, double longitude_deg, double height_m, double tow_s,
+            double rx_time_s);
+
+    /*!
+     * \brief Reports the Doppler shift measured for a satellite at the time
+     * of the last fix, to estimate the clock frequency offset.
+     */
+    void report_doppler(unsigned int prn, double doppler_hz);
+
+    /*!
+     * \brief Predicts the Doppler shift and the elevation of a satellite.
+     * \param prn - Satellite PRN.
+     * \param rx_time_s - Receiver time of the prediction (sample counter / sampling frequency) [s].
+     * \param doppler_hz - Predicted Doppler shift, including the clock offset when known [Hz].
+     * \param doppler_uncertainty_hz - Growth of the uncertainty of the Doppler shift since the fix [Hz].
+     * \param elevation_deg - Predicted elevation [deg].
+     * \param clock_calibrated - Tells if the clock offset is included in the Doppler shift.
+     * \return false if there is no fix or no orbit for the satellite.
+     */
+    bool predict(unsigned int prn, double rx_time_s, double* doppler_hz, double* doppler_uncertainty_hz,
+            double* elevation_deg, bool* clock_calibrated);
+
+private:
+    Gps_Acquisition_Assistance();
+
+    bool satellite_position(unsigned int prn, double tow_s, double* xyz);
+    void almanac_position(const Gps_Almanac& almanac, double tow_s, double* xyz);
+    double geometric_doppler(unsigned int prn, double tow_s);
+
+    boost::mutex d_mutex;
+    std::map<int, Gps_Ephemeris> d_ephemeris_map;
+    std::map<int, Gps_Almanac> d_almanac_map;
+
+    bool d_valid_fix;
+    double d_receiver_xyz[3];
+    double d_latitude_rad;
+    double d_longitude_rad;
+    double d_fix_tow_s;
+    double d_fix_rx_time_s;
+
+    double d_clock_offset_sum_hz;
+    unsigned int d_clock_offset_count;
+};
+
+#endif /* GNSS_SDR_GPS_ACQUISITION_ASSISTANCE_H_ */
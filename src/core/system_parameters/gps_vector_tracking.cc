@@ -0,0 +1,74 @@
+/*!
+ * \file gps_vector_tracking.cc
+ * \brief Carrier and code frequencies of the GPS satellites predicted by the
+ * PVT solution, fed back to the tracking loops (vector tracking)
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "gps_vector_tracking.h"
+#include <cmath>
+
+
+
+Gps_Vector_Tracking* Gps_Vector_Tracking::instance()
+{
+    // Never destroyed, so that no channel can outlive it
+    static Gps_Vector_Tracking* vector_tracking = new Gps_Vector_Tracking();
+    return vector_tracking;
+}
+
+
+
+Gps_Vector_Tracking::Gps_Vector_Tracking()
+{}
+
+
+
+void Gps_Vector_Tracking::set_prediction(unsigned int prn, double timestamp_secs, double carrier_doppler_hz, double code_freq_chips)
+{
+    Prediction prediction;
+    prediction.timestamp_secs = timestamp_secs;
+    prediction.carrier_doppler_hz = carrier_doppler_hz;
+    prediction.code_freq_chips = code_freq_chips;
+    boost::mutex::scoped_lock lock(d_mutex);
+    d_predictions[prn] = prediction;
+}
+
+
+
+bool Gps_Vector_Tracking::get_prediction(unsigned int prn, double timestamp_secs, double* carrier_doppler_hz, double* code_freq_chips)
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+    std::map<int, Prediction>::const_iterator prediction = d_predictions.find(prn);
+    if (prediction == d_predictions.end()
+            or std::fabs(timestamp_secs - prediction->second.timestamp_secs) > GPS_VECTOR_TRACKING_MAX_AGE_S)
+        {
+            return false;
+        }
+    *carrier_doppler_hz = prediction->second.carrier_doppler_hz;
+    *code_freq_chips = prediction->second.code_freq_chips;
+    return true;
+}
@@ -0,0 +1,101 @@
+/*!
+ * \file gps_vector_tracking.h
+ * \brief Carrier and code frequencies of the GPS satellites predicted by the
+ * PVT solution, fed back to the tracking loops (vector tracking)
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_GPS_VECTOR_TRACKING_H_
+#define GNSS_SDR_GPS_VECTOR_TRACKING_H_
+
+#include <map>
+#include <boost/thread/mutex.hpp>
+
+/*!
+ * \brief Predictions older than this are not used by the tracking loops [s]
+ */
+#define GPS_VECTOR_TRACKING_MAX_AGE_S 1.0
+
+/*!
+ * \brief Keeps, for each GPS satellite, the carrier Doppler shift and the
+ * code frequency predicted by the last PVT solution.
+ *
+ * The PVT block solves the receiver velocity and clock drift from the
+ * Doppler shifts of all the channels, and sets the prediction of each
+ * satellite. The tracking blocks read it to steer their NCOs with the
+ * prediction, and close their loops on the residual only, so a channel
+ * keeps the dynamics of the receiver through a short outage of its
+ * signal. The predictions are time-stamped in the receiver time of the
+ * tracking blocks (Gnss_Synchro::Tracking_timestamp_secs), and the old
+ * ones are ignored.
+ *
+ * Only the frequencies are predicted. The code phase of each channel is
+ * still closed by its own DLL: there is no prediction of the pseudorange
+ * (vector DLL).
+ *
+ * The PVT block and the tracking blocks of all the channels use it from
+ * their own threads, so all the methods are thread safe.
+ */
+class Gps_Vector_Tracking
+{
+public:
+    /*!
+     * \brief Returns the predictions shared by all the channels.
+     */
+    static Gps_Vector_Tracking* instance();
+
+    /*!
+     * \brief Sets the prediction of a satellite.
+     * \param prn - Satellite PRN.
+     * \param timestamp_secs - Receiver time of the prediction [s].
+     * \param carrier_doppler_hz - Predicted carrier Doppler shift [Hz].
+     * \param code_freq_chips - Predicted code frequency [chips/s].
+     */
+    void set_prediction(unsigned int prn, double timestamp_secs, double carrier_doppler_hz, double code_freq_chips);
+
+    /*!
+     * \brief Gets the prediction of a satellite.
+     * \param timestamp_secs - Current receiver time [s].
+     * \return false if there is no prediction for the satellite, or if it is
+     * older than GPS_VECTOR_TRACKING_MAX_AGE_S.
+     */
+    bool get_prediction(unsigned int prn, double timestamp_secs, double* carrier_doppler_hz, double* code_freq_chips);
+
+private:
+    struct Prediction
+    {
+        double timestamp_secs;
+        double carrier_doppler_hz;
+        double code_freq_chips;
+    };
+
+    Gps_Vector_Tracking();
+
+    boost::mutex d_mutex;
+    std::map<int, Prediction> d_predictions;
+};
+
+#endif /* GNSS_SDR_GPS_VECTOR_TRACKING_H_ */
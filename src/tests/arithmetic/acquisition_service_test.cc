@@ -0,0 +1,163 @@
+/*!
+ * \file acquisition_service_test.cc
+ * \brief  This file implements tests for the input spectra shared by the
+ * PCPS acquisition channels.
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+
+#include <cstdlib>
+#include <vector>
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
+#include <gnuradio/fft/fft.h>
+#include "pcps_acquisition_service.h"
+#include "pcps_wipeoff_table.h"
+
+
+namespace
+{
+void acquisition_service_test_dwell(pcps_acquisition_grid_sptr grid, const gr_complex* in,
+        pcps_shared_dwell_sptr* result)
+{
+    *result = Pcps_Acquisition_Service::instance()->dwell(grid, 1000, in);
+}
+}
+
+
+TEST(AcquisitionService_Test, SharedAndReleasedGrids)
+{
+    Pcps_Acquisition_Service* service = Pcps_Acquisition_Service::instance();
+    unsigned int grids = service->size();
+    {
+        pcps_acquisition_grid_sptr channel_1 = service->grid(0, 1000000, 1024, 5000, 500);
+        pcps_acquisition_grid_sptr channel_2 = service->grid(0, 1000000, 1024, 5000, 500);
+        pcps_acquisition_grid_sptr channel_3 = service->grid(0, 1000000, 1024, 5000, 1000);
+        EXPECT_EQ(channel_1.get(), channel_2.get());
+        EXPECT_NE(channel_1.get(), channel_3.get());
+        EXPECT_EQ(grids + 2, service->size());
+        EXPECT_EQ(21, channel_1->num_doppler_bins());
+    }
+    // Released, with their blocks, with the last reference
+    EXPECT_EQ(grids, service->size());
+
+    // The blocks kept fit in the memory budget
+    pcps_acquisition_grid_sptr small_grid = service->grid(0, 1000000, 1024, 5000, 500);
+    pcps_acquisition_grid_sptr large_grid = service->grid(0, 4000000, 16384, 5000, 250);
+    pcps_acquisition_grid_sptr huge_grid = service->grid(0, 4000000, 16384, 10000, 250);
+    EXPECT_EQ(8, small_grid->max_dwells());
+    EXPECT_EQ(3, large_grid->max_dwells());
+    EXPECT_EQ(1, huge_grid->max_dwells());
+}
+
+
+TEST(AcquisitionService_Test, EqualsTheChannelSpectra)
+{
+    const long fs = 1000000;
+    const unsigned int fft_size = 1024;
+    gr_complex* in;
+    if (posix_memalign((void**)&in, 16, fft_size * sizeof(gr_complex)) == 0){};
+    srand(1);
+    for (unsigned int i = 0; i < fft_size; i++)
+        {
+            in[i] = gr_complex((float)(rand() % 3) - 1.0, (float)(rand() % 3) - 1.0);
+        }
+
+    Pcps_Acquisition_Service* service = Pcps_Acquisition_Service::instance();
+    pcps_acquisition_grid_sptr grid = service->grid(0, fs, fft_size, 5000, 500);
+    pcps_shared_dwell_sptr dwell = service->dwell(grid, 1000, in);
+
+    // Wipe-off and FFT of each bin, as a channel without the service
+    Pcps_Wipeoff_Table table(0, fs, fft_size, 5000, 500, 32);
+    gr::fft::fft_complex fft(fft_size, true);
+    float power = 0.0;
+    for (unsigned int i = 0; i < fft_size; i++)
+        {
+            power += std::norm(in[i]);
+        }
+    EXPECT_NEAR(power / (float)fft_size, dwell->input_power(), 1e-4);
+    float max_error = 0.0;
+    for (unsigned int doppler_index = 0; doppler_index < table.num_doppler_bins(); doppler_index++)
+        {
+            table.wipeoff(fft.get_inbuf(), in, doppler_index);
+            fft.execute();
+            for (unsigned int i = 0; i < fft_size; i++)
+                {
+                    float error = std::abs(fft.get_outbuf()[i] - dwell->spectrum(doppler_index)[i]);
+                    if (error > max_error) max_error = error;
+                }
+        }
+    EXPECT_LT(max_error, 1e-3);
+
+    // A hit returns the same block, but not with other samples at the same stamp
+    EXPECT_EQ(dwell.get(), service->dwell(grid, 1000, in).get());
+    in[0] = gr_complex(5.0, 5.0);
+    pcps_shared_dwell_sptr stale = service->dwell(grid, 1000, in);
+    EXPECT_NE(dwell.get(), stale.get());
+
+    // The oldest block leaves the cache
+    for (unsigned int k = 1; k <= grid->max_dwells(); k++)
+        {
+            service->dwell(grid, 1000 + k * fft_size, in);
+        }
+    EXPECT_NE(stale.get(), service->dwell(grid, 1000, in).get());
+
+    free(in);
+}
+
+
+TEST(AcquisitionService_Test, ComputedOnceForConcurrentChannels)
+{
+    const unsigned int fft_size = 1024;
+    const int num_channels = 4;
+    gr_complex* in;
+    if (posix_memalign((void**)&in, 16, fft_size * sizeof(gr_complex)) == 0){};
+    srand(2);
+    for (unsigned int i = 0; i < fft_size; i++)
+        {
+            in[i] = gr_complex((float)(rand() % 3) - 1.0, (float)(rand() % 3) - 1.0);
+        }
+
+    // A grid of its own, so that no block of another test is found
+    pcps_acquisition_grid_sptr grid = Pcps_Acquisition_Service::instance()->grid(0, 1000000, fft_size, 3000, 500);
+    std::vector<pcps_shared_dwell_sptr> results(num_channels);
+    boost::thread_group channels;
+    for (int channel = 0; channel < num_channels; channel++)
+        {
+            channels.create_thread(boost::bind(&acquisition_service_test_dwell, grid, in, &results[channel]));
+        }
+    channels.join_all();
+    for (int channel = 1; channel < num_channels; channel++)
+        {
+            EXPECT_EQ(results[0].get(), results[channel].get());
+        }
+    EXPECT_LT(std::abs(results[0]->input_power()), 3.0);
+    EXPECT_LT(0.0, results[0]->input_power());
+
+    free(in);
+}
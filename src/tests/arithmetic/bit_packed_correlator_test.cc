@@ -0,0 +1,362 @@
+/*!
+ * \file bit_packed_correlator_test.cc
+ * \brief  This file implements tests for the bit-packed (XOR and popcount)
+ * carrier wipe-off and correlators.
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include <sys/time.h>
+#include <cmath>
+#include <complex>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+#include "bit_packed_correlator.h"
+#include "code_replica.h"
+#include "correlator.h"
+#include "nco_lib.h"
+
+
+TEST(BitPackedCorrelator_Test, CodeReplicaSigns)
+{
+    const int code_length = 1023;
+    const int num_samples = 4000 + 13;
+    const double phase_step = 1.023e6 / 4e6;
+    std::vector<gr_complex> code(code_length);
+    srand(1);
+    for (int i = 0; i < code_length; i++)
+        {
+            code[i] = gr_complex((float)(rand() % 2) * 2.0 - 1.0, 0.0);
+        }
+    std::vector<gr_complex> replica(num_samples);
+    std::vector<uint64_t> packed(code_replica_packed_words(num_samples));
+    code_replica_gen(&replica[0], &code[0], code_length, -3.7, phase_step, num_samples);
+    code_replica_gen_packed(&packed[0], &code[0], code_length, -3.7, phase_step, num_samples);
+
+    int errors = 0;
+    for (int i = 0; i < num_samples; i++)
+        {
+            bool negative = (packed[i / 64] >> (i % 64)) & 1;
+            if (negative != (replica[i].real() < 0)) errors++;
+        }
+    EXPECT_EQ(0, errors);
+    // No bits after the last sample
+    EXPECT_EQ((uint64_t)0, packed[num_samples / 64] >> (num_samples % 64));
+}
+
+
+
+TEST(BitPackedCorrelator_Test, EqualsQuantizedCorrelation)
+{
+    // 2-bit samples (+-1, +-3), a 1-bit code and the signs of the carrier
+    const int code_length = 1023;
+    const int num_samples = 4000;
+    const int n_taps = 3;
+    const double phase_step = 1.023e6 / 4e6;
+    const double carrier_phase_rad = 1.3;
+    const double carrier_phase_step_rad = 2.0 * M_PI * 1234.5 / 4e6;
+
+    std::vector<gr_complex> code(code_length);
+    std::vector<gr_complex> input(num_samples);
+    srand(2);
+    for (int i = 0; i < code_length; i++)
+        {
+            code[i] = gr_complex((float)(rand() % 2) * 2.0 - 1.0, 0.0);
+        }
+    const float levels[] = { -3.0, -1.0, 1.0, 3.0 };
+    for (int i = 0; i < num_samples; i++)
+        {
+            input[i] = gr_complex(levels[rand() % 4], levels[rand() % 4]);
+        }
+
+    std::vector<std::vector<uint64_t> > packed(n_taps, std::vector<uint64_t>(code_replica_packed_words(num_samples)));
+    std::vector<std::vector<gr_complex> > replica(n_taps, std::vector<gr_complex>(num_samples));
+    const uint64_t* codes[n_taps];
+    for (int tap = 0; tap < n_taps; tap++)
+        {
+            double start_phase = 10.0 + 0.5 * (double)(tap - 1);
+            code_replica_gen(&replica[tap][0], &code[0], code_length, start_phase, phase_step, num_samples);
+            code_replica_gen_packed(&packed[tap][0], &code[0], code_length, start_phase, phase_step, num_samples);
+            codes[tap] = &packed[tap][0];
+        }
+
+    gr_complex out[n_taps];
+    Bit_Packed_Correlator correlator(num_samples, 2.0);
+    correlator.Carrier_wipeoff_packed(num_samples, &input[0], carrier_phase_rad, carrier_phase_step_rad);
+    correlator.Multicorrelator_packed(n_taps, codes, out);
+
+    for (int tap = 0; tap < n_taps; tap++)
+        {
+            std::complex<double> expected(0.0, 0.0);
+            for (int i = 0; i < num_samples; i++)
+                {
+                    double phase = carrier_phase_rad + (double)i * carrier_phase_step_rad;
+                    std::complex<double> carrier(std::cos(phase) < 0 ? -1.0 : 1.0, std::sin(phase) < 0 ? 1.0 : -1.0);
+                    expected += std::complex<double>(input[i].real(), input[i].imag()) * carrier * (double)replica[tap][i].real();
+                }
+            // The carrier phase accumulators may differ at a zero crossing
+            EXPECT_NEAR(expected.real(), out[tap].real(), 12.0);
+            EXPECT_NEAR(expected.imag(), out[tap].imag(), 12.0);
+        }
+}
+
+
+
+TEST(BitPackedCorrelator_Test, TracksTheFloatCorrelation)
+{
+    // A 1-bit signal with a carrier phase of 0.6 rad: the prompt keeps the
+    // phase and the early and late taps are balanced
+    const int code_length = 1023;
+    const int num_samples = 4000;
+    const double phase_step = 1.023e6 / 4e6;
+    const double doppler_step_rad = 2.0 * M_PI * 1500.0 / 4e6;
+    std::vector<gr_complex> code(code_length);
+    srand(3);
+    for (int i = 0; i < code_length; i++)
+        {
+            code[i] = gr_complex((float)(rand() % 2) * 2.0 - 1.0, 0.0);
+        }
+    std::vector<gr_complex> signal(num_samples);
+    code_replica_gen(&signal[0], &code[0], code_length, 0.0, phase_step, num_samples);
+    for (int i = 0; i < num_samples; i++)
+        {
+            double phase = 0.6 + (double)i * doppler_step_rad;
+            gr_complex s = signal[i] * gr_complex(std::cos(phase), std::sin(phase));
+            signal[i] = gr_complex(s.real() < 0 ? -1.0 : 1.0, s.imag() < 0 ? -1.0 : 1.0);
+        }
+
+    const int words = code_replica_packed_words(num_samples);
+    std::vector<uint64_t> early(words), prompt(words), late(words);
+    code_replica_gen_packed(&early[0], &code[0], code_length, -0.5, phase_step, num_samples);
+    code_replica_gen_packed(&prompt[0], &code[0], code_length, 0.0, phase_step, num_samples);
+    code_replica_gen_packed(&late[0], &code[0], code_length, 0.5, phase_step, num_samples);
+    const uint64_t* codes[3] = { &early[0], &prompt[0], &late[0] };
+
+    gr_complex out[3];
+    Bit_Packed_Correlator correlator(num_samples, 0.0);
+    correlator.Carrier_wipeoff_packed(num_samples, &signal[0], 0.0, doppler_step_rad);
+    correlator.Multicorrelator_packed(3, codes, out);
+
+    EXPECT_NEAR(0.6, std::arg(out[1]), 0.1);
+    EXPECT_GT(std::abs(out[1]), 0.6 * 2.0 * num_samples);
+    EXPECT_NEAR(std::abs(out[0]), std::abs(out[2]), 0.05 * std::abs(out[1]));
+    EXPECT_LT(std::abs(out[0]), 0.75 * std::abs(out[1]));
+}
+
+
+
+TEST(BitPackedCorrelator_Test, EqualsTheFixedPointCarrier)
+{
+    // With the carrier phase accumulator of the correlator, the result is exact,
+    // in the whole words (SSE2) and in the last one (4093 = 63 * 64 + 61 samples)
+    const int code_length = 1023;
+    const int num_samples = 4093;
+    const double phase_step = 1.023e6 / 4e6;
+    const double carrier_phase_step_rad = M_PI / 2.0;
+    std::vector<gr_complex> code(code_length);
+    std::vector<gr_complex> input(num_samples);
+    srand(4);
+    for (int i = 0; i < code_length; i++)
+        {
+            code[i] = gr_complex((float)(rand() % 2) * 2.0 - 1.0, 0.0);
+        }
+    const float levels[] = { -3.0, -1.0, 1.0, 3.0 };
+    for (int i = 0; i < num_samples; i++)
+        {
+            input[i] = gr_complex(levels[rand() % 4], levels[rand() % 4]);
+        }
+    std::vector<gr_complex> replica(num_samples);
+    std::vector<uint64_t> packed(code_replica_packed_words(num_samples));
+    code_replica_gen(&replica[0], &code[0], code_length, 3.3, phase_step, num_samples);
+    code_replica_gen_packed(&packed[0], &code[0], code_length, 3.3, phase_step, num_samples);
+    const uint64_t* codes[1] = { &packed[0] };
+
+    gr_complex out;
+    Bit_Packed_Correlator correlator(num_samples, 2.0);
+    correlator.Carrier_wipeoff_packed(num_samples, &input[0], 0.0, carrier_phase_step_rad);
+    correlator.Multicorrelator_packed(1, codes, &out);
+
+    // A quarter of a cycle per sample: 2^30 per step
+    uint32_t phase_fxp = 0;
+    double expected_re = 0.0;
+    double expected_im = 0.0;
+    for (int i = 0; i < num_samples; i++)
+        {
+            double c = (((phase_fxp >> 31) ^ (phase_fxp >> 30)) & 1) ? -1.0 : 1.0;
+            double s = (phase_fxp >> 31) ? -1.0 : 1.0;
+            double chip = replica[i].real();
+            expected_re += (input[i].real() * c + input[i].imag() * s) * chip;
+            expected_im += (input[i].imag() * c - input[i].real() * s) * chip;
+            phase_fxp += (uint32_t)1 << 30;
+        }
+    EXPECT_NEAR(expected_re, out.real(), 0.5);
+    EXPECT_NEAR(expected_im, out.imag(), 0.5);
+}
+
+
+
+TEST(BitPackedCorrelator_Test, QuantizedSamples)
+{
+    std::vector<gr_complex> input(100);
+    for (int i = 0; i < 100; i++)
+        {
+            input[i] = gr_complex(i % 2 ? 1.0 : -1.0, i % 3 ? 1.0 : -1.0);
+        }
+    EXPECT_TRUE(Bit_Packed_Correlator::quantized(&input[0], 100, 0.0));
+    EXPECT_TRUE(Bit_Packed_Correlator::quantized(&input[0], 100, 2.0));
+    input[7] = gr_complex(3.0, -3.0);
+    EXPECT_FALSE(Bit_Packed_Correlator::quantized(&input[0], 100, 0.0));
+    EXPECT_TRUE(Bit_Packed_Correlator::quantized(&input[0], 100, 2.0));
+    // Both levels under the threshold
+    EXPECT_FALSE(Bit_Packed_Correlator::quantized(&input[0], 100, 4.0));
+    // A third level, as after a filter
+    input[8] = gr_complex(0.7, 1.0);
+    EXPECT_FALSE(Bit_Packed_Correlator::quantized(&input[0], 100, 2.0));
+    input[8] = gr_complex(0.0, 1.0);
+    EXPECT_FALSE(Bit_Packed_Correlator::quantized(&input[0], 100, 2.0));
+}
+
+
+
+TEST(BitPackedCorrelator_Test, CorrelatorBackend)
+{
+    const int code_length = 1023;
+    const int num_samples = 4000;
+    const int n_taps = 5;
+    const double phase_step = 1.023e6 / 4e6;
+    const double carrier_phase_step_rad = 2.0 * M_PI * -2345.0 / 4e6;
+    std::vector<gr_complex> code(code_length);
+    std::vector<gr_complex> input(num_samples);
+    srand(5);
+    for (int i = 0; i < code_length; i++)
+        {
+            code[i] = gr_complex((float)(rand() % 2) * 2.0 - 1.0, 0.0);
+        }
+    for (int i = 0; i < num_samples; i++)
+        {
+            input[i] = gr_complex(rand() % 2 ? 1.0 : -1.0, rand() % 2 ? 1.0 : -1.0);
+        }
+    std::vector<std::vector<uint64_t> > packed(n_taps, std::vector<uint64_t>(code_replica_packed_words(num_samples)));
+    const uint64_t* codes[n_taps];
+    for (int tap = 0; tap < n_taps; tap++)
+        {
+            code_replica_gen_packed(&packed[tap][0], &code[0], code_length, 0.3 * (double)tap, phase_step, num_samples);
+            codes[tap] = &packed[tap][0];
+        }
+
+    gr_complex out_packed[n_taps];
+    Bit_Packed_Correlator packed_correlator(num_samples, 0.0);
+    packed_correlator.Carrier_wipeoff_packed(num_samples, &input[0], 0.4, carrier_phase_step_rad);
+    packed_correlator.Multicorrelator_packed(n_taps, codes, out_packed);
+
+    gr_complex out[n_taps];
+    Correlator correlator;
+    correlator.set_bit_packed(2 * num_samples, 0.0);
+    correlator.Carrier_wipeoff_and_multicorrelator_packed(num_samples, &input[0], 0.4, carrier_phase_step_rad, n_taps, codes, out);
+    for (int tap = 0; tap < n_taps; tap++)
+        {
+            EXPECT_EQ(out_packed[tap], out[tap]);
+        }
+}
+
+
+
+TEST(BitPackedCorrelator_Test, EpochTimeAgainstTheFloatCorrelator)
+{
+    // Per epoch work of the tracking blocks with 3 taps at 4 Msps: replicas,
+    // carrier wipe-off and correlations
+    const int code_length = 1023;
+    const int num_samples = 4000;
+    const int n_taps = 3;
+    const int num_epochs = 1000;
+    const double phase_step = 1.023e6 / 4e6;
+    const float carrier_phase_step_rad = 2.0 * M_PI * 1500.0 / 4e6;
+    std::vector<gr_complex> code(code_length);
+    std::vector<gr_complex> input(num_samples);
+    srand(6);
+    for (int i = 0; i < code_length; i++)
+        {
+            code[i] = gr_complex((float)(rand() % 2) * 2.0 - 1.0, 0.0);
+        }
+    for (int i = 0; i < num_samples; i++)
+        {
+            input[i] = gr_complex(rand() % 2 ? 1.0 : -1.0, rand() % 2 ? 1.0 : -1.0);
+        }
+    gr_complex* replica;
+    gr_complex* carrier;
+    if (posix_memalign((void**)&replica, 16, (num_samples + 2) * sizeof(gr_complex)) == 0){};
+    if (posix_memalign((void**)&carrier, 16, num_samples * sizeof(gr_complex)) == 0){};
+    const gr_complex* taps[n_taps] = { replica, replica + 1, replica + 2 };
+    std::vector<std::vector<uint64_t> > packed(n_taps, std::vector<uint64_t>(code_replica_packed_words(num_samples)));
+    uint64_t* packed_taps[n_taps];
+    for (int tap = 0; tap < n_taps; tap++)
+        {
+            packed_taps[tap] = &packed[tap][0];
+        }
+    gr_complex out_float[n_taps];
+    gr_complex out_packed[n_taps];
+    Correlator correlator;
+    correlator.set_bit_packed(num_samples, 0.0);
+
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    long long int begin = tv.tv_sec * 1000000 + tv.tv_usec;
+    for (int k = 0; k < num_epochs; k++)
+        {
+            code_replica_gen(replica, &code[0], code_length, -0.5, phase_step, num_samples + 2);
+            rotator_nco(carrier, num_samples, 0.1, carrier_phase_step_rad);
+            correlator.Carrier_wipeoff_and_multicorrelator_volk(num_samples, &input[0], carrier, n_taps, taps, out_float);
+        }
+    gettimeofday(&tv, NULL);
+    long long int end = tv.tv_sec * 1000000 + tv.tv_usec;
+    std::cout << num_epochs << " epochs of " << num_samples << " samples with the float correlator finished in "
+              << (end - begin) << " microseconds" << std::endl;
+    ASSERT_LE(0, end - begin);
+
+    gettimeofday(&tv, NULL);
+    begin = tv.tv_sec * 1000000 + tv.tv_usec;
+    for (int k = 0; k < num_epochs; k++)
+        {
+            for (int tap = 0; tap < n_taps; tap++)
+                {
+                    // the taps of the float replica are one sample apart
+                    code_replica_gen_packed(packed_taps[tap], &code[0], code_length, -0.5 + (double)tap * phase_step,
+                            phase_step, num_samples);
+                }
+            correlator.Carrier_wipeoff_and_multicorrelator_packed(num_samples, &input[0], 0.1, carrier_phase_step_rad,
+                    n_taps, packed_taps, out_packed);
+        }
+    gettimeofday(&tv, NULL);
+    end = tv.tv_sec * 1000000 + tv.tv_usec;
+    std::cout << num_epochs << " epochs of " << num_samples << " samples with the bit-packed correlator finished in "
+              << (end - begin) << " microseconds" << std::endl;
+    ASSERT_LE(0, end - begin);
+
+    free(replica);
+    free(carrier);
+}
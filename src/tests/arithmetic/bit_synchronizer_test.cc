@@ -0,0 +1,72 @@
+/*!
+ * \file bit_synchronizer_test.cc
+ * \brief  This file implements tests for the histogram bit synchronization
+ * of the tracking loops.
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include <cstdlib>
+#include "bit_synchronizer.h"
+
+
+TEST(BitSynchronizer_Test, FindsTheBitEdge)
+{
+    const int symbols_per_bit = 20;
+    const int edge = 7;
+    Bit_Synchronizer synchronizer(symbols_per_bit, 10);
+
+    // Noisy prompt correlations of random bits, starting at symbol 7 of a bit
+    srand(1);
+    float bit = 1.0;
+    int symbol = 0;
+    for (symbol = 0; symbol < 100 * symbols_per_bit; symbol++)
+        {
+            if (symbol % symbols_per_bit == edge and rand() % 2 == 0)
+                {
+                    bit = -bit;
+                }
+            float noise = (float)(rand() % 100) / 100.0 - 0.5;
+            if (synchronizer.update(bit + noise) == true)
+                {
+                    break;
+                }
+        }
+    ASSERT_TRUE(synchronizer.synchronized());
+
+    // The next bits start at symbols 7, 27, 47...
+    for (int i = 0; i < 2 * symbols_per_bit; i++)
+        {
+            symbol++;
+            EXPECT_EQ(symbol % symbols_per_bit == edge, synchronizer.next_starts_bit());
+            synchronizer.update(1.0);
+        }
+
+    synchronizer.reset();
+    EXPECT_FALSE(synchronizer.synchronized());
+    EXPECT_FALSE(synchronizer.next_starts_bit());
+}
@@ -0,0 +1,110 @@
+/*!
+ * \file carrier_nco_test.cc
+ * \brief  This file implements accuracy tests for the rotator carrier NCO
+ * and the complex exponential generators built on it.
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include <cmath>
+#include <complex>
+#include "gnss_signal_processing.h"
+#include "nco_lib.h"
+
+
+TEST(CarrierNco_Test, RotatorEqualsExactPhase)
+{
+    // 10 ms at 4 Msps, with a Doppler shift at the edge of the search
+    const int n_samples = 40000;
+    const float start_phase_rad = 1.3;
+    const float phase_step_rad = GPS_TWO_PI * 9876.5 / 4e6;
+    std::complex<float>* carrier = new std::complex<float>[n_samples];
+
+    rotator_nco(carrier, n_samples, start_phase_rad, phase_step_rad);
+
+    float max_error = 0.0;
+    for (int i = 0; i < n_samples; i++)
+        {
+            double phase_rad = (double)start_phase_rad + (double)i * (double)phase_step_rad;
+            std::complex<double> expected(cos(phase_rad), -sin(phase_rad));
+            std::complex<double> actual(carrier[i].real(), carrier[i].imag());
+            max_error = std::max(max_error, (float)std::abs(actual - expected));
+        }
+    EXPECT_LT(max_error, 1e-4);
+
+    delete[] carrier;
+}
+
+
+TEST(CarrierNco_Test, ContinuousPhase)
+{
+    // Two consecutive epochs, as generated by the tracking loops
+    const int n_samples = 4092;
+    const float phase_step_rad = GPS_TWO_PI * -3210.0 / 4.092e6;
+    std::complex<float>* whole = new std::complex<float>[2 * n_samples];
+    std::complex<float>* second = new std::complex<float>[n_samples];
+
+    rotator_nco(whole, 2 * n_samples, 0.25, phase_step_rad);
+    rotator_nco(second, n_samples, 0.25 + (float)n_samples * phase_step_rad, phase_step_rad);
+
+    float max_error = 0.0;
+    for (int i = 0; i < n_samples; i++)
+        {
+            max_error = std::max(max_error, std::abs(whole[n_samples + i] - second[i]));
+        }
+    EXPECT_LT(max_error, 1e-4);
+
+    delete[] whole;
+    delete[] second;
+}
+
+
+TEST(CarrierNco_Test, ComplexExpGen)
+{
+    const unsigned int n_samples = 16368;
+    const double f = 4.092e6 / 4 + 2500;
+    const double fs = 4.092e6;
+    std::complex<float>* carrier = new std::complex<float>[n_samples];
+    std::complex<float>* carrier_conj = new std::complex<float>[n_samples];
+
+    complex_exp_gen(carrier, f, fs, n_samples);
+    complex_exp_gen_conj(carrier_conj, f, fs, n_samples);
+
+    const float phase_step_rad = (float)((GPS_TWO_PI * f) / fs);
+    float max_error = 0.0;
+    for (unsigned int i = 0; i < n_samples; i++)
+        {
+            double phase_rad = (double)i * (double)phase_step_rad;
+            std::complex<float> expected((float)cos(phase_rad), (float)sin(phase_rad));
+            max_error = std::max(max_error, std::abs(carrier[i] - expected));
+            max_error = std::max(max_error, std::abs(carrier_conj[i] - std::conj(expected)));
+        }
+    EXPECT_LT(max_error, 1e-4);
+
+    delete[] carrier;
+    delete[] carrier_conj;
+}
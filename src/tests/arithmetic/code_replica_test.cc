@@ -0,0 +1,110 @@
+/*!
+ * \file code_replica_test.cc
+ * \brief  This file implements tests for the generation of the local code
+ * replica of the tracking loops.
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include <cmath>
+#include <complex>
+#include <cstdlib>
+#include "code_replica.h"
+
+
+TEST(CodeReplica_Test, EqualsRoundedPhase)
+{
+    // A table with guard entries, sampled as the tracking loops did
+    const int code_length = 1023;
+    const int num_samples = 4096 + 8;
+    const double phase_step = 1.023e6 / 4.092e6 * (1.0 + 1.5e-6);
+    gr_complex* code = new gr_complex[code_length + 2];
+    gr_complex* replica = new gr_complex[num_samples];
+
+    srand(1);
+    for (int i = 0; i < code_length; i++)
+        {
+            code[i + 1] = gr_complex(i, (float)(rand() % 2) * 2.0 - 1.0);
+        }
+    code[0] = code[code_length];
+    code[code_length + 1] = code[1];
+
+    const double start_phases[] = { -0.5 - 0.123, -0.377, 0.0, 511.3, 1022.6 };
+    for (unsigned int k = 0; k < sizeof(start_phases) / sizeof(double); k++)
+        {
+            code_replica_gen(replica, &code[1], code_length, start_phases[k], phase_step, num_samples);
+            int errors = 0;
+            double tcode_chips = start_phases[k];
+            for (int i = 0; i < num_samples; i++)
+                {
+                    int associated_chip_index = 1 + round(fmod(tcode_chips, code_length));
+                    if (replica[i] != code[associated_chip_index])
+                        {
+                            errors++;
+                        }
+                    tcode_chips = tcode_chips + phase_step;
+                }
+            EXPECT_EQ(0, errors);
+        }
+
+    delete[] code;
+    delete[] replica;
+}
+
+
+TEST(CodeReplica_Test, TapsAreViews)
+{
+    // The late tap of the replica equals the early tap one spacing later
+    const int code_length = 2 * 4092;
+    const int spacing = 2;
+    const int num_samples = 4 * 4092;
+    const double phase_step = 2.0 * 1.023e6 / 4.092e6;
+    gr_complex* code = new gr_complex[code_length];
+    gr_complex* replica = new gr_complex[num_samples + 2 * spacing];
+    gr_complex* late = new gr_complex[num_samples];
+
+    for (int i = 0; i < code_length; i++)
+        {
+            code[i] = gr_complex(i, 0.0);
+        }
+    code_replica_gen(replica, code, code_length, -10.25, phase_step, num_samples + 2 * spacing);
+    code_replica_gen(late, code, code_length, -10.25 + 2 * spacing * phase_step, phase_step, num_samples);
+
+    int errors = 0;
+    for (int i = 0; i < num_samples; i++)
+        {
+            if (replica[i + 2 * spacing] != late[i])
+                {
+                    errors++;
+                }
+        }
+    EXPECT_EQ(0, errors);
+
+    delete[] code;
+    delete[] replica;
+    delete[] late;
+}
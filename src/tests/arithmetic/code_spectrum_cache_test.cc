@@ -0,0 +1,125 @@
+/*!
+ * \file code_spectrum_cache_test.cc
+ * \brief  This file implements tests for the cache of conjugated code
+ * spectra shared by the acquisition blocks.
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include "pcps_code_spectrum_cache.h"
+
+
+namespace
+{
+/*
+ * A spectrum that depends on every field of the key
+ */
+void fill_spectrum(gr_complex* spectrum, const std::string& signal, unsigned int prn,
+        long fs_in, unsigned int fft_size)
+{
+    for (unsigned int i = 0; i < fft_size; i++)
+        {
+            spectrum[i] = gr_complex((float)(prn * 1000 + i), (float)(signal.size() + fs_in % 1000));
+        }
+}
+}
+
+
+TEST(CodeSpectrumCache_Test, HitAndMiss)
+{
+    // Labels of their own: the cache is shared by the whole process
+    Pcps_Code_Spectrum_Cache* cache = Pcps_Code_Spectrum_Cache::instance();
+    const long fs = 4000000;
+    const unsigned int fft_size = 4000;
+    unsigned int size = cache->size();
+    gr_complex* spectrum;
+    if (posix_memalign((void**)&spectrum, 16, fft_size * sizeof(gr_complex)) == 0){};
+
+    EXPECT_TRUE(cache->find("Test 1C", 1, fs, fft_size) == 0);
+    fill_spectrum(spectrum, "Test 1C", 1, fs, fft_size);
+    cache->insert("Test 1C", 1, fs, fft_size, spectrum);
+    EXPECT_EQ(size + 1, cache->size());
+
+    // The hit returns a copy of the inserted spectrum
+    const gr_complex* cached = cache->find("Test 1C", 1, fs, fft_size);
+    ASSERT_TRUE(cached != 0);
+    EXPECT_TRUE(cached != spectrum);
+    EXPECT_EQ(0, memcmp(cached, spectrum, fft_size * sizeof(gr_complex)));
+
+    // Inserting the same key again neither replaces nor moves it
+    spectrum[0] = gr_complex(-1.0, -1.0);
+    cache->insert("Test 1C", 1, fs, fft_size, spectrum);
+    EXPECT_EQ(size + 1, cache->size());
+    EXPECT_TRUE(cached == cache->find("Test 1C", 1, fs, fft_size));
+    EXPECT_EQ(1000.0, cached[0].real());
+
+    free(spectrum);
+}
+
+
+TEST(CodeSpectrumCache_Test, NewPrnOrSignalMisses)
+{
+    // A channel reassigned to another PRN, signal, sampling frequency or
+    // integration length must not get the spectrum of the previous one
+    Pcps_Code_Spectrum_Cache* cache = Pcps_Code_Spectrum_Cache::instance();
+    const long fs = 4000000;
+    const unsigned int fft_size = 4000;
+    gr_complex* spectrum;
+    if (posix_memalign((void**)&spectrum, 16, 2 * fft_size * sizeof(gr_complex)) == 0){};
+
+    fill_spectrum(spectrum, "Test 1B", 5, fs, fft_size);
+    cache->insert("Test 1B", 5, fs, fft_size, spectrum);
+    EXPECT_TRUE(cache->find("Test 1B", 6, fs, fft_size) == 0);
+    EXPECT_TRUE(cache->find("Test 1B cboc", 5, fs, fft_size) == 0);
+    EXPECT_TRUE(cache->find("Test 1B", 5, 2 * fs, fft_size) == 0);
+    EXPECT_TRUE(cache->find("Test 1B", 5, fs, 2 * fft_size) == 0);
+
+    // Each key gets its own spectrum, and the first one is left untouched
+    fill_spectrum(spectrum, "Test 1B", 6, fs, fft_size);
+    cache->insert("Test 1B", 6, fs, fft_size, spectrum);
+    fill_spectrum(spectrum, "Test 1B cboc", 5, fs, fft_size);
+    cache->insert("Test 1B cboc", 5, fs, fft_size, spectrum);
+    fill_spectrum(spectrum, "Test 1B", 5, fs, 2 * fft_size);
+    cache->insert("Test 1B", 5, fs, 2 * fft_size, spectrum);
+
+    const gr_complex* prn_5 = cache->find("Test 1B", 5, fs, fft_size);
+    const gr_complex* prn_6 = cache->find("Test 1B", 6, fs, fft_size);
+    const gr_complex* cboc = cache->find("Test 1B cboc", 5, fs, fft_size);
+    const gr_complex* long_code = cache->find("Test 1B", 5, fs, 2 * fft_size);
+    ASSERT_TRUE(prn_5 != 0 && prn_6 != 0 && cboc != 0 && long_code != 0);
+    EXPECT_EQ(5000.0, prn_5[0].real());
+    EXPECT_EQ(7.0, prn_5[0].imag());
+    EXPECT_EQ(6000.0, prn_6[0].real());
+    EXPECT_EQ(12.0, cboc[0].imag());
+    EXPECT_EQ(5000.0 + 2 * fft_size - 1, long_code[2 * fft_size - 1].real());
+
+    free(spectrum);
+}
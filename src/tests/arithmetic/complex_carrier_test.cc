@@ -125,7 +125,7 @@ TEST(ComplexCarrier_Test, OwnComplexImplementation)
     gettimeofday(&tv, NULL);
     long long int end = tv.tv_sec * 1000000 + tv.tv_usec;
     std::cout << "A " << FLAGS_size_carrier_test
-              << "-length complex carrier using fixed point generated in " << (end - begin)
+              << "-length complex carrier using the rotator NCO generated in " << (end - begin)
               << " microseconds" << std::endl;
     ASSERT_LE(0, end - begin);
     std::complex<float> expected(1,0);
@@ -0,0 +1,148 @@
+/*!
+ * \file doppler_batch_engine_test.cc
+ * \brief  This file implements tests for the batched multi-Doppler FFT
+ * engine of the PCPS acquisition.
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+
+#include <cstdlib>
+#include <gnuradio/fft/fft.h>
+#include <volk/volk.h>
+#include "gnss_signal_processing.h"
+#include "pcps_doppler_batch_engine.h"
+#include "pcps_wipeoff_table.h"
+
+
+TEST(DopplerBatchEngine_Test, Batches)
+{
+    // 21 bins in batches of 4: the last one holds a single bin
+    Pcps_Doppler_Batch_Engine engine(100, 21, 4);
+    EXPECT_EQ(6, engine.num_batches());
+    EXPECT_EQ(4, engine.batch_length(0));
+    EXPECT_EQ(1, engine.batch_length(5));
+    EXPECT_EQ(20, engine.first_bin(5));
+
+    // Batch sizes out of range
+    Pcps_Doppler_Batch_Engine single(100, 21, 0);
+    EXPECT_EQ(1, single.batch_size());
+    EXPECT_EQ(21, single.num_batches());
+    Pcps_Doppler_Batch_Engine whole(100, 21, 50);
+    EXPECT_EQ(21, whole.batch_size());
+    EXPECT_EQ(1, whole.num_batches());
+}
+
+
+TEST(DopplerBatchEngine_Test, EqualsThePerBinGrid)
+{
+    // Rows of 1000 samples are padded in the buffers of the engine
+    const long fs = 1000000;
+    const unsigned int fft_size = 1000;
+    const unsigned int doppler_max = 5000;
+    const unsigned int doppler_step = 500;
+    const int doppler = -2000;
+    const unsigned int delay = 123;
+
+    gr_complex* code;
+    gr_complex* in;
+    gr_complex* carrier;
+    gr_complex* fft_code;
+    float* magnitude;
+    if (posix_memalign((void**)&code, 16, fft_size * sizeof(gr_complex)) == 0){};
+    if (posix_memalign((void**)&in, 16, fft_size * sizeof(gr_complex)) == 0){};
+    if (posix_memalign((void**)&carrier, 16, fft_size * sizeof(gr_complex)) == 0){};
+    if (posix_memalign((void**)&fft_code, 16, fft_size * sizeof(gr_complex)) == 0){};
+    if (posix_memalign((void**)&magnitude, 16, fft_size * sizeof(float)) == 0){};
+
+    // Delayed code on a carrier, plus noise
+    srand(1);
+    for (unsigned int i = 0; i < fft_size; i++)
+        {
+            code[i] = gr_complex((float)(rand() % 2) * 2.0 - 1.0, 0.0);
+        }
+    complex_exp_gen_conj(carrier, doppler, fs, fft_size);
+    for (unsigned int i = 0; i < fft_size; i++)
+        {
+            gr_complex noise = gr_complex((float)(rand() % 3) - 1.0, (float)(rand() % 3) - 1.0);
+            in[i] = code[(i + fft_size - delay) % fft_size] * std::conj(carrier[i]) + noise;
+        }
+    gr::fft::fft_complex* fft = new gr::fft::fft_complex(fft_size, true);
+    gr::fft::fft_complex* ifft = new gr::fft::fft_complex(fft_size, false);
+    memcpy(fft->get_inbuf(), code, fft_size * sizeof(gr_complex));
+    fft->execute();
+    volk_32fc_conjugate_32fc_a(fft_code, fft->get_outbuf(), fft_size);
+
+    Pcps_Wipeoff_Table table(0, fs, fft_size, doppler_max, doppler_step, 32);
+    Pcps_Doppler_Batch_Engine engine(fft_size, table.num_doppler_bins(), 4);
+    unsigned int best = 0;
+    float best_magnitude = 0.0;
+    for (unsigned int batch = 0; batch < engine.num_batches(); batch++)
+        {
+            engine.forward(batch, in, &table);
+            engine.correlate(fft_code);
+            for (unsigned int row = 0; row < engine.batch_length(batch); row++)
+                {
+                    // One bin at a time, as the acquisition before the engine
+                    unsigned int doppler_index = engine.first_bin(batch) + row;
+                    table.wipeoff(fft->get_inbuf(), in, doppler_index);
+                    fft->execute();
+                    volk_32fc_x2_multiply_32fc_a(ifft->get_inbuf(), fft->get_outbuf(), fft_code, fft_size);
+                    ifft->execute();
+                    volk_32fc_magnitude_squared_32f_a(magnitude, ifft->get_outbuf(), fft_size);
+                    unsigned int index = 0;
+                    for (unsigned int i = 1; i < fft_size; i++)
+                        {
+                            if (magnitude[i] > magnitude[index]) index = i;
+                        }
+
+                    EXPECT_EQ(index, engine.peak_index(row));
+                    EXPECT_NEAR(1.0, engine.peak_magnitude(row) / magnitude[index], 1e-4);
+                    float max_error = 0.0;
+                    for (unsigned int i = 0; i < fft_size; i++)
+                        {
+                            float error = std::abs(engine.magnitude(row)[i] - magnitude[i]);
+                            if (error > max_error) max_error = error;
+                        }
+                    EXPECT_LT(max_error, 1e-4 * magnitude[index]);
+                    if (engine.peak_magnitude(row) > best_magnitude)
+                        {
+                            best_magnitude = engine.peak_magnitude(row);
+                            best = doppler_index;
+                        }
+                }
+        }
+    EXPECT_EQ((doppler + (int)doppler_max) / (int)doppler_step, (int)best);
+
+    delete fft;
+    delete ifft;
+    free(code);
+    free(in);
+    free(carrier);
+    free(fft_code);
+    free(magnitude);
+}
@@ -0,0 +1,115 @@
+/*!
+ * \file doppler_rotation_test.cc
+ * \brief  This file implements tests for the Doppler search by rotation
+ * of the input spectrum.
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include <complex>
+#include <cstdlib>
+#include <gnuradio/fft/fft.h>
+#include <volk/volk.h>
+#include "gnss_signal_processing.h"
+#include "pcps_doppler_rotation.h"
+
+
+TEST(DopplerRotation_Test, GridDecomposition)
+{
+    // 4 MHz, 1 ms: FFT bin spacing is 1 kHz
+    Pcps_Doppler_Rotation rotation(0, 4000000, 4000, 10000, 500);
+
+    EXPECT_EQ(41, rotation.num_doppler_bins());
+    // integer and half-bin residuals
+    EXPECT_EQ(2, rotation.num_residuals());
+    // -10 kHz is a rotation of -10 bins
+    EXPECT_EQ(4000 - 10, rotation.shift(0));
+    EXPECT_NEAR(0.0, rotation.residual_hz(0), 1e-6);
+    // 0 Hz is not rotated
+    EXPECT_EQ(0, rotation.shift(20));
+}
+
+
+TEST(DopplerRotation_Test, RotationEqualsWipeoff)
+{
+    const long fs = 4000000;
+    const long freq = 12000;
+    const unsigned int fft_size = 4000;
+    const unsigned int doppler_max = 5000;
+    const unsigned int doppler_step = 250;
+
+    gr_complex* in;
+    gr_complex* codes;
+    gr_complex* wipeoff;
+    gr_complex* expected;
+    gr_complex* rotated;
+    if (posix_memalign((void**)&in, 16, fft_size * sizeof(gr_complex)) == 0){};
+    if (posix_memalign((void**)&codes, 16, fft_size * sizeof(gr_complex)) == 0){};
+    if (posix_memalign((void**)&wipeoff, 16, fft_size * sizeof(gr_complex)) == 0){};
+    if (posix_memalign((void**)&expected, 16, fft_size * sizeof(gr_complex)) == 0){};
+    if (posix_memalign((void**)&rotated, 16, fft_size * sizeof(gr_complex)) == 0){};
+
+    srand(1);
+    for (unsigned int i = 0; i < fft_size; i++)
+        {
+            in[i] = gr_complex((float)(rand() % 3) - 1.0, (float)(rand() % 3) - 1.0);
+            codes[i] = gr_complex((float)(rand() % 2) * 2.0 - 1.0, 0.0);
+        }
+
+    gr::fft::fft_complex* fft = new gr::fft::fft_complex(fft_size, true);
+    Pcps_Doppler_Rotation rotation(freq, fs, fft_size, doppler_max, doppler_step);
+    rotation.forward(in, fft);
+
+    float max_error = 0.0;
+    for (unsigned int doppler_index = 0; doppler_index < rotation.num_doppler_bins(); doppler_index++)
+        {
+            int doppler = -(int)doppler_max + doppler_step * doppler_index;
+            complex_exp_gen_conj(wipeoff, freq + doppler, fs, fft_size);
+            volk_32fc_x2_multiply_32fc_a(fft->get_inbuf(), in, wipeoff, fft_size);
+            fft->execute();
+            volk_32fc_x2_multiply_32fc_a(expected, fft->get_outbuf(), codes, fft_size);
+
+            rotation.multiply(rotated, doppler_index, codes);
+
+            for (unsigned int i = 0; i < fft_size; i++)
+                {
+                    float error = std::abs(expected[i] - rotated[i]) / (float)fft_size;
+                    if (error > max_error) max_error = error;
+                }
+        }
+
+    // Both paths use the fixed point carrier generator; differences come
+    // from its phase quantization only
+    EXPECT_LT(max_error, 0.01);
+
+    delete fft;
+    free(in);
+    free(codes);
+    free(wipeoff);
+    free(expected);
+    free(rotated);
+}
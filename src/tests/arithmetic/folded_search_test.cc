@@ -0,0 +1,132 @@
+/*!
+ * \file folded_search_test.cc
+ * \brief  This file implements tests for the code phase search on a
+ * folded dwell.
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include <complex>
+#include <cstdlib>
+#include <gnuradio/fft/fft.h>
+#include <volk/volk.h>
+#include "gnss_signal_processing.h"
+#include "pcps_folded_search.h"
+
+
+TEST(FoldedSearch_Test, Supported)
+{
+    EXPECT_TRUE(Pcps_Folded_Search::supported(4092, 3));
+    EXPECT_FALSE(Pcps_Folded_Search::supported(4092, 5));
+    EXPECT_FALSE(Pcps_Folded_Search::supported(4092, 1));
+}
+
+
+TEST(FoldedSearch_Test, PeakEqualsFullSearch)
+{
+    // Two code periods, the second one inverted (code B of the 8 ms search)
+    const long fs = 4092000;
+    const long freq = 0;
+    const int doppler = 1500;
+    const unsigned int samples_per_code = 2046;
+    const unsigned int fft_size = 2 * samples_per_code;
+    const unsigned int fold_factor = 3;
+    const unsigned int delay = 3001;
+
+    gr_complex* code_A;
+    gr_complex* code_B;
+    gr_complex* in;
+    gr_complex* wipeoff;
+    gr_complex* fft_code_A;
+    gr_complex* fft_code_B;
+    if (posix_memalign((void**)&code_A, 16, fft_size * sizeof(gr_complex)) == 0){};
+    if (posix_memalign((void**)&code_B, 16, fft_size * sizeof(gr_complex)) == 0){};
+    if (posix_memalign((void**)&in, 16, fft_size * sizeof(gr_complex)) == 0){};
+    if (posix_memalign((void**)&wipeoff, 16, fft_size * sizeof(gr_complex)) == 0){};
+    if (posix_memalign((void**)&fft_code_A, 16, fft_size * sizeof(gr_complex)) == 0){};
+    if (posix_memalign((void**)&fft_code_B, 16, fft_size * sizeof(gr_complex)) == 0){};
+
+    srand(1);
+    for (unsigned int i = 0; i < samples_per_code; i++)
+        {
+            float chip = (float)(rand() % 2) * 2.0 - 1.0;
+            code_A[i] = gr_complex(chip, 0.0);
+            code_A[i + samples_per_code] = gr_complex(chip, 0.0);
+            code_B[i] = gr_complex(chip, 0.0);
+            code_B[i + samples_per_code] = gr_complex(-chip, 0.0);
+        }
+
+    // Delayed code B on a carrier, plus noise
+    complex_exp_gen_conj(wipeoff, freq + doppler, fs, fft_size);
+    for (unsigned int i = 0; i < fft_size; i++)
+        {
+            gr_complex noise = gr_complex((float)(rand() % 3) - 1.0, (float)(rand() % 3) - 1.0);
+            in[i] = code_B[(i + fft_size - delay) % fft_size] * std::conj(wipeoff[i]) + noise;
+        }
+
+    // Conjugated code spectra, as used by the full search
+    gr::fft::fft_complex* fft = new gr::fft::fft_complex(fft_size, true);
+    gr::fft::fft_complex* ifft = new gr::fft::fft_complex(fft_size, false);
+    memcpy(fft->get_inbuf(), code_A, fft_size * sizeof(gr_complex));
+    fft->execute();
+    volk_32fc_conjugate_32fc_a(fft_code_A, fft->get_outbuf(), fft_size);
+    memcpy(fft->get_inbuf(), code_B, fft_size * sizeof(gr_complex));
+    fft->execute();
+    volk_32fc_conjugate_32fc_a(fft_code_B, fft->get_outbuf(), fft_size);
+
+    // Full search of code B
+    volk_32fc_x2_multiply_32fc_a(fft->get_inbuf(), in, wipeoff, fft_size);
+    fft->execute();
+    volk_32fc_x2_multiply_32fc_a(ifft->get_inbuf(), fft->get_outbuf(), fft_code_B, fft_size);
+    ifft->execute();
+    float full_magnitude = std::norm(ifft->get_outbuf()[delay]);
+
+    Pcps_Folded_Search search(fft_size, fold_factor, 2);
+    EXPECT_EQ(fft_size / fold_factor, search.folded_size());
+    search.set_local_code_spectrum(0, fft_code_A);
+    search.set_local_code_spectrum(1, fft_code_B);
+    search.fold(in, wipeoff);
+
+    unsigned int index_A = 0;
+    unsigned int index_B = 0;
+    float magnitude_A = search.correlate(0, &index_A);
+    float magnitude_B = search.correlate(1, &index_B);
+
+    // The ambiguity is resolved, and the peak has the scale of the full search
+    EXPECT_EQ(delay, index_B);
+    EXPECT_NEAR(1.0, magnitude_B / full_magnitude, 1e-3);
+    EXPECT_LT(magnitude_A, magnitude_B);
+
+    delete fft;
+    delete ifft;
+    free(code_A);
+    free(code_B);
+    free(in);
+    free(wipeoff);
+    free(fft_code_A);
+    free(fft_code_B);
+}
@@ -0,0 +1,146 @@
+/*!
+ * \file grid_recorder_test.cc
+ * \brief  This file implements tests for the capture of acquisition grids.
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include <cstdio>
+#include <fstream>
+#include <stdint.h>
+#include <gnuradio/gr_complex.h>
+#include "pcps_grid_recorder.h"
+
+
+TEST(GridRecorder_Test, WritesOneFilePerAttempt)
+{
+    const unsigned int fft_size = 16;
+    const unsigned int num_doppler_bins = 3;
+    gr_complex row[fft_size];
+
+    {
+        Pcps_Grid_Recorder recorder("./grid_recorder_test.dat", fft_size, num_doppler_bins, 2);
+        for (unsigned int attempt = 0; attempt < 2; attempt++)
+            {
+                EXPECT_TRUE(recorder.begin(3, 'G', "1C", 7, 1000 * (attempt + 1)));
+                // The first bin is out of the search window
+                for (unsigned int doppler_index = 1; doppler_index < num_doppler_bins; doppler_index++)
+                    {
+                        for (unsigned int i = 0; i < fft_size; i++)
+                            {
+                                row[i] = gr_complex(attempt, doppler_index * fft_size + i);
+                            }
+                        recorder.record(doppler_index, -500 + 500 * doppler_index, row);
+                    }
+                recorder.commit(0.5, 0.1);
+            }
+        // The destructor waits for the writer
+    }
+
+    for (unsigned int attempt = 0; attempt < 2; attempt++)
+        {
+            std::string filename = attempt == 0 ? "./grid_recorder_test_ch_3_G_1C_sat_7_0.dat" : "./grid_recorder_test_ch_3_G_1C_sat_7_1.dat";
+            std::ifstream file(filename.c_str(), std::ios::in | std::ios::binary);
+            EXPECT_TRUE(file.is_open());
+
+            char magic[8];
+            uint32_t size;
+            uint32_t bins;
+            uint64_t sample_stamp;
+            uint32_t prn;
+            char signal[4];
+            float statistics[2];
+            file.read(magic, 8);
+            file.read((char*)&size, sizeof(size));
+            file.read((char*)&bins, sizeof(bins));
+            file.read((char*)&sample_stamp, sizeof(sample_stamp));
+            file.read((char*)&prn, sizeof(prn));
+            file.read(signal, 4);
+            file.read((char*)statistics, sizeof(statistics));
+            EXPECT_EQ(0, std::string(magic, 8).compare("GSDRAG01"));
+            EXPECT_EQ(fft_size, size);
+            EXPECT_EQ(num_doppler_bins, bins);
+            EXPECT_EQ(1000 * (attempt + 1), sample_stamp);
+            EXPECT_EQ(7, prn);
+            EXPECT_EQ('G', signal[0]);
+            EXPECT_FLOAT_EQ(0.5, statistics[0]);
+
+            uint64_t offsets[num_doppler_bins];
+            for (unsigned int doppler_index = 0; doppler_index < num_doppler_bins; doppler_index++)
+                {
+                    int32_t doppler_hz;
+                    uint32_t recorded;
+                    file.read((char*)&doppler_hz, sizeof(doppler_hz));
+                    file.read((char*)&recorded, sizeof(recorded));
+                    file.read((char*)&offsets[doppler_index], sizeof(uint64_t));
+                    EXPECT_EQ(doppler_index > 0 ? 1 : 0, recorded);
+                    if (recorded)
+                        {
+                            EXPECT_EQ(-500 + 500 * (int)doppler_index, doppler_hz);
+                        }
+                }
+
+            file.seekg(offsets[2]);
+            file.read((char*)row, sizeof(row));
+            EXPECT_FLOAT_EQ(attempt, row[3].real());
+            EXPECT_FLOAT_EQ(2 * fft_size + 3, row[3].imag());
+            file.close();
+            std::remove(filename.c_str());
+        }
+}
+
+
+
+TEST(GridRecorder_Test, FileNames)
+{
+    const unsigned int fft_size = 4;
+    gr_complex row[fft_size];
+    for (unsigned int i = 0; i < fft_size; i++)
+        {
+            row[i] = gr_complex(i, 0);
+        }
+    {
+        // Two channels with the same file name, without extension after the last dot
+        Pcps_Grid_Recorder recorder_0("./grid_recorder_test", fft_size, 1, 1);
+        Pcps_Grid_Recorder recorder_1("./grid_recorder_test", fft_size, 1, 1);
+        EXPECT_TRUE(recorder_0.begin(0, 'G', "1C", 7, 1000));
+        recorder_0.record(0, 0, row);
+        recorder_0.commit(0.5, 0.1);
+        EXPECT_TRUE(recorder_1.begin(1, 'G', "1C", 7, 1000));
+        recorder_1.record(0, 0, row);
+        recorder_1.commit(0.5, 0.1);
+    }
+    const char* filenames[] = { "./grid_recorder_test_ch_0_G_1C_sat_7_0.dat",
+                                "./grid_recorder_test_ch_1_G_1C_sat_7_0.dat" };
+    for (unsigned int channel = 0; channel < 2; channel++)
+        {
+            std::ifstream file(filenames[channel], std::ios::in | std::ios::binary);
+            EXPECT_TRUE(file.is_open());
+            file.close();
+            std::remove(filenames[channel]);
+        }
+}
@@ -0,0 +1,148 @@
+/*!
+ * \file hierarchical_doppler_search_test.cc
+ * \brief  This file implements tests for the coarse-to-fine Doppler search
+ * of the PCPS acquisition.
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+
+#include <cstdlib>
+#include <vector>
+#include <gnuradio/fft/fft.h>
+#include <volk/volk.h>
+#include "gnss_signal_processing.h"
+#include "pcps_doppler_batch_engine.h"
+#include "pcps_hierarchical_doppler_search.h"
+#include "pcps_wipeoff_table.h"
+
+
+TEST(HierarchicalDopplerSearch_Test, OnlyWhenShorter)
+{
+    // 2 ms of GPS L1 C/A at 1 Msps, 41 bins of 250 Hz, coarse step 1 kHz
+    EXPECT_TRUE(Pcps_Hierarchical_Doppler_Search::supported(2000, 1000, 5000, 250, 1000, 2));
+    // A dwell of a single code period
+    EXPECT_FALSE(Pcps_Hierarchical_Doppler_Search::supported(1000, 1000, 5000, 250, 1000, 2));
+    // Not a whole number of code periods
+    EXPECT_FALSE(Pcps_Hierarchical_Doppler_Search::supported(2500, 1000, 5000, 250, 1000, 2));
+    // As many fine bins as in the regular grid
+    EXPECT_FALSE(Pcps_Hierarchical_Doppler_Search::supported(2000, 1000, 5000, 250, 1000, 8));
+    // Coarse step not greater than the step
+    EXPECT_FALSE(Pcps_Hierarchical_Doppler_Search::supported(2000, 1000, 5000, 250, 250, 2));
+}
+
+
+TEST(HierarchicalDopplerSearch_Test, FindsTheFullSearchPeak)
+{
+    const long fs = 1000000;
+    const unsigned int samples_per_code = 1000;
+    const unsigned int fft_size = 2 * samples_per_code;
+    const unsigned int doppler_max = 5000;
+    const unsigned int doppler_step = 250;
+    const unsigned int coarse_doppler_step = 1000;
+    const int doppler = 1750;
+    const unsigned int delay = 321;
+
+    gr_complex* code;
+    gr_complex* in;
+    gr_complex* carrier;
+    gr_complex* fft_code;
+    if (posix_memalign((void**)&code, 16, fft_size * sizeof(gr_complex)) == 0){};
+    if (posix_memalign((void**)&in, 16, fft_size * sizeof(gr_complex)) == 0){};
+    if (posix_memalign((void**)&carrier, 16, fft_size * sizeof(gr_complex)) == 0){};
+    if (posix_memalign((void**)&fft_code, 16, fft_size * sizeof(gr_complex)) == 0){};
+
+    // Two periods of a delayed code on a carrier, plus noise
+    srand(1);
+    for (unsigned int i = 0; i < samples_per_code; i++)
+        {
+            code[i] = gr_complex((float)(rand() % 2) * 2.0 - 1.0, 0.0);
+            code[i + samples_per_code] = code[i];
+        }
+    complex_exp_gen_conj(carrier, doppler, fs, fft_size);
+    for (unsigned int i = 0; i < fft_size; i++)
+        {
+            gr_complex noise = gr_complex((float)(rand() % 3) - 1.0, (float)(rand() % 3) - 1.0);
+            in[i] = code[(i + fft_size - delay) % fft_size] * std::conj(carrier[i]) + noise;
+        }
+    gr::fft::fft_complex* fft = new gr::fft::fft_complex(fft_size, true);
+    memcpy(fft->get_inbuf(), code, fft_size * sizeof(gr_complex));
+    fft->execute();
+    volk_32fc_conjugate_32fc_a(fft_code, fft->get_outbuf(), fft_size);
+
+    // Full search of the regular grid
+    Pcps_Wipeoff_Table table(0, fs, fft_size, doppler_max, doppler_step, 32);
+    const unsigned int num_doppler_bins = table.num_doppler_bins();
+    std::vector<unsigned int> full_index(num_doppler_bins);
+    std::vector<float> full_magnitude(num_doppler_bins);
+    Pcps_Doppler_Batch_Engine engine(fft_size, num_doppler_bins, 8);
+    unsigned int full_best = 0;
+    for (unsigned int batch = 0; batch < engine.num_batches(); batch++)
+        {
+            engine.forward(batch, in, &table);
+            engine.correlate(fft_code);
+            for (unsigned int row = 0; row < engine.batch_length(batch); row++)
+                {
+                    unsigned int doppler_index = engine.first_bin(batch) + row;
+                    full_index[doppler_index] = engine.peak_index(row);
+                    full_magnitude[doppler_index] = engine.peak_magnitude(row);
+                    if (full_magnitude[doppler_index] > full_magnitude[full_best]) full_best = doppler_index;
+                }
+        }
+    EXPECT_EQ((doppler + (int)doppler_max) / (int)doppler_step, (int)full_best);
+    EXPECT_EQ(delay, full_index[full_best]);
+
+    // Coarse to fine, reduced over the evaluated bins in Doppler order
+    Pcps_Hierarchical_Doppler_Search search(0, fs, fft_size, samples_per_code, doppler_max,
+            doppler_step, coarse_doppler_step, 2, 8);
+    search.set_local_code_spectrum(fft_code);
+    search.search(in, &table, 0, fft_code);
+    unsigned int best = num_doppler_bins;
+    unsigned int evaluated = 0;
+    for (unsigned int doppler_index = 0; doppler_index < num_doppler_bins; doppler_index++)
+        {
+            if (search.evaluated(doppler_index))
+                {
+                    evaluated++;
+                    EXPECT_EQ(full_index[doppler_index], search.peak_index(doppler_index));
+                    EXPECT_NEAR(1.0, search.peak_magnitude(doppler_index) / full_magnitude[doppler_index], 1e-4);
+                    if (best == num_doppler_bins || search.peak_magnitude(doppler_index) > search.peak_magnitude(best))
+                        {
+                            best = doppler_index;
+                        }
+                }
+        }
+    EXPECT_EQ(full_best, best);
+    EXPECT_EQ(delay, search.peak_index(best));
+    EXPECT_LT(evaluated, num_doppler_bins);
+
+    delete fft;
+    free(code);
+    free(in);
+    free(carrier);
+    free(fft_code);
+}
@@ -0,0 +1,158 @@
+/*!
+ * \file multi_correlator_test.cc
+ * \brief  This file implements tests for the single pass carrier wipe-off
+ * and multi-tap correlation.
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include <complex>
+#include <cstdlib>
+#include <gnuradio/gr_complex.h>
+#include <volk/volk.h>
+#include "correlator.h"
+#include "volk_cw_multi_corr.h"
+
+
+TEST(MultiCorrelator_Test, EqualsTwoPassCorrelation)
+{
+    // Odd length, not a multiple of the tile, and unaligned codes
+    const unsigned int num_points = 4093;
+    const unsigned int num_taps = 7;
+    const unsigned int spacing = 2;
+
+    gr_complex* input = new gr_complex[num_points];
+    gr_complex* carrier = new gr_complex[num_points];
+    gr_complex* code = new gr_complex[num_points + num_taps * spacing];
+    gr_complex* bb_signal = new gr_complex[num_points];
+    const gr_complex* codes[num_taps];
+    gr_complex out_generic[num_taps];
+    gr_complex out_volk[num_taps];
+
+    srand(1);
+    for (unsigned int i = 0; i < num_points; i++)
+        {
+            input[i] = gr_complex((float)(rand() % 200) - 100.0, (float)(rand() % 200) - 100.0);
+            carrier[i] = std::exp(gr_complex(0.0, 0.001 * i));
+            bb_signal[i] = input[i] * carrier[i];
+        }
+    for (unsigned int i = 0; i < num_points + num_taps * spacing; i++)
+        {
+            code[i] = gr_complex((float)(rand() % 2) * 2.0 - 1.0, 0.0);
+        }
+    // Taps as offset views of one replica
+    for (unsigned int tap = 0; tap < num_taps; tap++)
+        {
+            codes[tap] = code + tap * spacing + 1;
+        }
+
+    volk_cw_multi_corr_generic(input, carrier, codes, out_generic, num_taps, num_points);
+    volk_cw_multi_corr_u(input, carrier, codes, out_volk, num_taps, num_points);
+
+    for (unsigned int tap = 0; tap < num_taps; tap++)
+        {
+            gr_complex expected = gr_complex(0.0, 0.0);
+            for (unsigned int i = 0; i < num_points; i++)
+                {
+                    expected += bb_signal[i] * codes[tap][i];
+                }
+            EXPECT_NEAR(0.0, std::abs(out_generic[tap] - expected) / std::abs(expected), 1e-3);
+            EXPECT_NEAR(0.0, std::abs(out_volk[tap] - expected) / std::abs(expected), 1e-3);
+        }
+
+    // The E/P/L correlator gives the same values
+    Correlator correlator;
+    gr_complex E;
+    gr_complex P;
+    gr_complex L;
+    correlator.Carrier_wipeoff_and_EPL_volk(num_points, input, carrier, (gr_complex*)codes[0],
+            (gr_complex*)codes[1], (gr_complex*)codes[2], &E, &P, &L, true);
+    EXPECT_EQ(out_volk[0], E);
+    EXPECT_EQ(out_volk[1], P);
+    EXPECT_EQ(out_volk[2], L);
+
+    delete[] input;
+    delete[] carrier;
+    delete[] code;
+    delete[] bb_signal;
+}
+
+
+TEST(MultiCorrelator_Test, OwnedScratchBuffer)
+{
+    // Lengths around the tile, and a short call after a long one: the
+    // scratch buffer of the Correlator must not carry anything over
+    const unsigned int lengths[] = {4093, 1, 255, 256, 257, 2 * VOLK_CW_MULTI_CORR_TILE + 3, 4093};
+    const unsigned int num_lengths = sizeof(lengths) / sizeof(lengths[0]);
+    const unsigned int max_points = 4093;
+    const unsigned int num_taps = 5;
+
+    gr_complex* input = new gr_complex[max_points];
+    gr_complex* carrier = new gr_complex[max_points];
+    gr_complex* code = new gr_complex[max_points + num_taps];
+    const gr_complex* codes[num_taps];
+    gr_complex out_stack[num_taps];
+    gr_complex out_owned[num_taps];
+    gr_complex out_vepl[num_taps];
+
+    srand(2);
+    for (unsigned int i = 0; i < max_points; i++)
+        {
+            input[i] = gr_complex((float)(rand() % 200) - 100.0, (float)(rand() % 200) - 100.0);
+            carrier[i] = std::exp(gr_complex(0.0, -0.002 * i));
+        }
+    for (unsigned int i = 0; i < max_points + num_taps; i++)
+        {
+            code[i] = gr_complex((float)(rand() % 2) * 2.0 - 1.0, 0.0);
+        }
+    for (unsigned int tap = 0; tap < num_taps; tap++)
+        {
+            codes[tap] = code + tap;
+        }
+
+    Correlator correlator;
+    for (unsigned int k = 0; k < num_lengths; k++)
+        {
+            // Same values as the kernel with its scratch buffer in the stack
+            volk_cw_multi_corr_u(input, carrier, codes, out_stack, num_taps, lengths[k]);
+            correlator.Carrier_wipeoff_and_multicorrelator_volk(lengths[k], input, carrier,
+                    num_taps, codes, out_owned);
+            correlator.Carrier_wipeoff_and_VEPL_volk(lengths[k], input, carrier,
+                    (gr_complex*)codes[0], (gr_complex*)codes[1], (gr_complex*)codes[2],
+                    (gr_complex*)codes[3], (gr_complex*)codes[4], &out_vepl[0], &out_vepl[1],
+                    &out_vepl[2], &out_vepl[3], &out_vepl[4], true);
+            for (unsigned int tap = 0; tap < num_taps; tap++)
+                {
+                    EXPECT_EQ(out_stack[tap], out_owned[tap]);
+                    EXPECT_EQ(out_stack[tap], out_vepl[tap]);
+                }
+        }
+
+    delete[] input;
+    delete[] carrier;
+    delete[] code;
+}
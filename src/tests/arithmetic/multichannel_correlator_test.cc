@@ -0,0 +1,99 @@
+/*!
+ * \file multichannel_correlator_test.cc
+ * \brief  This file implements tests for the batched correlation of several
+ * tracking channels on one block of samples.
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include <complex>
+#include <cstdlib>
+#include <gnuradio/gr_complex.h>
+#include "correlator.h"
+#include "multichannel_correlator.h"
+#include "nco_lib.h"
+
+
+TEST(MultichannelCorrelator_Test, EqualsOneChannelAtATime)
+{
+    // Channels with different intervals of the block, none aligned to the tiles
+    const int block_samples = 3 * 4092;
+    const int num_channels = 4;
+    const int num_taps = 3;
+    const int spacing = 2;
+    const int first_sample[num_channels] = { 0, 17, 1500, 4093 };
+    const int num_samples[num_channels] = { 4092, 4092, 4091, 8000 };
+    const float carrier_phase_rad[num_channels] = { 0.0, 1.0, -2.5, 3.0 };
+    const float carrier_phase_step_rad[num_channels] = { 0.01, -0.003, 0.0, 0.0077 };
+
+    gr_complex* block = new gr_complex[block_samples];
+    gr_complex* carrier = new gr_complex[block_samples];
+    gr_complex* code = new gr_complex[block_samples + num_taps * spacing];
+    const gr_complex* codes[num_channels][num_taps];
+    gr_complex out_batch[num_channels][num_taps];
+    gr_complex out_single[num_taps];
+
+    srand(1);
+    for (int i = 0; i < block_samples; i++)
+        {
+            block[i] = gr_complex((float)(rand() % 200) - 100.0, (float)(rand() % 200) - 100.0);
+        }
+    for (int i = 0; i < block_samples + num_taps * spacing; i++)
+        {
+            code[i] = gr_complex((float)(rand() % 2) * 2.0 - 1.0, 0.0);
+        }
+
+    Multichannel_Correlator batch(num_channels, 1024);
+    for (int ch = 0; ch < num_channels; ch++)
+        {
+            for (int tap = 0; tap < num_taps; tap++)
+                {
+                    codes[ch][tap] = code + ch + tap * spacing;
+                }
+            EXPECT_TRUE(batch.add_channel(first_sample[ch], num_samples[ch], carrier_phase_rad[ch],
+                    carrier_phase_step_rad[ch], num_taps, codes[ch], out_batch[ch]));
+        }
+    EXPECT_FALSE(batch.add_channel(0, 1, 0.0, 0.0, num_taps, codes[0], out_single));
+    EXPECT_EQ(num_channels, batch.num_channels());
+    batch.correlate(block);
+
+    Correlator correlator;
+    for (int ch = 0; ch < num_channels; ch++)
+        {
+            rotator_nco(carrier, num_samples[ch], carrier_phase_rad[ch], carrier_phase_step_rad[ch]);
+            correlator.Carrier_wipeoff_and_multicorrelator_volk(num_samples[ch], block + first_sample[ch],
+                    carrier, num_taps, codes[ch], out_single);
+            for (int tap = 0; tap < num_taps; tap++)
+                {
+                    EXPECT_NEAR(0.0, std::abs(out_batch[ch][tap] - out_single[tap]) / std::abs(out_single[tap]), 1e-3);
+                }
+        }
+
+    delete[] block;
+    delete[] carrier;
+    delete[] code;
+}
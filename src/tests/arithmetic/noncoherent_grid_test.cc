@@ -0,0 +1,157 @@
+/*!
+ * \file noncoherent_grid_test.cc
+ * \brief  This file implements tests for the non-coherent accumulation of
+ * the acquisition dwells.
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+#include "pcps_noncoherent_grid.h"
+
+
+TEST(NoncoherentGrid_Test, SumOfTheDwells)
+{
+    // Rows of 1001 samples are padded in the grid
+    const unsigned int num_doppler_bins = 5;
+    const unsigned int fft_size = 1001;
+    const unsigned int num_dwells = 4;
+    const unsigned int peak_bin = 3;
+    const unsigned int peak_index = 777;
+
+    float* magnitude;
+    if (posix_memalign((void**)&magnitude, 16, fft_size * sizeof(float)) == 0){};
+    std::vector<double> sum(num_doppler_bins * fft_size, 0.0);
+
+    Pcps_Noncoherent_Grid grid(num_doppler_bins, fft_size);
+    srand(1);
+    for (unsigned int dwell = 0; dwell < num_dwells; dwell++)
+        {
+            for (unsigned int bin = 0; bin < num_doppler_bins; bin++)
+                {
+                    // Noise, and a peak only a little above it in each dwell
+                    for (unsigned int i = 0; i < fft_size; i++)
+                        {
+                            magnitude[i] = (float)(rand() % 1000) / 100.0;
+                        }
+                    if (bin == peak_bin)
+                        {
+                            magnitude[peak_index] = 10.0;
+                        }
+                    grid.accumulate(bin, magnitude);
+                    for (unsigned int i = 0; i < fft_size; i++)
+                        {
+                            sum[bin * fft_size + i] += magnitude[i];
+                        }
+                }
+            grid.end_dwell();
+        }
+    EXPECT_EQ(num_dwells, grid.num_dwells());
+
+    for (unsigned int bin = 0; bin < num_doppler_bins; bin++)
+        {
+            float max_error = 0.0;
+            for (unsigned int i = 0; i < fft_size; i++)
+                {
+                    float error = std::abs(grid.row(bin)[i] - (float)sum[bin * fft_size + i]);
+                    if (error > max_error) max_error = error;
+                }
+            EXPECT_LT(max_error, 1e-4);
+        }
+
+    unsigned int index = 0;
+    unsigned int best_bin = 0;
+    float best = 0.0;
+    for (unsigned int bin = 0; bin < num_doppler_bins; bin++)
+        {
+            unsigned int bin_index;
+            float bin_peak = grid.peak(bin, &bin_index);
+            EXPECT_NEAR(sum[bin * fft_size + bin_index], bin_peak, 1e-4);
+            if (bin_peak > best)
+                {
+                    best = bin_peak;
+                    best_bin = bin;
+                    index = bin_index;
+                }
+        }
+    EXPECT_EQ(peak_bin, best_bin);
+    EXPECT_EQ(peak_index, index);
+
+    // A new acquisition starts from an empty grid
+    grid.reset();
+    EXPECT_EQ(0, grid.num_dwells());
+    for (unsigned int bin = 0; bin < num_doppler_bins; bin++)
+        {
+            for (unsigned int i = 0; i < fft_size; i++)
+                {
+                    EXPECT_EQ(0.0, grid.row(bin)[i]);
+                }
+        }
+
+    free(magnitude);
+}
+
+
+TEST(NoncoherentGrid_Test, SumOfTheBestHypotheses)
+{
+    // Each dwell adds the greater of the two secondary code hypotheses
+    const unsigned int fft_size = 1001;
+    float* magnitude_a;
+    float* magnitude_b;
+    if (posix_memalign((void**)&magnitude_a, 16, fft_size * sizeof(float)) == 0){};
+    if (posix_memalign((void**)&magnitude_b, 16, fft_size * sizeof(float)) == 0){};
+    std::vector<double> sum(fft_size, 0.0);
+
+    Pcps_Noncoherent_Grid grid(1, fft_size);
+    srand(2);
+    for (unsigned int dwell = 0; dwell < 3; dwell++)
+        {
+            for (unsigned int i = 0; i < fft_size; i++)
+                {
+                    magnitude_a[i] = (float)(rand() % 1000) / 100.0;
+                    magnitude_b[i] = (float)(rand() % 1000) / 100.0;
+                    sum[i] += std::max(magnitude_a[i], magnitude_b[i]);
+                }
+            grid.accumulate_max(0, magnitude_a, magnitude_b);
+            grid.end_dwell();
+        }
+
+    float max_error = 0.0;
+    for (unsigned int i = 0; i < fft_size; i++)
+        {
+            float error = std::abs(grid.row(0)[i] - (float)sum[i]);
+            if (error > max_error) max_error = error;
+        }
+    EXPECT_LT(max_error, 1e-4);
+
+    free(magnitude_a);
+    free(magnitude_b);
+}
@@ -0,0 +1,135 @@
+/*!
+ * \file parallel_doppler_search_test.cc
+ * \brief  This file implements tests for the Doppler search split across
+ * the workers of the shared pool.
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+
+#include <cstdlib>
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
+#include <gnuradio/fft/fft.h>
+#include <volk/volk.h>
+#include "gnss_signal_processing.h"
+#include "pcps_doppler_batch_engine.h"
+#include "pcps_parallel_doppler_search.h"
+#include "pcps_wipeoff_table.h"
+
+
+namespace
+{
+void parallel_doppler_search_test_run(Pcps_Parallel_Doppler_Search* search, const gr_complex* in,
+        const Pcps_Wipeoff_Table* table, const gr_complex* fft_code)
+{
+    search->search(in, table, 0, fft_code);
+}
+}
+
+
+TEST(ParallelDopplerSearch_Test, EqualsTheSerialGrid)
+{
+    const long fs = 1000000;
+    const unsigned int fft_size = 1000;
+    const unsigned int doppler_max = 5000;
+    const unsigned int doppler_step = 500;
+    const unsigned int batch_size = 4;
+    const int doppler = 1500;
+    const unsigned int delay = 321;
+
+    gr_complex* code;
+    gr_complex* in;
+    gr_complex* carrier;
+    gr_complex* fft_code;
+    if (posix_memalign((void**)&code, 16, fft_size * sizeof(gr_complex)) == 0){};
+    if (posix_memalign((void**)&in, 16, fft_size * sizeof(gr_complex)) == 0){};
+    if (posix_memalign((void**)&carrier, 16, fft_size * sizeof(gr_complex)) == 0){};
+    if (posix_memalign((void**)&fft_code, 16, fft_size * sizeof(gr_complex)) == 0){};
+
+    // Delayed code on a carrier, plus noise
+    srand(1);
+    for (unsigned int i = 0; i < fft_size; i++)
+        {
+            code[i] = gr_complex((float)(rand() % 2) * 2.0 - 1.0, 0.0);
+        }
+    complex_exp_gen_conj(carrier, doppler, fs, fft_size);
+    for (unsigned int i = 0; i < fft_size; i++)
+        {
+            gr_complex noise = gr_complex((float)(rand() % 3) - 1.0, (float)(rand() % 3) - 1.0);
+            in[i] = code[(i + fft_size - delay) % fft_size] * std::conj(carrier[i]) + noise;
+        }
+    gr::fft::fft_complex* fft = new gr::fft::fft_complex(fft_size, true);
+    memcpy(fft->get_inbuf(), code, fft_size * sizeof(gr_complex));
+    fft->execute();
+    volk_32fc_conjugate_32fc_a(fft_code, fft->get_outbuf(), fft_size);
+
+    Pcps_Wipeoff_Table table(0, fs, fft_size, doppler_max, doppler_step, 32);
+    const unsigned int num_doppler_bins = table.num_doppler_bins();
+
+    // Serial grid
+    std::vector<unsigned int> serial_index(num_doppler_bins);
+    std::vector<float> serial_magnitude(num_doppler_bins);
+    Pcps_Doppler_Batch_Engine engine(fft_size, num_doppler_bins, batch_size);
+    for (unsigned int batch = 0; batch < engine.num_batches(); batch++)
+        {
+            engine.forward(batch, in, &table);
+            engine.correlate(fft_code);
+            for (unsigned int row = 0; row < engine.batch_length(batch); row++)
+                {
+                    serial_index[engine.first_bin(batch) + row] = engine.peak_index(row);
+                    serial_magnitude[engine.first_bin(batch) + row] = engine.peak_magnitude(row);
+                }
+        }
+    EXPECT_EQ(delay, serial_index[(doppler + doppler_max) / doppler_step]);
+
+    // Two channels searching at the same time with 3 workers each
+    Pcps_Parallel_Doppler_Search search_1(3, fft_size, num_doppler_bins, batch_size);
+    Pcps_Parallel_Doppler_Search search_2(3, fft_size, num_doppler_bins, batch_size);
+    EXPECT_EQ(3, search_1.num_workers());
+    // The threads are shared: at most 2, not 2 per channel
+    EXPECT_LE(Pcps_Doppler_Worker_Pool::instance()->num_threads(), 2);
+    for (int k = 0; k < 3; k++)
+        {
+            boost::thread channel_2(boost::bind(&parallel_doppler_search_test_run, &search_2, in, &table, fft_code));
+            search_1.search(in, &table, 0, fft_code);
+            channel_2.join();
+            for (unsigned int doppler_index = 0; doppler_index < num_doppler_bins; doppler_index++)
+                {
+                    EXPECT_EQ(serial_index[doppler_index], search_1.peak_index(doppler_index));
+                    EXPECT_EQ(serial_magnitude[doppler_index], search_1.peak_magnitude(doppler_index));
+                    EXPECT_EQ(serial_index[doppler_index], search_2.peak_index(doppler_index));
+                    EXPECT_EQ(serial_magnitude[doppler_index], search_2.peak_magnitude(doppler_index));
+                }
+        }
+
+    delete fft;
+    free(code);
+    free(in);
+    free(carrier);
+    free(fft_code);
+}
@@ -0,0 +1,79 @@
+/*!
+ * \file streaming_lock_detector_test.cc
+ * \brief  This file implements tests for the sliding window CN0 estimator
+ * and carrier lock detector.
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include <cstdlib>
+#include <gnuradio/gr_complex.h>
+#include "lock_detectors.h"
+#include "streaming_lock_detector.h"
+
+
+TEST(StreamingLockDetector_Test, EqualsTheWindowEstimators)
+{
+    // Prompt outputs of a tracked GPS L1 C/A signal with noise
+    const int window = 20;
+    const int num_epochs = 500;
+    const long fs_in = 4000000;
+    const double code_length = 1023;
+    gr_complex* prompt = new gr_complex[num_epochs];
+    srand(1);
+    for (int i = 0; i < num_epochs; i++)
+        {
+            float sign = (i / 20) % 2 == 0 ? 1.0 : -1.0;
+            float noise_i = (float)(rand() % 2001 - 1000) / 1000.0;
+            float noise_q = (float)(rand() % 2001 - 1000) / 1000.0;
+            prompt[i] = gr_complex(sign * 3000.0 + 800.0 * noise_i, 800.0 * noise_q);
+        }
+
+    Streaming_Lock_Detector_32f detector_32f(window, fs_in, code_length);
+    Streaming_Lock_Detector_64f detector_64f(window, fs_in, code_length);
+    for (int i = 0; i < num_epochs; i++)
+        {
+            detector_32f.update(prompt[i].real(), prompt[i].imag());
+            detector_64f.update(prompt[i].real(), prompt[i].imag());
+            EXPECT_EQ(i + 1 >= window, detector_32f.full());
+            if (detector_32f.full())
+                {
+                    // The last window epochs
+                    gr_complex* last = prompt + i + 1 - window;
+                    float cn0 = cn0_svn_estimator(last, window, fs_in, code_length);
+                    float lock = carrier_lock_detector(last, window);
+                    EXPECT_NEAR(cn0, detector_32f.cn0_db_hz(), 0.01);
+                    EXPECT_NEAR(cn0, detector_64f.cn0_db_hz(), 0.01);
+                    EXPECT_NEAR(lock, detector_32f.carrier_lock(), 1e-4);
+                    EXPECT_NEAR(lock, detector_64f.carrier_lock(), 1e-4);
+                }
+        }
+
+    detector_32f.reset();
+    EXPECT_FALSE(detector_32f.full());
+    delete[] prompt;
+}
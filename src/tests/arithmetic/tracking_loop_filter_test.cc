@@ -0,0 +1,124 @@
+/*!
+ * \file tracking_loop_filter_test.cc
+ * \brief  This file implements tests for the PLL and DLL loop filters
+ * with the summation interval of the extended coherent integration.
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include <cmath>
+#include "tracking_2nd_PLL_filter.h"
+#include "tracking_2nd_DLL_filter.h"
+
+
+/*
+ * Closes a PLL on a carrier with a constant frequency offset [Hz] for
+ * num_periods summation intervals, with a two quadrant atan discriminator
+ * of the mean phase error over each interval, as the tracking blocks do.
+ * Returns the final frequency error [Hz] and phase error [cycles].
+ */
+static void run_pll(Tracking_2nd_PLL_filter& filter, double& nco_hz, double& phase_error_cycles,
+        double offset_hz, float pdi_s, int num_periods)
+{
+    for (int k = 0; k < num_periods; k++)
+        {
+            double freq_error_hz = offset_hz - nco_hz;
+            double mean_error_cycles = phase_error_cycles + freq_error_hz * pdi_s / 2.0;
+            float discriminator = (float)(std::atan(std::tan(mean_error_cycles * 2.0 * M_PI)) / (2.0 * M_PI));
+            nco_hz = filter.get_carrier_nco(discriminator);
+            phase_error_cycles += freq_error_hz * pdi_s;
+        }
+}
+
+
+TEST(TrackingLoopFilter_Test, PllConvergesAtTheExtendedPdi)
+{
+    // 1 ms and 50 Hz until the bit synchronization, then 20 ms and 4 Hz
+    const double offset_hz = 5.0;
+    double nco_hz = 0.0;
+    double phase_error_cycles = 0.1;
+    Tracking_2nd_PLL_filter filter;
+    filter.set_pdi(0.001);
+    filter.set_PLL_BW(50.0);
+    filter.initialize();
+    run_pll(filter, nco_hz, phase_error_cycles, offset_hz, 0.001, 1000);
+    EXPECT_NEAR(offset_hz, nco_hz, 0.01);
+
+    filter.set_pdi(0.02);
+    filter.set_PLL_BW(4.0);
+    // a Doppler step after the switch
+    run_pll(filter, nco_hz, phase_error_cycles, offset_hz + 2.0, 0.02, 500);
+    EXPECT_NEAR(offset_hz + 2.0, nco_hz, 0.01);
+    EXPECT_NEAR(0.0, phase_error_cycles - std::floor(phase_error_cycles + 0.5), 0.001);
+}
+
+
+TEST(TrackingLoopFilter_Test, PllDivergesWithTheWideBandwidth)
+{
+    // Bn * T = 1: the bandwidth of the 1 ms loop does not work at 20 ms
+    const double offset_hz = 5.0;
+    double nco_hz = 0.0;
+    double phase_error_cycles = 0.1;
+    Tracking_2nd_PLL_filter filter;
+    filter.set_pdi(0.02);
+    filter.set_PLL_BW(50.0);
+    filter.initialize();
+    run_pll(filter, nco_hz, phase_error_cycles, offset_hz, 0.02, 500);
+    EXPECT_GT(std::abs(offset_hz - nco_hz), 1.0);
+
+    // Bn * T = 0.1, the limit of the tracking block
+    nco_hz = 0.0;
+    phase_error_cycles = 0.1;
+    filter.set_PLL_BW(5.0);
+    filter.initialize();
+    run_pll(filter, nco_hz, phase_error_cycles, offset_hz, 0.02, 500);
+    EXPECT_NEAR(offset_hz, nco_hz, 0.01);
+}
+
+
+TEST(TrackingLoopFilter_Test, DllConvergesAtTheExtendedPdi)
+{
+    // A code frequency offset [chips/s], with a linear discriminator of the
+    // mean code phase error [chips]
+    const double offset_chips_s = 0.5;
+    double nco_chips_s = 0.0;
+    double code_error_chips = 0.2;
+    const float pdi_s = 0.02;
+    Tracking_2nd_DLL_filter filter;
+    filter.set_pdi(pdi_s);
+    filter.set_DLL_BW(1.0);
+    filter.initialize();
+    for (int k = 0; k < 1000; k++)
+        {
+            double rate_error = offset_chips_s - nco_chips_s;
+            float discriminator = (float)(code_error_chips + rate_error * pdi_s / 2.0);
+            nco_chips_s = filter.get_code_nco(discriminator);
+            code_error_chips += rate_error * pdi_s;
+        }
+    EXPECT_NEAR(offset_chips_s, nco_chips_s, 0.001);
+    EXPECT_NEAR(0.0, code_error_chips, 0.001);
+}
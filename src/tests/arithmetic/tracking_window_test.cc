@@ -0,0 +1,110 @@
+/*!
+ * \file tracking_window_test.cc
+ * \brief  This file implements tests for the aligned input windows of the
+ * tracking blocks.
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include <complex>
+#include <cstdlib>
+#include <stdint.h>
+#include <gnuradio/gr_complex.h>
+#include "code_replica.h"
+#include "correlator.h"
+#include "nco_lib.h"
+#include "tracking_window.h"
+
+
+TEST(TrackingWindow_Test, AlignedWindowEqualsEpoch)
+{
+    const int num_samples = 4093;
+    const int code_length = 1023;
+    const double code_phase_step = 1.023e6 / 4.092e6;
+    const float phase_step_rad = 0.0123;
+    const int taps = 3;
+    const int spacing = 2;
+    gr_complex* input;
+    gr_complex* carrier;
+    if (posix_memalign((void**)&input, Tracking_Window::alignment(), (2 * num_samples) * sizeof(gr_complex)) == 0){};
+    if (posix_memalign((void**)&carrier, Tracking_Window::alignment(), (2 * num_samples) * sizeof(gr_complex)) == 0){};
+    gr_complex* code = new gr_complex[code_length];
+    gr_complex* replica = new gr_complex[2 * num_samples];
+
+    srand(1);
+    for (int i = 0; i < 2 * num_samples; i++)
+        {
+            input[i] = gr_complex((float)(rand() % 200) - 100.0, (float)(rand() % 200) - 100.0);
+        }
+    for (int i = 0; i < code_length; i++)
+        {
+            code[i] = gr_complex((float)(rand() % 2) * 2.0 - 1.0, 0.0);
+        }
+
+    Correlator correlator;
+    Tracking_Window window;
+    // Every misalignment of the first sample of the epoch
+    const int word_samples = Tracking_Window::alignment() / (int)sizeof(gr_complex);
+    for (int offset = 0; offset < word_samples; offset++)
+        {
+            const gr_complex* first = input + offset + Tracking_Window::history() - 1;
+            window.set(input + offset, num_samples);
+            EXPECT_EQ(0, (int)((uintptr_t)window.data() % Tracking_Window::alignment()));
+            EXPECT_EQ(first, window.data() + window.lead());
+            EXPECT_GE(window.length(), window.lead() + num_samples);
+            EXPECT_EQ(0, window.length() % word_samples);
+
+            // Epoch on its own, unaligned
+            const gr_complex* codes[taps];
+            gr_complex expected[taps];
+            code_replica_gen(replica, code, code_length, 10.0, code_phase_step, num_samples + taps * spacing);
+            for (int tap = 0; tap < taps; tap++)
+                {
+                    codes[tap] = replica + tap * spacing;
+                }
+            rotator_nco(carrier, num_samples, 0.5, phase_step_rad);
+            correlator.Carrier_wipeoff_and_multicorrelator_volk(num_samples, first, carrier, taps, codes, expected);
+
+            // Aligned window with zero carrier out of the epoch
+            gr_complex actual[taps];
+            code_replica_gen(replica, code, code_length, 10.0 - window.lead() * code_phase_step,
+                    code_phase_step, window.length() + taps * spacing);
+            rotator_nco(&carrier[window.lead()], num_samples, 0.5, phase_step_rad);
+            window.clear_padding(carrier);
+            correlator.Carrier_wipeoff_and_multicorrelator_volk(window.length(), window.data(), carrier, taps, codes, actual);
+
+            for (int tap = 0; tap < taps; tap++)
+                {
+                    EXPECT_NEAR(0.0, std::abs(actual[tap] - expected[tap]) / std::abs(expected[tap]), 1e-4);
+                }
+        }
+
+    free(input);
+    free(carrier);
+    delete[] code;
+    delete[] replica;
+}
@@ -0,0 +1,292 @@
+/*!
+ * \file wipeoff_table_test.cc
+ * \brief  This file implements tests for the Doppler wipe-offs: tables
+ * stored with 16 and 8 bit samples, shared tables and on-the-fly generation.
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include <sys/time.h>
+#include <complex>
+#include <cstdlib>
+#include <iostream>
+#include <gnuradio/fft/fft.h>
+#include <volk/volk.h>
+#include "gnss_signal_processing.h"
+#include "pcps_wipeoff_nco.h"
+#include "pcps_wipeoff_registry.h"
+#include "pcps_wipeoff_table.h"
+
+
+TEST(WipeoffTable_Test, Footprint)
+{
+    Pcps_Wipeoff_Table table_32(0, 4000000, 4000, 5000, 500, 32);
+    Pcps_Wipeoff_Table table_16(0, 4000000, 4000, 5000, 500, 16);
+    Pcps_Wipeoff_Table table_8(0, 4000000, 4000, 5000, 500, 8);
+    EXPECT_EQ(21, table_32.num_doppler_bins());
+    EXPECT_EQ(21 * 4000 * sizeof(gr_complex), table_32.size_bytes());
+    EXPECT_EQ(table_32.size_bytes() / 2, table_16.size_bytes());
+    EXPECT_EQ(table_32.size_bytes() / 4, table_8.size_bytes());
+
+    // Unsupported sizes fall back to float
+    Pcps_Wipeoff_Table table_12(0, 4000000, 4000, 5000, 500, 12);
+    EXPECT_EQ(32, table_12.bits());
+}
+
+
+TEST(WipeoffTable_Test, DetectionStatistic)
+{
+    const long fs = 4000000;
+    const long freq = 0;
+    const unsigned int fft_size = 4000;
+    const unsigned int doppler_max = 5000;
+    const unsigned int doppler_step = 500;
+    const unsigned int doppler_index = 13;
+    const int doppler = -(int)doppler_max + doppler_step * doppler_index;
+    const unsigned int delay = 1234;
+
+    gr_complex* code;
+    gr_complex* in;
+    gr_complex* wipeoff;
+    gr_complex* fft_code;
+    if (posix_memalign((void**)&code, 16, fft_size * sizeof(gr_complex)) == 0){};
+    if (posix_memalign((void**)&in, 16, fft_size * sizeof(gr_complex)) == 0){};
+    if (posix_memalign((void**)&wipeoff, 16, fft_size * sizeof(gr_complex)) == 0){};
+    if (posix_memalign((void**)&fft_code, 16, fft_size * sizeof(gr_complex)) == 0){};
+
+    // Delayed code on a carrier, plus noise
+    srand(1);
+    for (unsigned int i = 0; i < fft_size; i++)
+        {
+            code[i] = gr_complex((float)(rand() % 2) * 2.0 - 1.0, 0.0);
+        }
+    complex_exp_gen_conj(wipeoff, freq + doppler, fs, fft_size);
+    for (unsigned int i = 0; i < fft_size; i++)
+        {
+            gr_complex noise = gr_complex((float)(rand() % 3) - 1.0, (float)(rand() % 3) - 1.0);
+            in[i] = code[(i + fft_size - delay) % fft_size] * std::conj(wipeoff[i]) + noise;
+        }
+
+    gr::fft::fft_complex* fft = new gr::fft::fft_complex(fft_size, true);
+    gr::fft::fft_complex* ifft = new gr::fft::fft_complex(fft_size, false);
+    memcpy(fft->get_inbuf(), code, fft_size * sizeof(gr_complex));
+    fft->execute();
+    volk_32fc_conjugate_32fc_a(fft_code, fft->get_outbuf(), fft_size);
+
+    float magnitudes[3];
+    unsigned int indexes[3];
+    const unsigned int bits[3] = {32, 16, 8};
+    float* magnitude;
+    if (posix_memalign((void**)&magnitude, 16, fft_size * sizeof(float)) == 0){};
+    for (unsigned int i = 0; i < 3; i++)
+        {
+            Pcps_Wipeoff_Table table(freq, fs, fft_size, doppler_max, doppler_step, bits[i]);
+            EXPECT_EQ(bits[i], table.bits());
+            table.wipeoff(fft->get_inbuf(), in, doppler_index);
+            fft->execute();
+            volk_32fc_x2_multiply_32fc_a(ifft->get_inbuf(), fft->get_outbuf(), fft_code, fft_size);
+            ifft->execute();
+            volk_32fc_magnitude_squared_32f_a(magnitude, ifft->get_outbuf(), fft_size);
+            volk_32f_index_max_16u_a(&indexes[i], magnitude, fft_size);
+            magnitudes[i] = magnitude[indexes[i]];
+        }
+
+    // Same peak, and the same test statistic as the float path
+    EXPECT_EQ(delay, indexes[0]);
+    EXPECT_EQ(delay, indexes[1]);
+    EXPECT_EQ(delay, indexes[2]);
+    EXPECT_NEAR(1.0, magnitudes[1] / magnitudes[0], 1e-4);
+    EXPECT_NEAR(1.0, magnitudes[2] / magnitudes[0], 1e-2);
+
+    delete fft;
+    delete ifft;
+    free(code);
+    free(in);
+    free(wipeoff);
+    free(fft_code);
+    free(magnitude);
+}
+
+
+TEST(WipeoffTable_Test, SharedTables)
+{
+    Pcps_Wipeoff_Registry* registry = Pcps_Wipeoff_Registry::instance();
+    unsigned int tables = registry->size();
+    {
+        pcps_wipeoff_table_sptr channel_1 = registry->table(0, 4000000, 4000, 5000, 500, 32);
+        pcps_wipeoff_table_sptr channel_2 = registry->table(0, 4000000, 4000, 5000, 500, 32);
+        pcps_wipeoff_table_sptr channel_3 = registry->table(0, 4000000, 4000, 5000, 250, 32);
+        EXPECT_EQ(channel_1.get(), channel_2.get());
+        EXPECT_NE(channel_1.get(), channel_3.get());
+        EXPECT_EQ(tables + 2, registry->size());
+    }
+    // Released with the last reference
+    EXPECT_EQ(tables, registry->size());
+}
+
+
+TEST(WipeoffTable_Test, NcoEqualsTable)
+{
+    const long fs = 4000000;
+    const long freq = 12000;
+    const unsigned int fft_size = 16000;
+    const unsigned int doppler_max = 5000;
+    const unsigned int doppler_step = 500;
+
+    gr_complex* in;
+    gr_complex* out_table;
+    gr_complex* out_nco;
+    if (posix_memalign((void**)&in, 16, fft_size * sizeof(gr_complex)) == 0){};
+    if (posix_memalign((void**)&out_table, 16, fft_size * sizeof(gr_complex)) == 0){};
+    if (posix_memalign((void**)&out_nco, 16, fft_size * sizeof(gr_complex)) == 0){};
+    srand(1);
+    for (unsigned int i = 0; i < fft_size; i++)
+        {
+            in[i] = gr_complex((float)(rand() % 3) - 1.0, (float)(rand() % 3) - 1.0);
+        }
+
+    Pcps_Wipeoff_Table table(freq, fs, fft_size, doppler_max, doppler_step, 32);
+    Pcps_Wipeoff_Nco nco(freq, fs, fft_size, doppler_max, doppler_step);
+    EXPECT_EQ(table.num_doppler_bins(), nco.num_doppler_bins());
+
+    float max_error = 0.0;
+    for (unsigned int doppler_index = 0; doppler_index < nco.num_doppler_bins(); doppler_index++)
+        {
+            table.wipeoff(out_table, in, doppler_index);
+            nco.wipeoff(out_nco, in, doppler_index);
+            for (unsigned int i = 0; i < fft_size; i++)
+                {
+                    float error = std::abs(out_nco[i] - out_table[i]);
+                    if (error > max_error)
+                        {
+                            max_error = error;
+                        }
+                }
+        }
+    EXPECT_LT(max_error, 1e-2);
+
+    free(in);
+    free(out_table);
+    free(out_nco);
+}
+
+
+
+TEST(WipeoffTable_Test, IntegerEqualsFloat)
+{
+    // An odd length: the SSE2 loops and the last samples
+    const long fs = 4000000;
+    const long freq = 12000;
+    const unsigned int fft_size = 4003;
+    const unsigned int doppler_max = 5000;
+    const unsigned int doppler_step = 500;
+
+    gr_complex* in;
+    gr_complex* out_32;
+    gr_complex* out_int;
+    if (posix_memalign((void**)&in, 16, fft_size * sizeof(gr_complex)) == 0){};
+    if (posix_memalign((void**)&out_32, 16, fft_size * sizeof(gr_complex)) == 0){};
+    if (posix_memalign((void**)&out_int, 16, fft_size * sizeof(gr_complex)) == 0){};
+    srand(2);
+    for (unsigned int i = 0; i < fft_size; i++)
+        {
+            in[i] = gr_complex((float)(rand() % 3) - 1.0, (float)(rand() % 3) - 1.0);
+        }
+
+    Pcps_Wipeoff_Table table_32(freq, fs, fft_size, doppler_max, doppler_step, 32);
+    const unsigned int bits[2] = {16, 8};
+    // Quantization error of the wipe-off, times |in| <= sqrt(2)
+    const float max_errors[2] = {1e-4, 2e-2};
+    for (unsigned int b = 0; b < 2; b++)
+        {
+            Pcps_Wipeoff_Table table(freq, fs, fft_size, doppler_max, doppler_step, bits[b]);
+            float max_error = 0.0;
+            for (unsigned int doppler_index = 0; doppler_index < table.num_doppler_bins(); doppler_index++)
+                {
+                    table_32.wipeoff(out_32, in, doppler_index);
+                    table.wipeoff(out_int, in, doppler_index);
+                    for (unsigned int i = 0; i < fft_size; i++)
+                        {
+                            float error = std::abs(out_32[i] - out_int[i]);
+                            if (error > max_error)
+                                {
+                                    max_error = error;
+                                }
+                        }
+                }
+            EXPECT_LT(max_error, max_errors[b]);
+        }
+
+    free(in);
+    free(out_32);
+    free(out_int);
+}
+
+
+TEST(WipeoffTable_Test, WipeoffTime)
+{
+    // The wipe-offs of a whole grid, 100 times, with each storage size
+    const long fs = 4000000;
+    const unsigned int fft_size = 4000;
+    const unsigned int doppler_max = 10000;
+    const unsigned int doppler_step = 250;
+    const int repetitions = 100;
+
+    gr_complex* in;
+    gr_complex* out;
+    if (posix_memalign((void**)&in, 16, fft_size * sizeof(gr_complex)) == 0){};
+    if (posix_memalign((void**)&out, 16, fft_size * sizeof(gr_complex)) == 0){};
+    for (unsigned int i = 0; i < fft_size; i++)
+        {
+            in[i] = gr_complex(1.0, -1.0);
+        }
+
+    const unsigned int bits[3] = {32, 16, 8};
+    for (unsigned int b = 0; b < 3; b++)
+        {
+            Pcps_Wipeoff_Table table(0, fs, fft_size, doppler_max, doppler_step, bits[b]);
+            struct timeval tv;
+            gettimeofday(&tv, NULL);
+            long long int begin = tv.tv_sec * 1000000 + tv.tv_usec;
+            for (int k = 0; k < repetitions; k++)
+                {
+                    for (unsigned int doppler_index = 0; doppler_index < table.num_doppler_bins(); doppler_index++)
+                        {
+                            table.wipeoff(out, in, doppler_index);
+                        }
+                }
+            gettimeofday(&tv, NULL);
+            long long int end = tv.tv_sec * 1000000 + tv.tv_usec;
+            std::cout << repetitions << " grids of " << table.num_doppler_bins() << " wipe-offs with "
+                      << bits[b] << " bit samples (" << table.size_bytes() << " bytes) finished in "
+                      << (end - begin) << " microseconds" << std::endl;
+            ASSERT_LE(0, end - begin);
+        }
+
+    free(in);
+    free(out);
+}
@@ -0,0 +1,138 @@
+/*!
+ * \file channel_scheduler_test.cc
+ * \brief  This file implements tests for the work-stealing pool that runs
+ * the work of the channels.
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include <set>
+#include <vector>
+#include <boost/bind.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include "channel_scheduler.h"
+
+namespace
+{
+boost::mutex scheduler_test_mutex;
+unsigned int scheduler_test_count = 0;
+std::set<boost::thread::id> scheduler_test_threads;
+
+void scheduler_test_task()
+{
+    boost::this_thread::sleep(boost::posix_time::microseconds(100));
+    boost::mutex::scoped_lock lock(scheduler_test_mutex);
+    scheduler_test_count++;
+    scheduler_test_threads.insert(boost::this_thread::get_id());
+}
+
+void scheduler_test_empty_task()
+{
+    boost::mutex::scoped_lock lock(scheduler_test_mutex);
+    scheduler_test_count++;
+}
+
+void scheduler_test_submitter(Channel_Scheduler* scheduler, unsigned int queue, unsigned int num_tasks)
+{
+    for (unsigned int i = 0; i < num_tasks; i++)
+        {
+            scheduler->submit(queue, boost::bind(&scheduler_test_empty_task));
+        }
+}
+}
+
+
+TEST(Channel_Scheduler_Test, RunsAllTasksAndSteals)
+{
+    const unsigned int num_tasks = 400;
+    scheduler_test_count = 0;
+    scheduler_test_threads.clear();
+    {
+        Channel_Scheduler scheduler(4, false);
+        EXPECT_EQ(4, scheduler.num_workers());
+        // All the tasks go to the first worker, the others have to steal them
+        for (unsigned int i = 0; i < num_tasks; i++)
+            {
+                scheduler.submit(0, boost::bind(&scheduler_test_task));
+            }
+    }
+    // The destructor runs the pending tasks
+    EXPECT_EQ(num_tasks, scheduler_test_count);
+    EXPECT_LT(1, scheduler_test_threads.size());
+}
+
+
+TEST(Channel_Scheduler_Test, ConcurrentSubmissions)
+{
+    // Tasks taken as soon as they are queued, from several threads
+    const unsigned int num_submitters = 4;
+    const unsigned int num_tasks = 10000;
+    scheduler_test_count = 0;
+    {
+        Channel_Scheduler scheduler(3, false);
+        boost::thread_group submitters;
+        for (unsigned int i = 0; i < num_submitters; i++)
+            {
+                submitters.create_thread(boost::bind(&scheduler_test_submitter, &scheduler, i, num_tasks));
+            }
+        submitters.join_all();
+    }
+    EXPECT_EQ(num_submitters * num_tasks, scheduler_test_count);
+}
+
+
+TEST(Channel_Scheduler_Test, RunsTheEpochOfTheChannels)
+{
+    const unsigned int num_channels = 12;
+    const unsigned int num_epochs = 50;
+    Channel_Scheduler scheduler(3, false);
+    std::vector<unsigned int> queues;
+    std::vector<boost::function<void()> > tasks;
+    for (unsigned int channel = 0; channel < num_channels; channel++)
+        {
+            queues.push_back(channel);
+            tasks.push_back(boost::bind(&scheduler_test_task));
+        }
+    scheduler_test_count = 0;
+    for (unsigned int epoch = 0; epoch < num_epochs; epoch++)
+        {
+            // All the work of the epoch is done when it returns
+            scheduler.run_epoch(queues, tasks);
+            boost::mutex::scoped_lock lock(scheduler_test_mutex);
+            EXPECT_EQ((epoch + 1) * num_channels, scheduler_test_count);
+        }
+}
+
+
+TEST(Channel_Scheduler_Test, SharedByTheChannels)
+{
+    channel_scheduler_sptr first = Channel_Scheduler::shared(2, false);
+    channel_scheduler_sptr second = Channel_Scheduler::shared(8, true);
+    EXPECT_EQ(first.get(), second.get());
+    EXPECT_EQ(2, second->num_workers());
+}
@@ -0,0 +1,134 @@
+/*!
+ * \file tcp_tracking_transport_test.cc
+ * \brief  This file implements tests for the pipelined TCP transport of the
+ * TCP connector tracking, against the loopback stand-in of the loop filter
+ * program.
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include "tcp_packet_data.h"
+#include "tcp_tracking_loopback.h"
+#include "tcp_tracking_transport.h"
+
+
+TEST(TcpTrackingTransport_Test, PipelinedAndBatched)
+{
+    const unsigned short port = 2170;
+    const int num_channels = 3;
+    const int num_epochs = 40;
+    const int batch_epochs = 4;
+    const int pipeline_depth = 2;
+
+    Tcp_Tracking_Loopback loopback(port);
+    {
+        Tcp_Tracking_Transport transport(port, batch_epochs, pipeline_depth);
+        ASSERT_TRUE(transport.connected());
+        for (int epoch = 0; epoch < num_epochs; epoch++)
+            {
+                for (int ch = 0; ch < num_channels; ch++)
+                    {
+                        // GPS L1 C/A request: control id, E, L, P, acquisition Doppler, 1
+                        float tx_variables[NUM_TX_VARIABLES_GPS_L1_CA] = { (float)(epoch + 1), 1, 2, 3, 4, 5, 6,
+                                                                           (float)(1000 * ch + epoch), 1 };
+                        tcp_packet_data tcp_data;
+                        bool response = transport.exchange(ch, tx_variables, NUM_TX_VARIABLES_GPS_L1_CA, &tcp_data);
+                        if (epoch < pipeline_depth)
+                            {
+                                EXPECT_FALSE(response);
+                            }
+                        else
+                            {
+                                // Response of the request pipeline_depth epochs before
+                                ASSERT_TRUE(response);
+                                EXPECT_EQ((float)(1000 * ch + epoch - pipeline_depth), tcp_data.proc_pack_carrier_doppler_hz);
+                                EXPECT_EQ(0.0, tcp_data.proc_pack_code_error);
+                                EXPECT_EQ(0.0, tcp_data.proc_pack_carr_error);
+                            }
+                    }
+            }
+    }
+    loopback.join();
+    EXPECT_EQ((unsigned int)(num_channels * num_epochs), loopback.records());
+    EXPECT_LT(loopback.packets(), loopback.records());
+}
+
+
+TEST(TcpTrackingTransport_Test, ResetDropsThePipeline)
+{
+    const unsigned short port = 2171;
+    const int pipeline_depth = 3;
+
+    Tcp_Tracking_Loopback loopback(port);
+    Tcp_Tracking_Transport transport(port, 1, pipeline_depth);
+    ASSERT_TRUE(transport.connected());
+    tcp_packet_data tcp_data;
+    for (int epoch = 0; epoch < pipeline_depth; epoch++)
+        {
+            float tx_variables[NUM_TX_VARIABLES_GPS_L1_CA] = { (float)(epoch + 1), 0, 0, 0, 0, 0, 0, 100.0, 1 };
+            EXPECT_FALSE(transport.exchange(0, tx_variables, NUM_TX_VARIABLES_GPS_L1_CA, &tcp_data));
+        }
+
+    // A new satellite: the responses of the previous one are never used
+    transport.reset_channel(0);
+    for (int epoch = 0; epoch < 2 * pipeline_depth; epoch++)
+        {
+            float tx_variables[NUM_TX_VARIABLES_GPS_L1_CA] = { (float)(epoch + 1), 0, 0, 0, 0, 0, 0, (float)(200 + epoch), 1 };
+            bool response = transport.exchange(0, tx_variables, NUM_TX_VARIABLES_GPS_L1_CA, &tcp_data);
+            EXPECT_EQ(epoch >= pipeline_depth, response);
+            if (response)
+                {
+                    EXPECT_EQ((float)(200 + epoch - pipeline_depth), tcp_data.proc_pack_carrier_doppler_hz);
+                }
+        }
+}
+
+
+
+TEST(TcpTrackingTransport_Test, ClosesWhenTheProgramStopsReading)
+{
+    const unsigned short port = 2172;
+    const int num_epochs = 1 << 18; // Much more than the socket buffers
+
+    Tcp_Tracking_Loopback loopback(port, true);
+    boost::posix_time::ptime begin;
+    {
+        // No response is ever due, so the requests just pile up
+        Tcp_Tracking_Transport transport(port, 64, num_epochs);
+        ASSERT_TRUE(transport.connected());
+        tcp_packet_data tcp_data;
+        for (int epoch = 0; epoch < num_epochs; epoch++)
+            {
+                float tx_variables[NUM_TX_VARIABLES_GPS_L1_CA] = { (float)(epoch + 1), 0, 0, 0, 0, 0, 0, 100.0, 1 };
+                EXPECT_FALSE(transport.exchange(0, tx_variables, NUM_TX_VARIABLES_GPS_L1_CA, &tcp_data));
+            }
+        begin = boost::posix_time::microsec_clock::universal_time();
+    }
+    boost::posix_time::time_duration closing = boost::posix_time::microsec_clock::universal_time() - begin;
+    EXPECT_LT(closing.total_milliseconds(), 5000);
+}
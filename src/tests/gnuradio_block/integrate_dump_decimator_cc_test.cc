@@ -0,0 +1,83 @@
+/*!
+ * \file integrate_dump_decimator_cc_test.cc
+ * \brief  Executes an integrate-and-dump decimator in a flowgraph and
+ * checks its output.
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include <complex>
+#include <vector>
+#include <gnuradio/top_block.h>
+#include <gnuradio/blocks/vector_source_c.h>
+#include <gnuradio/blocks/vector_sink_c.h>
+#include "integrate_dump_decimator_cc.h"
+
+
+TEST(Integrate_Dump_Decimator_Cc_Test, FractionalRatio)
+{
+    // 2.5 input samples per output sample
+    double fs_in = 10000000.0;
+    double fs_out = 4000000.0;
+    int nsamples = 100000;
+    std::vector<gr_complex> input(nsamples);
+    for (int i = 0; i < nsamples; i++)
+        {
+            input[i] = gr_complex((float)(i % 7), (float)(i % 3) - 1.0);
+        }
+
+    gr::top_block_sptr top_block = gr::make_top_block("integrate_dump_decimator_cc_test");
+    gr::blocks::vector_source_c::sptr source = gr::blocks::vector_source_c::make(input);
+    integrate_dump_decimator_cc_sptr decimator = integrate_dump_make_decimator_cc(fs_in, fs_out);
+    gr::blocks::vector_sink_c::sptr sink = gr::blocks::vector_sink_c::make();
+
+    EXPECT_NO_THROW( {
+        top_block->connect(source, 0, decimator, 0);
+        top_block->connect(decimator, 0, sink, 0);
+        top_block->run(); // Start threads and wait
+    }) << "Failure running integrate_dump_decimator_cc.";
+
+    std::vector<gr_complex> output = sink->data();
+    EXPECT_LE((int)output.size(), nsamples * 2 / 5);
+    EXPECT_GE((int)output.size(), nsamples * 2 / 5 - 2);
+    for (unsigned int k = 0; k < output.size(); k++)
+        {
+            // Output k spans the input samples [2.5 k, 2.5 k + 2.5)
+            gr_complex expected;
+            if (k % 2 == 0)
+                {
+                    int first = 5 * k / 2;
+                    expected = (input[first] + input[first + 1] + input[first + 2] * (float)0.5) / (float)2.5;
+                }
+            else
+                {
+                    int first = (5 * k - 1) / 2;
+                    expected = (input[first] * (float)0.5 + input[first + 1] + input[first + 2]) / (float)2.5;
+                }
+            EXPECT_NEAR(0.0, std::abs(output[k] - expected), 1e-4);
+        }
+}
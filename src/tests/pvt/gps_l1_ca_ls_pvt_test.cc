@@ -0,0 +1,134 @@
+/*!
+ * \file gps_l1_ca_ls_pvt_test.cc
+ * \brief  This file implements tests for the velocity and clock drift
+ * solution of the GPS L1 C/A least squares PVT.
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+
+#include <cmath>
+#include <armadillo>
+#include "GPS_L1_CA.h"
+#include "gps_l1_ca_ls_pvt.h"
+
+
+/*
+ * A receiver in Barcelona, six satellites 22000 km away in directions spread
+ * over the sky, and the Doppler shifts of the receiver velocity and clock drift
+ */
+static void ls_pvt_test_geometry(arma::mat& satpos, arma::mat& satvel, arma::vec& doppler,
+        arma::vec& pos, const arma::vec& rx_vel, double drift_m_s)
+{
+    const double lat = 41.27 * GPS_PI / 180.0;
+    const double lon = 1.98 * GPS_PI / 180.0;
+    arma::vec up = arma::zeros(3);
+    up(0) = std::cos(lat) * std::cos(lon);
+    up(1) = std::cos(lat) * std::sin(lon);
+    up(2) = std::sin(lat);
+    arma::vec east = arma::zeros(3);
+    east(0) = -std::sin(lon);
+    east(1) = std::cos(lon);
+    arma::vec north = arma::cross(up, east);
+    pos = arma::zeros(4);
+    pos.subvec(0, 2) = 6371000.0 * up;
+
+    const double directions[6][3] = { { 1.0, 0.0, 0.0 }, { 0.6, 0.8, 0.0 }, { 0.6, -0.8, 0.0 },
+                                      { 0.6, 0.0, 0.8 }, { 0.6, 0.0, -0.8 }, { 0.8, 0.4, 0.4 } };
+    const double lambda = GPS_C_m_s / GPS_L1_FREQ_HZ;
+    satpos = arma::zeros(3, 6);
+    satvel = arma::zeros(3, 6);
+    doppler = arma::zeros(6);
+    for (int i = 0; i < 6; i++)
+        {
+            arma::vec los = directions[i][0] * up + directions[i][1] * east + directions[i][2] * north;
+            los = los / arma::norm(los, 2);
+            satpos.col(i) = pos.subvec(0, 2) + 22.0e6 * los;
+            satvel(0, i) = 3000.0 * std::cos((double)i);
+            satvel(1, i) = 3000.0 * std::sin((double)i);
+            satvel(2, i) = 500.0 * (double)i - 1500.0;
+            doppler(i) = -(arma::dot(los, satvel.col(i) - rx_vel) + drift_m_s) / lambda;
+        }
+}
+
+
+
+TEST(GpsL1CaLsPvt_Test, VelocityAndClockDrift)
+{
+    arma::mat satpos, satvel;
+    arma::vec doppler, pos;
+    arma::vec rx_vel = arma::zeros(3);
+    rx_vel(0) = 10.0;
+    rx_vel(1) = -5.0;
+    rx_vel(2) = 2.0;
+    const double drift_m_s = 150.0;
+    ls_pvt_test_geometry(satpos, satvel, doppler, pos, rx_vel, drift_m_s);
+
+    gps_l1_ca_ls_pvt ls_pvt(6, "", false);
+    arma::vec predicted_doppler;
+    arma::vec vel = ls_pvt.leastSquareVel(satpos, satvel, doppler, arma::eye(6, 6), pos, predicted_doppler);
+
+    // Up to the rotation of the Earth during the travel time, which the solver models
+    ASSERT_EQ(4, (int)vel.n_elem);
+    EXPECT_NEAR(rx_vel(0), vel(0), 0.5);
+    EXPECT_NEAR(rx_vel(1), vel(1), 0.5);
+    EXPECT_NEAR(rx_vel(2), vel(2), 0.5);
+    EXPECT_NEAR(drift_m_s, vel(3), 0.5);
+    ASSERT_EQ(6, (int)predicted_doppler.n_elem);
+    for (int i = 0; i < 6; i++)
+        {
+            EXPECT_NEAR(doppler(i), predicted_doppler(i), 0.5);
+        }
+}
+
+
+
+TEST(GpsL1CaLsPvt_Test, PredictsTheDopplerOfAnExcludedSatellite)
+{
+    arma::mat satpos, satvel;
+    arma::vec doppler, pos;
+    arma::vec rx_vel = arma::zeros(3);
+    rx_vel(0) = -20.0;
+    rx_vel(1) = 15.0;
+    const double drift_m_s = -80.0;
+    ls_pvt_test_geometry(satpos, satvel, doppler, pos, rx_vel, drift_m_s);
+
+    // The last satellite is out of lock: its weight is zero
+    arma::vec measured_doppler = doppler;
+    measured_doppler(5) += 1000.0;
+    arma::mat w = arma::eye(6, 6);
+    w(5, 5) = 0.0;
+
+    gps_l1_ca_ls_pvt ls_pvt(6, "", false);
+    arma::vec predicted_doppler;
+    arma::vec vel = ls_pvt.leastSquareVel(satpos, satvel, measured_doppler, w, pos, predicted_doppler);
+    EXPECT_NEAR(rx_vel(0), vel(0), 0.5);
+    EXPECT_NEAR(rx_vel(1), vel(1), 0.5);
+    EXPECT_NEAR(rx_vel(2), vel(2), 0.5);
+    EXPECT_NEAR(drift_m_s, vel(3), 0.5);
+    EXPECT_NEAR(doppler(5), predicted_doppler(5), 0.5);
+}
@@ -0,0 +1,187 @@
+/*!
+ * \file gps_acquisition_assistance_test.cc
+ * \brief  This file implements tests for the Doppler and elevation
+ * predictions of the GPS acquisition assistance.
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include <cmath>
+#include <cstring>
+#include "gps_almanac.h"
+#include "gps_acquisition_assistance.h"
+#include "gnss_sdr_supl_client.h"
+
+
+// A GPS orbit, and a receiver that sees the satellite at the time of the fix
+static void set_assistance_test_almanac(unsigned int prn)
+{
+    Gps_Almanac almanac;
+    almanac.i_satellite_PRN = prn;
+    almanac.d_sqrt_A = 5153.6;
+    almanac.d_e_eccentricity = 0.01;
+    almanac.d_M_0 = 0.2;
+    almanac.d_OMEGA = 0.3;
+    almanac.d_Delta_i = 0.0133;
+    almanac.d_OMEGA0 = 0.5;
+    almanac.d_OMEGA_DOT = -2.6e-9;
+    almanac.d_Toa = 100000.0;
+    Gps_Acquisition_Assistance::instance()->set_almanac(almanac);
+}
+
+
+TEST(GpsAcquisitionAssistance_Test, PropagatesWithTheReceiverTime)
+{
+    const unsigned int prn = 31;
+    Gps_Acquisition_Assistance* assistance = Gps_Acquisition_Assistance::instance();
+    set_assistance_test_almanac(prn);
+
+    double doppler_hz, uncertainty_hz, elevation_deg;
+    bool clock_calibrated;
+    assistance->set_receiver_fix(41.27, 1.98, 0.0, 100000.0, 50.0);
+    ASSERT_TRUE(assistance->predict(prn, 50.0, &doppler_hz, &uncertainty_hz, &elevation_deg, &clock_calibrated));
+    EXPECT_FALSE(clock_calibrated);
+    EXPECT_EQ(0.0, uncertainty_hz);
+    double doppler_at_fix_hz = doppler_hz;
+
+    // 60 s of samples after the fix, whatever the time it took to process them
+    double doppler_later_hz, elevation_later_deg;
+    ASSERT_TRUE(assistance->predict(prn, 110.0, &doppler_later_hz, &uncertainty_hz, &elevation_later_deg, &clock_calibrated));
+    EXPECT_GT(std::abs(doppler_later_hz - doppler_at_fix_hz), 1.0);
+
+    // The same as a fix taken 60 s later
+    assistance->set_receiver_fix(41.27, 1.98, 0.0, 100060.0, 1000.0);
+    ASSERT_TRUE(assistance->predict(prn, 1000.0, &doppler_hz, &uncertainty_hz, &elevation_deg, &clock_calibrated));
+    EXPECT_NEAR(doppler_later_hz, doppler_hz, 1e-6);
+    EXPECT_NEAR(elevation_later_deg, elevation_deg, 1e-9);
+
+    // No orbit, no prediction
+    EXPECT_FALSE(assistance->predict(prn + 1, 1000.0, &doppler_hz, &uncertainty_hz, &elevation_deg, &clock_calibrated));
+}
+
+
+TEST(GpsAcquisitionAssistance_Test, WindowWidensWithAge)
+{
+    const unsigned int prn = 31;
+    Gps_Acquisition_Assistance* assistance = Gps_Acquisition_Assistance::instance();
+    set_assistance_test_almanac(prn);
+    assistance->set_receiver_fix(41.27, 1.98, 0.0, 100000.0, 50.0);
+
+    double doppler_hz, uncertainty_hz, elevation_deg;
+    bool clock_calibrated;
+    const double ages_s[] = { 0.0, 1.0, 30.0, 300.0 };
+    double previous_hz = -1.0;
+    for (unsigned int k = 0; k < sizeof(ages_s) / sizeof(double); k++)
+        {
+            ASSERT_TRUE(assistance->predict(prn, 50.0 + ages_s[k], &doppler_hz, &uncertainty_hz, &elevation_deg, &clock_calibrated));
+            EXPECT_DOUBLE_EQ(ages_s[k] * GPS_ASSISTANCE_DOPPLER_DRIFT_HZ_S, uncertainty_hz);
+            EXPECT_GT(uncertainty_hz, previous_hz);
+            previous_hz = uncertainty_hz;
+        }
+    // Samples older than the fix are as uncertain
+    ASSERT_TRUE(assistance->predict(prn, 20.0, &doppler_hz, &uncertainty_hz, &elevation_deg, &clock_calibrated));
+    EXPECT_DOUBLE_EQ(30.0 * GPS_ASSISTANCE_DOPPLER_DRIFT_HZ_S, uncertainty_hz);
+}
+
+
+TEST(GpsAcquisitionAssistance_Test, EstimatesTheClockOffset)
+{
+    const unsigned int prn = 31;
+    Gps_Acquisition_Assistance* assistance = Gps_Acquisition_Assistance::instance();
+    set_assistance_test_almanac(prn);
+    assistance->set_receiver_fix(41.27, 1.98, 0.0, 100000.0, 50.0);
+
+    double geometric_hz, doppler_hz, uncertainty_hz, elevation_deg;
+    bool clock_calibrated;
+    ASSERT_TRUE(assistance->predict(prn, 50.0, &geometric_hz, &uncertainty_hz, &elevation_deg, &clock_calibrated));
+
+    // Doppler shifts measured at the fix with a clock offset of 500 Hz
+    assistance->report_doppler(prn, geometric_hz + 490.0);
+    assistance->report_doppler(prn, geometric_hz + 510.0);
+    ASSERT_TRUE(assistance->predict(prn, 50.0, &doppler_hz, &uncertainty_hz, &elevation_deg, &clock_calibrated));
+    EXPECT_TRUE(clock_calibrated);
+    EXPECT_NEAR(geometric_hz + 500.0, doppler_hz, 1e-6);
+
+    // A new fix estimates it again
+    assistance->set_receiver_fix(41.27, 1.98, 0.0, 100000.0, 50.0);
+    ASSERT_TRUE(assistance->predict(prn, 50.0, &doppler_hz, &uncertainty_hz, &elevation_deg, &clock_calibrated));
+    EXPECT_FALSE(clock_calibrated);
+}
+
+
+TEST(GpsAcquisitionAssistance_Test, PredictsWithTheSuplAlmanac)
+{
+    // The orbit of set_assistance_test_almanac(), as SUPL (RRLP) almanac fields
+    supl_assist_t assist;
+    memset(&assist, 0, sizeof(assist));
+    assist.cnt_alm = 1;
+    struct supl_almanac_s* a = &assist.alm[0];
+    a->prn = 29;
+    a->e = 20972;           // 2^-21
+    a->toa = 24;            // 2^12 s
+    a->Ksii = 6973;         // 2^-19 semi-circles
+    a->OMEGA_dot = -715;    // 2^-38 semi-circles/s
+    a->A_sqrt = 10554573;   // 2^-11 m^1/2
+    a->OMEGA_0 = 4194304;   // 2^-23 semi-circles
+    a->w = 2516582;         // 2^-23 semi-circles
+    a->M0 = 1677722;        // 2^-23 semi-circles
+
+    gnss_sdr_supl_client supl_client;
+    supl_client.read_supl_data(assist);
+    ASSERT_EQ(1, supl_client.gps_almanac_map.count(29));
+    Gps_Almanac supl_almanac = supl_client.gps_almanac_map[29];
+    EXPECT_NEAR(0.01, supl_almanac.d_e_eccentricity, 1e-6);
+    EXPECT_DOUBLE_EQ(98304.0, supl_almanac.d_Toa);
+    EXPECT_NEAR(5153.6, supl_almanac.d_sqrt_A, 1e-3);
+
+    Gps_Almanac almanac;
+    almanac.i_satellite_PRN = 30;
+    almanac.d_sqrt_A = 5153.6;
+    almanac.d_e_eccentricity = 0.01;
+    almanac.d_M_0 = 0.2;
+    almanac.d_OMEGA = 0.3;
+    almanac.d_Delta_i = 0.0133;
+    almanac.d_OMEGA0 = 0.5;
+    almanac.d_OMEGA_DOT = -2.6e-9;
+    almanac.d_Toa = 98304.0;
+
+    // Same predictions, up to the resolution of the fields
+    Gps_Acquisition_Assistance* assistance = Gps_Acquisition_Assistance::instance();
+    assistance->set_almanac(supl_almanac);
+    assistance->set_almanac(almanac);
+    assistance->set_receiver_fix(41.27, 1.98, 0.0, 98304.0, 50.0);
+    double supl_doppler_hz, supl_elevation_deg, doppler_hz, elevation_deg, uncertainty_hz;
+    bool clock_calibrated;
+    const double ages_s[] = { 0.0, 3600.0 };
+    for (unsigned int k = 0; k < sizeof(ages_s) / sizeof(double); k++)
+        {
+            ASSERT_TRUE(assistance->predict(29, 50.0 + ages_s[k], &supl_doppler_hz, &uncertainty_hz, &supl_elevation_deg, &clock_calibrated));
+            ASSERT_TRUE(assistance->predict(30, 50.0 + ages_s[k], &doppler_hz, &uncertainty_hz, &elevation_deg, &clock_calibrated));
+            EXPECT_NEAR(doppler_hz, supl_doppler_hz, 1.0);
+            EXPECT_NEAR(elevation_deg, supl_elevation_deg, 0.01);
+        }
+}
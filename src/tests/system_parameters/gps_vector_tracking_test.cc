@@ -0,0 +1,62 @@
+/*!
+ * \file gps_vector_tracking_test.cc
+ * \brief  This file implements tests for the predictions shared
+ * by the PVT block with the vector tracking loops.
+ *
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+
+#include "gps_vector_tracking.h"
+
+
+TEST(GpsVectorTracking_Test, IgnoresStalePredictions)
+{
+    const unsigned int prn = 29;
+    Gps_Vector_Tracking* vector_tracking = Gps_Vector_Tracking::instance();
+    double carrier_doppler_hz = 0.0;
+    double code_freq_chips = 0.0;
+    EXPECT_FALSE(vector_tracking->get_prediction(prn, 10.0, &carrier_doppler_hz, &code_freq_chips));
+
+    vector_tracking->set_prediction(prn, 10.0, 1234.5, 1023000.8);
+    EXPECT_TRUE(vector_tracking->get_prediction(prn, 10.5, &carrier_doppler_hz, &code_freq_chips));
+    EXPECT_DOUBLE_EQ(1234.5, carrier_doppler_hz);
+    EXPECT_DOUBLE_EQ(1023000.8, code_freq_chips);
+    EXPECT_TRUE(vector_tracking->get_prediction(prn, 10.0 + GPS_VECTOR_TRACKING_MAX_AGE_S, &carrier_doppler_hz, &code_freq_chips));
+
+    // Older than the maximum age, or from a later time than the channel
+    carrier_doppler_hz = 0.0;
+    EXPECT_FALSE(vector_tracking->get_prediction(prn, 10.0 + GPS_VECTOR_TRACKING_MAX_AGE_S + 0.01, &carrier_doppler_hz, &code_freq_chips));
+    EXPECT_FALSE(vector_tracking->get_prediction(prn, 10.0 - GPS_VECTOR_TRACKING_MAX_AGE_S - 0.01, &carrier_doppler_hz, &code_freq_chips));
+    EXPECT_EQ(0.0, carrier_doppler_hz);
+
+    // A new prediction replaces the stale one, and the other satellites are not aided
+    vector_tracking->set_prediction(prn, 20.0, -800.0, 1022999.5);
+    EXPECT_TRUE(vector_tracking->get_prediction(prn, 20.2, &carrier_doppler_hz, &code_freq_chips));
+    EXPECT_DOUBLE_EQ(-800.0, carrier_doppler_hz);
+    EXPECT_FALSE(vector_tracking->get_prediction(prn + 1, 20.2, &carrier_doppler_hz, &code_freq_chips));
+}
@@ -70,12 +70,32 @@ using google::LogMessage;
 DECLARE_string(log_dir);
 
 #include "arithmetic/complex_carrier_test.cc"
+#include "arithmetic/carrier_nco_test.cc"
 #include "arithmetic/conjugate_test.cc"
+#include "arithmetic/doppler_rotation_test.cc"
+#include "arithmetic/folded_search_test.cc"
+#include "arithmetic/wipeoff_table_test.cc"
+#include "arithmetic/doppler_batch_engine_test.cc"
+#include "arithmetic/parallel_doppler_search_test.cc"
+#include "arithmetic/hierarchical_doppler_search_test.cc"
+#include "arithmetic/acquisition_service_test.cc"
+#include "arithmetic/code_spectrum_cache_test.cc"
+#include "arithmetic/noncoherent_grid_test.cc"
+#include "arithmetic/grid_recorder_test.cc"
 #include "arithmetic/magnitude_squared_test.cc"
 #include "arithmetic/multiply_test.cc"
+#include "arithmetic/multi_correlator_test.cc"
+#include "arithmetic/multichannel_correlator_test.cc"
+#include "arithmetic/bit_packed_correlator_test.cc"
+#include "arithmetic/code_replica_test.cc"
+#include "arithmetic/tracking_window_test.cc"
+#include "arithmetic/bit_synchronizer_test.cc"
+#include "arithmetic/tracking_loop_filter_test.cc"
+#include "arithmetic/streaming_lock_detector_test.cc"
 #include "configuration/file_configuration_test.cc"
 #include "configuration/in_memory_configuration_test.cc"
 #include "control_thread/control_message_factory_test.cc"
+#include "control_thread/channel_scheduler_test.cc"
 //#include "control_thread/control_thread_test.cc"
 #include "flowgraph/pass_through_test.cc"
 //#include "flowgraph/gnss_flowgraph_test.cc"
@@ -98,8 +118,13 @@ DECLARE_string(log_dir);
 #include "gnss_block/galileo_e1_pcps_tong_ambiguous_acquisition_gsoc2013_test.cc"
 #include "gnss_block/galileo_e1_pcps_cccwsr_ambiguous_acquisition_gsoc2013_test.cc"
 #include "gnss_block/galileo_e1_dll_pll_veml_tracking_test.cc"
+#include "gnss_block/tcp_tracking_transport_test.cc"
 #include "gnuradio_block/gnss_sdr_valve_test.cc"
 #include "gnuradio_block/direct_resampler_conditioner_cc_test.cc"
+#include "gnuradio_block/integrate_dump_decimator_cc_test.cc"
+#include "pvt/gps_l1_ca_ls_pvt_test.cc"
+#include "system_parameters/gps_acquisition_assistance_test.cc"
+#include "system_parameters/gps_vector_tracking_test.cc"
 #include "string_converter/string_converter_test.cc"
 
 